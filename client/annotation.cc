@@ -39,4 +39,26 @@ void Annotation::Clear() {
   size_ = 0;
 }
 
+bool Annotation::BeginSequencedUpdate(uint16_t* sequence) {
+  uint16_t current = sequence_.load(std::memory_order_relaxed);
+  if ((current & 1) ||
+      !sequence_.compare_exchange_strong(
+          current, current + 1, std::memory_order_relaxed)) {
+    return false;
+  }
+
+  // Make the odd counter visible before any of the writes to the value.
+  std::atomic_thread_fence(std::memory_order_release);
+  *sequence = current + 1;
+  return true;
+}
+
+void Annotation::EndSequencedUpdate(uint16_t sequence) {
+  DCHECK(sequence & 1);
+
+  // 0 means that the counter has never been used, so skip it on wraparound.
+  const uint16_t next = static_cast<uint16_t>(sequence + 1);
+  sequence_.store(next ? next : 2, std::memory_order_release);
+}
+
 }  // namespace crashpad
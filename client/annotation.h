@@ -85,6 +85,10 @@ class Annotation {
     //! \brief A `NUL`-terminated C-string.
     kString = 1,
 
+    //! \brief A ring buffer of binary records, as stored by
+    //!     BreadcrumbAnnotation.
+    kBreadcrumbs = 2,
+
     //! \brief Clients may declare their own custom types by using values
     //!     greater than this.
     kUserDefinedStart = 0x8000,
@@ -133,7 +137,8 @@ class Annotation {
         name_(name),
         value_ptr_(value_ptr),
         size_(0),
-        type_(type) {}
+        type_(type),
+        sequence_(0) {}
 
   //! \brief Specifies the number of bytes in \a value_ptr_ to include when
   //!     generating a crash report.
@@ -170,6 +175,25 @@ class Annotation {
 
   std::atomic<Annotation*>& link_node() { return link_node_; }
 
+  //! \brief Begins an update of the annotation’s value and size, protected by
+  //!     a sequence counter.
+  //!
+  //! The counter is odd while an update is in progress, and a crash handler
+  //! reading the annotation will discard a value that it finds being updated
+  //! or that changed while it was being read, instead of reporting a torn
+  //! value. This method never waits: if another thread is already updating the
+  //! annotation, it returns `false`, and the caller must not modify the value,
+  //! leaving the other thread’s value in place.
+  //!
+  //! \param[out] sequence The counter value to pass to EndSequencedUpdate().
+  //!
+  //! \return `true` if the caller may update the value and must then call
+  //!     EndSequencedUpdate(), `false` otherwise.
+  bool BeginSequencedUpdate(uint16_t* sequence);
+
+  //! \brief Ends an update begun by BeginSequencedUpdate().
+  void EndSequencedUpdate(uint16_t sequence);
+
  private:
   //! \brief Linked list next-node pointer. Accessed only by \sa AnnotationList.
   //!
@@ -183,6 +207,14 @@ class Annotation {
   ValueSizeType size_;
   const Type type_;
 
+  //! \brief The sequence counter used by BeginSequencedUpdate() and
+  //!     EndSequencedUpdate().
+  //!
+  //! This is `0` for annotations that have never been updated that way, so
+  //! that readers know not to check it. It occupies what would otherwise be
+  //! padding, so it doesn’t change the layout seen by older readers.
+  std::atomic<uint16_t> sequence_;
+
   DISALLOW_COPY_AND_ASSIGN(Annotation);
 };
 
@@ -259,6 +291,160 @@ class StringAnnotation : public Annotation {
   DISALLOW_COPY_AND_ASSIGN(StringAnnotation);
 };
 
+//! \brief An \sa Annotation that stores a string value, and that can be set
+//!     from multiple threads without external synchronization.
+//!
+//! This behaves like StringAnnotation, but its value and size are updated
+//! under a sequence counter, so a crash report will never contain a value
+//! that was torn by a concurrent or interrupted Set(). A value that was being
+//! set at the time of the crash is omitted from the report. Set() never blocks
+//! or spins: when two threads set the annotation at the same time, one of
+//! their values is kept and the other is discarded.
+//!
+//! This is intended for annotations that are updated frequently from several
+//! threads, such as one recording the current request being handled.
+template <Annotation::ValueSizeType MaxSize>
+class SequencedStringAnnotation : public Annotation {
+ public:
+  //! \brief Constructs a new SequencedStringAnnotation with the given \a name.
+  //!
+  //! \param[in] name The Annotation name.
+  constexpr explicit SequencedStringAnnotation(const char name[])
+      : Annotation(Type::kString, name, value_), value_() {}
+
+  //! \brief Sets the Annotation’s string value.
+  //!
+  //! \param[in] string The string value.
+  //!
+  //! \return `true` if the value was set, or `false` if it was discarded
+  //!     because another thread was setting the annotation at the same time.
+  bool Set(base::StringPiece string) {
+    uint16_t sequence;
+    if (!BeginSequencedUpdate(&sequence)) {
+      return false;
+    }
+
+    Annotation::ValueSizeType size =
+        std::min(MaxSize, base::saturated_cast<ValueSizeType>(string.size()));
+    memcpy(value_, string.data(), size);
+    // Check for no embedded `NUL` characters.
+    DCHECK(!memchr(value_, '\0', size)) << "embedded NUL";
+    SetSize(size);
+
+    EndSequencedUpdate(sequence);
+    return true;
+  }
+
+ private:
+  // This value is not `NUL`-terminated, since the size is stored by the base
+  // annotation.
+  char value_[MaxSize];
+
+  DISALLOW_COPY_AND_ASSIGN(SequencedStringAnnotation);
+};
+
+//! \brief An \sa Annotation that records the most recent of a stream of small
+//!     binary records, such as the last events handled before a crash.
+//!
+//! The records are stored in a fixed-size ring buffer of \a NumRecords slots,
+//! each holding up to \a RecordSize bytes. Add() is lock-free, may be called
+//! from any number of threads at once, and is async-signal-safe, provided that
+//! the annotation has been registered by a previous call. The first call
+//! registers the annotation and calls AnnotationList::Register(), which
+//! allocates the annotation list if the module doesn’t have one yet.
+//!
+//! The whole buffer is the annotation’s value, so it is captured in a crash
+//! report as-is. Its layout, in the native byte order, is a header of four
+//! `uint32_t` fields:
+//!  - the format version, BreadcrumbAnnotation::kVersion
+//!  - the maximum size of a record, \a RecordSize
+//!  - the number of slots, \a NumRecords
+//!  - the index that the next record will be given
+//!
+//! followed by \a NumRecords slots, each of which is a `uint32_t` stamp, a
+//! `uint32_t` record size, and \a RecordSize bytes of record data. The record
+//! with index `i` is stored in slot `i % NumRecords`, and its slot’s stamp is
+//! `i + 1` once it has been written. A stamp of `0` means that the slot has
+//! never been written or is being written. A slot holds a record that belongs
+//! in the report if its stamp is nonzero, `(stamp - 1) % NumRecords` is the
+//! slot’s position, and `next_index - stamp`, computed modulo 2<sup>32</sup>,
+//! is less than \a NumRecords. The record with the largest such stamp is the
+//! most recent.
+//!
+//! A record can only be torn if enough other records are added while it is
+//! being written that the buffer wraps around to its slot.
+template <size_t RecordSize, size_t NumRecords>
+class BreadcrumbAnnotation : public Annotation {
+ public:
+  //! \brief The version of the buffer layout, stored in its header.
+  static constexpr uint32_t kVersion = 1;
+
+  //! \brief Constructs a new BreadcrumbAnnotation with the given \a name.
+  //!
+  //! \param[in] name The Annotation name.
+  constexpr explicit BreadcrumbAnnotation(const char name[])
+      : Annotation(Type::kBreadcrumbs, name, &buffer_),
+        buffer_{kVersion, RecordSize, NumRecords, {0}, {}} {}
+
+  //! \brief Adds a record, replacing the oldest one if the buffer is full.
+  //!
+  //! \param[in] data The record data.
+  //! \param[in] size The size of \a data. Records larger than \a RecordSize
+  //!     are truncated.
+  void Add(const void* data, size_t size) {
+    const uint32_t index =
+        buffer_.next_index.fetch_add(1, std::memory_order_relaxed);
+    Record& record = buffer_.records[index % NumRecords];
+
+    // Invalidate the slot before overwriting it, so that a partially-written
+    // record is never reported with the stamp of the one it replaces.
+    record.stamp.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    record.size = static_cast<uint32_t>(std::min(size, RecordSize));
+    memcpy(record.data, data, record.size);
+    record.stamp.store(index + 1, std::memory_order_release);
+
+    if (!is_set()) {
+      SetSize(sizeof(buffer_));
+    }
+  }
+
+ private:
+  static_assert(NumRecords > 0 && (NumRecords & (NumRecords - 1)) == 0,
+                "NumRecords must be a power of 2");
+  static_assert(RecordSize % sizeof(uint32_t) == 0,
+                "RecordSize must be a multiple of 4");
+
+  struct Record {
+    std::atomic<uint32_t> stamp;
+    uint32_t size;
+    char data[RecordSize];
+  };
+
+  struct Buffer {
+    const uint32_t version;
+    const uint32_t record_size;
+    const uint32_t num_records;
+    std::atomic<uint32_t> next_index;
+    Record records[NumRecords];
+  };
+
+  static_assert(sizeof(Buffer) == sizeof(uint32_t) * 4 +
+                                      NumRecords * (sizeof(uint32_t) * 2 +
+                                                    RecordSize),
+                "Buffer must not be padded");
+  static_assert(sizeof(Buffer) < kValueMaxSize, "Buffer too large");
+
+  Buffer buffer_;
+
+  DISALLOW_COPY_AND_ASSIGN(BreadcrumbAnnotation);
+};
+
+// static
+template <size_t RecordSize, size_t NumRecords>
+constexpr uint32_t BreadcrumbAnnotation<RecordSize, NumRecords>::kVersion;
+
 }  // namespace crashpad
 
 #endif  // CRASHPAD_CLIENT_ANNOTATION_H_
@@ -19,10 +19,14 @@
 
 namespace crashpad {
 
+// static
+constexpr size_t AnnotationList::kRegistryCapacity;
+
 AnnotationList::AnnotationList()
     : tail_pointer_(&tail_),
       head_(Annotation::Type::kInvalid, nullptr, nullptr),
-      tail_(Annotation::Type::kInvalid, nullptr, nullptr) {
+      tail_(Annotation::Type::kInvalid, nullptr, &registry_),
+      registry_() {
   head_.link_node().store(&tail_);
 }
 
@@ -57,6 +61,15 @@ void AnnotationList::Add(Annotation* annotation) {
   // path is taken once per annotation.
   DCHECK_LT(strlen(annotation->name_), Annotation::kNameMaxLength);
 
+  // Record |annotation| in the registry before linking it into the list, so
+  // that anything reachable through the list is also in the registry, unless
+  // the registry is full.
+  const uint32_t slot =
+      registry_.count.fetch_add(1, std::memory_order_relaxed);
+  if (slot < kRegistryCapacity) {
+    registry_.entries[slot].store(annotation, std::memory_order_release);
+  }
+
   // Update the head link to point to the new |annotation|.
   while (!head_.link_node().compare_exchange_weak(head_next, annotation)) {
     // Another thread has updated the head-next pointer, so try again with the
@@ -15,6 +15,10 @@
 #ifndef CRASHPAD_CLIENT_ANNOTATION_LIST_H_
 #define CRASHPAD_CLIENT_ANNOTATION_LIST_H_
 
+#include <stdint.h>
+
+#include <atomic>
+
 #include "base/macros.h"
 #include "client/annotation.h"
 
@@ -28,6 +32,15 @@ namespace crashpad {
 //! be used instead.
 class AnnotationList {
  public:
+  //! \brief The number of annotations that can be recorded in the registry.
+  //!
+  //! In addition to the linked list, the AnnotationList records each annotation
+  //! in a contiguous array, so that a crash handler can locate all of them in a
+  //! single read instead of following the list one node at a time. Annotations
+  //! beyond this number are still added to the list, but a handler will need
+  //! to walk the list to find them.
+  static constexpr size_t kRegistryCapacity = 1024;
+
   AnnotationList();
   ~AnnotationList();
 
@@ -83,9 +96,21 @@ class AnnotationList {
   const Annotation* const tail_pointer_;
 
   // Dummy linked-list head and tail elements of \a Annotation::Type::kInvalid.
+  // The tail’s value points to registry_, which lets the handler tell whether
+  // a registry is present. Older clients leave it null.
   Annotation head_;
   Annotation tail_;
 
+  // Every annotation that has been added, in the order that they were added.
+  // count is the number of slots claimed, which may exceed kRegistryCapacity.
+  // A claimed slot is briefly null until Add() stores the annotation into it.
+  // This is placed after the fields above so that their layout doesn’t change.
+  struct Registry {
+    std::atomic<uint32_t> count;
+    std::atomic<Annotation*> entries[kRegistryCapacity];
+  };
+  Registry registry_;
+
   DISALLOW_COPY_AND_ASSIGN(AnnotationList);
 };
 
@@ -16,9 +16,11 @@
 
 #include <array>
 #include <string>
+#include <vector>
 
 #include "client/annotation_list.h"
 #include "client/crashpad_info.h"
+#include "client/test/test_sequenced_string_annotation.h"
 #include "gtest/gtest.h"
 #include "test/gtest_death.h"
 
@@ -108,6 +110,96 @@ TEST_F(Annotation, StringType) {
   EXPECT_EQ("loooo", annotation.value());
 }
 
+TEST_F(Annotation, SequencedStringType) {
+  TestSequencedStringAnnotation<5> annotation("name");
+
+  EXPECT_FALSE(annotation.is_set());
+  EXPECT_EQ(crashpad::Annotation::Type::kString, annotation.type());
+
+  EXPECT_TRUE(annotation.Set("test"));
+  EXPECT_TRUE(annotation.is_set());
+  EXPECT_EQ(1u, AnnotationsCount());
+  EXPECT_EQ(4u, annotation.size());
+  EXPECT_EQ("test",
+            std::string(static_cast<const char*>(annotation.value()),
+                        annotation.size()));
+
+  EXPECT_TRUE(annotation.Set(std::string("loooooooooooong")));
+  EXPECT_EQ(5u, annotation.size());
+  EXPECT_EQ("loooo",
+            std::string(static_cast<const char*>(annotation.value()),
+                        annotation.size()));
+
+  // While another update is in progress, Set() doesn’t wait, and discards its
+  // value.
+  uint16_t sequence;
+  ASSERT_TRUE(annotation.BeginUpdate(&sequence));
+  uint16_t other_sequence;
+  EXPECT_FALSE(annotation.BeginUpdate(&other_sequence));
+  EXPECT_FALSE(annotation.Set("fail"));
+  annotation.EndUpdate(sequence);
+  EXPECT_EQ("loooo",
+            std::string(static_cast<const char*>(annotation.value()),
+                        annotation.size()));
+
+  EXPECT_TRUE(annotation.Set("ok"));
+  EXPECT_EQ("ok",
+            std::string(static_cast<const char*>(annotation.value()),
+                        annotation.size()));
+}
+
+// Returns the records in a BreadcrumbAnnotation’s value, oldest first, by
+// decoding it as a crash processor would.
+std::vector<std::string> BreadcrumbRecords(const void* value, size_t size) {
+  const uint32_t* header = static_cast<const uint32_t*>(value);
+  EXPECT_EQ(header[0], 1u);
+  const uint32_t record_size = header[1];
+  const uint32_t num_records = header[2];
+  const uint32_t next_index = header[3];
+  const size_t stride = sizeof(uint32_t) * 2 + record_size;
+  EXPECT_EQ(size, sizeof(uint32_t) * 4 + num_records * stride);
+
+  std::vector<std::string> records;
+  for (uint32_t age = num_records; age > 0; --age) {
+    const uint32_t stamp = next_index - age + 1;
+    const uint32_t slot = (stamp - 1) % num_records;
+    const char* record = static_cast<const char*>(value) +
+                         sizeof(uint32_t) * 4 + slot * stride;
+    const uint32_t* record_header = reinterpret_cast<const uint32_t*>(record);
+    if (stamp != 0 && record_header[0] == stamp) {
+      records.push_back(std::string(record + sizeof(uint32_t) * 2,
+                                    record_header[1]));
+    }
+  }
+  return records;
+}
+
+TEST_F(Annotation, BreadcrumbType) {
+  crashpad::BreadcrumbAnnotation<8, 4> annotation("name");
+
+  EXPECT_FALSE(annotation.is_set());
+  EXPECT_EQ(crashpad::Annotation::Type::kBreadcrumbs, annotation.type());
+  EXPECT_EQ(0u, AnnotationsCount());
+  EXPECT_TRUE(BreadcrumbRecords(annotation.value(),
+                                sizeof(uint32_t) * 4 + 4 * (8 + 8))
+                  .empty());
+
+  annotation.Add("one", 3);
+  annotation.Add("two", 3);
+  EXPECT_TRUE(annotation.is_set());
+  EXPECT_EQ(1u, AnnotationsCount());
+  EXPECT_EQ(BreadcrumbRecords(annotation.value(), annotation.size()),
+            (std::vector<std::string>{"one", "two"}));
+
+  // Long records are truncated, and once the buffer is full, the oldest records
+  // are replaced.
+  annotation.Add("three", 5);
+  annotation.Add("four", 4);
+  annotation.Add("five is too long", 16);
+  EXPECT_EQ(BreadcrumbRecords(annotation.value(), annotation.size()),
+            (std::vector<std::string>{"two", "three", "four", "five is "}));
+}
+
 TEST(StringAnnotation, ArrayOfString) {
   static crashpad::StringAnnotation<4> annotations[] = {
       {"test-1", crashpad::StringAnnotation<4>::Tag::kArray},
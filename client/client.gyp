@@ -70,6 +70,8 @@
             'client_argv_handling.h',
             'crashpad_info_note.S',
             'crash_report_database_generic.cc',
+            'shared_annotation_storage.cc',
+            'shared_annotation_storage.h',
           ],
         }],
       ],
@@ -46,6 +46,7 @@
         'simple_address_range_bag_test.cc',
         'simple_string_dictionary_test.cc',
         'simulate_crash_mac_test.cc',
+        'test/test_sequenced_string_annotation.h',
       ],
       'conditions': [
         ['OS=="win"', {
@@ -53,6 +54,11 @@
             '../handler/handler.gyp:crashpad_handler_console',
           ],
         }],
+        ['OS=="linux" or OS=="android"', {
+          'sources': [
+            'shared_annotation_storage_test.cc',
+          ],
+        }],
       ],
       'target_conditions': [
         ['OS=="android"', {
@@ -80,6 +80,8 @@ CrashReportDatabase::UploadReport::UploadReport()
       database_(nullptr),
       attachment_readers_(),
       attachment_map_(),
+      upload_parameters_(),
+      has_upload_parameters_(false),
       report_metrics_(false) {}
 
 CrashReportDatabase::UploadReport::~UploadReport() {
@@ -88,6 +90,15 @@ CrashReportDatabase::UploadReport::~UploadReport() {
   }
 }
 
+bool CrashReportDatabase::UploadReport::GetUploadParameters(
+    std::map<std::string, std::string>* parameters) const {
+  if (!has_upload_parameters_) {
+    return false;
+  }
+  *parameters = upload_parameters_;
+  return true;
+}
+
 bool CrashReportDatabase::UploadReport::Initialize(const base::FilePath path,
                                                    CrashReportDatabase* db) {
   database_ = db;
@@ -136,6 +136,19 @@ class CrashReportDatabase {
     //!     the attachment, or `nullptr` on failure with an error logged.
     FileWriter* AddAttachment(const std::string& name);
 
+    //! \brief Records the HTTP form parameters to upload with the report.
+    //!
+    //! These are stored alongside the report so that an uploader can obtain
+    //! them with UploadReport::GetUploadParameters() instead of deriving them
+    //! from the report itself. They are not uploaded as an attachment.
+    //!
+    //! \note This function is not yet implemented on macOS or Windows.
+    //!
+    //! \param[in] parameters The form parameters.
+    //! \return `true` on success, `false` on failure with an error logged.
+    bool SetUploadParameters(
+        const std::map<std::string, std::string>& parameters);
+
    private:
     friend class CrashReportDatabaseGeneric;
     friend class CrashReportDatabaseMac;
@@ -175,6 +188,16 @@ class CrashReportDatabase {
       return attachment_map_;
     }
 
+    //! \brief Obtains the HTTP form parameters recorded for the report by
+    //!     NewReport::SetUploadParameters().
+    //!
+    //! \param[out] parameters The form parameters.
+    //! \return `true` if parameters were recorded for the report. `false` if
+    //!     they were not, or could not be read, in which case the caller must
+    //!     derive them from the report itself.
+    bool GetUploadParameters(
+        std::map<std::string, std::string>* parameters) const;
+
    private:
     friend class CrashReportDatabase;
     friend class CrashReportDatabaseGeneric;
@@ -188,6 +211,8 @@ class CrashReportDatabase {
     CrashReportDatabase* database_;
     std::vector<std::unique_ptr<FileReader>> attachment_readers_;
     std::map<std::string, FileReader*> attachment_map_;
+    std::map<std::string, std::string> upload_parameters_;
+    bool has_upload_parameters_;
     bool report_metrics_;
 
     DISALLOW_COPY_AND_ASSIGN(UploadReport);
@@ -404,6 +429,17 @@ class CrashReportDatabase {
   //! \return The number of reports cleaned.
   virtual int CleanDatabase(time_t lockfile_ttl) { return 0; }
 
+  //! \brief Returns the directory into which reports are moved as they become
+  //!     pending, so that it can be watched for newly pending reports.
+  //!
+  //! Reports only enter this directory by being renamed into it, so watching
+  //! for files moved into it is sufficient to observe new pending reports.
+  //!
+  //! \return The directory, or an empty path if the database implementation
+  //!     does not keep pending reports in a single directory. The macOS and
+  //!     Windows implementations always return an empty path.
+  virtual base::FilePath PendingReportsDirectory() { return base::FilePath(); }
+
  protected:
   CrashReportDatabase() {}
 
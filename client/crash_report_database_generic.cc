@@ -15,12 +15,14 @@
 #include "client/crash_report_database.h"
 
 #include <stdint.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 
 #include <utility>
 
 #include "base/logging.h"
+#include "base/numerics/safe_conversions.h"
 #include "build/build_config.h"
 #include "client/settings.h"
 #include "util/file/directory_reader.h"
@@ -72,6 +74,12 @@ constexpr base::FilePath::CharType kCompletedDirectory[] =
 constexpr base::FilePath::CharType kAttachmentsDirectory[] =
     FILE_PATH_LITERAL("attachments");
 
+// Upload parameters are kept in the report’s attachments directory, so that
+// they share the attachments’ lifetime, under a name that AttachmentNameIsOK()
+// rejects so that it can’t collide with an attachment.
+constexpr base::FilePath::CharType kUploadParametersFile[] =
+    FILE_PATH_LITERAL("@upload_parameters");
+
 constexpr const base::FilePath::CharType* kReportDirectories[] = {
     kNewDirectory,
     kPendingDirectory,
@@ -171,6 +179,74 @@ off_t GetFileSize(const base::FilePath& filepath) {
   return 0;
 }
 
+// The upload parameters file contains kUploadParametersVersion, followed by
+// each key and value in turn, each preceded by its uint32_t length.
+constexpr int32_t kUploadParametersVersion = 1;
+
+void AppendSizedString(const std::string& value, std::string* data) {
+  const uint32_t size = base::checked_cast<uint32_t>(value.size());
+  data->append(reinterpret_cast<const char*>(&size), sizeof(size));
+  data->append(value);
+}
+
+bool ReadSizedString(const std::string& data,
+                     size_t* offset,
+                     std::string* value) {
+  uint32_t size;
+  if (data.size() - *offset < sizeof(size)) {
+    return false;
+  }
+  memcpy(&size, &data[*offset], sizeof(size));
+  *offset += sizeof(size);
+
+  if (data.size() - *offset < size) {
+    return false;
+  }
+  value->assign(data, *offset, size);
+  *offset += size;
+  return true;
+}
+
+std::string SerializeUploadParameters(
+    const std::map<std::string, std::string>& parameters) {
+  std::string data(reinterpret_cast<const char*>(&kUploadParametersVersion),
+                   sizeof(kUploadParametersVersion));
+  for (const auto& kv : parameters) {
+    AppendSizedString(kv.first, &data);
+    AppendSizedString(kv.second, &data);
+  }
+  return data;
+}
+
+bool DeserializeUploadParameters(
+    const std::string& data,
+    std::map<std::string, std::string>* parameters) {
+  int32_t version;
+  if (data.size() < sizeof(version)) {
+    LOG(ERROR) << "upload parameters too short";
+    return false;
+  }
+  memcpy(&version, data.data(), sizeof(version));
+  if (version != kUploadParametersVersion) {
+    LOG(ERROR) << "upload parameters version mismatch";
+    return false;
+  }
+
+  parameters->clear();
+  size_t offset = sizeof(version);
+  while (offset < data.size()) {
+    std::string key;
+    std::string value;
+    if (!ReadSizedString(data, &offset, &key) ||
+        !ReadSizedString(data, &offset, &value)) {
+      LOG(ERROR) << "upload parameters truncated";
+      return false;
+    }
+    (*parameters)[key] = value;
+  }
+  return true;
+}
+
 void AddAttachmentSize(const base::FilePath& attachments_dir, uint64_t* size) {
   // Early return if the attachment directory does not exist.
   if (!IsDirectory(attachments_dir, /*allow_symlinks=*/false)) {
@@ -217,6 +293,7 @@ class CrashReportDatabaseGeneric : public CrashReportDatabase {
   OperationStatus DeleteReport(const UUID& uuid) override;
   OperationStatus RequestUpload(const UUID& uuid) override;
   int CleanDatabase(time_t lockfile_ttl) override;
+  base::FilePath PendingReportsDirectory() override;
 
   // Build a filepath for the directory for the report to hold attachments.
   base::FilePath AttachmentsPath(const UUID& uuid);
@@ -329,6 +406,36 @@ FileWriter* CrashReportDatabase::NewReport::AddAttachment(
   return attachment_writers_.back().get();
 }
 
+bool CrashReportDatabase::NewReport::SetUploadParameters(
+    const std::map<std::string, std::string>& parameters) {
+  base::FilePath attachments_dir =
+      static_cast<CrashReportDatabaseGeneric*>(database_)->AttachmentsPath(
+          uuid_);
+  if (!LoggingCreateDirectory(
+          attachments_dir, FilePermissions::kOwnerOnly, true)) {
+    return false;
+  }
+
+  base::FilePath path = attachments_dir.Append(kUploadParametersFile);
+
+  FileWriter writer;
+  if (!writer.Open(path,
+                   FileWriteMode::kTruncateOrCreate,
+                   FilePermissions::kOwnerOnly)) {
+    LOG(ERROR) << "could not open " << path.value();
+    return false;
+  }
+  ScopedRemoveFile remover(path);
+
+  const std::string data = SerializeUploadParameters(parameters);
+  if (!writer.Write(data.data(), data.size())) {
+    return false;
+  }
+
+  attachment_removers_.emplace_back(std::move(remover));
+  return true;
+}
+
 void CrashReportDatabase::UploadReport::InitializeAttachments() {
   base::FilePath attachments_dir =
       static_cast<CrashReportDatabaseGeneric*>(database_)->AttachmentsPath(
@@ -346,6 +453,14 @@ void CrashReportDatabase::UploadReport::InitializeAttachments() {
   while ((dir_result = reader.NextFile(&filename)) ==
          DirectoryReader::Result::kSuccess) {
     const base::FilePath filepath(attachments_dir.Append(filename));
+    if (filename.value() == kUploadParametersFile) {
+      std::string data;
+      has_upload_parameters_ =
+          LoggingReadEntireFile(filepath, &data) &&
+          DeserializeUploadParameters(data, &upload_parameters_);
+      continue;
+    }
+
     std::unique_ptr<FileReader> reader(std::make_unique<FileReader>());
     if (!reader->Open(filepath)) {
       LOG(ERROR) << "attachment " << filepath.value()
@@ -639,6 +754,11 @@ int CrashReportDatabaseGeneric::CleanDatabase(time_t lockfile_ttl) {
   return removed;
 }
 
+base::FilePath CrashReportDatabaseGeneric::PendingReportsDirectory() {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return base_dir_.Append(kPendingDirectory);
+}
+
 OperationStatus CrashReportDatabaseGeneric::RecordUploadAttempt(
     UploadReport* report,
     bool successful,
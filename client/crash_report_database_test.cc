@@ -719,6 +719,46 @@ TEST_F(CrashReportDatabaseTest, Attachments) {
 #endif
 }
 
+TEST_F(CrashReportDatabaseTest, UploadParameters) {
+#if defined(OS_MACOSX) || defined(OS_WIN)
+  // Upload parameters aren't supported on Mac and Windows yet.
+  GTEST_SKIP();
+#else
+  // A report without recorded parameters doesn’t have any.
+  CrashReportDatabase::Report report;
+  ASSERT_NO_FATAL_FAILURE(CreateCrashReport(&report));
+  std::unique_ptr<const CrashReportDatabase::UploadReport> upload_report;
+  ASSERT_EQ(db()->GetReportForUploading(report.uuid, &upload_report),
+            CrashReportDatabase::kNoError);
+  std::map<std::string, std::string> parameters;
+  EXPECT_FALSE(upload_report->GetUploadParameters(&parameters));
+  upload_report.reset();
+
+  std::unique_ptr<CrashReportDatabase::NewReport> new_report;
+  ASSERT_EQ(db()->PrepareNewCrashReport(&new_report),
+            CrashReportDatabase::kNoError);
+  const std::map<std::string, std::string> kParameters = {
+      {"prod", "product"},
+      {"list_annotations", "one\ntwo"},
+      {"empty", ""},
+      {std::string("nul\0key", 7), std::string("\0", 1)},
+  };
+  ASSERT_TRUE(new_report->SetUploadParameters(kParameters));
+
+  UUID uuid;
+  ASSERT_EQ(db()->FinishedWritingCrashReport(std::move(new_report), &uuid),
+            CrashReportDatabase::kNoError);
+
+  ASSERT_EQ(db()->GetReportForUploading(uuid, &upload_report),
+            CrashReportDatabase::kNoError);
+  ASSERT_TRUE(upload_report->GetUploadParameters(&parameters));
+  EXPECT_EQ(parameters, kParameters);
+
+  // The parameters aren’t uploaded as an attachment.
+  EXPECT_TRUE(upload_report->GetAttachments().empty());
+#endif
+}
+
 TEST_F(CrashReportDatabaseTest, OrphanedAttachments) {
 #if defined(OS_MACOSX) || defined(OS_WIN)
   // Attachments aren't supported on Mac and Windows yet.
@@ -836,6 +876,26 @@ TEST_F(CrashReportDatabaseTest, CleanBrokenDatabase) {
   EXPECT_FALSE(PathExists(report.file_path));
   EXPECT_FALSE(PathExists(metadata3));
 }
+
+TEST_F(CrashReportDatabaseTest, PendingReportsDirectory) {
+  const base::FilePath pending_dir = db()->PendingReportsDirectory();
+  ASSERT_FALSE(pending_dir.empty());
+
+  CrashReportDatabase::Report report;
+  ASSERT_NO_FATAL_FAILURE(CreateCrashReport(&report));
+  EXPECT_EQ(report.file_path.DirName(), pending_dir);
+
+  // A report that is explicitly requested for upload after its upload was
+  // skipped returns to the pending directory.
+  EXPECT_EQ(db()->SkipReportUpload(
+                report.uuid, Metrics::CrashSkippedReason::kUploadsDisabled),
+            CrashReportDatabase::kNoError);
+  EXPECT_EQ(db()->RequestUpload(report.uuid), CrashReportDatabase::kNoError);
+  CrashReportDatabase::Report requested;
+  EXPECT_EQ(db()->LookUpCrashReport(report.uuid, &requested),
+            CrashReportDatabase::kNoError);
+  EXPECT_EQ(requested.file_path.DirName(), pending_dir);
+}
 #endif  // !OS_MACOSX && !OS_WIN
 
 TEST_F(CrashReportDatabaseTest, TotalSize_MainReportOnly) {
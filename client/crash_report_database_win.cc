@@ -633,6 +633,12 @@ FileWriter* CrashReportDatabase::NewReport::AddAttachment(
   return nullptr;
 }
 
+bool CrashReportDatabase::NewReport::SetUploadParameters(
+    const std::map<std::string, std::string>& parameters) {
+  // Upload parameters aren't implemented in the Windows database yet.
+  return false;
+}
+
 void CrashReportDatabase::UploadReport::InitializeAttachments() {
   // Attachments aren't implemented in the Windows database yet.
 }
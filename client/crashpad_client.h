@@ -40,6 +40,10 @@
 
 namespace crashpad {
 
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+class SharedAnnotationStorage;
+#endif  // OS_LINUX || OS_ANDROID
+
 //! \brief The primary interface for an application to have Crashpad monitor
 //!     it for crashes.
 class CrashpadClient {
@@ -423,6 +427,39 @@ class CrashpadClient {
   //!
   //! \param[in] unhandled_signals The set of unhandled signals
   void SetUnhandledSignals(const std::set<int>& unhandled_signals);
+
+  //! \brief Keeps this module’s crash keys in storage that is shared with the
+  //!     handler.
+  //!
+  //! This installs the SimpleStringDictionary and AnnotationList held in
+  //! \a storage in this module’s CrashpadInfo, replacing any that were
+  //! installed before, so it should be called before any crash keys are set.
+  //! StartHandler() and SetHandlerSocket() share \a storage with the handler,
+  //! which then reads it from its own mapping instead of from this process.
+  //!
+  //! This method should be called before calling StartHandler() or
+  //! SetHandlerSocket().
+  //!
+  //! \param[in] storage The storage to use, which must have been successfully
+  //!     initialized and must outlive this process’ use of Crashpad.
+  void SetSharedAnnotationStorage(SharedAnnotationStorage* storage);
+
+  //! \brief Sends the crashing thread’s state to the handler with each crash
+  //!     dump request.
+  //!
+  //! When enabled, the signal handler copies the crashing thread’s signal
+  //! information, context, and the most recently used part of its stack into
+  //! a memory file that is passed to the handler. The handler reads these
+  //! locally instead of from this process. If the handler can’t attach to the
+  //! crashing thread, it captures that thread with the context and stack from
+  //! the file instead. This is disabled by default.
+  //!
+  //! This method should be called before calling StartHandler() or
+  //! SetHandlerSocket().
+  //!
+  //! \param[in] send_crashing_thread_state Whether to send the crashing
+  //!     thread’s state.
+  void SetSendCrashingThreadState(bool send_crashing_thread_state);
 #endif  // OS_LINUX || OS_ANDROID || DOXYGEN
 
 #if defined(OS_IOS) || DOXYGEN
@@ -636,6 +673,8 @@ class CrashpadClient {
   ScopedKernelHANDLE handler_start_thread_;
 #elif defined(OS_LINUX) || defined(OS_ANDROID)
   std::set<int> unhandled_signals_;
+  SharedAnnotationStorage* shared_annotation_storage_;
+  bool send_crashing_thread_state_;
 #endif  // OS_MACOSX
 
   DISALLOW_COPY_AND_ASSIGN(CrashpadClient);
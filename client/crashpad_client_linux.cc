@@ -26,6 +26,8 @@
 #include "base/logging.h"
 #include "base/strings/stringprintf.h"
 #include "client/client_argv_handling.h"
+#include "client/crashpad_info.h"
+#include "client/shared_annotation_storage.h"
 #include "third_party/lss/lss.h"
 #include "util/file/file_io.h"
 #include "util/file/filesystem.h"
@@ -282,14 +284,20 @@ class RequestCrashDumpHandler : public SignalHandler {
   // retrieving this information from the handler is not necessary.
   bool Initialize(ScopedFileHandle sock,
                   pid_t pid,
-                  const std::set<int>* unhandled_signals) {
+                  const std::set<int>* unhandled_signals,
+                  const SharedAnnotationStorage* shared_annotation_storage,
+                  bool send_crashing_thread_state) {
     ExceptionHandlerClient client(sock.get(), true);
+    ucred creds;
+    uint32_t handler_features = 0;
     if (pid < 0) {
-      ucred creds;
-      if (!client.GetHandlerCredentials(&creds)) {
+      if (!client.GetHandlerCredentials(&creds, &handler_features)) {
         return false;
       }
       pid = creds.pid;
+    } else if (shared_annotation_storage &&
+               !client.GetHandlerCredentials(&creds, &handler_features)) {
+      handler_features = 0;
     }
     if (pid > 0 && prctl(PR_SET_PTRACER, pid, 0, 0, 0) != 0) {
       PLOG(WARNING) << "prctl";
@@ -303,8 +311,24 @@ class RequestCrashDumpHandler : public SignalHandler {
       // with the handler. ExceptionHandlerClient lifetimes and ownership will
       // need to be reconsidered if it becomes responsible for state.
     }
+    if (shared_annotation_storage) {
+      // Without the shared storage, the handler reads annotations from this
+      // process instead, so failing to share it isn’t fatal. A handler that
+      // doesn’t support sharing would reject the message and drop this
+      // client, so it’s only sent to handlers that report support for it.
+      if (!(handler_features & ExceptionHandlerProtocol::ServerToClientMessage::
+                                   kFeatureSharedAnnotations)) {
+        LOG(WARNING) << "handler doesn't support shared annotation storage";
+      } else if (client.RegisterSharedAnnotations(
+              shared_annotation_storage->fd(),
+              shared_annotation_storage->address(),
+              shared_annotation_storage->size()) != 0) {
+        LOG(WARNING) << "couldn't share annotation storage with the handler";
+      }
+    }
     sock_to_handler_.reset(sock.release());
     handler_pid_ = pid;
+    send_crashing_thread_state_ = send_crashing_thread_state;
     return Install(unhandled_signals);
   }
 
@@ -330,6 +354,7 @@ class RequestCrashDumpHandler : public SignalHandler {
 #endif
 
     ExceptionHandlerClient client(sock_to_handler_.get(), true);
+    client.SetSendCrashingThreadState(send_crashing_thread_state_);
     client.RequestCrashDump(info);
   }
 
@@ -346,6 +371,7 @@ class RequestCrashDumpHandler : public SignalHandler {
 
   ScopedFileHandle sock_to_handler_;
   pid_t handler_pid_ = -1;
+  bool send_crashing_thread_state_ = false;
 
 #if defined(OS_CHROMEOS)
   // An optional UNIX timestamp passed to us from Chrome.
@@ -360,7 +386,10 @@ class RequestCrashDumpHandler : public SignalHandler {
 
 }  // namespace
 
-CrashpadClient::CrashpadClient() {}
+CrashpadClient::CrashpadClient()
+    : unhandled_signals_(),
+      shared_annotation_storage_(nullptr),
+      send_crashing_thread_state_(false) {}
 
 CrashpadClient::~CrashpadClient() {}
 
@@ -396,8 +425,11 @@ bool CrashpadClient::StartHandler(
   }
 
   auto signal_handler = RequestCrashDumpHandler::Get();
-  return signal_handler->Initialize(
-      std::move(client_sock), handler_pid, &unhandled_signals_);
+  return signal_handler->Initialize(std::move(client_sock),
+                                    handler_pid,
+                                    &unhandled_signals_,
+                                    shared_annotation_storage_,
+                                    send_crashing_thread_state_);
 }
 
 #if defined(OS_ANDROID) || defined(OS_LINUX)
@@ -409,7 +441,11 @@ bool CrashpadClient::GetHandlerSocket(int* sock, pid_t* pid) {
 
 bool CrashpadClient::SetHandlerSocket(ScopedFileHandle sock, pid_t pid) {
   auto signal_handler = RequestCrashDumpHandler::Get();
-  return signal_handler->Initialize(std::move(sock), pid, &unhandled_signals_);
+  return signal_handler->Initialize(std::move(sock),
+                                    pid,
+                                    &unhandled_signals_,
+                                    shared_annotation_storage_,
+                                    send_crashing_thread_state_);
 }
 #endif  // OS_ANDROID || OS_LINUX
 
@@ -573,6 +609,21 @@ void CrashpadClient::SetUnhandledSignals(const std::set<int>& signals) {
   unhandled_signals_ = signals;
 }
 
+void CrashpadClient::SetSharedAnnotationStorage(
+    SharedAnnotationStorage* storage) {
+  DCHECK(!SignalHandler::Get());
+  CrashpadInfo* crashpad_info = CrashpadInfo::GetCrashpadInfo();
+  crashpad_info->set_simple_annotations(storage->simple_annotations());
+  crashpad_info->set_annotations_list(storage->annotations_list());
+  shared_annotation_storage_ = storage;
+}
+
+void CrashpadClient::SetSendCrashingThreadState(
+    bool send_crashing_thread_state) {
+  DCHECK(!SignalHandler::Get());
+  send_crashing_thread_state_ = send_crashing_thread_state;
+}
+
 #if defined(OS_CHROMEOS)
 // static
 void CrashpadClient::SetCrashLoopBefore(uint64_t crash_loop_before_time) {
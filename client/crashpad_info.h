@@ -22,6 +22,7 @@
 #include "client/annotation_list.h"
 #include "client/simple_address_range_bag.h"
 #include "client/simple_string_dictionary.h"
+#include "util/misc/capture_profile.h"
 #include "util/misc/tri_state.h"
 
 #if defined(OS_WIN)
@@ -101,13 +102,42 @@ struct CrashpadInfo {
   //! \sa simple_annotations()
   void set_simple_annotations(SimpleStringDictionary* simple_annotations) {
     simple_annotations_ = simple_annotations;
+    simple_annotations_entries_ = 0;
   }
 
-  //! \return The simple annotations dictionary.
+  //! \brief Sets the simple annotations dictionary to one that finds its
+  //!     entries by hashing their keys.
+  //!
+  //! This behaves like set_simple_annotations(SimpleStringDictionary*), but
+  //! allows for many more than SimpleStringDictionary::num_entries
+  //! annotations. The number of entries is recorded, so that all of them are
+  //! read.
+  //!
+  //! \param[in] simple_annotations A dictionary that maps string keys to string
+  //!     values. The CrashpadInfo object does not take ownership of the
+  //!     THashedSimpleStringDictionary object. It is the caller’s
+  //!     responsibility to ensure that this pointer remains valid while it is
+  //!     in effect for a CrashpadInfo object.
+  //!
+  //! \sa simple_annotations()
+  template <size_t NumEntries>
+  void set_simple_annotations(
+      THashedSimpleStringDictionary<SimpleStringDictionary::key_size,
+                                    SimpleStringDictionary::value_size,
+                                    NumEntries>* simple_annotations) {
+    static_assert(NumEntries > 0 && NumEntries <= kMaxSimpleAnnotationsEntries,
+                  "too many entries");
+    simple_annotations_ =
+        reinterpret_cast<SimpleStringDictionary*>(simple_annotations);
+    simple_annotations_entries_ = NumEntries;
+  }
+
+  //! \return The simple annotations dictionary, or `nullptr` if none has been
+  //!     set or if a THashedSimpleStringDictionary was set.
   //!
   //! \sa set_simple_annotations()
   SimpleStringDictionary* simple_annotations() const {
-    return simple_annotations_;
+    return simple_annotations_entries_ == 0 ? simple_annotations_ : nullptr;
   }
 
   //! \brief Sets the annotations list.
@@ -198,6 +228,19 @@ struct CrashpadInfo {
     indirectly_referenced_memory_cap_ = limit;
   }
 
+  //! \brief Selects how much of the process the Crashpad handler captures.
+  //!
+  //! When handling an exception, the Crashpad handler will scan all modules in
+  //! a process. The first one that has a CrashpadInfo structure populated with
+  //! a value other than CaptureProfile::kUnset for this field will dictate the
+  //! capture profile. If all modules with a CrashpadInfo structure specify
+  //! CaptureProfile::kUnset, the handler’s default profile will be used.
+  //!
+  //! This is currently only supported on Linux and Android.
+  void set_capture_profile(CaptureProfile capture_profile) {
+    capture_profile_ = capture_profile;
+  }
+
   //! \brief Adds a custom stream to the minidump.
   //!
   //! The memory block referenced by \a data and \a size will added to the
@@ -223,6 +266,13 @@ struct CrashpadInfo {
     kSignature = 'CPad',
   };
 
+  enum : uint32_t {
+    //! \brief The largest number of entries that a
+    //!     THashedSimpleStringDictionary given to set_simple_annotations() may
+    //!     have. Readers ignore larger counts.
+    kMaxSimpleAnnotationsEntries = 4096,
+  };
+
  private:
   // The compiler won’t necessarily see anyone using these fields, but it
   // shouldn’t warn about that. These fields aren’t intended for use by the
@@ -242,12 +292,16 @@ struct CrashpadInfo {
   TriState crashpad_handler_behavior_;
   TriState system_crash_reporter_forwarding_;
   TriState gather_indirectly_referenced_memory_;
-  uint8_t padding_1_;
+  CaptureProfile capture_profile_;
   SimpleAddressRangeBag* extra_memory_ranges_;  // weak
   SimpleStringDictionary* simple_annotations_;  // weak
   internal::UserDataMinidumpStreamListEntry* user_data_minidump_stream_head_;
   AnnotationList* annotations_list_;  // weak
 
+  // The number of entries in the THashedSimpleStringDictionary at
+  // simple_annotations_, or 0 if it’s a SimpleStringDictionary.
+  uint32_t simple_annotations_entries_;
+
   // It’s generally safe to add new fields without changing
   // kCrashpadInfoVersion, because readers should check size_ and ignore fields
   // that aren’t present, as well as unknown fields.
@@ -0,0 +1,204 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "client/shared_annotation_storage.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <mutex>
+
+#include "base/logging.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/process/process_metrics.h"
+
+namespace crashpad {
+
+namespace {
+
+// Guards g_storages, which lists every initialized storage so that each can be
+// copied for a child process. The fork handlers hold the lock across fork(),
+// so the list is consistent in the child.
+std::mutex* StoragesLock() {
+  static auto* lock = new std::mutex();
+  return lock;
+}
+
+SharedAnnotationStorage* g_storages;
+
+}  // namespace
+
+SharedAnnotationStorage::SharedAnnotationStorage()
+    : fd_(),
+      mapping_(),
+      used_(0),
+      simple_annotations_(nullptr),
+      annotations_list_(nullptr),
+      next_(nullptr),
+      initialized_() {}
+
+SharedAnnotationStorage::~SharedAnnotationStorage() {
+  std::lock_guard<std::mutex> lock(*StoragesLock());
+  for (SharedAnnotationStorage** storage = &g_storages; *storage;
+       storage = &(*storage)->next_) {
+    if (*storage == this) {
+      *storage = next_;
+      break;
+    }
+  }
+}
+
+bool SharedAnnotationStorage::Initialize(size_t size) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+
+  const size_t page_size = base::GetPageSize();
+  size = (size + page_size - 1) & ~(page_size - 1);
+
+  fd_.reset(HANDLE_EINTR(memfd_create("crashpad_annotations",
+                                      MFD_CLOEXEC | MFD_ALLOW_SEALING)));
+  if (!fd_.is_valid()) {
+    PLOG(ERROR) << "memfd_create";
+    return false;
+  }
+
+  if (HANDLE_EINTR(ftruncate(fd_.get(), size)) != 0) {
+    PLOG(ERROR) << "ftruncate";
+    return false;
+  }
+
+  if (fcntl(fd_.get(),
+            F_ADD_SEALS,
+            F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0) {
+    PLOG(ERROR) << "fcntl";
+    return false;
+  }
+
+  if (!mapping_.ResetMmap(nullptr,
+                          size,
+                          PROT_READ | PROT_WRITE,
+                          MAP_SHARED,
+                          fd_.get(),
+                          0)) {
+    return false;
+  }
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+
+  simple_annotations_ = New<SimpleStringDictionary>();
+  annotations_list_ = New<AnnotationList>();
+  if (!simple_annotations_ || !annotations_list_) {
+    LOG(ERROR) << "size " << size << " too small";
+    return false;
+  }
+
+  static const int atfork_result = pthread_atfork(
+      &PrepareFork, &ParentAfterFork, &ChildAfterFork);
+  if (atfork_result != 0) {
+    LOG(WARNING) << "pthread_atfork: " << strerror(atfork_result);
+  }
+
+  std::lock_guard<std::mutex> lock(*StoragesLock());
+  next_ = g_storages;
+  g_storages = this;
+
+  return true;
+}
+
+void* SharedAnnotationStorage::Allocate(size_t size, size_t alignment) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  DCHECK(alignment && !(alignment & (alignment - 1)));
+
+  size_t used = used_.load(std::memory_order_relaxed);
+  size_t offset;
+  do {
+    offset = (used + alignment - 1) & ~(alignment - 1);
+    if (offset > mapping_.len() || mapping_.len() - offset < size) {
+      return nullptr;
+    }
+  } while (!used_.compare_exchange_weak(
+      used, offset + size, std::memory_order_relaxed));
+
+  // The memory file starts out zeroed, and allocations are never reused.
+  return mapping_.addr_as<char*>() + offset;
+}
+
+// static
+void SharedAnnotationStorage::PrepareFork() {
+  StoragesLock()->lock();
+}
+
+// static
+void SharedAnnotationStorage::ParentAfterFork() {
+  StoragesLock()->unlock();
+}
+
+// static
+void SharedAnnotationStorage::ChildAfterFork() {
+  for (SharedAnnotationStorage* storage = g_storages; storage;
+       storage = storage->next_) {
+    storage->CopyForChild();
+  }
+  StoragesLock()->unlock();
+}
+
+void SharedAnnotationStorage::CopyForChild() {
+  // Nothing can be logged here. If no copy can be made, the child is left
+  // sharing the storage with its parent.
+  const size_t size = mapping_.len();
+  ScopedFileHandle fd(HANDLE_EINTR(memfd_create(
+      "crashpad_annotations", MFD_CLOEXEC | MFD_ALLOW_SEALING)));
+  if (fd.is_valid() &&
+      (HANDLE_EINTR(ftruncate(fd.get(), size)) != 0 ||
+       fcntl(fd.get(),
+             F_ADD_SEALS,
+             F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0)) {
+    fd.reset();
+  }
+
+  // Without a memory file, the copy is held in anonymous memory.
+  void* copy = fd.is_valid()
+                   ? mmap(nullptr,
+                          size,
+                          PROT_READ | PROT_WRITE,
+                          MAP_SHARED,
+                          fd.get(),
+                          0)
+                   : mmap(nullptr,
+                          size,
+                          PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS,
+                          -1,
+                          0);
+  if (copy == MAP_FAILED) {
+    return;
+  }
+  memcpy(copy, mapping_.addr(), size);
+
+  // Replacing the parent’s mapping in place keeps every pointer into the
+  // storage valid.
+  if (mremap(copy,
+             size,
+             size,
+             MREMAP_MAYMOVE | MREMAP_FIXED,
+             mapping_.addr()) == MAP_FAILED) {
+    munmap(copy, size);
+    return;
+  }
+  fd_.reset(fd.release());
+}
+
+}  // namespace crashpad
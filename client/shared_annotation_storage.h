@@ -0,0 +1,135 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_CLIENT_SHARED_ANNOTATION_STORAGE_H_
+#define CRASHPAD_CLIENT_SHARED_ANNOTATION_STORAGE_H_
+
+#include <stddef.h>
+
+#include <atomic>
+#include <new>
+#include <utility>
+
+#include "base/macros.h"
+#include "client/annotation_list.h"
+#include "client/simple_string_dictionary.h"
+#include "util/file/file_io.h"
+#include "util/misc/address_types.h"
+#include "util/misc/initialization_state_dcheck.h"
+#include "util/posix/scoped_mmap.h"
+
+namespace crashpad {
+
+//! \brief Storage for annotations in a memory file that is shared with the
+//!     Crashpad handler.
+//!
+//! The handler maps the same file, so it can read everything stored here from
+//! its own mapping when it captures a crash dump, without reading this
+//! process’ memory. This holds a SimpleStringDictionary and an AnnotationList,
+//! which CrashpadClient::SetSharedAnnotationStorage() installs in this
+//! module’s CrashpadInfo, and any annotations allocated with New().
+//!
+//! Annotations allocated elsewhere, such as those with static storage
+//! duration, may still be added to the AnnotationList. Their values are read
+//! from this process, as usual.
+//!
+//! The storage isn’t shared across `fork()`. A child process gets its own
+//! memory file holding a copy of the storage, mapped at the same address, so
+//! that the parent and child don’t see each other’s annotations. The child’s
+//! copy isn’t shared with the handler, which reads it from the child’s memory.
+//!
+//! Objects of this class should never be destroyed once they have been
+//! installed.
+class SharedAnnotationStorage {
+ public:
+  SharedAnnotationStorage();
+  ~SharedAnnotationStorage();
+
+  //! \brief Creates and maps the memory file.
+  //!
+  //! The file is sealed against resizing, so that the handler can safely map
+  //! it.
+  //!
+  //! \param[in] size The size of the storage, which is rounded up to a
+  //!     multiple of the page size. This must be large enough for a
+  //!     SimpleStringDictionary and an AnnotationList.
+  //!
+  //! \return `true` on success, `false` on failure with a message logged.
+  bool Initialize(size_t size);
+
+  //! \brief Allocates memory from the storage.
+  //!
+  //! Memory allocated from the storage can’t be freed. This method is
+  //! lock-free and async-signal-safe.
+  //!
+  //! \param[in] size The size of the allocation.
+  //! \param[in] alignment The required alignment of the allocation, which must
+  //!     be a power of 2.
+  //!
+  //! \return The allocated memory, which is zeroed, or `nullptr` if there
+  //!     isn’t enough space left.
+  void* Allocate(size_t size, size_t alignment);
+
+  //! \brief Constructs an object, such as a StringAnnotation, in the storage.
+  //!
+  //! \return The new object, or `nullptr` if there isn’t enough space left.
+  template <typename T, typename... Args>
+  T* New(Args&&... args) {
+    void* memory = Allocate(sizeof(T), alignof(T));
+    return memory ? new (memory) T(std::forward<Args>(args)...) : nullptr;
+  }
+
+  //! \brief Returns the SimpleStringDictionary held in the storage.
+  SimpleStringDictionary* simple_annotations() const {
+    return simple_annotations_;
+  }
+
+  //! \brief Returns the AnnotationList held in the storage.
+  AnnotationList* annotations_list() const { return annotations_list_; }
+
+  //! \brief Returns a file descriptor for the memory file.
+  //!
+  //! In a child process that couldn’t create a memory file of its own after
+  //! `fork()`, the storage is held in anonymous memory and this returns `-1`.
+  int fd() const { return fd_.get(); }
+
+  //! \brief Returns the address at which the storage is mapped.
+  VMAddress address() const { return mapping_.addr_as<VMAddress>(); }
+
+  //! \brief Returns the size of the storage.
+  VMSize size() const { return mapping_.len(); }
+
+ private:
+  static void PrepareFork();
+  static void ParentAfterFork();
+  static void ChildAfterFork();
+
+  //! \brief Gives a child process its own copy of the storage. Called in the
+  //!     child after `fork()`, so this must be async-signal-safe.
+  void CopyForChild();
+
+  ScopedFileHandle fd_;
+  ScopedMmap mapping_;
+  std::atomic<size_t> used_;
+  SimpleStringDictionary* simple_annotations_;
+  AnnotationList* annotations_list_;
+  SharedAnnotationStorage* next_;  // The next storage to copy at fork().
+  InitializationStateDcheck initialized_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedAnnotationStorage);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_CLIENT_SHARED_ANNOTATION_STORAGE_H_
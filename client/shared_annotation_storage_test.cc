@@ -0,0 +1,134 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "client/shared_annotation_storage.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "base/posix/eintr_wrapper.h"
+#include "base/process/process_metrics.h"
+#include "client/annotation.h"
+#include "gtest/gtest.h"
+#include "test/errors.h"
+#include "util/misc/from_pointer_cast.h"
+#include "util/posix/scoped_mmap.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// Checks that |object| lies within |storage|.
+void ExpectInStorage(const SharedAnnotationStorage& storage,
+                     const void* object,
+                     size_t size) {
+  const VMAddress address = FromPointerCast<VMAddress>(object);
+  EXPECT_GE(address, storage.address());
+  EXPECT_LE(address + size, storage.address() + storage.size());
+}
+
+TEST(SharedAnnotationStorage, Basics) {
+  SharedAnnotationStorage storage;
+  ASSERT_TRUE(storage.Initialize(1));
+  EXPECT_EQ(storage.size() % base::GetPageSize(), 0u);
+
+  ASSERT_TRUE(storage.simple_annotations());
+  ExpectInStorage(
+      storage, storage.simple_annotations(), sizeof(SimpleStringDictionary));
+  ASSERT_TRUE(storage.annotations_list());
+  ExpectInStorage(storage, storage.annotations_list(), sizeof(AnnotationList));
+
+  // The file can’t be resized, so it’s safe for the handler to map.
+  int seals = fcntl(storage.fd(), F_GET_SEALS);
+  ASSERT_GE(seals, 0);
+  EXPECT_TRUE(seals & F_SEAL_SHRINK);
+  EXPECT_NE(ftruncate(storage.fd(), 0), 0);
+
+  // Objects constructed in the storage are visible through another mapping of
+  // the file.
+  auto* annotation = storage.New<StringAnnotation<8>>("name");
+  ASSERT_TRUE(annotation);
+  ExpectInStorage(storage, annotation, sizeof(*annotation));
+  storage.annotations_list()->Add(annotation);
+  annotation->Set("value");
+  storage.simple_annotations()->SetKeyValue("key", "value");
+
+  ScopedMmap mapping;
+  ASSERT_TRUE(mapping.ResetMmap(
+      nullptr, storage.size(), PROT_READ, MAP_SHARED, storage.fd(), 0));
+  const VMAddress offset =
+      FromPointerCast<VMAddress>(annotation) - storage.address();
+  const auto* mapped_annotation = reinterpret_cast<const StringAnnotation<8>*>(
+      mapping.addr_as<const char*>() + offset);
+  EXPECT_EQ(mapped_annotation->value(), "value");
+  EXPECT_EQ(memcmp(mapping.addr(),
+                   storage.simple_annotations(),
+                   sizeof(SimpleStringDictionary)),
+            0);
+}
+
+TEST(SharedAnnotationStorage, Allocate) {
+  SharedAnnotationStorage storage;
+  ASSERT_TRUE(storage.Initialize(1));
+
+  void* first = storage.Allocate(1, 1);
+  ASSERT_TRUE(first);
+  void* aligned = storage.Allocate(8, 8);
+  ASSERT_TRUE(aligned);
+  EXPECT_EQ(FromPointerCast<VMAddress>(aligned) % 8, 0u);
+  EXPECT_GT(aligned, first);
+
+  EXPECT_FALSE(storage.Allocate(storage.size(), 1));
+
+  // Allocating the rest of the storage works, and leaves nothing behind.
+  const VMSize used = FromPointerCast<VMAddress>(aligned) + 8 -
+                      storage.address();
+  EXPECT_TRUE(storage.Allocate(storage.size() - used, 1));
+  EXPECT_FALSE(storage.Allocate(1, 1));
+}
+
+TEST(SharedAnnotationStorage, Fork) {
+  SharedAnnotationStorage storage;
+  ASSERT_TRUE(storage.Initialize(1));
+  storage.simple_annotations()->SetKeyValue("key", "parent");
+
+  pid_t pid = fork();
+  ASSERT_GE(pid, 0) << ErrnoMessage("fork");
+  if (pid == 0) {
+    // The child starts with a copy of the parent’s storage at the same
+    // address, backed by a memory file of its own.
+    bool ok = storage.address() != 0 && storage.fd() >= 0 &&
+              strcmp(storage.simple_annotations()->GetValueForKey("key"),
+                     "parent") == 0;
+    storage.simple_annotations()->SetKeyValue("key", "child");
+    _exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  int status;
+  ASSERT_EQ(HANDLE_EINTR(waitpid(pid, &status, 0)), pid)
+      << ErrnoMessage("waitpid");
+  EXPECT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(WEXITSTATUS(status), EXIT_SUCCESS);
+
+  // The child’s change isn’t seen by the parent.
+  EXPECT_STREQ(storage.simple_annotations()->GetValueForKey("key"), "parent");
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
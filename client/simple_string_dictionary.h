@@ -15,6 +15,7 @@
 #ifndef CRASHPAD_CLIENT_SIMPLE_STRING_DICTIONARY_H_
 #define CRASHPAD_CLIENT_SIMPLE_STRING_DICTIONARY_H_
 
+#include <stdint.h>
 #include <string.h>
 #include <sys/types.h>
 
@@ -237,6 +238,9 @@ class TSimpleStringDictionary {
   }
 
  private:
+  template <size_t, size_t, size_t>
+  friend class THashedSimpleStringDictionary;
+
   static void SetFromStringPiece(base::StringPiece src,
                                  char* dst,
                                  size_t dst_size) {
@@ -274,6 +278,237 @@ class TSimpleStringDictionary {
   Entry entries_[NumEntries];
 };
 
+//! \brief A TSimpleStringDictionary that finds entries by hashing their keys,
+//!     for use when \a NumEntries is large.
+//!
+//! TSimpleStringDictionary compares a key against every entry to find it,
+//! which becomes expensive for maps with hundreds of entries. This class keeps
+//! a hash of each entry’s key and uses open addressing with linear probing, so
+//! that a lookup usually examines only one or two entries.
+//!
+//! Like TSimpleStringDictionary, this class does not perform any dynamic
+//! allocations, and none of its methods take locks, so they are safe to call
+//! from signal handlers. Like TSimpleStringDictionary, it is not safe to call
+//! methods that modify the map concurrently with any other method.
+//!
+//! The entries are stored first, in the same layout as a
+//! TSimpleStringDictionary with the same template parameters, and the hashes
+//! follow them. A dictionary with the default \a KeySize and \a ValueSize can
+//! be registered with CrashpadInfo::set_simple_annotations(), which records
+//! \a NumEntries so that the handler reads all of the entries.
+template <size_t KeySize = 256, size_t ValueSize = 256, size_t NumEntries = 64>
+class THashedSimpleStringDictionary {
+ private:
+  using Base = TSimpleStringDictionary<KeySize, ValueSize, NumEntries>;
+
+ public:
+  //! \brief Constant and publicly accessible versions of the template
+  //!     parameters.
+  //! \{
+  static const size_t key_size = KeySize;
+  static const size_t value_size = ValueSize;
+  static const size_t num_entries = NumEntries;
+  //! \}
+
+  //! \brief A single entry in the map, identical to
+  //!     TSimpleStringDictionary::Entry.
+  using Entry = typename Base::Entry;
+
+  //! \brief An iterator to traverse all of the active entries in a
+  //!     THashedSimpleStringDictionary.
+  class Iterator {
+   public:
+    explicit Iterator(const THashedSimpleStringDictionary& map)
+        : map_(map), current_(0) {}
+
+    //! \brief Returns the next entry in the map, or `nullptr` if at the end of
+    //!     the collection.
+    const Entry* Next() {
+      while (current_ < map_.num_entries) {
+        const Entry* entry = &map_.entries_[current_++];
+        if (entry->is_active()) {
+          return entry;
+        }
+      }
+      return nullptr;
+    }
+
+   private:
+    const THashedSimpleStringDictionary& map_;
+    size_t current_;
+
+    DISALLOW_COPY_AND_ASSIGN(Iterator);
+  };
+
+  THashedSimpleStringDictionary() : entries_(), hashes_() {}
+
+  THashedSimpleStringDictionary(const THashedSimpleStringDictionary& other) {
+    *this = other;
+  }
+
+  THashedSimpleStringDictionary& operator=(
+      const THashedSimpleStringDictionary& other) {
+    memcpy(entries_, other.entries_, sizeof(entries_));
+    memcpy(hashes_, other.hashes_, sizeof(hashes_));
+    return *this;
+  }
+
+  //! \brief Returns the number of active key/value pairs. The upper limit for
+  //!     this is \a NumEntries.
+  size_t GetCount() const {
+    size_t count = 0;
+    for (size_t i = 0; i < num_entries; ++i) {
+      if (entries_[i].is_active()) {
+        ++count;
+      }
+    }
+    return count;
+  }
+
+  //! \copydoc TSimpleStringDictionary::GetValueForKey()
+  const char* GetValueForKey(base::StringPiece key) const {
+    DCHECK(key.data());
+    DCHECK(key.size());
+    DCHECK_EQ(key.find('\0', 0), base::StringPiece::npos);
+    if (!key.data() || !key.size()) {
+      return nullptr;
+    }
+
+    const size_t index = FindIndex(key, HashKey(key));
+    if (index == num_entries) {
+      return nullptr;
+    }
+
+    return entries_[index].value;
+  }
+
+  //! \copydoc TSimpleStringDictionary::SetKeyValue()
+  void SetKeyValue(base::StringPiece key, base::StringPiece value) {
+    if (!value.data()) {
+      RemoveKey(key);
+      return;
+    }
+
+    DCHECK(key.data());
+    DCHECK(key.size());
+    DCHECK_EQ(key.find('\0', 0), base::StringPiece::npos);
+    if (!key.data() || !key.size()) {
+      return;
+    }
+
+    // |key| must not be an empty string.
+    DCHECK_NE(key[0], '\0');
+    if (key[0] == '\0') {
+      return;
+    }
+
+    // |value| must not contain embedded NULs.
+    DCHECK_EQ(value.find('\0', 0), base::StringPiece::npos);
+
+    const uint32_t hash = HashKey(key);
+    size_t index = FindIndex(key, hash);
+
+    // If it does not yet exist, attempt to insert it in the first unused slot
+    // along its probe sequence.
+    if (index == num_entries) {
+      const size_t start = hash % num_entries;
+      for (size_t probe = 0; probe < num_entries; ++probe) {
+        const size_t candidate = (start + probe) % num_entries;
+        if (hashes_[candidate] == kUnusedHash) {
+          index = candidate;
+          Base::SetFromStringPiece(key, entries_[index].key, key_size);
+          hashes_[index] = hash;
+          break;
+        }
+      }
+    }
+
+    // If the map is out of space, |index| will be num_entries.
+    if (index == num_entries) {
+      return;
+    }
+
+    Base::SetFromStringPiece(value, entries_[index].value, value_size);
+  }
+
+  //! \copydoc TSimpleStringDictionary::RemoveKey()
+  void RemoveKey(base::StringPiece key) {
+    DCHECK(key.data());
+    DCHECK(key.size());
+    DCHECK_EQ(key.find('\0', 0), base::StringPiece::npos);
+    if (!key.data() || !key.size()) {
+      return;
+    }
+
+    size_t hole = FindIndex(key, HashKey(key));
+    if (hole == num_entries) {
+      return;
+    }
+
+    // A probe sequence ends at the first unused slot, so removing an entry
+    // mustn’t leave a gap ahead of any entry that was stored beyond it. Move
+    // each such entry back into the gap, which leaves a new gap where it was,
+    // until reaching an unused slot. This keeps removal from leaving markers
+    // behind that would lengthen later probes.
+    size_t index = hole;
+    for (size_t probe = 1; probe < num_entries; ++probe) {
+      index = (index + 1) % num_entries;
+      if (hashes_[index] == kUnusedHash) {
+        break;
+      }
+
+      // The entry can move if the gap is no further along its probe sequence
+      // than the entry itself.
+      const size_t home = hashes_[index] % num_entries;
+      if ((index + num_entries - home) % num_entries >=
+          (index + num_entries - hole) % num_entries) {
+        entries_[hole] = entries_[index];
+        hashes_[hole] = hashes_[index];
+        hole = index;
+      }
+    }
+
+    entries_[hole].key[0] = '\0';
+    entries_[hole].value[0] = '\0';
+    hashes_[hole] = kUnusedHash;
+  }
+
+ private:
+  // A value in hashes_ that isn’t the hash of any key, marking a slot that
+  // doesn’t hold an entry. It ends a probe sequence.
+  static constexpr uint32_t kUnusedHash = 0;
+
+  // Returns the FNV-1a hash of |key|, adjusted to avoid kUnusedHash.
+  static uint32_t HashKey(base::StringPiece key) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < key.size(); ++i) {
+      hash ^= static_cast<uint8_t>(key[i]);
+      hash *= 16777619u;
+    }
+    return hash != kUnusedHash ? hash : 1;
+  }
+
+  // Returns the index of the active entry for |key|, whose hash is |hash|, or
+  // num_entries if there isn’t one.
+  size_t FindIndex(base::StringPiece key, uint32_t hash) const {
+    const size_t start = hash % num_entries;
+    for (size_t probe = 0; probe < num_entries; ++probe) {
+      const size_t index = (start + probe) % num_entries;
+      if (hashes_[index] == kUnusedHash) {
+        break;
+      }
+      if (hashes_[index] == hash &&
+          Base::EntryKeyEquals(key, entries_[index])) {
+        return index;
+      }
+    }
+    return num_entries;
+  }
+
+  Entry entries_[NumEntries];
+  uint32_t hashes_[NumEntries];
+};
+
 //! \brief A TSimpleStringDictionary with default template parameters.
 //!
 //! For historical reasons this specialized version is available with the same
@@ -283,6 +518,9 @@ using SimpleStringDictionary = TSimpleStringDictionary<256, 256, 64>;
 static_assert(std::is_standard_layout<SimpleStringDictionary>::value,
               "SimpleStringDictionary must be standard layout");
 
+static_assert(std::is_standard_layout<THashedSimpleStringDictionary<>>::value,
+              "THashedSimpleStringDictionary must be standard layout");
+
 }  // namespace crashpad
 
 #endif  // CRASHPAD_CLIENT_SIMPLE_STRING_DICTIONARY_H_
@@ -14,6 +14,11 @@
 
 #include "client/simple_string_dictionary.h"
 
+#include <stdio.h>
+
+#include <map>
+#include <string>
+
 #include "base/logging.h"
 #include "gtest/gtest.h"
 #include "test/gtest_death.h"
@@ -250,6 +255,149 @@ TEST(SimpleStringDictionary, OutOfSpace) {
   EXPECT_FALSE(map.GetValueForKey("c"));
 }
 
+TEST(HashedSimpleStringDictionary, AddRemove) {
+  THashedSimpleStringDictionary<5, 7, 6> map;
+  map.SetKeyValue("rob", "ert");
+  map.SetKeyValue("mike", "pink");
+  map.SetKeyValue("mark", "allays");
+
+  EXPECT_EQ(map.GetCount(), 3u);
+  EXPECT_STREQ("ert", map.GetValueForKey("rob"));
+  EXPECT_STREQ("pink", map.GetValueForKey("mike"));
+  EXPECT_STREQ("allays", map.GetValueForKey("mark"));
+  EXPECT_FALSE(map.GetValueForKey("bob"));
+
+  map.RemoveKey("mike");
+
+  EXPECT_EQ(map.GetCount(), 2u);
+  EXPECT_FALSE(map.GetValueForKey("mike"));
+
+  map.SetKeyValue("mark", "mal");
+  EXPECT_EQ(map.GetCount(), 2u);
+  EXPECT_STREQ("mal", map.GetValueForKey("mark"));
+
+  map.SetKeyValue("mark", base::StringPiece(nullptr, 0));
+  EXPECT_EQ(map.GetCount(), 1u);
+  EXPECT_FALSE(map.GetValueForKey("mark"));
+
+  THashedSimpleStringDictionary<5, 7, 6> copy(map);
+  EXPECT_EQ(copy.GetCount(), 1u);
+  EXPECT_STREQ("ert", copy.GetValueForKey("rob"));
+}
+
+// With more keys than entries, some keys must share probe sequences, and
+// removed entries must not hide the keys stored after them.
+TEST(HashedSimpleStringDictionary, Collisions) {
+  using TestMap = THashedSimpleStringDictionary<8, 8, 16>;
+  TestMap map;
+
+  char key[8];
+  char value[8];
+  for (int i = 0; i < 16; ++i) {
+    snprintf(key, sizeof(key), "key%d", i);
+    snprintf(value, sizeof(value), "value%d", i);
+    map.SetKeyValue(key, value);
+  }
+  EXPECT_EQ(map.GetCount(), 16u);
+
+  // The map is full.
+  map.SetKeyValue("extra", "value");
+  EXPECT_EQ(map.GetCount(), 16u);
+  EXPECT_FALSE(map.GetValueForKey("extra"));
+
+  for (int i = 0; i < 16; i += 2) {
+    snprintf(key, sizeof(key), "key%d", i);
+    map.RemoveKey(key);
+  }
+  EXPECT_EQ(map.GetCount(), 8u);
+
+  for (int i = 0; i < 16; ++i) {
+    snprintf(key, sizeof(key), "key%d", i);
+    snprintf(value, sizeof(value), "value%d", i);
+    if (i % 2 == 0) {
+      EXPECT_FALSE(map.GetValueForKey(key)) << key;
+    } else {
+      EXPECT_STREQ(map.GetValueForKey(key), value) << key;
+    }
+  }
+
+  // Removed entries are reused, and every key appears only once.
+  for (int i = 0; i < 16; ++i) {
+    snprintf(key, sizeof(key), "key%d", i);
+    map.SetKeyValue(key, "again");
+  }
+  EXPECT_EQ(map.GetCount(), 16u);
+
+  size_t count = 0;
+  TestMap::Iterator iterator(map);
+  while (const TestMap::Entry* entry = iterator.Next()) {
+    EXPECT_STREQ(entry->value, "again");
+    ++count;
+  }
+  EXPECT_EQ(count, 16u);
+}
+
+// Removal moves entries back along their probe sequences instead of leaving
+// markers behind. Churning through many more keys than the map holds must keep
+// every remaining key reachable.
+TEST(HashedSimpleStringDictionary, Churn) {
+  using TestMap = THashedSimpleStringDictionary<8, 8, 8>;
+  TestMap map;
+  std::map<std::string, std::string> expected;
+
+  char key[8];
+  char value[8];
+  for (int i = 0; i < 1000; ++i) {
+    snprintf(key, sizeof(key), "key%d", (i * 7) % 23);
+    if (i % 3 == 2) {
+      map.RemoveKey(key);
+      expected.erase(key);
+    } else {
+      snprintf(value, sizeof(value), "v%d", i);
+      map.SetKeyValue(key, value);
+      if (expected.size() < TestMap::num_entries || expected.count(key)) {
+        expected[key] = value;
+      }
+    }
+
+    ASSERT_EQ(map.GetCount(), expected.size());
+    for (int j = 0; j < 23; ++j) {
+      snprintf(key, sizeof(key), "key%d", j);
+      const auto it = expected.find(key);
+      if (it == expected.end()) {
+        EXPECT_FALSE(map.GetValueForKey(key)) << key;
+      } else {
+        EXPECT_STREQ(map.GetValueForKey(key), it->second.c_str()) << key;
+      }
+    }
+  }
+}
+
+// The entries are laid out as they are in a TSimpleStringDictionary, so that
+// the handler can read them.
+TEST(HashedSimpleStringDictionary, Layout) {
+  using TestMap = THashedSimpleStringDictionary<>;
+  static_assert(sizeof(TestMap::Entry) == sizeof(SimpleStringDictionary::Entry),
+                "Entry size mismatch");
+
+  TestMap map;
+  map.SetKeyValue("key1", "value1");
+  map.SetKeyValue("key2", "value2");
+
+  size_t count = 0;
+  TestMap::Iterator iterator(map);
+  while (const TestMap::Entry* entry = iterator.Next()) {
+    const size_t offset = reinterpret_cast<const char*>(entry) -
+                          reinterpret_cast<const char*>(&map);
+    EXPECT_EQ(offset % sizeof(SimpleStringDictionary::Entry), 0u);
+    EXPECT_LT(offset,
+              SimpleStringDictionary::num_entries *
+                  sizeof(SimpleStringDictionary::Entry));
+    ++count;
+  }
+  EXPECT_EQ(count, 2u);
+}
+
 #if DCHECK_IS_ON()
 
 TEST(SimpleStringDictionaryDeathTest, SetKeyValueWithNullKey) {
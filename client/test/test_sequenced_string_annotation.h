@@ -0,0 +1,43 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_CLIENT_TEST_TEST_SEQUENCED_STRING_ANNOTATION_H_
+#define CRASHPAD_CLIENT_TEST_TEST_SEQUENCED_STRING_ANNOTATION_H_
+
+#include <stdint.h>
+
+#include "client/annotation.h"
+
+namespace crashpad {
+namespace test {
+
+//! \brief A SequencedStringAnnotation that exposes its sequenced update
+//!     methods, so that an update can be left in progress, as it would be if
+//!     the thread updating it had crashed.
+template <Annotation::ValueSizeType MaxSize>
+class TestSequencedStringAnnotation
+    : public SequencedStringAnnotation<MaxSize> {
+ public:
+  using SequencedStringAnnotation<MaxSize>::SequencedStringAnnotation;
+
+  bool BeginUpdate(uint16_t* sequence) {
+    return this->BeginSequencedUpdate(sequence);
+  }
+  void EndUpdate(uint16_t sequence) { this->EndSequencedUpdate(sequence); }
+};
+
+}  // namespace test
+}  // namespace crashpad
+
+#endif  // CRASHPAD_CLIENT_TEST_TEST_SEQUENCED_STRING_ANNOTATION_H_
@@ -35,6 +35,7 @@
         'android/sys/mman.h',
         'android/sys/syscall.h',
         'android/sys/user.h',
+        'linux/fcntl.h',
         'linux/signal.h',
         'linux/sys/ptrace.h',
         'linux/sys/user.h',
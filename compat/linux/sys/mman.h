@@ -37,4 +37,14 @@ int memfd_create(const char* name, unsigned int flags);
 
 #endif  // __GLIBC__
 
+// Missing from glibc before 2.27 and from older bionic.
+
+#if !defined(MFD_CLOEXEC)
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+#if !defined(MFD_ALLOW_SEALING)
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+
 #endif  // CRASHPAD_COMPAT_LINUX_SYS_MMAN_H_
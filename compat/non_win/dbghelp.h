@@ -43,6 +43,12 @@
 //! \sa MINIDUMP_LOCATION_DESCRIPTOR
 typedef uint32_t RVA;
 
+//! \brief A 64-bit offset within a minidump file, relative to the start of its
+//!     MINIDUMP_HEADER.
+//!
+//! This is used where data may be located beyond the range of an RVA.
+typedef uint64_t RVA64;
+
 //! \brief A pointer to a structure or union within a minidump file.
 struct __attribute__((packed, aligned(4))) MINIDUMP_LOCATION_DESCRIPTOR {
   //! \brief The size of the referenced structure or union, in bytes.
@@ -66,6 +72,19 @@ struct __attribute__((packed, aligned(4))) MINIDUMP_MEMORY_DESCRIPTOR {
   MINIDUMP_LOCATION_DESCRIPTOR Memory;
 };
 
+//! \brief A memory region whose contents are stored in the data referenced by
+//!     a MINIDUMP_MEMORY64_LIST.
+//!
+//! \sa MINIDUMP_MEMORY64_LIST
+struct __attribute__((packed, aligned(4))) MINIDUMP_MEMORY_DESCRIPTOR64 {
+  //! \brief The base address of the memory region in the address space of the
+  //!     process that the minidump file contains a snapshot of.
+  uint64_t StartOfMemoryRange;
+
+  //! \brief The size of the memory region, in bytes.
+  uint64_t DataSize;
+};
+
 //! \brief The top-level structure identifying a minidump file.
 //!
 //! This structure contains a pointer to the stream directory, a second-level
@@ -157,6 +176,9 @@ enum MINIDUMP_STREAM_TYPE {
   //! \brief The stream type for MINIDUMP_SYSTEM_INFO.
   SystemInfoStream = 7,
 
+  //! \brief The stream type for MINIDUMP_MEMORY64_LIST.
+  Memory64ListStream = 9,
+
   //! \brief The stream contains information about active `HANDLE`s.
   HandleDataStream = 12,
 
@@ -632,6 +654,25 @@ struct __attribute__((packed, aligned(4))) MINIDUMP_MEMORY_LIST {
   MINIDUMP_MEMORY_DESCRIPTOR MemoryRanges[0];
 };
 
+//! \brief Information about memory regions within the process, whose contents
+//!     are stored contiguously.
+//!
+//! This is used for minidump files that contain a snapshot of large parts of
+//! a process’ memory, which may not be addressable with an RVA. The contents of
+//! the memory regions are stored one after another, in the order that they
+//! appear in the #MemoryRanges array, starting at #BaseRva.
+struct __attribute__((packed, aligned(4))) MINIDUMP_MEMORY64_LIST {
+  //! \brief The number of memory regions present in the #MemoryRanges array.
+  uint64_t NumberOfMemoryRanges;
+
+  //! \brief The location of the contents of the first memory region.
+  RVA64 BaseRva;
+
+  //! \brief Structures identifying each memory region present in the minidump
+  //!     file.
+  MINIDUMP_MEMORY_DESCRIPTOR64 MemoryRanges[0];
+};
+
 //! \brief Contains the state of an individual system handle at the time the
 //!     snapshot was taken. This structure is Windows-specific.
 //!
@@ -28,6 +28,7 @@
 #include "build/build_config.h"
 #include "client/settings.h"
 #include "handler/minidump_to_upload_parameters.h"
+#include "handler/upload_bundle.h"
 #include "snapshot/minidump/process_snapshot_minidump.h"
 #include "snapshot/module_snapshot.h"
 #include "util/file/file_reader.h"
@@ -43,13 +44,26 @@
 #include "handler/mac/file_limit_annotation.h"
 #endif  // OS_MACOSX
 
+#if defined(OS_POSIX) || defined(OS_FUCHSIA)
+#include "util/posix/mapped_file_reader.h"
+#endif  // OS_POSIX || OS_FUCHSIA
+
 namespace crashpad {
 
+namespace {
+
+// How long to wait before checking again on a report that another process was
+// uploading, in case it fails or abandons the upload.
+constexpr time_t kBusyReportRetrySeconds = 60;
+
+}  // namespace
+
 CrashReportUploadThread::CrashReportUploadThread(CrashReportDatabase* database,
                                                  const std::string& url,
                                                  const Options& options)
     : options_(options),
       url_(url),
+      rate_limiter_(options.rate_limiter_options),
       // When watching for pending reports, check every 15 minutes, even in the
       // absence of a signal from the handler thread. This allows for failed
       // uploads to be retried periodically, and for pending reports written by
@@ -58,6 +72,10 @@ CrashReportUploadThread::CrashReportUploadThread(CrashReportDatabase* database,
                                             : WorkerThread::kIndefiniteWait,
               this),
       known_pending_report_uuids_(),
+      bundled_reports_(),
+      bundled_size_(0),
+      next_work_time_(0),
+      known_upload_attempt_time_(0),
       database_(database) {
   DCHECK(!url_.empty());
 }
@@ -71,12 +89,54 @@ void CrashReportUploadThread::ReportPending(const UUID& report_uuid) {
 }
 
 void CrashReportUploadThread::Start() {
+  // Account for upload attempts made by previous instances, so that restarting
+  // doesn’t grant a fresh burst of uploads. Attempts made later by other
+  // processes sharing the database are accounted for as they happen.
+  time_t last_upload_attempt_time;
+  if (database_->GetSettings()->GetLastUploadAttemptTime(
+          &last_upload_attempt_time)) {
+    rate_limiter_.SetLastUploadAttemptTime(last_upload_attempt_time);
+    known_upload_attempt_time_ = last_upload_attempt_time;
+  }
+
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  // pending_watcher_ is set up before thread_ starts, because DoWork() consults
+  // it. If the pending directory can’t be watched, fall back to periodic scans.
+  if (options_.watch_pending_reports) {
+    const base::FilePath pending_dir = database_->PendingReportsDirectory();
+    if (!pending_dir.empty()) {
+      pending_watcher_.reset(new DirectoryWatcher(this));
+      if (!pending_watcher_->AddDirectory(pending_dir)) {
+        pending_watcher_.reset();
+      }
+    }
+  }
+#endif  // OS_LINUX || OS_ANDROID
+
   thread_.Start(
       options_.watch_pending_reports ? 0.0 : WorkerThread::kIndefiniteWait);
+
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  // The watcher calls into thread_, so it can only start once thread_ has.
+  if (pending_watcher_) {
+    pending_watcher_->Start();
+  }
+#endif  // OS_LINUX || OS_ANDROID
 }
 
 void CrashReportUploadThread::Stop() {
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  // The watcher calls into thread_, so it must be stopped first.
+  if (pending_watcher_) {
+    pending_watcher_->Stop();
+  }
+#endif  // OS_LINUX || OS_ANDROID
+
   thread_.Stop();
+
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  pending_watcher_.reset();
+#endif  // OS_LINUX || OS_ANDROID
 }
 
 void CrashReportUploadThread::ProcessPendingReports() {
@@ -152,43 +212,64 @@ void CrashReportUploadThread::ProcessPendingReport(
     return;
   }
 
-  // This currently implements very simplistic rate-limiting, compatible with
-  // the Breakpad client, where the strategy is to permit one upload attempt per
-  // hour, and retire reports that would exceed this limit or for which the
-  // upload fails on the first attempt.
-  //
-  // If upload was requested explicitly (i.e. by user action), we do not
-  // throttle the upload.
-  //
-  // TODO(mark): Provide a proper rate-limiting strategy and allow for failed
-  // upload attempts to be retried.
-  if (!report.upload_explicitly_requested && options_.rate_limit) {
-    time_t last_upload_attempt_time;
-    if (settings->GetLastUploadAttemptTime(&last_upload_attempt_time)) {
-      time_t now = time(nullptr);
-      if (now >= last_upload_attempt_time) {
-        // If the most recent upload attempt occurred within the past hour,
-        // don’t attempt to upload the new report. If it happened longer ago,
-        // attempt to upload the report.
-        constexpr int kUploadAttemptIntervalSeconds = 60 * 60;  // 1 hour
-        if (now - last_upload_attempt_time < kUploadAttemptIntervalSeconds) {
+  // If upload was requested explicitly (i.e. by user action), it is neither
+  // throttled nor delayed by a backoff from earlier failed attempts.
+  if (!report.upload_explicitly_requested && report.upload_attempts > 0) {
+    switch (rate_limiter_.ShouldRetry(report.uuid,
+                                      report.upload_attempts,
+                                      report.last_upload_attempt_time,
+                                      time(nullptr))) {
+      case UploadRateLimiter::RetryResult::kRetry:
+        break;
+
+      case UploadRateLimiter::RetryResult::kWait:
+        // Leave the report pending. It will be considered again on a later
+        // pass.
+        ScheduleWork(report.last_upload_attempt_time +
+                     rate_limiter_.BackoffSeconds(report.uuid,
+                                                  report.upload_attempts));
+        return;
+
+      case UploadRateLimiter::RetryResult::kGiveUp:
+        database_->SkipReportUpload(report.uuid,
+                                    Metrics::CrashSkippedReason::kUploadFailed);
+        return;
+    }
+  }
+
+  // A report that fits into the bundle currently being collected joins a
+  // request that the rate limiter has already permitted.
+  const bool joins_bundle =
+      options_.bundle_max_size > 0 && !bundled_reports_.empty() &&
+      bundled_size_ + report.total_size <= options_.bundle_max_size;
+
+  if (!report.upload_explicitly_requested && options_.rate_limit &&
+      !joins_bundle) {
+    AccountForOtherUploadAttempts();
+    switch (rate_limiter_.TryAcquire(time(nullptr))) {
+      case UploadRateLimiter::AcquireResult::kAllowed:
+        break;
+
+      case UploadRateLimiter::AcquireResult::kThrottled:
+        // A report that has never been attempted is retired, compatible with
+        // the Breakpad client. A report being retried remains pending, so that
+        // a transient failure doesn’t cost it its remaining attempts.
+        if (report.upload_attempts == 0) {
           database_->SkipReportUpload(
               report.uuid, Metrics::CrashSkippedReason::kUploadThrottled);
-          return;
+        } else {
+          ScheduleWork(rate_limiter_.NextAcquireTime());
         }
-      } else {
-        // The most recent upload attempt purportedly occurred in the future. If
-        // it “happened” at least one day in the future, assume that the last
-        // upload attempt time is bogus, and attempt to upload the report. If
-        // the most recent upload time is in the future but within one day,
-        // accept it and don’t attempt to upload the report.
-        constexpr int kBackwardsClockTolerance = 60 * 60 * 24;  // 1 day
-        if (last_upload_attempt_time - now < kBackwardsClockTolerance) {
+        return;
+
+      case UploadRateLimiter::AcquireResult::kUnexpectedTime:
+        if (report.upload_attempts == 0) {
           database_->SkipReportUpload(
               report.uuid, Metrics::CrashSkippedReason::kUnexpectedTime);
-          return;
+        } else {
+          ScheduleWork(rate_limiter_.NextAcquireTime());
         }
-      }
+        return;
     }
   }
 
@@ -200,10 +281,14 @@ void CrashReportUploadThread::ProcessPendingReport(
       break;
 
     case CrashReportDatabase::kBusyError:
+      // Someone else is working on it now. If they don’t finish with it, it’s
+      // still pending, and a change to the pending directory might not come
+      // to signal that.
+      ScheduleWork(time(nullptr) + kBusyReportRetrySeconds);
+      return;
+
     case CrashReportDatabase::kReportNotFound:
-      // Someone else may have gotten to it first. If they’re working on it now,
-      // this will be kBusyError. If they’ve already finished with it, it’ll be
-      // kReportNotFound.
+      // Someone else got to it first and has already finished with it.
       return;
 
     case CrashReportDatabase::kFileSystemError:
@@ -219,52 +304,186 @@ void CrashReportUploadThread::ProcessPendingReport(
       return;
   }
 
+  if (options_.bundle_max_size > 0) {
+    // Start a new bundle if this report won’t fit in the current one. A report
+    // that exceeds the limit on its own is uploaded by itself.
+    if (!bundled_reports_.empty() &&
+        bundled_size_ + report.total_size > options_.bundle_max_size) {
+      UploadBundledReports();
+    }
+    bundled_size_ += report.total_size;
+    bundled_reports_.push_back(std::move(upload_report));
+    if (bundled_size_ >= options_.bundle_max_size) {
+      UploadBundledReports();
+    }
+    return;
+  }
+
   std::string response_body;
   UploadResult upload_result =
       UploadReport(upload_report.get(), &response_body);
+  FinishUpload(std::move(upload_report), upload_result, response_body);
+}
+
+void CrashReportUploadThread::FinishUpload(
+    std::unique_ptr<const CrashReportDatabase::UploadReport> upload_report,
+    UploadResult upload_result,
+    const std::string& response_body) {
+  const UUID uuid = upload_report->uuid;
+  const int upload_attempts = upload_report->upload_attempts;
   switch (upload_result) {
     case UploadResult::kSuccess:
       database_->RecordUploadComplete(std::move(upload_report), response_body);
+      NoteOwnUploadAttempt();
       break;
     case UploadResult::kPermanentFailure:
+      // Releasing upload_report records an upload attempt, which was this
+      // thread’s own.
       upload_report.reset();
+      NoteOwnUploadAttempt();
       database_->SkipReportUpload(
-          report.uuid, Metrics::CrashSkippedReason::kPrepareForUploadFailed);
+          uuid, Metrics::CrashSkippedReason::kPrepareForUploadFailed);
       break;
     case UploadResult::kRetry:
+      // Releasing upload_report records the failed attempt, bumping the
+      // report’s upload attempt count and last upload attempt time.
       upload_report.reset();
-
-      // TODO(mark): Deal with retries properly: don’t call SkipReportUplaod()
-      // if the result was kRetry and the report hasn’t already been retried
-      // too many times.
-      database_->SkipReportUpload(report.uuid,
-                                  Metrics::CrashSkippedReason::kUploadFailed);
+      NoteOwnUploadAttempt();
+
+      // Retries only happen when scanning for pending reports. Without that,
+      // or once the report has been attempted too many times, give up on it.
+      if (!options_.watch_pending_reports ||
+          !rate_limiter_.MayRetry(upload_attempts + 1)) {
+        database_->SkipReportUpload(uuid,
+                                    Metrics::CrashSkippedReason::kUploadFailed);
+      } else {
+        ScheduleWork(time(nullptr) +
+                     rate_limiter_.BackoffSeconds(uuid, upload_attempts + 1));
+      }
       break;
   }
 }
 
-CrashReportUploadThread::UploadResult CrashReportUploadThread::UploadReport(
-    const CrashReportDatabase::UploadReport* report,
-    std::string* response_body) {
-  std::map<std::string, std::string> parameters;
+void CrashReportUploadThread::UploadBundledReports() {
+  std::vector<std::unique_ptr<const CrashReportDatabase::UploadReport>>
+      reports;
+  reports.swap(bundled_reports_);
+  bundled_size_ = 0;
 
-  FileReader* reader = report->Reader();
-  FileOffset start_offset = reader->SeekGet();
-  if (start_offset < 0) {
-    return UploadResult::kPermanentFailure;
+  if (reports.empty()) {
+    return;
+  }
+
+  if (reports.size() == 1) {
+    // A lone report is uploaded in the ordinary way, which any server accepts.
+    std::string response_body;
+    UploadResult upload_result =
+        UploadReport(reports[0].get(), &response_body);
+    FinishUpload(std::move(reports[0]), upload_result, response_body);
+    return;
+  }
+
+  HTTPMultipartBuilder http_multipart_builder;
+  http_multipart_builder.SetGzipEnabled(options_.upload_gzip);
+  UploadBundle bundle(&http_multipart_builder);
+
+  // The URL identifies the client by the first report’s parameters. Reports in
+  // a database generally all come from the same product.
+  std::map<std::string, std::string> url_parameters;
+  for (auto& report : reports) {
+    std::map<std::string, std::string> parameters;
+    if (!ReadUploadParameters(report.get(), &parameters)) {
+      FinishUpload(
+          std::move(report), UploadResult::kPermanentFailure, std::string());
+      continue;
+    }
+
+    if (bundle.report_count() == 0) {
+      url_parameters = parameters;
+    }
+    bundle.AddReport(report->uuid, parameters, report->Reader());
+    for (const auto& it : report->GetAttachments()) {
+      bundle.AddAttachment(report->uuid, it.first, it.second);
+    }
   }
 
+  if (bundle.report_count() == 0) {
+    return;
+  }
+
+  // Each report is individually marked as uploaded only if the server’s
+  // response says that it was accepted. The rest remain pending, to be retried
+  // on their own schedules.
+  std::string response_body;
+  std::map<std::string, std::string> report_ids;
+  if (ExecuteUpload(&http_multipart_builder, url_parameters, &response_body)) {
+    UploadBundle::ParseResponse(response_body, &report_ids);
+  }
+
+  for (auto& report : reports) {
+    if (!report) {
+      continue;
+    }
+
+    const auto it = report_ids.find(report->uuid.ToString());
+    if (it != report_ids.end()) {
+      FinishUpload(std::move(report), UploadResult::kSuccess, it->second);
+    } else {
+      FinishUpload(std::move(report), UploadResult::kRetry, std::string());
+    }
+  }
+}
+
+bool CrashReportUploadThread::ReadUploadParameters(
+    const CrashReportDatabase::UploadReport* report,
+    std::map<std::string, std::string>* parameters) {
+  // Parameters recorded when the report was captured spare reading the whole
+  // minidump back in.
+  if (report->GetUploadParameters(parameters)) {
+    return true;
+  }
+
+  parameters->clear();
+
   // Ignore any errors that might occur when attempting to interpret the
   // minidump file. This may result in its being uploaded with few or no
   // parameters, but as long as there’s a dump file, the server can decide what
   // to do with it.
-  ProcessSnapshotMinidump minidump_process_snapshot;
-  if (minidump_process_snapshot.Initialize(reader)) {
-    parameters =
-        BreakpadHTTPFormParametersFromMinidump(&minidump_process_snapshot);
+  const auto read_parameters = [parameters](FileReaderInterface* reader) {
+    ProcessSnapshotMinidump minidump_process_snapshot;
+    if (minidump_process_snapshot.InitializeLazily(reader)) {
+      *parameters =
+          BreakpadHTTPFormParametersFromMinidump(&minidump_process_snapshot);
+    }
+  };
+
+#if defined(OS_POSIX) || defined(OS_FUCHSIA)
+  // A mapped minidump is consulted in place, without copying out the parts of
+  // it that are read. The report is locked for uploading, so the file won’t be
+  // truncated underneath the mapping.
+  MappedFileReader mapped_reader;
+  if (mapped_reader.Open(report->file_path)) {
+    read_parameters(&mapped_reader);
+    return true;
+  }
+#endif  // OS_POSIX || OS_FUCHSIA
+
+  FileReader* reader = report->Reader();
+  FileOffset start_offset = reader->SeekGet();
+  if (start_offset < 0) {
+    return false;
   }
 
-  if (!reader->SeekSet(start_offset)) {
+  read_parameters(reader);
+
+  return reader->SeekSet(start_offset);
+}
+
+CrashReportUploadThread::UploadResult CrashReportUploadThread::UploadReport(
+    const CrashReportDatabase::UploadReport* report,
+    std::string* response_body) {
+  std::map<std::string, std::string> parameters;
+  if (!ReadUploadParameters(report, &parameters)) {
     return UploadResult::kPermanentFailure;
   }
 
@@ -289,16 +508,27 @@ CrashReportUploadThread::UploadResult CrashReportUploadThread::UploadReport(
 
   http_multipart_builder.SetFileAttachment(kMinidumpKey,
                                            report->uuid.ToString() + ".dmp",
-                                           reader,
+                                           report->Reader(),
                                            "application/octet-stream");
 
+  if (!ExecuteUpload(&http_multipart_builder, parameters, response_body)) {
+    return UploadResult::kRetry;
+  }
+
+  return UploadResult::kSuccess;
+}
+
+bool CrashReportUploadThread::ExecuteUpload(
+    HTTPMultipartBuilder* http_multipart_builder,
+    const std::map<std::string, std::string>& parameters,
+    std::string* response_body) {
   std::unique_ptr<HTTPTransport> http_transport(HTTPTransport::Create());
   HTTPHeaders content_headers;
-  http_multipart_builder.PopulateContentHeaders(&content_headers);
+  http_multipart_builder->PopulateContentHeaders(&content_headers);
   for (const auto& content_header : content_headers) {
     http_transport->SetHeader(content_header.first, content_header.second);
   }
-  http_transport->SetBodyStream(http_multipart_builder.GetBodyStream());
+  http_transport->SetBodyStream(http_multipart_builder->GetBodyStream());
   // TODO(mark): The timeout should be configurable by the client.
   http_transport->SetTimeout(60.0);  // 1 minute.
 
@@ -327,15 +557,61 @@ CrashReportUploadThread::UploadResult CrashReportUploadThread::UploadReport(
   }
   http_transport->SetURL(url);
 
-  if (!http_transport->ExecuteSynchronously(response_body)) {
-    return UploadResult::kRetry;
+  return http_transport->ExecuteSynchronously(response_body);
+}
+
+void CrashReportUploadThread::ScheduleWork(time_t when) {
+  if (next_work_time_ == 0 || when < next_work_time_) {
+    next_work_time_ = when;
   }
+}
 
-  return UploadResult::kSuccess;
+void CrashReportUploadThread::AccountForOtherUploadAttempts() {
+  time_t last_upload_attempt_time;
+  if (database_->GetSettings()->GetLastUploadAttemptTime(
+          &last_upload_attempt_time) &&
+      last_upload_attempt_time > known_upload_attempt_time_) {
+    rate_limiter_.AccountForUploadAttempt(last_upload_attempt_time);
+    known_upload_attempt_time_ = last_upload_attempt_time;
+  }
+}
+
+void CrashReportUploadThread::NoteOwnUploadAttempt() {
+  time_t last_upload_attempt_time;
+  if (database_->GetSettings()->GetLastUploadAttemptTime(
+          &last_upload_attempt_time)) {
+    known_upload_attempt_time_ =
+        std::max(known_upload_attempt_time_, last_upload_attempt_time);
+  }
 }
 
 void CrashReportUploadThread::DoWork(const WorkerThread* thread) {
+  next_work_time_ = 0;
+
   ProcessPendingReports();
+
+  // Don’t leave reports waiting in a partially filled bundle until the next
+  // pass.
+  UploadBundledReports();
+
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  if (pending_watcher_) {
+    // New pending reports will be signaled by pending_watcher_, so the only
+    // reason to wake up on a timer is to retry a report that was held back.
+    if (next_work_time_ == 0) {
+      thread_.SetNextWorkDelay(WorkerThread::kIndefiniteWait);
+    } else {
+      thread_.SetNextWorkDelay(
+          std::max(next_work_time_ - time(nullptr), static_cast<time_t>(1)));
+    }
+  }
+#endif  // OS_LINUX || OS_ANDROID
+}
+
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+void CrashReportUploadThread::FilesMovedIn() {
+  thread_.DoWorkNow();
 }
+#endif  // OS_LINUX || OS_ANDROID
 
 }  // namespace crashpad
@@ -15,16 +15,28 @@
 #ifndef CRASHPAD_HANDLER_CRASH_REPORT_UPLOAD_THREAD_H_
 #define CRASHPAD_HANDLER_CRASH_REPORT_UPLOAD_THREAD_H_
 
+#include <stdint.h>
+#include <time.h>
+
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "base/macros.h"
+#include "build/build_config.h"
 #include "client/crash_report_database.h"
+#include "handler/upload_rate_limiter.h"
 #include "util/misc/uuid.h"
+#include "util/net/http_multipart_builder.h"
 #include "util/stdlib/thread_safe_vector.h"
 #include "util/thread/stoppable.h"
 #include "util/thread/worker_thread.h"
 
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+#include "util/linux/directory_watcher.h"
+#endif  // OS_LINUX || OS_ANDROID
+
 namespace crashpad {
 
 //! \brief A thread that processes pending crash reports in a
@@ -40,7 +52,16 @@ namespace crashpad {
 //! It also catches reports that are added without a ReportPending() signal
 //! being caught. This may happen if crash reports are added to the database by
 //! other processes.
+//!
+//! Where the database supports it, new pending reports are noticed by watching
+//! the database’s pending directory with a DirectoryWatcher instead of by
+//! periodic scans. The thread then only wakes on a timer when a report held
+//! back by the rate limiter or a retry backoff becomes eligible for upload, so
+//! that an idle handler doesn’t wake at all.
 class CrashReportUploadThread : public WorkerThread::Delegate,
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+                                public DirectoryWatcher::Delegate,
+#endif  // OS_LINUX || OS_ANDROID
                                 public Stoppable {
  public:
    //! \brief Options to be passed to the CrashReportUploadThread constructor.
@@ -49,12 +70,23 @@ class CrashReportUploadThread : public WorkerThread::Delegate,
     //! should be added to the URL.
     bool identify_client_via_url;
 
-    //! Whether uploads should be throttled to a (currently hardcoded) rate.
+    //! Whether uploads should be throttled to the rate established by
+    //! #rate_limiter_options.
     bool rate_limit;
 
+    //! The upload rate limit, and the strategy for retrying failed uploads.
+    //!
+    //! Failed uploads are only retried when #watch_pending_reports is `true`.
+    UploadRateLimiter::Options rate_limiter_options;
+
     //! Whether uploads should use `gzip` compression.
     bool upload_gzip;
 
+    //! The maximum total size, in bytes, of the reports that may be combined
+    //! into a single upload request, in the format described by UploadBundle.
+    //! When `0`, each report is uploaded in its own request.
+    uint64_t bundle_max_size;
+
     //! Whether to periodically check for new pending reports not already known
     //! to exist. When `false`, only an initial upload attempt will be made for
     //! reports known to exist by having been added by the ReportPending()
@@ -145,8 +177,66 @@ class CrashReportUploadThread : public WorkerThread::Delegate,
   //! remain in the “pending” state. If the upload fails and no more retries are
   //! desired, or report upload is disabled, it will be marked as “completed” in
   //! the database without ever having been uploaded.
+  //!
+  //! Reports whose earlier upload attempts failed are left in the “pending”
+  //! state without an upload attempt until rate_limiter_ determines that their
+  //! backoff delay has elapsed.
+  //!
+  //! When bundled uploads are enabled, the report is instead added to a bundle
+  //! that is uploaded by UploadBundledReports() once it is full, or at the end
+  //! of the current pass.
   void ProcessPendingReport(const CrashReportDatabase::Report& report);
 
+  //! \brief Arranges for the work function to run no later than \a when, if
+  //!     new pending reports are being watched for by pending_watcher_.
+  //!
+  //! This is used when a report is left pending to be retried later.
+  void ScheduleWork(time_t when);
+
+  //! \brief Accounts in rate_limiter_ for an upload attempt recorded in the
+  //!     database’s settings by another process since the last one that this
+  //!     object knows of.
+  //!
+  //! Only the most recent attempt is recorded in the settings, so several
+  //! attempts made elsewhere between two calls count as one.
+  void AccountForOtherUploadAttempts();
+
+  //! \brief Notes the upload attempt time recorded in the database’s settings
+  //!     by an attempt that this object just made, so that
+  //!     AccountForOtherUploadAttempts() doesn’t count it again.
+  void NoteOwnUploadAttempt();
+
+  //! \brief Updates the database to reflect the result of an upload attempt.
+  //!
+  //! \param[in] upload_report The report for which an upload was attempted.
+  //! \param[in] upload_result The result of the upload attempt.
+  //! \param[in] response_body If \a upload_result is UploadResult::kSuccess,
+  //!     the identifier assigned to the report by the server.
+  void FinishUpload(
+      std::unique_ptr<const CrashReportDatabase::UploadReport> upload_report,
+      UploadResult upload_result,
+      const std::string& response_body);
+
+  //! \brief Uploads the reports collected by ProcessPendingReport() in a single
+  //!     request, and updates the database with each report’s result.
+  //!
+  //! This does nothing if no reports have been collected.
+  void UploadBundledReports();
+
+  //! \brief Obtains the form parameters to upload alongside a crash report.
+  //!
+  //! The parameters recorded in the database when the report was captured are
+  //! used if available. Otherwise, they are derived from the minidump.
+  //!
+  //! \param[in] report The report to obtain parameters for. Its reader is left
+  //!     at the position that it had on entry.
+  //! \param[out] parameters The form parameters.
+  //!
+  //! \return `true` on success. `false` if the report could not be read, in
+  //!     which case it should not be uploaded.
+  bool ReadUploadParameters(const CrashReportDatabase::UploadReport* report,
+                            std::map<std::string, std::string>* parameters);
+
   //! \brief Attempts to upload a crash report.
   //!
   //! \param[in] report The report to upload. The caller is responsible for
@@ -162,15 +252,46 @@ class CrashReportUploadThread : public WorkerThread::Delegate,
   UploadResult UploadReport(const CrashReportDatabase::UploadReport* report,
                             std::string* response_body);
 
+  //! \brief Sends an upload request to the server.
+  //!
+  //! \param[in] http_multipart_builder The builder for the request body.
+  //! \param[in] parameters Form parameters used to identify the client in the
+  //!     URL, if enabled by Options::identify_client_via_url.
+  //! \param[out] response_body The response body sent by the server.
+  //!
+  //! \return `true` if the server accepted the request.
+  bool ExecuteUpload(HTTPMultipartBuilder* http_multipart_builder,
+                     const std::map<std::string, std::string>& parameters,
+                     std::string* response_body);
+
   // WorkerThread::Delegate:
   //! \brief Calls ProcessPendingReports() in response to ReportPending() having
   //!     been called on any thread, as well as periodically on a timer.
   void DoWork(const WorkerThread* thread) override;
 
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  // DirectoryWatcher::Delegate:
+  //! \brief Calls ProcessPendingReports() in response to a report being moved
+  //!     into the database’s pending directory.
+  void FilesMovedIn() override;
+
+  std::unique_ptr<DirectoryWatcher> pending_watcher_;
+#endif  // OS_LINUX || OS_ANDROID
+
   const Options options_;
   const std::string url_;
+  UploadRateLimiter rate_limiter_;
   WorkerThread thread_;
   ThreadSafeVector<UUID> known_pending_report_uuids_;
+  std::vector<std::unique_ptr<const CrashReportDatabase::UploadReport>>
+      bundled_reports_;
+  uint64_t bundled_size_;
+  time_t next_work_time_;
+
+  // The most recent upload attempt time read from the database’s settings that
+  // rate_limiter_ has accounted for.
+  time_t known_upload_attempt_time_;
+
   CrashReportDatabase* database_;  // weak
 
   DISALLOW_COPY_AND_ASSIGN(CrashReportUploadThread);
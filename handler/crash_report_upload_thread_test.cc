@@ -0,0 +1,273 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "handler/crash_report_upload_thread.h"
+
+#include <stdint.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/strings/stringprintf.h"
+#include "build/build_config.h"
+#include "client/crash_report_database.h"
+#include "client/settings.h"
+#include "gtest/gtest.h"
+#include "test/scoped_temp_dir.h"
+#include "util/misc/clock.h"
+#include "util/misc/uuid.h"
+#include "util/synchronization/semaphore.h"
+#include "util/thread/thread.h"
+
+#if COMPILER_MSVC
+#pragma warning(push)
+#pragma warning(disable: 4244 4245 4267 4702)
+#endif
+
+#include "third_party/cpp-httplib/cpp-httplib/httplib.h"
+
+#if COMPILER_MSVC
+#pragma warning(pop)
+#endif
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// Stands in for a collection server. Answers each POST to /upload with the
+// response most recently set by SetResponse(), and records the request bodies.
+class TestUploadServer final : public Thread {
+ public:
+  TestUploadServer()
+      : Thread(),
+        server_(),
+        request_received_(0),
+        mutex_(),
+        request_bodies_(),
+        response_body_(),
+        response_code_(500),
+        port_(0) {
+    server_.Post("/upload",
+                 [this](const httplib::Request& request,
+                        httplib::Response& response) {
+                   std::lock_guard<std::mutex> lock(mutex_);
+                   request_bodies_.push_back(request.body);
+                   response.status = response_code_;
+                   response.set_content(response_code_ == 200 ? response_body_
+                                                              : "error",
+                                        "text/plain");
+                   request_received_.Signal();
+                 });
+    port_ = server_.bind_to_any_port("localhost");
+  }
+
+  ~TestUploadServer() override {}
+
+  std::string url() const {
+    return base::StringPrintf("http://localhost:%d/upload", port_);
+  }
+
+  void SetResponse(uint16_t response_code, const std::string& response_body) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    response_code_ = response_code;
+    response_body_ = response_body;
+  }
+
+  //! \brief Waits for the next request to be answered.
+  bool WaitForRequest() { return request_received_.TimedWait(30.0); }
+
+  std::vector<std::string> request_bodies() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return request_bodies_;
+  }
+
+  void Stop() {
+    // stop() has no effect until the server is listening.
+    while (!server_.is_running()) {
+      SleepNanoseconds(1E6);
+    }
+    server_.stop();
+    Join();
+  }
+
+ private:
+  // Thread:
+  void ThreadMain() override { server_.listen_after_bind(); }
+
+  httplib::Server server_;
+  Semaphore request_received_;
+  std::mutex mutex_;
+  std::vector<std::string> request_bodies_;
+  std::string response_body_;
+  uint16_t response_code_;
+  int port_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestUploadServer);
+};
+
+class CrashReportUploadThreadTest : public testing::Test {
+ protected:
+  CrashReportUploadThreadTest() : temp_dir_(), database_(), server_() {}
+
+  void SetUp() override {
+    ASSERT_GT(server_.url().size(), 0u);
+    server_.Start();
+
+    database_ = CrashReportDatabase::Initialize(temp_dir_.path());
+    ASSERT_TRUE(database_);
+    ASSERT_TRUE(database_->GetSettings()->SetUploadsEnabled(true));
+  }
+
+  void TearDown() override { server_.Stop(); }
+
+  void CreateCrashReport(UUID* uuid) {
+    std::unique_ptr<CrashReportDatabase::NewReport> new_report;
+    ASSERT_EQ(database_->PrepareNewCrashReport(&new_report),
+              CrashReportDatabase::kNoError);
+    static constexpr char kTest[] = "test";
+    ASSERT_TRUE(new_report->Writer()->Write(kTest, sizeof(kTest)));
+    ASSERT_EQ(database_->FinishedWritingCrashReport(std::move(new_report), uuid),
+              CrashReportDatabase::kNoError);
+  }
+
+  // Bundles everything that’s pending, retries failed reports after the
+  // shortest backoff that the rate limiter permits, one second, and leaves
+  // them pending (rather than giving up on them) after a failure.
+  CrashReportUploadThread::Options BundlingOptions() {
+    CrashReportUploadThread::Options options;
+    options.identify_client_via_url = false;
+    options.rate_limit = false;
+    options.rate_limiter_options.initial_backoff_seconds = 1;
+    options.upload_gzip = false;
+    options.bundle_max_size = 1024 * 1024;
+    options.watch_pending_reports = true;
+    return options;
+  }
+
+  // Starts an upload thread, which scans for pending reports right away, and
+  // stops it once the server has answered one request.
+  void RunUploadThread() {
+    CrashReportUploadThread upload_thread(
+        database_.get(), server_.url(), BundlingOptions());
+    upload_thread.Start();
+    EXPECT_TRUE(server_.WaitForRequest());
+    upload_thread.Stop();
+  }
+
+  void ExpectUploaded(const UUID& uuid, const std::string& id) {
+    CrashReportDatabase::Report report;
+    ASSERT_EQ(database_->LookUpCrashReport(uuid, &report),
+              CrashReportDatabase::kNoError);
+    EXPECT_TRUE(report.uploaded);
+    EXPECT_EQ(report.id, id);
+  }
+
+  void ExpectPending(const UUID& uuid, int upload_attempts) {
+    std::vector<CrashReportDatabase::Report> pending_reports;
+    ASSERT_EQ(database_->GetPendingReports(&pending_reports),
+              CrashReportDatabase::kNoError);
+    bool found = false;
+    for (const auto& report : pending_reports) {
+      if (report.uuid == uuid) {
+        found = true;
+        EXPECT_FALSE(report.uploaded);
+        EXPECT_EQ(report.upload_attempts, upload_attempts);
+      }
+    }
+    EXPECT_TRUE(found) << uuid.ToString();
+  }
+
+  TestUploadServer* server() { return &server_; }
+
+ private:
+  ScopedTempDir temp_dir_;
+  std::unique_ptr<CrashReportDatabase> database_;
+  TestUploadServer server_;
+
+  DISALLOW_COPY_AND_ASSIGN(CrashReportUploadThreadTest);
+};
+
+TEST_F(CrashReportUploadThreadTest, BundleAccepted) {
+  UUID uuids[2];
+  ASSERT_NO_FATAL_FAILURE(CreateCrashReport(&uuids[0]));
+  ASSERT_NO_FATAL_FAILURE(CreateCrashReport(&uuids[1]));
+
+  server()->SetResponse(200,
+                        uuids[0].ToString() + "=id_0\r\n" +
+                            uuids[1].ToString() + "=id_1\r\n");
+  ASSERT_NO_FATAL_FAILURE(RunUploadThread());
+
+  // Both reports went up in a single request.
+  const std::vector<std::string> request_bodies = server()->request_bodies();
+  ASSERT_EQ(request_bodies.size(), 1u);
+  EXPECT_NE(request_bodies[0].find("bundle_reports"), std::string::npos);
+  EXPECT_NE(request_bodies[0].find(uuids[0].ToString() +
+                                   "/upload_file_minidump"),
+            std::string::npos);
+  EXPECT_NE(request_bodies[0].find(uuids[1].ToString() +
+                                   "/upload_file_minidump"),
+            std::string::npos);
+
+  ExpectUploaded(uuids[0], "id_0");
+  ExpectUploaded(uuids[1], "id_1");
+}
+
+TEST_F(CrashReportUploadThreadTest, BundlePartiallyAccepted) {
+  UUID uuids[2];
+  ASSERT_NO_FATAL_FAILURE(CreateCrashReport(&uuids[0]));
+  ASSERT_NO_FATAL_FAILURE(CreateCrashReport(&uuids[1]));
+
+  // Only the reports listed in the response are recorded as uploaded.
+  server()->SetResponse(200, uuids[1].ToString() + "=id_1\r\n");
+  ASSERT_NO_FATAL_FAILURE(RunUploadThread());
+  ASSERT_EQ(server()->request_bodies().size(), 1u);
+
+  ExpectPending(uuids[0], 1);
+  ExpectUploaded(uuids[1], "id_1");
+}
+
+TEST_F(CrashReportUploadThreadTest, BundleFailureIsRetried) {
+  UUID uuids[2];
+  ASSERT_NO_FATAL_FAILURE(CreateCrashReport(&uuids[0]));
+  ASSERT_NO_FATAL_FAILURE(CreateCrashReport(&uuids[1]));
+
+  // A failed bundle leaves each of its reports pending, with the attempt
+  // recorded.
+  server()->SetResponse(500, std::string());
+  ASSERT_NO_FATAL_FAILURE(RunUploadThread());
+  ASSERT_EQ(server()->request_bodies().size(), 1u);
+
+  ExpectPending(uuids[0], 1);
+  ExpectPending(uuids[1], 1);
+
+  // The next pass bundles them up again.
+  server()->SetResponse(200,
+                        uuids[0].ToString() + "=id_0\r\n" +
+                            uuids[1].ToString() + "=id_1\r\n");
+  ASSERT_NO_FATAL_FAILURE(RunUploadThread());
+
+  const std::vector<std::string> request_bodies = server()->request_bodies();
+  ASSERT_EQ(request_bodies.size(), 2u);
+  EXPECT_NE(request_bodies[1].find("bundle_reports"), std::string::npos);
+
+  ExpectUploaded(uuids[0], "id_0");
+  ExpectUploaded(uuids[1], "id_1");
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
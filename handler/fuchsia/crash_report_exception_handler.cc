@@ -21,6 +21,7 @@
 
 #include "base/fuchsia/fuchsia_logging.h"
 #include "client/settings.h"
+#include "handler/minidump_to_upload_parameters.h"
 #include "minidump/minidump_file_writer.h"
 #include "minidump/minidump_user_extension_stream_data_source.h"
 #include "snapshot/fuchsia/process_snapshot_fuchsia.h"
@@ -107,6 +108,12 @@ bool CrashReportExceptionHandler::HandleException(const zx::process& process,
     return false;
   }
 
+  // Record the upload parameters now, from the snapshot that the minidump was
+  // written from, so that the uploader needn’t parse the minidump to find them.
+  // If this fails, the uploader will fall back to doing so.
+  new_report->SetUploadParameters(
+      BreakpadHTTPFormParametersFromMinidump(&process_snapshot));
+
   if (process_attachments_) {
     // Note that attachments are read at this point each time rather than once
     // so that if the contents of the VMO has changed it will be re-read for
@@ -56,6 +56,10 @@
         'minidump_to_upload_parameters.h',
         'prune_crash_reports_thread.cc',
         'prune_crash_reports_thread.h',
+        'upload_bundle.cc',
+        'upload_bundle.h',
+        'upload_rate_limiter.cc',
+        'upload_rate_limiter.h',
         'user_stream_data_source.cc',
         'user_stream_data_source.h',
         'win/crash_report_exception_handler.cc',
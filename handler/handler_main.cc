@@ -16,6 +16,7 @@
 
 #include <errno.h>
 #include <getopt.h>
+#include <inttypes.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <sys/types.h>
@@ -48,6 +49,7 @@
 #include "tools/tool_support.h"
 #include "util/file/file_io.h"
 #include "util/misc/address_types.h"
+#include "util/misc/capture_profile.h"
 #include "util/misc/metrics.h"
 #include "util/misc/paths.h"
 #include "util/numeric/in_range_cast.h"
@@ -63,6 +65,7 @@
 #if defined(OS_LINUX) || defined(OS_ANDROID)
 #include <unistd.h>
 
+#include "handler/linux/capture_snapshot.h"
 #include "handler/linux/crash_report_exception_handler.h"
 #include "handler/linux/exception_handler_server.h"
 #include "util/posix/signals.h"
@@ -110,6 +113,14 @@ void Usage(const base::FilePath& me) {
 "Crashpad's exception handler server.\n"
 "\n"
 "      --annotation=KEY=VALUE  set a process annotation in each crash report\n"
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+"      --capture-profile=PROFILE\n"
+"                              capture minimal, default, or full crash reports\n"
+"                              from clients that don't choose a profile\n"
+"      --capture-timeout-ms=MILLISECONDS\n"
+"                              leave out what can't be captured within\n"
+"                              MILLISECONDS of a crash\n"
+#endif  // OS_LINUX || OS_ANDROID
 "      --database=PATH         store the crash report database at PATH\n"
 #if defined(OS_MACOSX)
 "      --handshake-fd=FD       establish communication with the client over FD\n"
@@ -131,6 +142,9 @@ void Usage(const base::FilePath& me) {
 #if defined(OS_MACOSX)
 "      --mach-service=SERVICE  register SERVICE with the bootstrap server\n"
 #endif  // OS_MACOSX
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+"      --max-thread-stacks=N   capture the stacks of at most N threads\n"
+#endif  // OS_LINUX || OS_ANDROID
 "      --metrics-dir=DIR       store metrics files in DIR (only in Chromium)\n"
 "      --monitor-self          run a second handler to catch crashes in the first\n"
 "      --monitor-self-annotation=KEY=VALUE\n"
@@ -147,6 +161,11 @@ void Usage(const base::FilePath& me) {
 "      --no-write-minidump-to-database\n"
 "                              don't write minidump to database\n"
 #endif  // OS_ANDROID
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+"      --omit-unmodified-module-memory\n"
+"                              leave memory that is the same as in module files\n"
+"                              out of minidumps where possible\n"
+#endif  // OS_LINUX || OS_ANDROID
 #if defined(OS_WIN)
 "      --pipe-name=PIPE        communicate with the client over PIPE\n"
 #endif  // OS_WIN
@@ -163,6 +182,14 @@ void Usage(const base::FilePath& me) {
 "      --trace-parent-with-exception=EXCEPTION_INFORMATION_ADDRESS\n"
 "                              request a dump for the handler's parent process\n"
 #endif  // OS_LINUX || OS_ANDROID
+"      --upload-bundle-size=BYTES\n"
+"                              combine reports into uploads of up to BYTES\n"
+"      --upload-burst=N        permit up to N upload attempts in quick succession\n"
+"      --upload-interval=SECONDS\n"
+"                              permit one more upload attempt every SECONDS\n"
+"      --upload-max-attempts=N abandon a report after N failed upload attempts\n"
+"      --upload-retry-backoff=SECONDS\n"
+"                              delay the first retry of a failed upload\n"
 "      --url=URL               send crash reports to this Breakpad server URL,\n"
 "                              only if uploads are enabled for the database\n"
 #if defined(OS_CHROMEOS)
@@ -202,6 +229,10 @@ struct Options {
   VMAddress sanitization_information_address;
   int initial_client_fd;
   bool shared_client_connection;
+  bool omit_unmodified_module_memory;
+  CaptureProfile capture_profile;
+  size_t max_thread_stacks;
+  unsigned int capture_timeout_ms;
 #if defined(OS_ANDROID)
   bool write_minidump_to_log;
   bool write_minidump_to_database;
@@ -215,6 +246,8 @@ struct Options {
   bool periodic_tasks;
   bool rate_limit;
   bool upload_gzip;
+  uint64_t upload_bundle_size;
+  UploadRateLimiter::Options upload_rate_limiter;
 #if defined(OS_CHROMEOS)
   bool use_cros_crash_reporter = false;
   base::FilePath minidump_dir_for_tests;
@@ -461,6 +494,20 @@ void MonitorSelf(const Options& options) {
   if (!options.upload_gzip) {
     extra_arguments.push_back("--no-upload-gzip");
   }
+  if (options.upload_bundle_size) {
+    extra_arguments.push_back(base::StringPrintf(
+        "--upload-bundle-size=%" PRIu64, options.upload_bundle_size));
+  }
+  extra_arguments.push_back(base::StringPrintf(
+      "--upload-burst=%d", options.upload_rate_limiter.burst));
+  extra_arguments.push_back(base::StringPrintf(
+      "--upload-interval=%d", options.upload_rate_limiter.interval_seconds));
+  extra_arguments.push_back(
+      base::StringPrintf("--upload-max-attempts=%d",
+                         options.upload_rate_limiter.max_upload_attempts));
+  extra_arguments.push_back(
+      base::StringPrintf("--upload-retry-backoff=%d",
+                         options.upload_rate_limiter.initial_backoff_seconds));
   for (const auto& iterator : options.monitor_self_annotations) {
     extra_arguments.push_back(
         base::StringPrintf("--monitor-self-annotation=%s=%s",
@@ -541,6 +588,10 @@ int HandlerMain(int argc,
     // Long options without short equivalents.
     kOptionLastChar = 255,
     kOptionAnnotation,
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+    kOptionCaptureProfile,
+    kOptionCaptureTimeoutMs,
+#endif  // OS_LINUX || OS_ANDROID
     kOptionDatabase,
 #if defined(OS_MACOSX)
     kOptionHandshakeFD,
@@ -554,6 +605,9 @@ int HandlerMain(int argc,
 #if defined(OS_MACOSX)
     kOptionMachService,
 #endif  // OS_MACOSX
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+    kOptionMaxThreadStacks,
+#endif  // OS_LINUX || OS_ANDROID
     kOptionMetrics,
     kOptionMonitorSelf,
     kOptionMonitorSelfAnnotation,
@@ -565,6 +619,9 @@ int HandlerMain(int argc,
 #if defined(OS_ANDROID)
     kOptionNoWriteMinidumpToDatabase,
 #endif  // OS_ANDROID
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+    kOptionOmitUnmodifiedModuleMemory,
+#endif  // OS_LINUX || OS_ANDROID
 #if defined(OS_WIN)
     kOptionPipeName,
 #endif  // OS_WIN
@@ -576,6 +633,11 @@ int HandlerMain(int argc,
     kOptionSharedClientConnection,
     kOptionTraceParentWithException,
 #endif
+    kOptionUploadBundleSize,
+    kOptionUploadBurst,
+    kOptionUploadInterval,
+    kOptionUploadMaxAttempts,
+    kOptionUploadRetryBackoff,
     kOptionURL,
 #if defined(OS_CHROMEOS)
     kOptionUseCrosCrashReporter,
@@ -593,6 +655,13 @@ int HandlerMain(int argc,
 
   static constexpr option long_options[] = {
     {"annotation", required_argument, nullptr, kOptionAnnotation},
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+    {"capture-profile", required_argument, nullptr, kOptionCaptureProfile},
+    {"capture-timeout-ms",
+     required_argument,
+     nullptr,
+     kOptionCaptureTimeoutMs},
+#endif  // OS_LINUX || OS_ANDROID
     {"database", required_argument, nullptr, kOptionDatabase},
 #if defined(OS_MACOSX)
     {"handshake-fd", required_argument, nullptr, kOptionHandshakeFD},
@@ -609,6 +678,9 @@ int HandlerMain(int argc,
 #if defined(OS_MACOSX)
     {"mach-service", required_argument, nullptr, kOptionMachService},
 #endif  // OS_MACOSX
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+    {"max-thread-stacks", required_argument, nullptr, kOptionMaxThreadStacks},
+#endif  // OS_LINUX || OS_ANDROID
     {"metrics-dir", required_argument, nullptr, kOptionMetrics},
     {"monitor-self", no_argument, nullptr, kOptionMonitorSelf},
     {"monitor-self-annotation",
@@ -632,6 +704,12 @@ int HandlerMain(int argc,
      nullptr,
      kOptionNoWriteMinidumpToDatabase},
 #endif  // OS_ANDROID
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+    {"omit-unmodified-module-memory",
+     no_argument,
+     nullptr,
+     kOptionOmitUnmodifiedModuleMemory},
+#endif  // OS_LINUX || OS_ANDROID
 #if defined(OS_WIN)
     {"pipe-name", required_argument, nullptr, kOptionPipeName},
 #endif  // OS_WIN
@@ -655,6 +733,17 @@ int HandlerMain(int argc,
      nullptr,
      kOptionTraceParentWithException},
 #endif  // OS_LINUX || OS_ANDROID
+    {"upload-bundle-size", required_argument, nullptr, kOptionUploadBundleSize},
+    {"upload-burst", required_argument, nullptr, kOptionUploadBurst},
+    {"upload-interval", required_argument, nullptr, kOptionUploadInterval},
+    {"upload-max-attempts",
+     required_argument,
+     nullptr,
+     kOptionUploadMaxAttempts},
+    {"upload-retry-backoff",
+     required_argument,
+     nullptr,
+     kOptionUploadRetryBackoff},
     {"url", required_argument, nullptr, kOptionURL},
 #if defined(OS_CHROMEOS)
     {"use-cros-crash-reporter",
@@ -685,6 +774,7 @@ int HandlerMain(int argc,
   options.identify_client_via_url = true;
 #if defined(OS_LINUX) || defined(OS_ANDROID)
   options.initial_client_fd = kInvalidFileHandle;
+  options.capture_profile = CaptureProfile::kDefault;
 #endif
   options.periodic_tasks = true;
   options.rate_limit = true;
@@ -702,6 +792,25 @@ int HandlerMain(int argc,
         }
         break;
       }
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+      case kOptionCaptureProfile: {
+        if (!StringToCaptureProfile(optarg, &options.capture_profile)) {
+          ToolSupport::UsageHint(
+              me, "--capture-profile requires minimal, default, or full");
+          return ExitFailure();
+        }
+        break;
+      }
+      case kOptionCaptureTimeoutMs: {
+        if (!StringToNumber(optarg, &options.capture_timeout_ms) ||
+            options.capture_timeout_ms == 0) {
+          ToolSupport::UsageHint(
+              me, "--capture-timeout-ms requires a positive MILLISECONDS");
+          return ExitFailure();
+        }
+        break;
+      }
+#endif  // OS_LINUX || OS_ANDROID
       case kOptionDatabase: {
         options.database = base::FilePath(
             ToolSupport::CommandLineArgumentToFilePathStringType(optarg));
@@ -741,6 +850,17 @@ int HandlerMain(int argc,
         break;
       }
 #endif  // OS_ANDROID || OS_LINUX
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+      case kOptionMaxThreadStacks: {
+        if (!StringToNumber(optarg, &options.max_thread_stacks) ||
+            options.max_thread_stacks == 0) {
+          ToolSupport::UsageHint(me,
+                                 "--max-thread-stacks requires a positive N");
+          return ExitFailure();
+        }
+        break;
+      }
+#endif  // OS_LINUX || OS_ANDROID
       case kOptionMetrics: {
         options.metrics_dir = base::FilePath(
             ToolSupport::CommandLineArgumentToFilePathStringType(optarg));
@@ -784,6 +904,12 @@ int HandlerMain(int argc,
         break;
       }
 #endif  // OS_ANDROID
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+      case kOptionOmitUnmodifiedModuleMemory: {
+        options.omit_unmodified_module_memory = true;
+        break;
+      }
+#endif  // OS_LINUX || OS_ANDROID
 #if defined(OS_WIN)
       case kOptionPipeName: {
         options.pipe_name = optarg;
@@ -819,6 +945,52 @@ int HandlerMain(int argc,
         break;
       }
 #endif  // OS_LINUX || OS_ANDROID
+      case kOptionUploadBundleSize: {
+        if (!StringToNumber(optarg, &options.upload_bundle_size)) {
+          ToolSupport::UsageHint(me, "failed to parse --upload-bundle-size");
+          return ExitFailure();
+        }
+        break;
+      }
+      case kOptionUploadBurst: {
+        if (!StringToNumber(optarg, &options.upload_rate_limiter.burst) ||
+            options.upload_rate_limiter.burst <= 0) {
+          ToolSupport::UsageHint(me, "--upload-burst requires a positive N");
+          return ExitFailure();
+        }
+        break;
+      }
+      case kOptionUploadInterval: {
+        if (!StringToNumber(optarg,
+                            &options.upload_rate_limiter.interval_seconds) ||
+            options.upload_rate_limiter.interval_seconds <= 0) {
+          ToolSupport::UsageHint(
+              me, "--upload-interval requires a positive SECONDS");
+          return ExitFailure();
+        }
+        break;
+      }
+      case kOptionUploadMaxAttempts: {
+        if (!StringToNumber(optarg,
+                            &options.upload_rate_limiter.max_upload_attempts) ||
+            options.upload_rate_limiter.max_upload_attempts <= 0) {
+          ToolSupport::UsageHint(me,
+                                 "--upload-max-attempts requires a positive N");
+          return ExitFailure();
+        }
+        break;
+      }
+      case kOptionUploadRetryBackoff: {
+        int* backoff = &options.upload_rate_limiter.initial_backoff_seconds;
+        if (!StringToNumber(optarg, backoff) || *backoff <= 0) {
+          ToolSupport::UsageHint(
+              me, "--upload-retry-backoff requires a positive SECONDS");
+          return ExitFailure();
+        }
+        options.upload_rate_limiter.max_backoff_seconds = std::max(
+            options.upload_rate_limiter.max_backoff_seconds, *backoff);
+        break;
+      }
       case kOptionURL: {
         options.url = optarg;
         break;
@@ -969,7 +1141,9 @@ int HandlerMain(int argc,
     upload_thread_options.identify_client_via_url =
         options.identify_client_via_url;
     upload_thread_options.rate_limit = options.rate_limit;
+    upload_thread_options.rate_limiter_options = options.upload_rate_limiter;
     upload_thread_options.upload_gzip = options.upload_gzip;
+    upload_thread_options.bundle_max_size = options.upload_bundle_size;
     upload_thread_options.watch_pending_reports = options.periodic_tasks;
 
     upload_thread.Reset(new CrashReportUploadThread(
@@ -978,6 +1152,13 @@ int HandlerMain(int argc,
   }
 
 #if defined(OS_LINUX) || defined(OS_ANDROID)
+  CaptureOptions capture_options;
+  capture_options.omit_unmodified_module_memory =
+      options.omit_unmodified_module_memory;
+  capture_options.default_capture_profile = options.capture_profile;
+  capture_options.max_thread_stacks = options.max_thread_stacks;
+  capture_options.capture_timeout_ms = options.capture_timeout_ms;
+
   std::unique_ptr<ExceptionHandlerServer::Delegate> exception_handler;
 #else
   std::unique_ptr<CrashReportExceptionHandler> exception_handler;
@@ -988,6 +1169,7 @@ int HandlerMain(int argc,
     auto cros_handler = std::make_unique<CrosCrashReportExceptionHandler>(
         database.get(),
         &options.annotations,
+        capture_options,
         user_stream_sources);
 
     if (!options.minidump_dir_for_tests.empty()) {
@@ -1006,6 +1188,7 @@ int HandlerMain(int argc,
         &options.annotations,
         true,
         false,
+        capture_options,
         user_stream_sources);
   }
 #else
@@ -1025,6 +1208,9 @@ int HandlerMain(int argc,
       true,
       false,
 #endif  // OS_LINUX
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+      capture_options,
+#endif  // OS_LINUX || OS_ANDROID
       user_stream_sources);
 #endif  // OS_CHROMEOS
 
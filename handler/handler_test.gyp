@@ -36,10 +36,21 @@
       'include_dirs': [
         '..',
       ],
+      'xcode_settings': {
+        'WARNING_CFLAGS!': [
+          '-Wexit-time-destructors',
+        ],
+      },
+      'cflags!': [
+        '-Wexit-time-destructors',
+      ],
       'sources': [
+        'crash_report_upload_thread_test.cc',
         'crashpad_handler_test.cc',
         'linux/exception_handler_server_test.cc',
         'minidump_to_upload_parameters_test.cc',
+        'upload_bundle_test.cc',
+        'upload_rate_limiter_test.cc',
       ],
       'conditions': [
         ['OS!="win"', {
@@ -50,6 +61,18 @@
             'crashpad_handler_test.cc',
           ],
         }],
+        ['OS=="win"', {
+          'link_settings': {
+            'libraries': [
+              '-lws2_32.lib',
+            ],
+          },
+        }],
+        ['OS=="android"', {
+          'sources!': [
+            'crash_report_upload_thread_test.cc',
+          ],
+        }],
       ],
       'target_conditions': [
         ['OS=="android"', {
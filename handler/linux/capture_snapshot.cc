@@ -15,7 +15,12 @@
 #include "handler/linux/capture_snapshot.h"
 
 #include <utility>
+#include <vector>
 
+#include "minidump/minidump_capture_truncation_writer.h"
+#include "minidump/minidump_file_writer.h"
+#include "minidump/minidump_memory64_writer.h"
+#include "minidump/minidump_omitted_memory_writer.h"
 #include "snapshot/crashpad_info_client_options.h"
 #include "snapshot/sanitized/sanitization_information.h"
 #include "util/misc/metrics.h"
@@ -23,18 +28,45 @@
 
 namespace crashpad {
 
+CaptureOptions::CaptureOptions()
+    : omit_unmodified_module_memory(false),
+      default_capture_profile(CaptureProfile::kDefault),
+      max_thread_stacks(0),
+      capture_timeout_ms(0) {}
+
 bool CaptureSnapshot(
     PtraceConnection* connection,
     const ExceptionHandlerProtocol::ClientInformation& info,
+    const ProcessMemoryOverlay::Region* shared_annotations,
+    const std::vector<ProcessMemoryOverlay::Region>* crashing_thread_state,
+    LinkMapCache* link_map_cache,
+    ElfModuleMetadataCache* module_metadata_cache,
+    const CaptureOptions& capture_options,
+    CaptureDeadline* deadline,
     const std::map<std::string, std::string>& process_annotations,
     uid_t client_uid,
     VMAddress requesting_thread_stack_address,
     pid_t* requesting_thread_id,
     std::unique_ptr<ProcessSnapshotLinux>* snapshot,
     std::unique_ptr<ProcessSnapshotSanitized>* sanitized_snapshot) {
+  // The thread ID in the exception information is in the client’s PID
+  // namespace, which is only known to be the same as this one’s if the
+  // exception thread isn’t identified by its stack address.
+  const VMAddress exception_info_address =
+      requesting_thread_stack_address ? 0 : info.exception_information_address;
+
   std::unique_ptr<ProcessSnapshotLinux> process_snapshot(
       new ProcessSnapshotLinux());
-  if (!process_snapshot->Initialize(connection)) {
+  if (!process_snapshot->Initialize(
+          connection,
+          shared_annotations,
+          link_map_cache,
+          module_metadata_cache,
+          capture_options.omit_unmodified_module_memory,
+          deadline,
+          crashing_thread_state,
+          capture_options.default_capture_profile,
+          exception_info_address)) {
     Metrics::ExceptionCaptureResult(Metrics::CaptureResult::kSnapshotFailed);
     return false;
   }
@@ -68,6 +100,22 @@ bool CaptureSnapshot(
     process_snapshot->AddAnnotation(p.first, p.second);
   }
 
+  CaptureProfile capture_profile =
+      client_options.capture_profile != CaptureProfile::kUnset
+          ? client_options.capture_profile
+          : capture_options.default_capture_profile;
+  if (capture_profile == CaptureProfile::kFull &&
+      info.sanitization_information_address) {
+    // Writable memory isn’t sanitized, so it isn’t captured for snapshots that
+    // will be sanitized.
+    capture_profile = CaptureProfile::kDefault;
+  }
+  CaptureLimits capture_limits = CaptureLimitsForProfile(capture_profile);
+  if (capture_options.max_thread_stacks) {
+    capture_limits.max_thread_stacks = capture_options.max_thread_stacks;
+  }
+  process_snapshot->ApplyCaptureLimits(capture_limits);
+
   if (info.sanitization_information_address) {
     SanitizationInformation sanitization_info;
     ProcessMemoryRange range;
@@ -110,10 +158,61 @@ bool CaptureSnapshot(
       return false;
     }
     *sanitized_snapshot = std::move(sanitized);
+  } else {
+    // Memory gathered near pointers isn’t sanitized, so it’s only gathered for
+    // snapshots that won’t be sanitized.
+    process_snapshot->GatherIndirectlyReferencedMemory();
   }
 
   *snapshot = std::move(process_snapshot);
   return true;
 }
 
+void AddOmittedMemoryStream(const ProcessSnapshotLinux& process_snapshot,
+                            MinidumpFileWriter* minidump) {
+  const std::vector<CheckedRange<uint64_t>> omitted_memory =
+      process_snapshot.OmittedMemory();
+  if (omitted_memory.empty()) {
+    return;
+  }
+
+  auto omitted_memory_list =
+      std::make_unique<MinidumpOmittedMemoryListWriter>();
+  omitted_memory_list->InitializeFromRanges(omitted_memory);
+  minidump->AddStream(std::move(omitted_memory_list));
+}
+
+void AddCaptureTruncationStream(const CaptureDeadline* deadline,
+                                MinidumpFileWriter* minidump) {
+  if (!deadline || !deadline->IsSet()) {
+    return;
+  }
+
+  auto capture_truncation =
+      std::make_unique<MinidumpCaptureTruncationWriter>();
+  capture_truncation->InitializeFromDeadline(deadline);
+  minidump->AddStream(std::move(capture_truncation));
+}
+
+void AddWritableMemoryStream(const ProcessSnapshotLinux& process_snapshot,
+                             CaptureDeadline* deadline,
+                             MinidumpFileWriter* minidump) {
+  const std::vector<CheckedRange<uint64_t>>& writable_memory =
+      process_snapshot.WritableMemory();
+  if (writable_memory.empty()) {
+    return;
+  }
+
+  // Writing this stream is the slowest part of writing a minidump, so it’s
+  // left out entirely if there’s no time left for it.
+  if (deadline && deadline->Expired(CaptureDeadline::kPhaseSerialization)) {
+    return;
+  }
+
+  auto memory64_list = std::make_unique<MinidumpMemory64ListWriter>();
+  memory64_list->InitializeFromRanges(
+      process_snapshot.Memory(), writable_memory, deadline);
+  minidump->AddStream(std::move(memory64_list));
+}
+
 }  // namespace crashpad
@@ -20,19 +20,67 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "snapshot/elf/elf_module_metadata_cache.h"
+#include "snapshot/linux/link_map_cache.h"
 #include "snapshot/linux/process_snapshot_linux.h"
 #include "snapshot/sanitized/process_snapshot_sanitized.h"
 #include "util/linux/exception_handler_protocol.h"
 #include "util/linux/ptrace_connection.h"
 #include "util/misc/address_types.h"
+#include "util/misc/capture_deadline.h"
+#include "util/misc/capture_profile.h"
+#include "util/process/process_memory_overlay.h"
 
 namespace crashpad {
 
+class MinidumpFileWriter;
+
+//! \brief Options that control what CaptureSnapshot() captures.
+struct CaptureOptions {
+  //! \brief Constructs options that capture a snapshot as
+  //!     CaptureProfile::kDefault specifies, without a time limit.
+  CaptureOptions();
+
+  //! \brief `true` if memory whose contents are the same as in module files
+  //!     should be left out of the snapshot where possible. Use
+  //!     AddOmittedMemoryStream() to record what was left out.
+  bool omit_unmodified_module_memory;
+
+  //! \brief The profile that limits what is captured, used if the client
+  //!     doesn’t request one with CrashpadInfo::set_capture_profile().
+  CaptureProfile default_capture_profile;
+
+  //! \brief The number of threads whose stacks are captured, overriding the
+  //!     capture profile’s limit. Other threads are captured without their
+  //!     stacks. If 0, the profile’s limit applies.
+  size_t max_thread_stacks;
+
+  //! \brief The time allowed for capturing each snapshot and writing it, in
+  //!     milliseconds, used to construct the CaptureDeadline passed to
+  //!     CaptureSnapshot(). If 0, captures have no time limit.
+  unsigned int capture_timeout_ms;
+};
+
 //! \brief Captures a snapshot of a client over \a connection.
 //!
 //! \param[in] connection A PtraceConnection to the client to snapshot.
 //! \param[in] info Information about the client configuring the snapshot.
+//! \param[in] shared_annotations Annotation storage that the client shares
+//!     with the handler. Optional.
+//! \param[in] crashing_thread_state Copies of the crashing thread’s exception
+//!     information, context, and stack that the client sent with its request,
+//!     which are read instead of the client’s memory. Optional.
+//! \param[in] link_map_cache A cache of the modules located in previous
+//!     snapshots, which is updated with the modules found in this one.
+//!     Optional.
+//! \param[in] module_metadata_cache A cache of metadata read from modules,
+//!     shared across all clients. Optional.
+//! \param[in] capture_options Options that control what is captured.
+//! \param[in] deadline The deadline of the capture. Work that can be left out
+//!     is skipped once it has passed. Use AddCaptureTruncationStream() to
+//!     record what was left out. Optional.
 //! \param[in] process_annotations A map of annotations to insert as
 //!     process-level annotations into the snapshot.
 //! \param[in] client_uid The client's user ID.
@@ -55,6 +103,12 @@ namespace crashpad {
 bool CaptureSnapshot(
     PtraceConnection* connection,
     const ExceptionHandlerProtocol::ClientInformation& info,
+    const ProcessMemoryOverlay::Region* shared_annotations,
+    const std::vector<ProcessMemoryOverlay::Region>* crashing_thread_state,
+    LinkMapCache* link_map_cache,
+    ElfModuleMetadataCache* module_metadata_cache,
+    const CaptureOptions& capture_options,
+    CaptureDeadline* deadline,
     const std::map<std::string, std::string>& process_annotations,
     uid_t client_uid,
     VMAddress requesting_thread_stack_address,
@@ -62,6 +116,48 @@ bool CaptureSnapshot(
     std::unique_ptr<ProcessSnapshotLinux>* process_snapshot,
     std::unique_ptr<ProcessSnapshotSanitized>* sanitized_snapshot);
 
+//! \brief Adds a stream to \a minidump listing the memory that was left out
+//!     of \a process_snapshot because it is unmodified module memory.
+//!
+//! No stream is added if no memory was left out.
+//!
+//! \param[in] process_snapshot A snapshot captured by CaptureSnapshot().
+//! \param[in] minidump The minidump to add the stream to.
+void AddOmittedMemoryStream(const ProcessSnapshotLinux& process_snapshot,
+                            MinidumpFileWriter* minidump);
+
+//! \brief Adds a stream to \a minidump recording which phases of a capture were
+//!     cut short by its deadline.
+//!
+//! No stream is added if the capture has no deadline. The phases are recorded
+//! when \a minidump is written, so this should be called after the streams
+//! whose production checks \a deadline have been added to \a minidump. If
+//! \a minidump is written to a file that can be seeked, the stream is updated
+//! once the whole file has been written, so that it also records whether the
+//! stream added by AddWritableMemoryStream() was cut short.
+//!
+//! \param[in] deadline The deadline passed to CaptureSnapshot().
+//! \param[in] minidump The minidump to add the stream to.
+void AddCaptureTruncationStream(const CaptureDeadline* deadline,
+                                MinidumpFileWriter* minidump);
+
+//! \brief Adds a stream to \a minidump containing the writable memory that the
+//!     capture profile applied to \a process_snapshot includes.
+//!
+//! The memory is read from the client while \a minidump is written. No stream
+//! is added if the profile doesn’t include writable memory, or if \a deadline
+//! has passed. This must be called after all other streams have been added to
+//! \a minidump.
+//!
+//! \param[in] process_snapshot A snapshot captured by CaptureSnapshot().
+//! \param[in] deadline The deadline passed to CaptureSnapshot(). Once it has
+//!     passed while \a minidump is written, memory is no longer read from the
+//!     client. Optional.
+//! \param[in] minidump The minidump to add the stream to.
+void AddWritableMemoryStream(const ProcessSnapshotLinux& process_snapshot,
+                             CaptureDeadline* deadline,
+                             MinidumpFileWriter* minidump);
+
 }  // namespace crashpad
 
 #endif  // CRASHPAD_HANDLER_LINUX_CAPTURE_SNAPSHOT_H_
@@ -20,6 +20,7 @@
 #include "base/logging.h"
 #include "client/settings.h"
 #include "handler/linux/capture_snapshot.h"
+#include "handler/minidump_to_upload_parameters.h"
 #include "minidump/minidump_file_writer.h"
 #include "snapshot/linux/process_snapshot_linux.h"
 #include "snapshot/sanitized/process_snapshot_sanitized.h"
@@ -27,8 +28,10 @@
 #include "util/file/output_stream_file_writer.h"
 #include "util/linux/direct_ptrace_connection.h"
 #include "util/linux/ptrace_client.h"
+#include "util/misc/capture_deadline.h"
 #include "util/misc/implicit_cast.h"
 #include "util/misc/metrics.h"
+#include "util/misc/time.h"
 #include "util/misc/uuid.h"
 #include "util/stream/base94_output_stream.h"
 #include "util/stream/log_output_stream.h"
@@ -64,13 +67,17 @@ CrashReportExceptionHandler::CrashReportExceptionHandler(
     const std::map<std::string, std::string>* process_annotations,
     bool write_minidump_to_database,
     bool write_minidump_to_log,
+    const CaptureOptions& capture_options,
     const UserStreamDataSources* user_stream_data_sources)
     : database_(database),
       upload_thread_(upload_thread),
       process_annotations_(process_annotations),
       write_minidump_to_database_(write_minidump_to_database),
       write_minidump_to_log_(write_minidump_to_log),
-      user_stream_data_sources_(user_stream_data_sources) {
+      capture_options_(capture_options),
+      user_stream_data_sources_(user_stream_data_sources),
+      link_map_cache_(),
+      module_metadata_cache_(ElfModuleMetadataCache::kDefaultCapacity) {
   DCHECK(write_minidump_to_database_ | write_minidump_to_log_);
 }
 
@@ -82,7 +89,9 @@ bool CrashReportExceptionHandler::HandleException(
     const ExceptionHandlerProtocol::ClientInformation& info,
     VMAddress requesting_thread_stack_address,
     pid_t* requesting_thread_id,
-    UUID* local_report_id) {
+    UUID* local_report_id,
+    const ProcessMemoryOverlay::Region* shared_annotations,
+    const std::vector<ProcessMemoryOverlay::Region>* crashing_thread_state) {
   Metrics::ExceptionEncountered();
 
   DirectPtraceConnection connection;
@@ -94,6 +103,8 @@ bool CrashReportExceptionHandler::HandleException(
 
   return HandleExceptionWithConnection(&connection,
                                        info,
+                                       shared_annotations,
+                                       crashing_thread_state,
                                        client_uid,
                                        requesting_thread_stack_address,
                                        requesting_thread_id,
@@ -105,7 +116,9 @@ bool CrashReportExceptionHandler::HandleExceptionWithBroker(
     uid_t client_uid,
     const ExceptionHandlerProtocol::ClientInformation& info,
     int broker_sock,
-    UUID* local_report_id) {
+    UUID* local_report_id,
+    const ProcessMemoryOverlay::Region* shared_annotations,
+    const std::vector<ProcessMemoryOverlay::Region>* crashing_thread_state) {
   Metrics::ExceptionEncountered();
 
   PtraceClient client;
@@ -115,21 +128,38 @@ bool CrashReportExceptionHandler::HandleExceptionWithBroker(
     return false;
   }
 
-  return HandleExceptionWithConnection(
-      &client, info, client_uid, 0, nullptr, local_report_id);
+  return HandleExceptionWithConnection(&client,
+                                       info,
+                                       shared_annotations,
+                                       crashing_thread_state,
+                                       client_uid,
+                                       0,
+                                       nullptr,
+                                       local_report_id);
 }
 
 bool CrashReportExceptionHandler::HandleExceptionWithConnection(
     PtraceConnection* connection,
     const ExceptionHandlerProtocol::ClientInformation& info,
+    const ProcessMemoryOverlay::Region* shared_annotations,
+    const std::vector<ProcessMemoryOverlay::Region>* crashing_thread_state,
     uid_t client_uid,
     VMAddress requesting_thread_stack_address,
     pid_t* requesting_thread_id,
     UUID* local_report_id) {
+  CaptureDeadline deadline(capture_options_.capture_timeout_ms *
+                           kNanosecondsPerMillisecond);
+
   std::unique_ptr<ProcessSnapshotLinux> process_snapshot;
   std::unique_ptr<ProcessSnapshotSanitized> sanitized_snapshot;
   if (!CaptureSnapshot(connection,
                        info,
+                       shared_annotations,
+                       crashing_thread_state,
+                       &link_map_cache_,
+                       &module_metadata_cache_,
+                       capture_options_,
+                       &deadline,
                        *process_annotations_,
                        client_uid,
                        requesting_thread_stack_address,
@@ -152,15 +182,18 @@ bool CrashReportExceptionHandler::HandleExceptionWithConnection(
   return write_minidump_to_database_
              ? WriteMinidumpToDatabase(process_snapshot.get(),
                                        sanitized_snapshot.get(),
+                                       &deadline,
                                        write_minidump_to_log_,
                                        local_report_id)
              : WriteMinidumpToLog(process_snapshot.get(),
-                                  sanitized_snapshot.get());
+                                  sanitized_snapshot.get(),
+                                  &deadline);
 }
 
 bool CrashReportExceptionHandler::WriteMinidumpToDatabase(
     ProcessSnapshotLinux* process_snapshot,
     ProcessSnapshotSanitized* sanitized_snapshot,
+    CaptureDeadline* deadline,
     bool write_minidump_to_log,
     UUID* local_report_id) {
   std::unique_ptr<CrashReportDatabase::NewReport> new_report;
@@ -181,7 +214,11 @@ bool CrashReportExceptionHandler::WriteMinidumpToDatabase(
 
   MinidumpFileWriter minidump;
   minidump.InitializeFromSnapshot(snapshot);
-  AddUserExtensionStreams(user_stream_data_sources_, snapshot, &minidump);
+  AddOmittedMemoryStream(*process_snapshot, &minidump);
+  AddUserExtensionStreams(
+      user_stream_data_sources_, snapshot, &minidump, deadline);
+  AddCaptureTruncationStream(deadline, &minidump);
+  AddWritableMemoryStream(*process_snapshot, deadline, &minidump);
 
   if (!minidump.WriteEverything(new_report->Writer())) {
     LOG(ERROR) << "WriteEverything failed";
@@ -190,6 +227,12 @@ bool CrashReportExceptionHandler::WriteMinidumpToDatabase(
     return false;
   }
 
+  // Record the upload parameters now, from the snapshot that the minidump was
+  // written from, so that the uploader needn’t parse the minidump to find them.
+  // If this fails, the uploader will fall back to doing so.
+  new_report->SetUploadParameters(
+      BreakpadHTTPFormParametersFromMinidump(snapshot));
+
   bool write_minidump_to_log_succeed = false;
   if (write_minidump_to_log) {
     if (auto* file_reader = new_report->Reader()) {
@@ -225,13 +268,18 @@ bool CrashReportExceptionHandler::WriteMinidumpToDatabase(
 
 bool CrashReportExceptionHandler::WriteMinidumpToLog(
     ProcessSnapshotLinux* process_snapshot,
-    ProcessSnapshotSanitized* sanitized_snapshot) {
+    ProcessSnapshotSanitized* sanitized_snapshot,
+    CaptureDeadline* deadline) {
   ProcessSnapshot* snapshot =
       sanitized_snapshot ? implicit_cast<ProcessSnapshot*>(sanitized_snapshot)
                          : implicit_cast<ProcessSnapshot*>(process_snapshot);
   MinidumpFileWriter minidump;
   minidump.InitializeFromSnapshot(snapshot);
-  AddUserExtensionStreams(user_stream_data_sources_, snapshot, &minidump);
+  AddOmittedMemoryStream(*process_snapshot, &minidump);
+  AddUserExtensionStreams(
+      user_stream_data_sources_, snapshot, &minidump, deadline);
+  AddCaptureTruncationStream(deadline, &minidump);
+  AddWritableMemoryStream(*process_snapshot, deadline, &minidump);
 
   OutputStreamFileWriter writer(std::make_unique<ZlibOutputStream>(
       ZlibOutputStream::Mode::kCompress,
@@ -21,12 +21,17 @@
 #include "base/macros.h"
 #include "client/crash_report_database.h"
 #include "handler/crash_report_upload_thread.h"
+#include "handler/linux/capture_snapshot.h"
 #include "handler/linux/exception_handler_server.h"
 #include "handler/user_stream_data_source.h"
+#include "snapshot/elf/elf_module_metadata_cache.h"
+#include "snapshot/linux/link_map_cache.h"
 #include "util/linux/exception_handler_protocol.h"
 #include "util/linux/ptrace_connection.h"
 #include "util/misc/address_types.h"
+#include "util/misc/capture_deadline.h"
 #include "util/misc/uuid.h"
+#include "util/process/process_memory_overlay.h"
 
 namespace crashpad {
 
@@ -57,6 +62,10 @@ class CrashReportExceptionHandler : public ExceptionHandlerServer::Delegate {
   //!     written to database.
   //! \param[in] write_minidump_to_log Whether the minidump shall be written to
   //!     log.
+  //! \param[in] capture_options Options that control what is captured from
+  //!     clients, and how long each capture may take. Once a capture’s time
+  //!     has passed, work that can be left out of the report is skipped, and a
+  //!     MinidumpCaptureTruncation stream records what was left out.
   //! \param[in] user_stream_data_sources Data sources to be used to extend
   //!     crash reports. For each crash report that is written, the data sources
   //!     are called in turn. These data sources may contribute additional
@@ -67,6 +76,7 @@ class CrashReportExceptionHandler : public ExceptionHandlerServer::Delegate {
       const std::map<std::string, std::string>* process_annotations,
       bool write_minidump_to_database,
       bool write_minidump_to_log,
+      const CaptureOptions& capture_options,
       const UserStreamDataSources* user_stream_data_sources);
 
   ~CrashReportExceptionHandler() override;
@@ -78,19 +88,28 @@ class CrashReportExceptionHandler : public ExceptionHandlerServer::Delegate {
                        const ExceptionHandlerProtocol::ClientInformation& info,
                        VMAddress requesting_thread_stack_address = 0,
                        pid_t* requesting_thread_id = nullptr,
-                       UUID* local_report_id = nullptr) override;
+                       UUID* local_report_id = nullptr,
+                       const ProcessMemoryOverlay::Region* shared_annotations =
+                           nullptr,
+                       const std::vector<ProcessMemoryOverlay::Region>*
+                           crashing_thread_state = nullptr) override;
 
   bool HandleExceptionWithBroker(
       pid_t client_process_id,
       uid_t client_uid,
       const ExceptionHandlerProtocol::ClientInformation& info,
       int broker_sock,
-      UUID* local_report_id = nullptr) override;
+      UUID* local_report_id = nullptr,
+      const ProcessMemoryOverlay::Region* shared_annotations = nullptr,
+      const std::vector<ProcessMemoryOverlay::Region>* crashing_thread_state =
+          nullptr) override;
 
  private:
   bool HandleExceptionWithConnection(
       PtraceConnection* connection,
       const ExceptionHandlerProtocol::ClientInformation& info,
+      const ProcessMemoryOverlay::Region* shared_annotations,
+      const std::vector<ProcessMemoryOverlay::Region>* crashing_thread_state,
       uid_t client_uid,
       VMAddress requesting_thread_stack_address,
       pid_t* requesting_thread_id,
@@ -98,17 +117,22 @@ class CrashReportExceptionHandler : public ExceptionHandlerServer::Delegate {
 
   bool WriteMinidumpToDatabase(ProcessSnapshotLinux* process_snapshot,
                                ProcessSnapshotSanitized* sanitized_snapshot,
+                               CaptureDeadline* deadline,
                                bool write_minidump_to_log,
                                UUID* local_report_id);
   bool WriteMinidumpToLog(ProcessSnapshotLinux* process_snapshot,
-                          ProcessSnapshotSanitized* sanitized_snapshot);
+                          ProcessSnapshotSanitized* sanitized_snapshot,
+                          CaptureDeadline* deadline);
 
   CrashReportDatabase* database_;  // weak
   CrashReportUploadThread* upload_thread_;  // weak
   const std::map<std::string, std::string>* process_annotations_;  // weak
   bool write_minidump_to_database_;
   bool write_minidump_to_log_;
+  CaptureOptions capture_options_;
   const UserStreamDataSources* user_stream_data_sources_;  // weak
+  LinkMapCache link_map_cache_;
+  ElfModuleMetadataCache module_metadata_cache_;
 
   DISALLOW_COPY_AND_ASSIGN(CrashReportExceptionHandler);
 };
@@ -27,7 +27,9 @@
 #include "util/file/file_writer.h"
 #include "util/linux/direct_ptrace_connection.h"
 #include "util/linux/ptrace_client.h"
+#include "util/misc/capture_deadline.h"
 #include "util/misc/metrics.h"
+#include "util/misc/time.h"
 #include "util/misc/uuid.h"
 #include "util/posix/double_fork_and_exec.h"
 
@@ -130,11 +132,15 @@ bool WriteAnnotationsAndMinidump(
 CrosCrashReportExceptionHandler::CrosCrashReportExceptionHandler(
     CrashReportDatabase* database,
     const std::map<std::string, std::string>* process_annotations,
+    const CaptureOptions& capture_options,
     const UserStreamDataSources* user_stream_data_sources)
     : database_(database),
       process_annotations_(process_annotations),
+      capture_options_(capture_options),
       user_stream_data_sources_(user_stream_data_sources),
-      always_allow_feedback_(false) {}
+      always_allow_feedback_(false),
+      link_map_cache_(),
+      module_metadata_cache_(ElfModuleMetadataCache::kDefaultCapacity) {}
 
 CrosCrashReportExceptionHandler::~CrosCrashReportExceptionHandler() = default;
 
@@ -144,7 +150,9 @@ bool CrosCrashReportExceptionHandler::HandleException(
     const ExceptionHandlerProtocol::ClientInformation& info,
     VMAddress requesting_thread_stack_address,
     pid_t* requesting_thread_id,
-    UUID* local_report_id) {
+    UUID* local_report_id,
+    const ProcessMemoryOverlay::Region* shared_annotations,
+    const std::vector<ProcessMemoryOverlay::Region>* crashing_thread_state) {
   Metrics::ExceptionEncountered();
 
   DirectPtraceConnection connection;
@@ -156,6 +164,8 @@ bool CrosCrashReportExceptionHandler::HandleException(
 
   return HandleExceptionWithConnection(&connection,
                                        info,
+                                       shared_annotations,
+                                       crashing_thread_state,
                                        client_uid,
                                        requesting_thread_stack_address,
                                        requesting_thread_id,
@@ -167,7 +177,9 @@ bool CrosCrashReportExceptionHandler::HandleExceptionWithBroker(
     uid_t client_uid,
     const ExceptionHandlerProtocol::ClientInformation& info,
     int broker_sock,
-    UUID* local_report_id) {
+    UUID* local_report_id,
+    const ProcessMemoryOverlay::Region* shared_annotations,
+    const std::vector<ProcessMemoryOverlay::Region>* crashing_thread_state) {
   Metrics::ExceptionEncountered();
 
   PtraceClient client;
@@ -177,21 +189,38 @@ bool CrosCrashReportExceptionHandler::HandleExceptionWithBroker(
     return false;
   }
 
-  return HandleExceptionWithConnection(
-      &client, info, client_uid, 0, nullptr, local_report_id);
+  return HandleExceptionWithConnection(&client,
+                                       info,
+                                       shared_annotations,
+                                       crashing_thread_state,
+                                       client_uid,
+                                       0,
+                                       nullptr,
+                                       local_report_id);
 }
 
 bool CrosCrashReportExceptionHandler::HandleExceptionWithConnection(
     PtraceConnection* connection,
     const ExceptionHandlerProtocol::ClientInformation& info,
+    const ProcessMemoryOverlay::Region* shared_annotations,
+    const std::vector<ProcessMemoryOverlay::Region>* crashing_thread_state,
     uid_t client_uid,
     VMAddress requesting_thread_stack_address,
     pid_t* requesting_thread_id,
     UUID* local_report_id) {
+  CaptureDeadline deadline(capture_options_.capture_timeout_ms *
+                           kNanosecondsPerMillisecond);
+
   std::unique_ptr<ProcessSnapshotLinux> process_snapshot;
   std::unique_ptr<ProcessSnapshotSanitized> sanitized_snapshot;
   if (!CaptureSnapshot(connection,
                        info,
+                       shared_annotations,
+                       crashing_thread_state,
+                       &link_map_cache_,
+                       &module_metadata_cache_,
+                       capture_options_,
+                       &deadline,
                        *process_annotations_,
                        client_uid,
                        requesting_thread_stack_address,
@@ -222,7 +251,11 @@ bool CrosCrashReportExceptionHandler::HandleExceptionWithConnection(
 
   MinidumpFileWriter minidump;
   minidump.InitializeFromSnapshot(snapshot);
-  AddUserExtensionStreams(user_stream_data_sources_, snapshot, &minidump);
+  AddOmittedMemoryStream(*process_snapshot, &minidump);
+  AddUserExtensionStreams(
+      user_stream_data_sources_, snapshot, &minidump, &deadline);
+  AddCaptureTruncationStream(&deadline, &minidump);
+  AddWritableMemoryStream(*process_snapshot, &deadline, &minidump);
 
   FileWriter file_writer;
   if (!file_writer.OpenMemfd(base::FilePath("minidump"))) {
@@ -20,12 +20,16 @@
 
 #include "base/macros.h"
 #include "client/crash_report_database.h"
+#include "handler/linux/capture_snapshot.h"
 #include "handler/linux/exception_handler_server.h"
 #include "handler/user_stream_data_source.h"
+#include "snapshot/elf/elf_module_metadata_cache.h"
+#include "snapshot/linux/link_map_cache.h"
 #include "util/linux/exception_handler_protocol.h"
 #include "util/linux/ptrace_connection.h"
 #include "util/misc/address_types.h"
 #include "util/misc/uuid.h"
+#include "util/process/process_memory_overlay.h"
 
 namespace crashpad {
 
@@ -49,6 +53,8 @@ class CrosCrashReportExceptionHandler
   //!     To interoperate with Breakpad servers, the recommended practice is to
   //!     specify values for the `"prod"` and `"ver"` keys as process
   //!     annotations.
+  //! \param[in] capture_options Options that control what is captured from
+  //!     clients, and how long each capture may take.
   //! \param[in] user_stream_data_sources Data sources to be used to extend
   //!     crash reports. For each crash report that is written, the data sources
   //!     are called in turn. These data sources may contribute additional
@@ -56,6 +62,7 @@ class CrosCrashReportExceptionHandler
   CrosCrashReportExceptionHandler(
       CrashReportDatabase* database,
       const std::map<std::string, std::string>* process_annotations,
+      const CaptureOptions& capture_options,
       const UserStreamDataSources* user_stream_data_sources);
 
   ~CrosCrashReportExceptionHandler() override;
@@ -67,14 +74,21 @@ class CrosCrashReportExceptionHandler
                        const ExceptionHandlerProtocol::ClientInformation& info,
                        VMAddress requesting_thread_stack_address = 0,
                        pid_t* requesting_thread_id = nullptr,
-                       UUID* local_report_id = nullptr) override;
+                       UUID* local_report_id = nullptr,
+                       const ProcessMemoryOverlay::Region* shared_annotations =
+                           nullptr,
+                       const std::vector<ProcessMemoryOverlay::Region>*
+                           crashing_thread_state = nullptr) override;
 
   bool HandleExceptionWithBroker(
       pid_t client_process_id,
       uid_t client_uid,
       const ExceptionHandlerProtocol::ClientInformation& info,
       int broker_sock,
-      UUID* local_report_id = nullptr) override;
+      UUID* local_report_id = nullptr,
+      const ProcessMemoryOverlay::Region* shared_annotations = nullptr,
+      const std::vector<ProcessMemoryOverlay::Region>* crashing_thread_state =
+          nullptr) override;
 
   void SetDumpDir(const base::FilePath& dump_dir) { dump_dir_ = dump_dir; }
   void SetAlwaysAllowFeedback() { always_allow_feedback_ = true; }
@@ -82,6 +96,8 @@ class CrosCrashReportExceptionHandler
   bool HandleExceptionWithConnection(
       PtraceConnection* connection,
       const ExceptionHandlerProtocol::ClientInformation& info,
+      const ProcessMemoryOverlay::Region* shared_annotations,
+      const std::vector<ProcessMemoryOverlay::Region>* crashing_thread_state,
       uid_t client_uid,
       VMAddress requesting_thread_stack_address,
       pid_t* requesting_thread_id,
@@ -89,9 +105,12 @@ class CrosCrashReportExceptionHandler
 
   CrashReportDatabase* database_;  // weak
   const std::map<std::string, std::string>* process_annotations_;  // weak
+  CaptureOptions capture_options_;
   const UserStreamDataSources* user_stream_data_sources_;  // weak
   base::FilePath dump_dir_;
   bool always_allow_feedback_;
+  LinkMapCache link_map_cache_;
+  ElfModuleMetadataCache module_metadata_cache_;
 
   DISALLOW_COPY_AND_ASSIGN(CrosCrashReportExceptionHandler);
 };
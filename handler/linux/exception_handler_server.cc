@@ -15,14 +15,20 @@
 #include "handler/linux/exception_handler_server.h"
 
 #include <errno.h>
+#include <fcntl.h>
 #include <linux/capability.h>
+#include <string.h>
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <sys/syscall.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <string>
 #include <utility>
 
 #include "base/compiler_specific.h"
@@ -35,6 +41,7 @@
 #include "util/linux/proc_task_reader.h"
 #include "util/linux/socket.h"
 #include "util/misc/as_underlying_type.h"
+#include "util/numeric/safe_assignment.h"
 
 namespace crashpad {
 
@@ -147,10 +154,126 @@ void SendSIGCONT(pid_t pid, pid_t tid) {
   }
 }
 
+// The largest crashing thread state file that’s read. Clients write much less
+// than this.
+constexpr off_t kMaxCrashingThreadStateSize = 1024 * 1024;
+
+bool RegionsOverlap(const ProcessMemoryOverlay::Region& lhs,
+                    const ProcessMemoryOverlay::Region& rhs) {
+  return lhs.address < rhs.address + rhs.size &&
+         rhs.address < lhs.address + lhs.size;
+}
+
+// Reads a crashing thread state file passed by a client into |contents|, and
+// sets |regions| to the regions of the client’s memory that it holds. Regions
+// that overlap another region or |shared_annotations| are left out.
+void ReadCrashingThreadState(
+    int fd,
+    const ProcessMemoryOverlay::Region* shared_annotations,
+    std::string* contents,
+    std::vector<ProcessMemoryOverlay::Region>* regions) {
+  // The file is read instead of mapped, so that the client can’t cause reads
+  // of it to fail by shrinking it. Its offset is shared with the client, so
+  // it’s read from the start explicitly.
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    PLOG(ERROR) << "fstat";
+    return;
+  }
+  if (!S_ISREG(st.st_mode)) {
+    LOG(ERROR) << "crashing thread state not a regular file";
+    return;
+  }
+
+  // The client must not be able to change the file while it’s read.
+  const int seals = fcntl(fd, F_GET_SEALS);
+  if (seals < 0) {
+    PLOG(ERROR) << "fcntl";
+    return;
+  }
+  constexpr int kRequiredSeals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE;
+  if ((seals & kRequiredSeals) != kRequiredSeals) {
+    LOG(ERROR) << "crashing thread state not sealed";
+    return;
+  }
+
+  if (st.st_size > kMaxCrashingThreadStateSize) {
+    LOG(ERROR) << "crashing thread state too large, " << st.st_size;
+    return;
+  }
+  contents->resize(st.st_size);
+  const ssize_t bytes_read =
+      HANDLE_EINTR(pread(fd, &(*contents)[0], contents->size(), 0));
+  if (bytes_read < 0) {
+    PLOG(ERROR) << "pread";
+    return;
+  }
+  contents->resize(bytes_read);
+
+  using Header = ExceptionHandlerProtocol::CrashingThreadStateHeader;
+  using FileRegion = ExceptionHandlerProtocol::CrashingThreadStateRegion;
+  Header header;
+  if (contents->size() < sizeof(header)) {
+    LOG(ERROR) << "crashing thread state too small";
+    return;
+  }
+  memcpy(&header, contents->data(), sizeof(header));
+  if (header.version != Header::kVersion) {
+    LOG(ERROR) << "unexpected crashing thread state version "
+               << header.version;
+    return;
+  }
+  if (header.region_count >
+      (contents->size() - sizeof(header)) / sizeof(FileRegion)) {
+    LOG(ERROR) << "invalid crashing thread state region count "
+               << header.region_count;
+    return;
+  }
+
+  std::vector<ProcessMemoryOverlay::Region> file_regions;
+  size_t offset = sizeof(header) + header.region_count * sizeof(FileRegion);
+  for (size_t index = 0; index < header.region_count; ++index) {
+    FileRegion file_region;
+    memcpy(&file_region,
+           contents->data() + sizeof(header) + index * sizeof(file_region),
+           sizeof(file_region));
+    if (file_region.size > contents->size() - offset) {
+      LOG(ERROR) << "crashing thread state truncated";
+      return;
+    }
+    if (file_region.size &&
+        file_region.address + file_region.size > file_region.address) {
+      ProcessMemoryOverlay::Region region;
+      region.address = file_region.address;
+      region.size = file_region.size;
+      region.data = contents->data() + offset;
+      file_regions.push_back(region);
+    }
+    offset += static_cast<size_t>(file_region.size);
+  }
+
+  std::sort(file_regions.begin(),
+            file_regions.end(),
+            [](const ProcessMemoryOverlay::Region& lhs,
+               const ProcessMemoryOverlay::Region& rhs) {
+              return lhs.address < rhs.address;
+            });
+  for (const ProcessMemoryOverlay::Region& region : file_regions) {
+    if ((!regions->empty() && RegionsOverlap(regions->back(), region)) ||
+        (shared_annotations && RegionsOverlap(*shared_annotations, region))) {
+      LOG(WARNING) << "overlapping crashing thread state region";
+      continue;
+    }
+    regions->push_back(region);
+  }
+}
+
 bool SendCredentials(int client_sock) {
   ExceptionHandlerProtocol::ServerToClientMessage message = {};
   message.type =
       ExceptionHandlerProtocol::ServerToClientMessage::kTypeCredentials;
+  message.features = ExceptionHandlerProtocol::ServerToClientMessage::
+      kFeatureSharedAnnotations;
   return UnixCredentialSocket::SendMsg(
              client_sock, &message, sizeof(message)) == 0;
 }
@@ -417,8 +540,9 @@ bool ExceptionHandlerServer::UninstallClientSocket(Event* event) {
 bool ExceptionHandlerServer::ReceiveClientMessage(Event* event) {
   ExceptionHandlerProtocol::ClientToServerMessage message;
   ucred creds;
+  std::vector<ScopedFileHandle> fds;
   if (!UnixCredentialSocket::RecvMsg(
-          event->fd.get(), &message, sizeof(message), &creds)) {
+          event->fd.get(), &message, sizeof(message), &creds, &fds)) {
     return false;
   }
 
@@ -426,13 +550,26 @@ bool ExceptionHandlerServer::ReceiveClientMessage(Event* event) {
     case ExceptionHandlerProtocol::ClientToServerMessage::kTypeCheckCredentials:
       return SendCredentials(event->fd.get());
 
-    case ExceptionHandlerProtocol::ClientToServerMessage::kTypeCrashDumpRequest:
+    case ExceptionHandlerProtocol::ClientToServerMessage::
+        kTypeCrashDumpRequest: {
+      const auto shared_annotations =
+          event->shared_annotations.find(creds.pid);
       return HandleCrashDumpRequest(
           creds,
           message.client_info,
           message.requesting_thread_stack_address,
+          shared_annotations != event->shared_annotations.end()
+              ? shared_annotations->second.get()
+              : nullptr,
+          fds,
           event->fd.get(),
           event->type == Event::Type::kSharedSocketMessage);
+    }
+
+    case ExceptionHandlerProtocol::ClientToServerMessage::
+        kTypeSharedAnnotations:
+      ReceiveSharedAnnotations(event, creds, message.shared_annotations, fds);
+      return true;
   }
 
   DCHECK(false);
@@ -440,16 +577,88 @@ bool ExceptionHandlerServer::ReceiveClientMessage(Event* event) {
   return false;
 }
 
+void ExceptionHandlerServer::ReceiveSharedAnnotations(
+    Event* event,
+    const ucred& creds,
+    const ExceptionHandlerProtocol::SharedAnnotationsInformation& info,
+    const std::vector<ScopedFileHandle>& fds) {
+  // Problems with the shared storage are logged but otherwise ignored, leaving
+  // the client’s annotations to be read from its memory.
+  if (fds.size() != 1) {
+    LOG(ERROR) << "expected 1 fd, got " << fds.size();
+    return;
+  }
+  const int fd = fds[0].get();
+
+  // The client must not be able to shrink the file, which would cause reads
+  // of the mapping to raise SIGBUS in the handler.
+  const int seals = fcntl(fd, F_GET_SEALS);
+  if (seals < 0) {
+    PLOG(ERROR) << "fcntl";
+    return;
+  }
+  if (!(seals & F_SEAL_SHRINK)) {
+    LOG(ERROR) << "shared annotations not sealed";
+    return;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    PLOG(ERROR) << "fstat";
+    return;
+  }
+  size_t size;
+  if (info.size == 0 || info.size > static_cast<VMSize>(st.st_size) ||
+      !AssignIfInRange(&size, info.size)) {
+    LOG(ERROR) << "invalid shared annotations size " << info.size;
+    return;
+  }
+
+  auto shared_annotations = std::make_unique<SharedAnnotations>();
+  if (!shared_annotations->mapping.ResetMmap(
+          nullptr, size, PROT_READ, MAP_SHARED, fd, 0)) {
+    return;
+  }
+  shared_annotations->address = info.address;
+  event->shared_annotations[creds.pid] = std::move(shared_annotations);
+}
+
 bool ExceptionHandlerServer::HandleCrashDumpRequest(
     const ucred& creds,
     const ExceptionHandlerProtocol::ClientInformation& client_info,
     VMAddress requesting_thread_stack_address,
+    const SharedAnnotations* shared_annotations,
+    const std::vector<ScopedFileHandle>& fds,
     int client_sock,
     bool multiple_clients) {
   pid_t client_process_id = creds.pid;
   pid_t requesting_thread_id = -1;
   uid_t client_uid = creds.uid;
 
+  ProcessMemoryOverlay::Region region;
+  if (shared_annotations) {
+    region.address = shared_annotations->address;
+    region.size = shared_annotations->mapping.len();
+    region.data = shared_annotations->mapping.addr();
+  }
+  const ProcessMemoryOverlay::Region* shared_region =
+      shared_annotations ? &region : nullptr;
+
+  // Problems with the crashing thread’s state are logged but otherwise
+  // ignored, leaving it to be read from the client.
+  std::string crashing_thread_state;
+  std::vector<ProcessMemoryOverlay::Region> crashing_thread_regions;
+  if (fds.size() == 1) {
+    ReadCrashingThreadState(fds[0].get(),
+                            shared_region,
+                            &crashing_thread_state,
+                            &crashing_thread_regions);
+  } else if (!fds.empty()) {
+    LOG(ERROR) << "expected at most 1 fd, got " << fds.size();
+  }
+  const std::vector<ProcessMemoryOverlay::Region>* crashing_thread_region_list =
+      !crashing_thread_regions.empty() ? &crashing_thread_regions : nullptr;
+
   switch (
       strategy_decider_->ChooseStrategy(client_sock, multiple_clients, creds)) {
     case PtraceStrategyDecider::Strategy::kError:
@@ -473,7 +682,10 @@ bool ExceptionHandlerServer::HandleCrashDumpRequest(
                                  client_uid,
                                  client_info,
                                  requesting_thread_stack_address,
-                                 &requesting_thread_id);
+                                 &requesting_thread_id,
+                                 nullptr,
+                                 shared_region,
+                                 crashing_thread_region_list);
       if (multiple_clients) {
         SendSIGCONT(client_process_id, requesting_thread_id);
         return true;
@@ -483,8 +695,13 @@ bool ExceptionHandlerServer::HandleCrashDumpRequest(
 
     case PtraceStrategyDecider::Strategy::kUseBroker:
       DCHECK(!multiple_clients);
-      delegate_->HandleExceptionWithBroker(
-          client_process_id, client_uid, client_info, client_sock);
+      delegate_->HandleExceptionWithBroker(client_process_id,
+                                           client_uid,
+                                           client_info,
+                                           client_sock,
+                                           nullptr,
+                                           shared_region,
+                                           crashing_thread_region_list);
       break;
   }
 
@@ -21,6 +21,7 @@
 #include <atomic>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include "base/macros.h"
 #include "util/file/file_io.h"
@@ -28,6 +29,8 @@
 #include "util/misc/address_types.h"
 #include "util/misc/initialization_state_dcheck.h"
 #include "util/misc/uuid.h"
+#include "util/posix/scoped_mmap.h"
+#include "util/process/process_memory_overlay.h"
 
 namespace crashpad {
 
@@ -86,6 +89,12 @@ class ExceptionHandlerServer {
     //!     ID could not be determined. Optional.
     //! \param[out] local_report_id The unique identifier for the report created
     //!     in the local report database. Optional.
+    //! \param[in] shared_annotations Annotation storage that the client shares
+    //!     with the handler, mapped into the handler. Optional.
+    //! \param[in] crashing_thread_state Copies of the crashing thread’s state
+    //!     that the client passed with its request, to be read instead of the
+    //!     client’s memory. These don’t overlap each other or \a
+    //!     shared_annotations. Optional.
     //! \return `true` on success. `false` on failure with a message logged.
     virtual bool HandleException(
         pid_t client_process_id,
@@ -93,7 +102,10 @@ class ExceptionHandlerServer {
         const ExceptionHandlerProtocol::ClientInformation& info,
         VMAddress requesting_thread_stack_address = 0,
         pid_t* requesting_thread_id = nullptr,
-        UUID* local_report_id = nullptr) = 0;
+        UUID* local_report_id = nullptr,
+        const ProcessMemoryOverlay::Region* shared_annotations = nullptr,
+        const std::vector<ProcessMemoryOverlay::Region>* crashing_thread_state =
+            nullptr) = 0;
 
     //! \brief Called on the receipt of a crash dump request from a client for a
     //!     crash that should be mediated by a PtraceBroker.
@@ -104,13 +116,22 @@ class ExceptionHandlerServer {
     //! \param[in] broker_sock A socket connected to the PtraceBroker.
     //! \param[out] local_report_id The unique identifier for the report created
     //!     in the local report database. Optional.
+    //! \param[in] shared_annotations Annotation storage that the client shares
+    //!     with the handler, mapped into the handler. Optional.
+    //! \param[in] crashing_thread_state Copies of the crashing thread’s state
+    //!     that the client passed with its request, to be read instead of the
+    //!     client’s memory. These don’t overlap each other or \a
+    //!     shared_annotations. Optional.
     //! \return `true` on success. `false` on failure with a message logged.
     virtual bool HandleExceptionWithBroker(
         pid_t client_process_id,
         uid_t client_uid,
         const ExceptionHandlerProtocol::ClientInformation& info,
         int broker_sock,
-        UUID* local_report_id = nullptr) = 0;
+        UUID* local_report_id = nullptr,
+        const ProcessMemoryOverlay::Region* shared_annotations = nullptr,
+        const std::vector<ProcessMemoryOverlay::Region>* crashing_thread_state =
+            nullptr) = 0;
 
     virtual ~Delegate() {}
   };
@@ -153,6 +174,12 @@ class ExceptionHandlerServer {
   void Stop();
 
  private:
+  // Annotation storage shared by a client, mapped into the handler.
+  struct SharedAnnotations {
+    ScopedMmap mapping;
+    VMAddress address;
+  };
+
   struct Event {
     enum class Type {
       // Used by Stop() to shutdown the server.
@@ -167,16 +194,28 @@ class ExceptionHandlerServer {
 
     Type type;
     ScopedFileHandle fd;
+
+    // Annotation storage shared by the clients using this socket, keyed by
+    // process ID. This is released when the socket is closed.
+    std::unordered_map<pid_t, std::unique_ptr<SharedAnnotations>>
+        shared_annotations;
   };
 
   void HandleEvent(Event* event, uint32_t event_type);
   bool InstallClientSocket(ScopedFileHandle socket, Event::Type type);
   bool UninstallClientSocket(Event* event);
   bool ReceiveClientMessage(Event* event);
+  void ReceiveSharedAnnotations(
+      Event* event,
+      const ucred& creds,
+      const ExceptionHandlerProtocol::SharedAnnotationsInformation& info,
+      const std::vector<ScopedFileHandle>& fds);
   bool HandleCrashDumpRequest(
       const ucred& creds,
       const ExceptionHandlerProtocol::ClientInformation& client_info,
       VMAddress requesting_thread_stack_address,
+      const SharedAnnotations* shared_annotations,
+      const std::vector<ScopedFileHandle>& fds,
       int client_sock,
       bool multiple_clients);
 
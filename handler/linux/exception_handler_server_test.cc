@@ -14,9 +14,17 @@
 
 #include "handler/linux/exception_handler_server.h"
 
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <map>
+#include <string>
+#include <vector>
+
 #include "base/logging.h"
 #include "build/build_config.h"
 #include "gtest/gtest.h"
@@ -25,9 +33,13 @@
 #include "test/multiprocess.h"
 #include "util/linux/direct_ptrace_connection.h"
 #include "util/linux/exception_handler_client.h"
+#include "util/linux/exception_information.h"
 #include "util/linux/ptrace_client.h"
 #include "util/linux/scoped_pr_set_ptracer.h"
+#include "util/misc/capture_context.h"
+#include "util/misc/from_pointer_cast.h"
 #include "util/misc/uuid.h"
+#include "util/posix/scoped_mmap.h"
 #include "util/synchronization/semaphore.h"
 #include "util/thread/thread.h"
 
@@ -39,6 +51,9 @@ namespace crashpad {
 namespace test {
 namespace {
 
+constexpr size_t kSharedAnnotationsSize = 4096;
+constexpr char kSharedAnnotationsContents[] = "shared annotations";
+
 // Runs the ExceptionHandlerServer on a background thread.
 class RunServerThread : public Thread {
  public:
@@ -91,7 +106,13 @@ class ScopedStopServerAndJoinThread {
 class TestDelegate : public ExceptionHandlerServer::Delegate {
  public:
   TestDelegate()
-      : Delegate(), last_exception_address_(0), last_client_(-1), sem_(0) {}
+      : Delegate(),
+        last_exception_address_(0),
+        last_client_(-1),
+        last_shared_annotations_address_(0),
+        last_shared_annotations_(),
+        last_crashing_thread_state_(),
+        sem_(0) {}
 
   ~TestDelegate() {}
 
@@ -112,13 +133,19 @@ class TestDelegate : public ExceptionHandlerServer::Delegate {
                        const ExceptionHandlerProtocol::ClientInformation& info,
                        VMAddress requesting_thread_stack_address,
                        pid_t* requesting_thread_id = nullptr,
-                       UUID* local_report_id = nullptr) override {
+                       UUID* local_report_id = nullptr,
+                       const ProcessMemoryOverlay::Region* shared_annotations =
+                           nullptr,
+                       const std::vector<ProcessMemoryOverlay::Region>*
+                           crashing_thread_state = nullptr) override {
     DirectPtraceConnection connection;
     bool connected = connection.Initialize(client_process_id);
     EXPECT_TRUE(connected);
 
     last_exception_address_ = info.exception_information_address;
     last_client_ = client_process_id;
+    SetSharedAnnotations(shared_annotations);
+    SetCrashingThreadState(crashing_thread_state);
     sem_.Signal();
     if (!connected) {
       return false;
@@ -145,20 +172,68 @@ class TestDelegate : public ExceptionHandlerServer::Delegate {
       uid_t client_uid,
       const ExceptionHandlerProtocol::ClientInformation& info,
       int broker_sock,
-      UUID* local_report_id = nullptr) override {
+      UUID* local_report_id = nullptr,
+      const ProcessMemoryOverlay::Region* shared_annotations = nullptr,
+      const std::vector<ProcessMemoryOverlay::Region>* crashing_thread_state =
+          nullptr) override {
     PtraceClient client;
     bool connected = client.Initialize(broker_sock, client_process_id);
     EXPECT_TRUE(connected);
 
     last_exception_address_ = info.exception_information_address,
     last_client_ = client_process_id;
+    SetSharedAnnotations(shared_annotations);
+    SetCrashingThreadState(crashing_thread_state);
     sem_.Signal();
     return connected;
   }
 
+  // The address and contents of the shared annotation storage passed with the
+  // last exception, valid after WaitForException() returns `true`.
+  VMAddress last_shared_annotations_address() const {
+    return last_shared_annotations_address_;
+  }
+  const std::string& last_shared_annotations() const {
+    return last_shared_annotations_;
+  }
+
+  // The contents of each region of the crashing thread state passed with the
+  // last exception, by address, valid after WaitForException() returns `true`.
+  const std::map<VMAddress, std::string>& last_crashing_thread_state() const {
+    return last_crashing_thread_state_;
+  }
+
  private:
+  void SetSharedAnnotations(
+      const ProcessMemoryOverlay::Region* shared_annotations) {
+    if (shared_annotations) {
+      last_shared_annotations_address_ = shared_annotations->address;
+      last_shared_annotations_.assign(
+          static_cast<const char*>(shared_annotations->data),
+          shared_annotations->size);
+    } else {
+      last_shared_annotations_address_ = 0;
+      last_shared_annotations_.clear();
+    }
+  }
+
+  void SetCrashingThreadState(
+      const std::vector<ProcessMemoryOverlay::Region>* crashing_thread_state) {
+    last_crashing_thread_state_.clear();
+    if (crashing_thread_state) {
+      for (const ProcessMemoryOverlay::Region& region :
+           *crashing_thread_state) {
+        last_crashing_thread_state_[region.address].assign(
+            static_cast<const char*>(region.data), region.size);
+      }
+    }
+  }
+
   VMAddress last_exception_address_;
   pid_t last_client_;
+  VMAddress last_shared_annotations_address_;
+  std::string last_shared_annotations_;
+  std::map<VMAddress, std::string> last_crashing_thread_state_;
   Semaphore sem_;
 
   DISALLOW_COPY_AND_ASSIGN(TestDelegate);
@@ -226,8 +301,15 @@ class ExceptionHandlerServerTest : public testing::TestWithParam<bool> {
 
   class CrashDumpTest : public Multiprocess {
    public:
-    CrashDumpTest(ExceptionHandlerServerTest* server_test, bool succeeds)
-        : Multiprocess(), server_test_(server_test), succeeds_(succeeds) {}
+    CrashDumpTest(ExceptionHandlerServerTest* server_test,
+                  bool succeeds,
+                  bool share_annotations = false,
+                  bool send_crashing_thread_state = false)
+        : Multiprocess(),
+          server_test_(server_test),
+          succeeds_(succeeds),
+          share_annotations_(share_annotations),
+          send_crashing_thread_state_(send_crashing_thread_state) {}
 
     ~CrashDumpTest() = default;
 
@@ -236,6 +318,20 @@ class ExceptionHandlerServerTest : public testing::TestWithParam<bool> {
       ASSERT_TRUE(
           LoggingReadFileExactly(ReadPipeHandle(), &info, sizeof(info)));
 
+      VMAddress shared_annotations_address = 0;
+      if (share_annotations_) {
+        ASSERT_TRUE(LoggingReadFileExactly(ReadPipeHandle(),
+                                           &shared_annotations_address,
+                                           sizeof(shared_annotations_address)));
+      }
+
+      ExceptionInformation exception_information;
+      if (send_crashing_thread_state_) {
+        ASSERT_TRUE(LoggingReadFileExactly(ReadPipeHandle(),
+                                           &exception_information,
+                                           sizeof(exception_information)));
+      }
+
       if (succeeds_) {
         VMAddress last_address;
         pid_t last_client;
@@ -243,6 +339,37 @@ class ExceptionHandlerServerTest : public testing::TestWithParam<bool> {
             5.0, &last_client, &last_address));
         EXPECT_EQ(last_address, info.exception_information_address);
         EXPECT_EQ(last_client, ChildPID());
+
+        TestDelegate* delegate = server_test_->Delegate();
+        EXPECT_EQ(delegate->last_shared_annotations_address(),
+                  shared_annotations_address);
+        if (share_annotations_) {
+          EXPECT_EQ(delegate->last_shared_annotations().size(),
+                    kSharedAnnotationsSize);
+          EXPECT_EQ(strcmp(delegate->last_shared_annotations().c_str(),
+                           kSharedAnnotationsContents),
+                    0);
+        }
+
+        // The crashing thread’s exception information, signal information,
+        // and context are sent with the request.
+        const std::map<VMAddress, std::string>& state =
+            delegate->last_crashing_thread_state();
+        if (send_crashing_thread_state_) {
+          const auto it = state.find(info.exception_information_address);
+          ASSERT_NE(it, state.end());
+          ASSERT_EQ(it->second.size(), sizeof(exception_information));
+          EXPECT_EQ(memcmp(it->second.data(),
+                           &exception_information,
+                           sizeof(exception_information)),
+                    0);
+          EXPECT_NE(state.find(exception_information.siginfo_address),
+                    state.end());
+          EXPECT_NE(state.find(exception_information.context_address),
+                    state.end());
+        } else {
+          EXPECT_TRUE(state.empty());
+        }
       } else {
         CheckedReadFileAtEOF(ReadPipeHandle());
       }
@@ -253,6 +380,22 @@ class ExceptionHandlerServerTest : public testing::TestWithParam<bool> {
 
       ExceptionHandlerProtocol::ClientInformation info;
       info.exception_information_address = 42;
+
+      // The crashing thread’s state is read from the ExceptionInformation, so
+      // a real one is needed to send it.
+      ExceptionInformation exception_information = {};
+      siginfo_t siginfo = {};
+      NativeCPUContext context;
+      if (send_crashing_thread_state_) {
+        CaptureContext(&context);
+        exception_information.siginfo_address =
+            FromPointerCast<VMAddress>(&siginfo);
+        exception_information.context_address =
+            FromPointerCast<VMAddress>(&context);
+        exception_information.thread_id = syscall(SYS_gettid);
+        info.exception_information_address =
+            FromPointerCast<VMAddress>(&exception_information);
+      }
       ASSERT_TRUE(LoggingWriteFile(WritePipeHandle(), &info, sizeof(info)));
 
       // If the current ptrace_scope is restricted, the broker needs to be set
@@ -262,12 +405,47 @@ class ExceptionHandlerServerTest : public testing::TestWithParam<bool> {
 
       ExceptionHandlerClient client(server_test_->SockToHandler(),
                                     server_test_->use_multi_client_socket_);
+
+      ScopedFileHandle memfd;
+      ScopedMmap mapping;
+      if (share_annotations_) {
+        memfd.reset(memfd_create("test", MFD_CLOEXEC | MFD_ALLOW_SEALING));
+        ASSERT_TRUE(memfd.is_valid()) << ErrnoMessage("memfd_create");
+        ASSERT_EQ(ftruncate(memfd.get(), kSharedAnnotationsSize), 0)
+            << ErrnoMessage("ftruncate");
+        ASSERT_EQ(fcntl(memfd.get(), F_ADD_SEALS, F_SEAL_SHRINK), 0)
+            << ErrnoMessage("fcntl");
+        ASSERT_TRUE(mapping.ResetMmap(nullptr,
+                                      kSharedAnnotationsSize,
+                                      PROT_READ | PROT_WRITE,
+                                      MAP_SHARED,
+                                      memfd.get(),
+                                      0));
+        strcpy(mapping.addr_as<char*>(), kSharedAnnotationsContents);
+
+        const VMAddress address = mapping.addr_as<VMAddress>();
+        ASSERT_TRUE(
+            LoggingWriteFile(WritePipeHandle(), &address, sizeof(address)));
+        ASSERT_EQ(client.RegisterSharedAnnotations(
+                      memfd.get(), address, kSharedAnnotationsSize),
+                  0);
+      }
+
+      if (send_crashing_thread_state_) {
+        ASSERT_TRUE(LoggingWriteFile(WritePipeHandle(),
+                                     &exception_information,
+                                     sizeof(exception_information)));
+        client.SetSendCrashingThreadState(true);
+      }
+
       ASSERT_EQ(client.RequestCrashDump(info), 0);
     }
 
    private:
     ExceptionHandlerServerTest* server_test_;
     bool succeeds_;
+    bool share_annotations_;
+    bool send_crashing_thread_state_;
 
     DISALLOW_COPY_AND_ASSIGN(CrashDumpTest);
   };
@@ -333,6 +511,19 @@ TEST_P(ExceptionHandlerServerTest, MultipleStops) {
   ASSERT_TRUE(ServerThread()->JoinWithTimeout(5.0));
 }
 
+TEST_P(ExceptionHandlerServerTest, HandlerFeatures) {
+  ScopedStopServerAndJoinThread stop_server(Server(), ServerThread());
+  ServerThread()->Start();
+
+  ExceptionHandlerClient client(SockToHandler(), UsingMultiClientSocket());
+  ucred creds;
+  uint32_t features;
+  ASSERT_TRUE(client.GetHandlerCredentials(&creds, &features));
+  EXPECT_EQ(creds.pid, getpid());
+  EXPECT_TRUE(features & ExceptionHandlerProtocol::ServerToClientMessage::
+                             kFeatureSharedAnnotations);
+}
+
 TEST_P(ExceptionHandlerServerTest, RequestCrashDumpDefault) {
   ScopedStopServerAndJoinThread stop_server(Server(), ServerThread());
   ServerThread()->Start();
@@ -341,6 +532,22 @@ TEST_P(ExceptionHandlerServerTest, RequestCrashDumpDefault) {
   test.Run();
 }
 
+TEST_P(ExceptionHandlerServerTest, RequestCrashDumpWithSharedAnnotations) {
+  ScopedStopServerAndJoinThread stop_server(Server(), ServerThread());
+  ServerThread()->Start();
+
+  CrashDumpTest test(this, true, true);
+  test.Run();
+}
+
+TEST_P(ExceptionHandlerServerTest, RequestCrashDumpWithCrashingThreadState) {
+  ScopedStopServerAndJoinThread stop_server(Server(), ServerThread());
+  ServerThread()->Start();
+
+  CrashDumpTest test(this, true, false, true);
+  test.Run();
+}
+
 TEST_P(ExceptionHandlerServerTest, RequestCrashDumpNoPtrace) {
   ExpectCrashDumpUsingStrategy(PtraceStrategyDecider::Strategy::kNoPtrace,
                                false);
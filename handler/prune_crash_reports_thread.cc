@@ -14,32 +14,108 @@
 
 #include "handler/prune_crash_reports_thread.h"
 
+#include <time.h>
+
 #include <utility>
+#include <vector>
 
+#include "client/crash_report_database.h"
 #include "client/prune_crash_reports.h"
 
 namespace crashpad {
 
+namespace {
+
+// CleanDatabase() removes reports that were left unfinished in the database’s
+// new directory once they’re this old.
+constexpr time_t kCleanDatabaseLockoutSeconds = 60 * 60 * 24 * 3;
+
+}  // namespace
+
 PruneCrashReportThread::PruneCrashReportThread(
     CrashReportDatabase* database,
     std::unique_ptr<PruneCondition> condition)
-    : thread_(60 * 60 * 24, this),
+    :
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+      pending_watcher_(),
+      prune_requested_(false),
+#endif  // OS_LINUX || OS_ANDROID
+      thread_(60 * 60 * 24, this),
       condition_(std::move(condition)),
       database_(database) {}
 
 PruneCrashReportThread::~PruneCrashReportThread() {}
 
 void PruneCrashReportThread::Start() {
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  // pending_watcher_ is set up before thread_ starts, because DoWork() consults
+  // it. If the pending directory can’t be watched, prune on a timer alone.
+  const base::FilePath pending_dir = database_->PendingReportsDirectory();
+  if (!pending_dir.empty()) {
+    pending_watcher_.reset(new DirectoryWatcher(this));
+    if (!pending_watcher_->AddDirectory(pending_dir)) {
+      pending_watcher_.reset();
+    }
+  }
+#endif  // OS_LINUX || OS_ANDROID
+
   thread_.Start(60 * 10);
+
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  if (pending_watcher_) {
+    pending_watcher_->Start();
+  }
+#endif  // OS_LINUX || OS_ANDROID
 }
 
 void PruneCrashReportThread::Stop() {
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  // The watcher calls into thread_, so it must be stopped first.
+  if (pending_watcher_) {
+    pending_watcher_->Stop();
+  }
+#endif  // OS_LINUX || OS_ANDROID
+
   thread_.Stop();
+
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  pending_watcher_.reset();
+#endif  // OS_LINUX || OS_ANDROID
 }
 
 void PruneCrashReportThread::DoWork(const WorkerThread* thread) {
-  database_->CleanDatabase(60 * 60 * 24 * 3);
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  prune_requested_ = false;
+#endif  // OS_LINUX || OS_ANDROID
+
+  database_->CleanDatabase(kCleanDatabaseLockoutSeconds);
   PruneCrashReportDatabase(database_, condition_.get());
+
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  if (pending_watcher_) {
+    // Growth of the database will be signaled by pending_watcher_. With no
+    // reports left that might age out, the 24-hour timer isn’t needed, but
+    // unfinished reports in the new directory, which pending_watcher_ doesn’t
+    // see, must still be cleaned up once they’re old enough.
+    std::vector<CrashReportDatabase::Report> pending_reports;
+    std::vector<CrashReportDatabase::Report> completed_reports;
+    if (database_->GetPendingReports(&pending_reports) ==
+            CrashReportDatabase::kNoError &&
+        database_->GetCompletedReports(&completed_reports) ==
+            CrashReportDatabase::kNoError &&
+        pending_reports.empty() && completed_reports.empty()) {
+      thread_.SetNextWorkDelay(kCleanDatabaseLockoutSeconds);
+    }
+  }
+#endif  // OS_LINUX || OS_ANDROID
+}
+
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+void PruneCrashReportThread::FilesMovedIn() {
+  if (!prune_requested_.exchange(true)) {
+    thread_.DoWorkNow();
+  }
 }
+#endif  // OS_LINUX || OS_ANDROID
 
 }  // namespace crashpad
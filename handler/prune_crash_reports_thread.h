@@ -15,12 +15,18 @@
 #ifndef CRASHPAD_HANDLER_PRUNE_CRASH_REPORTS_THREAD_H_
 #define CRASHPAD_HANDLER_PRUNE_CRASH_REPORTS_THREAD_H_
 
+#include <atomic>
 #include <memory>
 
 #include "base/macros.h"
+#include "build/build_config.h"
 #include "util/thread/stoppable.h"
 #include "util/thread/worker_thread.h"
 
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+#include "util/linux/directory_watcher.h"
+#endif  // OS_LINUX || OS_ANDROID
+
 namespace crashpad {
 
 class CrashReportDatabase;
@@ -32,7 +38,18 @@ class PruneCondition;
 //! After the thread is started, the database is pruned using the condition
 //! every 24 hours. Upon calling Start(), the thread waits 10 minutes before
 //! performing the initial prune operation.
-class PruneCrashReportThread : public WorkerThread::Delegate, public Stoppable {
+//!
+//! Where the database supports it, the database’s pending directory is watched
+//! with a DirectoryWatcher, and the database is also pruned whenever a new
+//! report arrives. The 24-hour timer is then only used while the database holds
+//! reports that could be pruned as they age. An idle handler with an empty
+//! database wakes only every 3 days, to clean up reports that were never
+//! finished.
+class PruneCrashReportThread : public WorkerThread::Delegate,
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+                               public DirectoryWatcher::Delegate,
+#endif  // OS_LINUX || OS_ANDROID
+                               public Stoppable {
  public:
   //! \brief Constructs a new object.
   //!
@@ -67,6 +84,17 @@ class PruneCrashReportThread : public WorkerThread::Delegate, public Stoppable {
   // WorkerThread::Delegate:
   void DoWork(const WorkerThread* thread) override;
 
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  // DirectoryWatcher::Delegate:
+  void FilesMovedIn() override;
+
+  std::unique_ptr<DirectoryWatcher> pending_watcher_;
+
+  // Whether a prune has been requested by FilesMovedIn() and not yet started,
+  // so that a burst of new reports only causes one prune.
+  std::atomic<bool> prune_requested_;
+#endif  // OS_LINUX || OS_ANDROID
+
   WorkerThread thread_;
   std::unique_ptr<PruneCondition> condition_;
   CrashReportDatabase* database_;  // weak
@@ -0,0 +1,116 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "handler/upload_bundle.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "util/string/split_string.h"
+
+namespace crashpad {
+
+namespace {
+
+constexpr char kBundleReportsKey[] = "bundle_reports";
+constexpr char kMinidumpKey[] = "upload_file_minidump";
+
+std::string BundleKey(const std::string& uuid, const std::string& key) {
+  return uuid + "/" + key;
+}
+
+}  // namespace
+
+UploadBundle::UploadBundle(HTTPMultipartBuilder* builder)
+    : report_uuids_(), builder_(builder) {}
+
+UploadBundle::~UploadBundle() {}
+
+void UploadBundle::AddReport(
+    const UUID& uuid,
+    const std::map<std::string, std::string>& parameters,
+    FileReaderInterface* minidump) {
+  const std::string uuid_string = uuid.ToString();
+  DCHECK(std::find(report_uuids_.begin(), report_uuids_.end(), uuid_string) ==
+         report_uuids_.end());
+
+  for (const auto& kv : parameters) {
+    if (kv.first == kMinidumpKey) {
+      LOG(WARNING) << "reserved key " << kv.first << ", discarding value "
+                   << kv.second;
+    } else {
+      builder_->SetFormData(BundleKey(uuid_string, kv.first), kv.second);
+    }
+  }
+
+  builder_->SetFileAttachment(BundleKey(uuid_string, kMinidumpKey),
+                              uuid_string + ".dmp",
+                              minidump,
+                              "application/octet-stream");
+
+  std::string bundle_reports;
+  for (const std::string& report_uuid : report_uuids_) {
+    bundle_reports += report_uuid + ",";
+  }
+  bundle_reports += uuid_string;
+  builder_->SetFormData(kBundleReportsKey, bundle_reports);
+
+  report_uuids_.push_back(uuid_string);
+}
+
+void UploadBundle::AddAttachment(const UUID& uuid,
+                                 const std::string& name,
+                                 FileReaderInterface* reader) {
+  const std::string uuid_string = uuid.ToString();
+  DCHECK(std::find(report_uuids_.begin(), report_uuids_.end(), uuid_string) !=
+         report_uuids_.end());
+
+  builder_->SetFileAttachment(BundleKey(uuid_string, name),
+                              name,
+                              reader,
+                              "application/octet-stream");
+}
+
+// static
+bool UploadBundle::ParseResponse(
+    const std::string& response_body,
+    std::map<std::string, std::string>* report_ids) {
+  report_ids->clear();
+
+  bool success = true;
+  for (std::string line : SplitString(response_body, '\n')) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (line.empty()) {
+      continue;
+    }
+
+    std::string uuid_string;
+    std::string id;
+    UUID uuid;
+    if (!SplitStringFirst(line, '=', &uuid_string, &id) ||
+        !uuid.InitializeFromString(uuid_string)) {
+      LOG(ERROR) << "malformed bundle response line " << line;
+      success = false;
+      continue;
+    }
+
+    (*report_ids)[uuid.ToString()] = id;
+  }
+
+  return success;
+}
+
+}  // namespace crashpad
@@ -0,0 +1,105 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_HANDLER_UPLOAD_BUNDLE_H_
+#define CRASHPAD_HANDLER_UPLOAD_BUNDLE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "util/file/file_reader.h"
+#include "util/misc/uuid.h"
+#include "util/net/http_multipart_builder.h"
+
+namespace crashpad {
+
+//! \brief Combines several crash reports into a single multipart upload
+//!     request.
+//!
+//! The request body is a `multipart/form-data` body, like that of a
+//! single-report upload. Each report contributes the form fields and file
+//! attachments that it would have in a single-report upload, but with its
+//! field names prefixed by the report’s UUID and a slash, as in
+//! `00112233-4455-6677-8899-aabbccddeeff/prod`. A report’s minidump is named
+//! `<uuid>/upload_file_minidump`. The `bundle_reports` field lists the UUIDs of
+//! all of the reports in the bundle, separated by commas, in the order in which
+//! they were added.
+//!
+//! The server’s response body is expected to contain one line for each report
+//! that it accepted, of the form `<uuid>=<id>`, where `<id>` is the possibly
+//! empty identifier that it assigned to the report. Reports that do not appear
+//! in the response are considered to have failed to upload, and may be
+//! retried.
+class UploadBundle {
+ public:
+  //! \brief Constructs a bundle whose reports will be added to \a builder.
+  //!
+  //! \param[in] builder The builder that will produce the request body. The
+  //!     caller retains ownership, and is responsible for configuring options
+  //!     such as `gzip` compression.
+  explicit UploadBundle(HTTPMultipartBuilder* builder);
+  ~UploadBundle();
+
+  //! \brief Adds a report to the bundle.
+  //!
+  //! \param[in] uuid The report’s unique identifier.
+  //! \param[in] parameters The report’s form fields. A field named
+  //!     `upload_file_minidump` is reserved and will be discarded.
+  //! \param[in] minidump A reader for the report’s minidump, positioned at the
+  //!     beginning of the minidump. The caller retains ownership and must keep
+  //!     it alive until the request body has been consumed.
+  void AddReport(const UUID& uuid,
+                 const std::map<std::string, std::string>& parameters,
+                 FileReaderInterface* minidump);
+
+  //! \brief Adds an attachment to a report in the bundle.
+  //!
+  //! \param[in] uuid The unique identifier of a report previously added with
+  //!     AddReport().
+  //! \param[in] name The attachment’s name, used as its key and file name.
+  //! \param[in] reader A reader for the attachment. The caller retains
+  //!     ownership and must keep it alive until the request body has been
+  //!     consumed.
+  void AddAttachment(const UUID& uuid,
+                     const std::string& name,
+                     FileReaderInterface* reader);
+
+  //! \brief Returns the number of reports that have been added to the bundle.
+  size_t report_count() const { return report_uuids_.size(); }
+
+  //! \brief Interprets the server’s response to a bundled upload.
+  //!
+  //! \param[in] response_body The response body sent by the server.
+  //! \param[out] report_ids A map whose keys are the string forms of the UUIDs
+  //!     of the reports accepted by the server, and whose values are the
+  //!     identifiers assigned to them by the server.
+  //!
+  //! \return `true` on success. `false` if \a response_body was malformed, with
+  //!     a message logged. On failure, \a report_ids will contain the reports
+  //!     accepted according to the well-formed lines of \a response_body.
+  static bool ParseResponse(const std::string& response_body,
+                            std::map<std::string, std::string>* report_ids);
+
+ private:
+  std::vector<std::string> report_uuids_;
+  HTTPMultipartBuilder* builder_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(UploadBundle);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_HANDLER_UPLOAD_BUNDLE_H_
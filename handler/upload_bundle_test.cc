@@ -0,0 +1,186 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "handler/upload_bundle.h"
+
+#include <string.h>
+
+#include <map>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "util/file/string_file.h"
+#include "util/misc/uuid.h"
+#include "util/net/http_body.h"
+#include "util/net/http_headers.h"
+#include "util/net/http_multipart_builder.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+std::string ReadBody(HTTPBodyStream* stream) {
+  std::string body;
+  uint8_t buffer[256];
+  FileOperationResult bytes_read;
+  while ((bytes_read = stream->GetBytesBuffer(buffer, sizeof(buffer))) > 0) {
+    body.append(reinterpret_cast<char*>(buffer), bytes_read);
+  }
+  EXPECT_EQ(bytes_read, 0);
+  return body;
+}
+
+// Stands in for a collection server that accepts bundled uploads. Splits a
+// multipart/form-data body into its parts, keyed by the name given in each
+// part’s Content-Disposition header. For file parts, the file name is recorded
+// in |filenames|.
+void ParseMultipartBody(const std::string& body,
+                        const std::string& boundary,
+                        std::map<std::string, std::string>* parts,
+                        std::map<std::string, std::string>* filenames) {
+  const std::string delimiter = "--" + boundary;
+  const std::string terminator = delimiter + "--\r\n";
+  ASSERT_GE(body.size(), terminator.size());
+  EXPECT_EQ(body.substr(body.size() - terminator.size()), terminator);
+
+  size_t position = 0;
+  while (body.compare(position, terminator.size(), terminator) != 0) {
+    ASSERT_EQ(body.compare(position, delimiter.size(), delimiter), 0);
+    position += delimiter.size() + 2;
+
+    const size_t headers_end = body.find("\r\n\r\n", position);
+    ASSERT_NE(headers_end, std::string::npos);
+    const std::string headers = body.substr(position, headers_end - position);
+    position = headers_end + 4;
+
+    const size_t content_end = body.find("\r\n" + delimiter, position);
+    ASSERT_NE(content_end, std::string::npos);
+    const std::string content = body.substr(position, content_end - position);
+    position = content_end + 2;
+
+    static constexpr char kNamePrefix[] =
+        "Content-Disposition: form-data; name=\"";
+    ASSERT_EQ(headers.compare(0, strlen(kNamePrefix), kNamePrefix), 0);
+    const size_t name_end = headers.find('"', strlen(kNamePrefix));
+    ASSERT_NE(name_end, std::string::npos);
+    const std::string name = headers.substr(
+        strlen(kNamePrefix), name_end - strlen(kNamePrefix));
+    EXPECT_EQ(parts->count(name), 0u) << name;
+    (*parts)[name] = content;
+
+    static constexpr char kFilenamePrefix[] = "; filename=\"";
+    if (headers.find(kFilenamePrefix, name_end) == name_end + 1) {
+      const size_t filename_start = name_end + 1 + strlen(kFilenamePrefix);
+      const size_t filename_end = headers.find('"', filename_start);
+      ASSERT_NE(filename_end, std::string::npos);
+      (*filenames)[name] =
+          headers.substr(filename_start, filename_end - filename_start);
+    }
+  }
+}
+
+TEST(UploadBundle, BundleFormat) {
+  UUID uuid_1;
+  ASSERT_TRUE(uuid_1.InitializeFromString(
+      "00112233-4455-6677-8899-aabbccddeeff"));
+  UUID uuid_2;
+  ASSERT_TRUE(uuid_2.InitializeFromString(
+      "ffeeddcc-bbaa-9988-7766-554433221100"));
+
+  StringFile minidump_1;
+  minidump_1.SetString("MDMP one");
+  StringFile minidump_2;
+  minidump_2.SetString("MDMP two");
+  StringFile attachment;
+  attachment.SetString("attached");
+
+  HTTPMultipartBuilder builder;
+  UploadBundle bundle(&builder);
+  bundle.AddReport(uuid_1,
+                   {{"prod", "product_1"},
+                    {"ver", "1"},
+                    {"upload_file_minidump", "reserved"}},
+                   &minidump_1);
+  bundle.AddAttachment(uuid_1, "log.txt", &attachment);
+  bundle.AddReport(uuid_2, {{"prod", "product_2"}}, &minidump_2);
+  EXPECT_EQ(bundle.report_count(), 2u);
+
+  HTTPHeaders headers;
+  builder.PopulateContentHeaders(&headers);
+  const std::string& content_type = headers[kContentType];
+  static constexpr char kBoundaryEq[] = "boundary=";
+  const size_t boundary = content_type.find(kBoundaryEq);
+  ASSERT_NE(boundary, std::string::npos);
+
+  std::map<std::string, std::string> parts;
+  std::map<std::string, std::string> filenames;
+  ParseMultipartBody(ReadBody(builder.GetBodyStream().get()),
+                     content_type.substr(boundary + strlen(kBoundaryEq)),
+                     &parts,
+                     &filenames);
+
+  const std::string uuid_1_string = uuid_1.ToString();
+  const std::string uuid_2_string = uuid_2.ToString();
+  const std::map<std::string, std::string> kExpectedParts = {
+      {"bundle_reports", uuid_1_string + "," + uuid_2_string},
+      {uuid_1_string + "/prod", "product_1"},
+      {uuid_1_string + "/ver", "1"},
+      {uuid_1_string + "/upload_file_minidump", "MDMP one"},
+      {uuid_1_string + "/log.txt", "attached"},
+      {uuid_2_string + "/prod", "product_2"},
+      {uuid_2_string + "/upload_file_minidump", "MDMP two"},
+  };
+  EXPECT_EQ(parts, kExpectedParts);
+
+  const std::map<std::string, std::string> kExpectedFilenames = {
+      {uuid_1_string + "/upload_file_minidump", uuid_1_string + ".dmp"},
+      {uuid_1_string + "/log.txt", "log.txt"},
+      {uuid_2_string + "/upload_file_minidump", uuid_2_string + ".dmp"},
+  };
+  EXPECT_EQ(filenames, kExpectedFilenames);
+}
+
+TEST(UploadBundle, ParseResponse) {
+  std::map<std::string, std::string> report_ids;
+  EXPECT_TRUE(UploadBundle::ParseResponse(std::string(), &report_ids));
+  EXPECT_TRUE(report_ids.empty());
+
+  // UUIDs are canonicalized, CRLF line endings are accepted, and server
+  // identifiers may be empty.
+  EXPECT_TRUE(UploadBundle::ParseResponse(
+      "00112233-4455-6677-8899-AABBCCDDEEFF=abc123\r\n"
+      "ffeeddcc-bbaa-9988-7766-554433221100=\n",
+      &report_ids));
+  const std::map<std::string, std::string> kExpected = {
+      {"00112233-4455-6677-8899-aabbccddeeff", "abc123"},
+      {"ffeeddcc-bbaa-9988-7766-554433221100", ""},
+  };
+  EXPECT_EQ(report_ids, kExpected);
+
+  // Malformed lines are reported, but don’t prevent the well-formed lines from
+  // being used.
+  EXPECT_FALSE(UploadBundle::ParseResponse(
+      "not-a-uuid=abc\n"
+      "00112233-4455-6677-8899-aabbccddeeff=def\n"
+      "garbage\n",
+      &report_ids));
+  const std::map<std::string, std::string> kExpectedPartial = {
+      {"00112233-4455-6677-8899-aabbccddeeff", "def"},
+  };
+  EXPECT_EQ(report_ids, kExpectedPartial);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
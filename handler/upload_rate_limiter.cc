@@ -0,0 +1,160 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "handler/upload_rate_limiter.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+namespace crashpad {
+
+namespace {
+
+// If the most recent upload attempt “happened” at least this far in the
+// future, its time is assumed to be bogus and is disregarded.
+constexpr time_t kBackwardsClockTolerance = 60 * 60 * 24;  // 1 day
+
+// Mixes the bits of a report’s UUID and attempt count into a value suitable for
+// deriving jitter.
+uint32_t JitterSeed(const UUID& uuid, int upload_attempts) {
+  uint32_t seed = uuid.data_1 ^ (uuid.data_2 << 16 | uuid.data_3);
+  for (uint8_t byte : uuid.data_4) {
+    seed = seed * 31 + byte;
+  }
+  for (uint8_t byte : uuid.data_5) {
+    seed = seed * 31 + byte;
+  }
+  seed ^= static_cast<uint32_t>(upload_attempts);
+
+  // Finalize with the MurmurHash3 mixer so that nearby inputs diverge.
+  seed ^= seed >> 16;
+  seed *= 0x85ebca6b;
+  seed ^= seed >> 13;
+  seed *= 0xc2b2ae35;
+  seed ^= seed >> 16;
+  return seed;
+}
+
+}  // namespace
+
+UploadRateLimiter::UploadRateLimiter(const Options& options)
+    : options_(options), bucket_full_time_(0), last_upload_attempt_time_(0) {
+  DCHECK_GT(options_.burst, 0);
+  DCHECK_GT(options_.interval_seconds, 0);
+  DCHECK_GT(options_.initial_backoff_seconds, 0);
+  DCHECK_GE(options_.max_backoff_seconds, options_.initial_backoff_seconds);
+  DCHECK_GT(options_.max_upload_attempts, 0);
+}
+
+UploadRateLimiter::~UploadRateLimiter() {}
+
+void UploadRateLimiter::SetLastUploadAttemptTime(
+    time_t last_upload_attempt_time) {
+  last_upload_attempt_time_ = last_upload_attempt_time;
+  bucket_full_time_ = last_upload_attempt_time +
+                      static_cast<time_t>(options_.burst) *
+                          options_.interval_seconds;
+}
+
+void UploadRateLimiter::AccountForUploadAttempt(time_t upload_attempt_time) {
+  bucket_full_time_ = std::max(bucket_full_time_, upload_attempt_time) +
+                      options_.interval_seconds;
+  last_upload_attempt_time_ =
+      std::max(last_upload_attempt_time_, upload_attempt_time);
+}
+
+UploadRateLimiter::AcquireResult UploadRateLimiter::TryAcquire(time_t now) {
+  if (last_upload_attempt_time_ > now) {
+    // The most recent upload attempt purportedly occurred in the future. If it
+    // “happened” at least one day in the future, assume that its time is bogus
+    // and forget about it. If it’s in the future but within one day, accept it
+    // and don’t permit an attempt.
+    if (last_upload_attempt_time_ - now < kBackwardsClockTolerance) {
+      return AcquireResult::kUnexpectedTime;
+    }
+    last_upload_attempt_time_ = 0;
+    bucket_full_time_ = 0;
+  }
+
+  // The bucket holds (bucket_full_time_ - now) / interval_seconds fewer tokens
+  // than its capacity. An attempt is permitted as long as at least one token
+  // remains.
+  const time_t burst_allowance =
+      static_cast<time_t>(options_.burst - 1) * options_.interval_seconds;
+  if (bucket_full_time_ - now > burst_allowance) {
+    return AcquireResult::kThrottled;
+  }
+
+  bucket_full_time_ =
+      std::max(bucket_full_time_, now) + options_.interval_seconds;
+  last_upload_attempt_time_ = now;
+  return AcquireResult::kAllowed;
+}
+
+time_t UploadRateLimiter::NextAcquireTime() const {
+  return std::max(bucket_full_time_ - static_cast<time_t>(options_.burst - 1) *
+                                          options_.interval_seconds,
+                  last_upload_attempt_time_);
+}
+
+UploadRateLimiter::RetryResult UploadRateLimiter::ShouldRetry(
+    const UUID& uuid,
+    int upload_attempts,
+    time_t last_upload_attempt_time,
+    time_t now) const {
+  if (upload_attempts <= 0) {
+    return RetryResult::kRetry;
+  }
+
+  if (!MayRetry(upload_attempts)) {
+    return RetryResult::kGiveUp;
+  }
+
+  if (now < last_upload_attempt_time) {
+    // The most recent attempt purportedly occurred in the future. As in
+    // TryAcquire(), wait if it’s within one day, and otherwise assume that its
+    // time is bogus.
+    return last_upload_attempt_time - now < kBackwardsClockTolerance
+               ? RetryResult::kWait
+               : RetryResult::kRetry;
+  }
+
+  return now - last_upload_attempt_time >= BackoffSeconds(uuid, upload_attempts)
+             ? RetryResult::kRetry
+             : RetryResult::kWait;
+}
+
+int UploadRateLimiter::BackoffSeconds(const UUID& uuid,
+                                      int upload_attempts) const {
+  DCHECK_GE(upload_attempts, 1);
+
+  int delay = options_.initial_backoff_seconds;
+  for (int attempt = 1;
+       attempt < upload_attempts && delay < options_.max_backoff_seconds;
+       ++attempt) {
+    delay = delay > options_.max_backoff_seconds / 2
+                ? options_.max_backoff_seconds
+                : delay * 2;
+  }
+  delay = std::min(delay, options_.max_backoff_seconds);
+
+  const uint32_t max_jitter = static_cast<uint32_t>(delay / 4);
+  return delay - static_cast<int>(JitterSeed(uuid, upload_attempts) %
+                                  (max_jitter + 1));
+}
+
+}  // namespace crashpad
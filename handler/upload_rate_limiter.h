@@ -0,0 +1,182 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_HANDLER_UPLOAD_RATE_LIMITER_H_
+#define CRASHPAD_HANDLER_UPLOAD_RATE_LIMITER_H_
+
+#include <time.h>
+
+#include "base/macros.h"
+#include "util/misc/uuid.h"
+
+namespace crashpad {
+
+//! \brief Decides when crash report upload attempts may be made.
+//!
+//! Upload attempts are limited by a token bucket that holds up to
+//! Options::burst tokens and gains one token every Options::interval_seconds.
+//! Each upload attempt consumes one token. With the default options, this
+//! permits one upload attempt per hour, matching the Breakpad client.
+//!
+//! Reports whose upload failed are retried after an exponentially increasing
+//! delay, with jitter, until Options::max_upload_attempts attempts have been
+//! made.
+//!
+//! All times are supplied by the caller, so that this class does not depend on
+//! the system clock.
+class UploadRateLimiter {
+ public:
+  //! \brief Options to be passed to the UploadRateLimiter constructor.
+  struct Options {
+    //! \brief The maximum number of upload attempts that may be made in quick
+    //!     succession after a quiet period.
+    int burst = 1;
+
+    //! \brief The number of seconds over which one upload attempt is added to
+    //!     the permitted burst, establishing the sustained rate.
+    int interval_seconds = 60 * 60;  // 1 hour
+
+    //! \brief The number of seconds to wait before retrying a report whose
+    //!     first upload attempt failed.
+    //!
+    //! The delay doubles after each subsequent failed attempt, up to
+    //! #max_backoff_seconds.
+    int initial_backoff_seconds = 15 * 60;  // 15 minutes
+
+    //! \brief The maximum number of seconds to wait before retrying a report.
+    int max_backoff_seconds = 24 * 60 * 60;  // 1 day
+
+    //! \brief The number of upload attempts after which a report that has
+    //!     never been uploaded successfully is abandoned.
+    int max_upload_attempts = 5;
+  };
+
+  //! \brief The result of TryAcquire().
+  enum class AcquireResult {
+    //! \brief An upload attempt may be made now.
+    kAllowed,
+
+    //! \brief Too many upload attempts have been made recently.
+    kThrottled,
+
+    //! \brief The most recent upload attempt appears to have been made in the
+    //!     near future, so the current time is suspect.
+    kUnexpectedTime,
+  };
+
+  //! \brief The result of ShouldRetry().
+  enum class RetryResult {
+    //! \brief The report’s backoff delay has elapsed, so it may be retried.
+    kRetry,
+
+    //! \brief The report’s backoff delay has not yet elapsed.
+    kWait,
+
+    //! \brief The report has been attempted too many times and should be
+    //!     abandoned.
+    kGiveUp,
+  };
+
+  //! \brief Constructs a new object.
+  //!
+  //! \param[in] options Options for the rate limiter. Each value must be
+  //!     positive, and #Options::max_backoff_seconds must not be less than
+  //!     #Options::initial_backoff_seconds.
+  explicit UploadRateLimiter(const Options& options);
+  ~UploadRateLimiter();
+
+  //! \brief Accounts for an upload attempt made before this object was
+  //!     created, such as one recorded by Settings::GetLastUploadAttemptTime().
+  //!
+  //! The token bucket is treated as having been emptied by this attempt, so
+  //! that restarting the handler does not grant a fresh burst.
+  //!
+  //! \param[in] last_upload_attempt_time The time of the previous attempt.
+  void SetLastUploadAttemptTime(time_t last_upload_attempt_time);
+
+  //! \brief Accounts for an upload attempt made elsewhere while this object
+  //!     exists, such as by another handler sharing the same database.
+  //!
+  //! The attempt consumes a token as though it had been permitted by
+  //! TryAcquire() at \a upload_attempt_time.
+  //!
+  //! \param[in] upload_attempt_time The time of the attempt.
+  void AccountForUploadAttempt(time_t upload_attempt_time);
+
+  //! \brief Consumes a token from the bucket if one is available.
+  //!
+  //! \param[in] now The current time.
+  //!
+  //! \return A member of AcquireResult. A token is only consumed if this
+  //!     returns AcquireResult::kAllowed.
+  AcquireResult TryAcquire(time_t now);
+
+  //! \brief Returns the earliest time at which TryAcquire() may return
+  //!     AcquireResult::kAllowed, assuming that the clock doesn’t move
+  //!     backwards. This may be in the past.
+  time_t NextAcquireTime() const;
+
+  //! \brief Determines whether a report whose previous upload attempts failed
+  //!     should be attempted again.
+  //!
+  //! \param[in] uuid The report’s unique identifier, used to derive jitter.
+  //! \param[in] upload_attempts The number of failed upload attempts made for
+  //!     the report.
+  //! \param[in] last_upload_attempt_time The time of the most recent failed
+  //!     attempt.
+  //! \param[in] now The current time.
+  //!
+  //! \return A member of RetryResult.
+  RetryResult ShouldRetry(const UUID& uuid,
+                          int upload_attempts,
+                          time_t last_upload_attempt_time,
+                          time_t now) const;
+
+  //! \brief Returns the number of seconds to wait after a failed upload
+  //!     attempt before retrying.
+  //!
+  //! The delay is Options::initial_backoff_seconds, doubled for each failed
+  //! attempt beyond the first and capped at Options::max_backoff_seconds. Up to
+  //! a quarter of the delay is subtracted as jitter so that reports that failed
+  //! together are not retried together. The jitter is derived from \a uuid and
+  //! \a upload_attempts, so repeated calls produce the same result.
+  //!
+  //! \param[in] uuid The report’s unique identifier.
+  //! \param[in] upload_attempts The number of failed upload attempts made for
+  //!     the report. Must be at least `1`.
+  int BackoffSeconds(const UUID& uuid, int upload_attempts) const;
+
+  //! \brief Returns whether a report that has had \a upload_attempts failed
+  //!     upload attempts may be attempted again.
+  bool MayRetry(int upload_attempts) const {
+    return upload_attempts < options_.max_upload_attempts;
+  }
+
+ private:
+  const Options options_;
+
+  // The time at which the token bucket will be full again. Upload attempts are
+  // permitted while this is no more than (burst - 1) intervals in the future.
+  time_t bucket_full_time_;
+
+  // The time of the most recent upload attempt, used to detect a clock that
+  // has moved backwards.
+  time_t last_upload_attempt_time_;
+
+  DISALLOW_COPY_AND_ASSIGN(UploadRateLimiter);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_HANDLER_UPLOAD_RATE_LIMITER_H_
@@ -0,0 +1,250 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "handler/upload_rate_limiter.h"
+
+#include "base/stl_util.h"
+#include "gtest/gtest.h"
+#include "util/misc/uuid.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// An arbitrary starting point for the fake clock used by these tests.
+constexpr time_t kStartTime = 1500000000;
+
+constexpr int kHour = 60 * 60;
+
+UUID TestUUID(const char* string) {
+  UUID uuid;
+  EXPECT_TRUE(uuid.InitializeFromString(string));
+  return uuid;
+}
+
+TEST(UploadRateLimiter, DefaultIsOnePerHour) {
+  UploadRateLimiter limiter((UploadRateLimiter::Options()));
+
+  time_t now = kStartTime;
+  EXPECT_EQ(limiter.TryAcquire(now),
+            UploadRateLimiter::AcquireResult::kAllowed);
+  EXPECT_EQ(limiter.TryAcquire(now),
+            UploadRateLimiter::AcquireResult::kThrottled);
+
+  now += kHour - 1;
+  EXPECT_EQ(limiter.TryAcquire(now),
+            UploadRateLimiter::AcquireResult::kThrottled);
+
+  now += 1;
+  EXPECT_EQ(limiter.TryAcquire(now),
+            UploadRateLimiter::AcquireResult::kAllowed);
+  EXPECT_EQ(limiter.TryAcquire(now),
+            UploadRateLimiter::AcquireResult::kThrottled);
+}
+
+TEST(UploadRateLimiter, Burst) {
+  UploadRateLimiter::Options options;
+  options.burst = 3;
+  options.interval_seconds = 100;
+  UploadRateLimiter limiter(options);
+
+  time_t now = kStartTime;
+  for (int index = 0; index < 3; ++index) {
+    SCOPED_TRACE(index);
+    EXPECT_EQ(limiter.TryAcquire(now),
+              UploadRateLimiter::AcquireResult::kAllowed);
+  }
+  EXPECT_EQ(limiter.TryAcquire(now),
+            UploadRateLimiter::AcquireResult::kThrottled);
+
+  // One token is regained per interval.
+  now += 100;
+  EXPECT_EQ(limiter.TryAcquire(now),
+            UploadRateLimiter::AcquireResult::kAllowed);
+  EXPECT_EQ(limiter.TryAcquire(now),
+            UploadRateLimiter::AcquireResult::kThrottled);
+
+  // The bucket never holds more than the burst size, no matter how long it’s
+  // left alone.
+  now += 100 * 100;
+  for (int index = 0; index < 3; ++index) {
+    SCOPED_TRACE(index);
+    EXPECT_EQ(limiter.TryAcquire(now),
+              UploadRateLimiter::AcquireResult::kAllowed);
+  }
+  EXPECT_EQ(limiter.TryAcquire(now),
+            UploadRateLimiter::AcquireResult::kThrottled);
+}
+
+TEST(UploadRateLimiter, LastUploadAttemptTime) {
+  UploadRateLimiter::Options options;
+  options.burst = 2;
+  options.interval_seconds = 100;
+  UploadRateLimiter limiter(options);
+
+  // An attempt made before the limiter existed leaves the bucket empty.
+  limiter.SetLastUploadAttemptTime(kStartTime);
+  EXPECT_EQ(limiter.TryAcquire(kStartTime + 99),
+            UploadRateLimiter::AcquireResult::kThrottled);
+  EXPECT_EQ(limiter.TryAcquire(kStartTime + 100),
+            UploadRateLimiter::AcquireResult::kAllowed);
+  EXPECT_EQ(limiter.TryAcquire(kStartTime + 100),
+            UploadRateLimiter::AcquireResult::kThrottled);
+}
+
+TEST(UploadRateLimiter, AccountForUploadAttempt) {
+  UploadRateLimiter::Options options;
+  options.burst = 2;
+  options.interval_seconds = 100;
+  UploadRateLimiter limiter(options);
+
+  // An attempt made elsewhere consumes one token, leaving one of the burst.
+  limiter.AccountForUploadAttempt(kStartTime);
+  EXPECT_EQ(limiter.TryAcquire(kStartTime),
+            UploadRateLimiter::AcquireResult::kAllowed);
+  EXPECT_EQ(limiter.TryAcquire(kStartTime),
+            UploadRateLimiter::AcquireResult::kThrottled);
+
+  // Another one delays the next permitted attempt by an interval.
+  limiter.AccountForUploadAttempt(kStartTime + 50);
+  EXPECT_EQ(limiter.TryAcquire(kStartTime + 199),
+            UploadRateLimiter::AcquireResult::kThrottled);
+  EXPECT_EQ(limiter.TryAcquire(kStartTime + 200),
+            UploadRateLimiter::AcquireResult::kAllowed);
+}
+
+TEST(UploadRateLimiter, NextAcquireTime) {
+  UploadRateLimiter::Options options;
+  options.burst = 2;
+  options.interval_seconds = 100;
+  UploadRateLimiter limiter(options);
+
+  EXPECT_LE(limiter.NextAcquireTime(), kStartTime);
+  ASSERT_EQ(limiter.TryAcquire(kStartTime),
+            UploadRateLimiter::AcquireResult::kAllowed);
+  EXPECT_LE(limiter.NextAcquireTime(), kStartTime);
+  ASSERT_EQ(limiter.TryAcquire(kStartTime),
+            UploadRateLimiter::AcquireResult::kAllowed);
+
+  const time_t next_acquire_time = limiter.NextAcquireTime();
+  EXPECT_EQ(next_acquire_time, kStartTime + 100);
+  EXPECT_EQ(limiter.TryAcquire(next_acquire_time - 1),
+            UploadRateLimiter::AcquireResult::kThrottled);
+  EXPECT_EQ(limiter.TryAcquire(next_acquire_time),
+            UploadRateLimiter::AcquireResult::kAllowed);
+}
+
+TEST(UploadRateLimiter, ClockMovedBackwards) {
+  UploadRateLimiter limiter((UploadRateLimiter::Options()));
+
+  // A last attempt time in the near future is respected.
+  limiter.SetLastUploadAttemptTime(kStartTime + kHour);
+  EXPECT_EQ(limiter.TryAcquire(kStartTime),
+            UploadRateLimiter::AcquireResult::kUnexpectedTime);
+
+  // A last attempt time more than a day in the future is disregarded.
+  limiter.SetLastUploadAttemptTime(kStartTime + 24 * kHour);
+  EXPECT_EQ(limiter.TryAcquire(kStartTime),
+            UploadRateLimiter::AcquireResult::kAllowed);
+  EXPECT_EQ(limiter.TryAcquire(kStartTime),
+            UploadRateLimiter::AcquireResult::kThrottled);
+}
+
+TEST(UploadRateLimiter, BackoffSeconds) {
+  UploadRateLimiter::Options options;
+  options.initial_backoff_seconds = 1000;
+  options.max_backoff_seconds = 5000;
+  UploadRateLimiter limiter(options);
+
+  const UUID uuid = TestUUID("00112233-4455-6677-8899-aabbccddeeff");
+
+  // Each failure doubles the delay, less up to a quarter of jitter, until the
+  // maximum is reached.
+  const int kExpectedDelays[] = {1000, 2000, 4000, 5000, 5000};
+  for (size_t index = 0; index < base::size(kExpectedDelays); ++index) {
+    SCOPED_TRACE(index);
+    const int attempts = static_cast<int>(index) + 1;
+    const int backoff = limiter.BackoffSeconds(uuid, attempts);
+    EXPECT_LE(backoff, kExpectedDelays[index]);
+    EXPECT_GE(backoff, kExpectedDelays[index] - kExpectedDelays[index] / 4);
+
+    // The jitter is stable for a given report and attempt count.
+    EXPECT_EQ(limiter.BackoffSeconds(uuid, attempts), backoff);
+  }
+
+  // Huge attempt counts don’t overflow.
+  EXPECT_LE(limiter.BackoffSeconds(uuid, 1000), 5000);
+  EXPECT_GE(limiter.BackoffSeconds(uuid, 1000), 5000 - 5000 / 4);
+}
+
+TEST(UploadRateLimiter, BackoffJitterVariesByReport) {
+  UploadRateLimiter::Options options;
+  options.initial_backoff_seconds = 100000;
+  options.max_backoff_seconds = 100000;
+  UploadRateLimiter limiter(options);
+
+  const UUID uuid_1 = TestUUID("00112233-4455-6677-8899-aabbccddeeff");
+  const UUID uuid_2 = TestUUID("00112233-4455-6677-8899-aabbccddeefe");
+  const UUID uuid_3 = TestUUID("ffeeddcc-bbaa-9988-7766-554433221100");
+
+  const int backoff_1 = limiter.BackoffSeconds(uuid_1, 1);
+  const int backoff_2 = limiter.BackoffSeconds(uuid_2, 1);
+  const int backoff_3 = limiter.BackoffSeconds(uuid_3, 1);
+  EXPECT_FALSE(backoff_1 == backoff_2 && backoff_2 == backoff_3);
+}
+
+TEST(UploadRateLimiter, ShouldRetry) {
+  UploadRateLimiter::Options options;
+  options.initial_backoff_seconds = 1000;
+  options.max_backoff_seconds = 8000;
+  options.max_upload_attempts = 3;
+  UploadRateLimiter limiter(options);
+
+  const UUID uuid = TestUUID("00112233-4455-6677-8899-aabbccddeeff");
+
+  // A report that has never been attempted may always be attempted.
+  EXPECT_EQ(limiter.ShouldRetry(uuid, 0, 0, kStartTime),
+            UploadRateLimiter::RetryResult::kRetry);
+
+  for (int attempts = 1; attempts < 3; ++attempts) {
+    SCOPED_TRACE(attempts);
+    const int backoff = limiter.BackoffSeconds(uuid, attempts);
+    EXPECT_EQ(limiter.ShouldRetry(uuid, attempts, kStartTime, kStartTime),
+              UploadRateLimiter::RetryResult::kWait);
+    EXPECT_EQ(limiter.ShouldRetry(
+                  uuid, attempts, kStartTime, kStartTime + backoff - 1),
+              UploadRateLimiter::RetryResult::kWait);
+    EXPECT_EQ(
+        limiter.ShouldRetry(uuid, attempts, kStartTime, kStartTime + backoff),
+        UploadRateLimiter::RetryResult::kRetry);
+
+    // A failed attempt in the near future means waiting, but one more than a
+    // day in the future is disregarded.
+    EXPECT_EQ(
+        limiter.ShouldRetry(uuid, attempts, kStartTime + kHour, kStartTime),
+        UploadRateLimiter::RetryResult::kWait);
+    EXPECT_EQ(limiter.ShouldRetry(
+                  uuid, attempts, kStartTime + 24 * kHour, kStartTime),
+              UploadRateLimiter::RetryResult::kRetry);
+  }
+
+  EXPECT_TRUE(limiter.MayRetry(2));
+  EXPECT_FALSE(limiter.MayRetry(3));
+  EXPECT_EQ(limiter.ShouldRetry(uuid, 3, kStartTime, kStartTime + 100000),
+            UploadRateLimiter::RetryResult::kGiveUp);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
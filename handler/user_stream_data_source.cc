@@ -18,16 +18,20 @@
 #include "minidump/minidump_file_writer.h"
 #include "minidump/minidump_user_extension_stream_data_source.h"
 #include "snapshot/process_snapshot.h"
+#include "util/misc/capture_deadline.h"
 
 namespace crashpad {
 
 void AddUserExtensionStreams(
     const UserStreamDataSources* user_stream_data_sources,
     ProcessSnapshot* process_snapshot,
-    MinidumpFileWriter* minidump_file_writer) {
+    MinidumpFileWriter* minidump_file_writer,
+    CaptureDeadline* deadline) {
   if (!user_stream_data_sources)
     return;
   for (const auto& source : *user_stream_data_sources) {
+    if (deadline && deadline->Expired(CaptureDeadline::kPhaseUserStreams))
+      break;
     std::unique_ptr<MinidumpUserExtensionStreamDataSource> data_source(
         source->ProduceStreamData(process_snapshot));
     if (data_source &&
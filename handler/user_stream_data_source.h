@@ -20,6 +20,7 @@
 
 namespace crashpad {
 
+class CaptureDeadline;
 class MinidumpFileWriter;
 class MinidumpUserExtensionStreamDataSource;
 class ProcessSnapshot;
@@ -58,10 +59,13 @@ using UserStreamDataSources =
 //! \param[in] process_snapshot An initialized snapshot to the crashing process.
 //! \param[in] minidump_file_writer Any extension streams will be added to this
 //!     minidump.
+//! \param[in] deadline The deadline of the capture. Once it has passed, no
+//!     more sources are dispatched to. Optional.
 void AddUserExtensionStreams(
     const UserStreamDataSources* user_stream_data_sources,
     ProcessSnapshot* process_snapshot,
-    MinidumpFileWriter* minidump_file_writer);
+    MinidumpFileWriter* minidump_file_writer,
+    CaptureDeadline* deadline = nullptr);
 
 }  // namespace crashpad
 
@@ -37,6 +37,8 @@
         'minidump_annotation_writer.h',
         'minidump_byte_array_writer.cc',
         'minidump_byte_array_writer.h',
+        'minidump_capture_truncation_writer.cc',
+        'minidump_capture_truncation_writer.h',
         'minidump_context.h',
         'minidump_context_writer.cc',
         'minidump_context_writer.h',
@@ -50,6 +52,8 @@
         'minidump_file_writer.h',
         'minidump_handle_writer.cc',
         'minidump_handle_writer.h',
+        'minidump_memory64_writer.cc',
+        'minidump_memory64_writer.h',
         'minidump_memory_info_writer.cc',
         'minidump_memory_info_writer.h',
         'minidump_memory_writer.cc',
@@ -60,6 +64,8 @@
         'minidump_module_crashpad_info_writer.h',
         'minidump_module_writer.cc',
         'minidump_module_writer.h',
+        'minidump_omitted_memory_writer.cc',
+        'minidump_omitted_memory_writer.h',
         'minidump_rva_list_writer.cc',
         'minidump_rva_list_writer.h',
         'minidump_simple_string_dictionary_writer.cc',
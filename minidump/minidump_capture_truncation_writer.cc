@@ -0,0 +1,130 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "minidump/minidump_capture_truncation_writer.h"
+
+#include <limits>
+
+#include "base/logging.h"
+#include "util/file/file_writer.h"
+#include "util/misc/capture_deadline.h"
+#include "util/numeric/safe_assignment.h"
+
+namespace crashpad {
+
+// The phases are recorded with the same bits that CaptureDeadline uses.
+static_assert(kMinidumpCapturePhaseThreads == CaptureDeadline::kPhaseThreads,
+              "threads phase");
+static_assert(kMinidumpCapturePhaseModules == CaptureDeadline::kPhaseModules,
+              "modules phase");
+static_assert(kMinidumpCapturePhaseIndirectlyReferencedMemory ==
+                  CaptureDeadline::kPhaseIndirectlyReferencedMemory,
+              "indirectly referenced memory phase");
+static_assert(kMinidumpCapturePhaseWritableMemory ==
+                  CaptureDeadline::kPhaseWritableMemory,
+              "writable memory phase");
+static_assert(kMinidumpCapturePhaseUserStreams ==
+                  CaptureDeadline::kPhaseUserStreams,
+              "user streams phase");
+static_assert(kMinidumpCapturePhaseSerialization ==
+                  CaptureDeadline::kPhaseSerialization,
+              "serialization phase");
+
+namespace {
+
+// Converts |nanoseconds| to milliseconds, saturating at the largest value that
+// a uint32_t can hold.
+uint32_t SaturatingMilliseconds(uint64_t nanoseconds) {
+  uint32_t milliseconds;
+  return AssignIfInRange(&milliseconds, nanoseconds / 1000000)
+             ? milliseconds
+             : std::numeric_limits<uint32_t>::max();
+}
+
+}  // namespace
+
+MinidumpCaptureTruncationWriter::MinidumpCaptureTruncationWriter()
+    : MinidumpStreamWriter(),
+      capture_truncation_(),
+      deadline_(nullptr),
+      offset_(-1) {
+  capture_truncation_.version = MinidumpCaptureTruncation::kVersion;
+}
+
+MinidumpCaptureTruncationWriter::~MinidumpCaptureTruncationWriter() {}
+
+void MinidumpCaptureTruncationWriter::InitializeFromDeadline(
+    const CaptureDeadline* deadline) {
+  DCHECK_EQ(state(), kStateMutable);
+  DCHECK(!deadline_);
+
+  deadline_ = deadline;
+}
+
+size_t MinidumpCaptureTruncationWriter::SizeOfObject() {
+  DCHECK_GE(state(), kStateFrozen);
+  return sizeof(capture_truncation_);
+}
+
+std::vector<internal::MinidumpWritable*>
+MinidumpCaptureTruncationWriter::Children() {
+  DCHECK_GE(state(), kStateFrozen);
+  return std::vector<internal::MinidumpWritable*>();
+}
+
+bool MinidumpCaptureTruncationWriter::WillWriteAtOffsetImpl(
+    FileOffset offset) {
+  DCHECK_EQ(state(), kStateFrozen);
+
+  offset_ = offset;
+  return MinidumpStreamWriter::WillWriteAtOffsetImpl(offset);
+}
+
+bool MinidumpCaptureTruncationWriter::WriteObject(
+    FileWriterInterface* file_writer) {
+  DCHECK_EQ(state(), kStateWritable);
+
+  UpdateFromDeadline();
+  return file_writer->Write(&capture_truncation_, sizeof(capture_truncation_));
+}
+
+bool MinidumpCaptureTruncationWriter::WriteUpdate(
+    FileWriterInterface* file_writer,
+    FileOffset start_offset) {
+  DCHECK_EQ(state(), kStateWritten);
+
+  if (!deadline_) {
+    return true;
+  }
+
+  UpdateFromDeadline();
+  return file_writer->Seek(start_offset + offset_, SEEK_SET) >= 0 &&
+         file_writer->Write(&capture_truncation_, sizeof(capture_truncation_));
+}
+
+MinidumpStreamType MinidumpCaptureTruncationWriter::StreamType() const {
+  return kMinidumpStreamTypeCrashpadCaptureTruncation;
+}
+
+void MinidumpCaptureTruncationWriter::UpdateFromDeadline() {
+  if (deadline_) {
+    capture_truncation_.truncated_phases = deadline_->TruncatedPhases();
+    capture_truncation_.timeout_ms =
+        SaturatingMilliseconds(deadline_->TimeoutNanoseconds());
+    capture_truncation_.elapsed_ms =
+        SaturatingMilliseconds(deadline_->ElapsedNanoseconds());
+  }
+}
+
+}  // namespace crashpad
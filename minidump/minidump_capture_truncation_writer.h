@@ -0,0 +1,81 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_MINIDUMP_MINIDUMP_CAPTURE_TRUNCATION_WRITER_H_
+#define CRASHPAD_MINIDUMP_MINIDUMP_CAPTURE_TRUNCATION_WRITER_H_
+
+#include <sys/types.h>
+
+#include <vector>
+
+#include "base/macros.h"
+#include "minidump/minidump_extensions.h"
+#include "minidump/minidump_stream_writer.h"
+#include "minidump/minidump_writable.h"
+
+namespace crashpad {
+
+class CaptureDeadline;
+
+//! \brief The writer for a MinidumpCaptureTruncation stream in a minidump file.
+class MinidumpCaptureTruncationWriter final
+    : public internal::MinidumpStreamWriter {
+ public:
+  MinidumpCaptureTruncationWriter();
+  ~MinidumpCaptureTruncationWriter() override;
+
+  //! \brief Arranges for the MinidumpCaptureTruncation to record the state of
+  //!     \a deadline.
+  //!
+  //! \a deadline is read when the stream is written, so phases that are cut
+  //! short while earlier parts of the minidump are written are recorded. If
+  //! the minidump is written to a file that can be seeked, the stream is
+  //! rewritten once the whole file has been, so that phases cut short while
+  //! later parts were written, such as the contents of a
+  //! MinidumpMemory64ListWriter, are recorded too.
+  //!
+  //! \param[in] deadline The deadline of the capture that the minidump is
+  //!     written from. This object does not take ownership of \a deadline,
+  //!     which must outlive it.
+  //!
+  //! \note Valid in #kStateMutable.
+  void InitializeFromDeadline(const CaptureDeadline* deadline);
+
+  // MinidumpStreamWriter:
+  bool WriteUpdate(FileWriterInterface* file_writer,
+                   FileOffset start_offset) override;
+
+ protected:
+  // MinidumpWritable:
+  size_t SizeOfObject() override;
+  std::vector<internal::MinidumpWritable*> Children() override;
+  bool WillWriteAtOffsetImpl(FileOffset offset) override;
+  bool WriteObject(FileWriterInterface* file_writer) override;
+
+  // MinidumpStreamWriter:
+  MinidumpStreamType StreamType() const override;
+
+ private:
+  void UpdateFromDeadline();
+
+  MinidumpCaptureTruncation capture_truncation_;
+  const CaptureDeadline* deadline_;  // weak
+  FileOffset offset_;
+
+  DISALLOW_COPY_AND_ASSIGN(MinidumpCaptureTruncationWriter);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_MINIDUMP_MINIDUMP_CAPTURE_TRUNCATION_WRITER_H_
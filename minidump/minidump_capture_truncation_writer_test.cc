@@ -0,0 +1,179 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "minidump/minidump_capture_truncation_writer.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/macros.h"
+#include "gtest/gtest.h"
+#include "minidump/minidump_file_writer.h"
+#include "minidump/minidump_memory64_writer.h"
+#include "minidump/test/minidump_file_writer_test_util.h"
+#include "minidump/test/minidump_writable_test_util.h"
+#include "util/file/string_file.h"
+#include "util/misc/capture_deadline.h"
+#include "util/numeric/checked_range.h"
+#include "util/process/process_memory.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// The capture truncation record is expected to be the only stream.
+void GetCaptureTruncationStream(
+    const std::string& file_contents,
+    const MinidumpCaptureTruncation** capture_truncation) {
+  constexpr size_t kDirectoryOffset = sizeof(MINIDUMP_HEADER);
+  constexpr size_t kCaptureTruncationStreamOffset =
+      kDirectoryOffset + sizeof(MINIDUMP_DIRECTORY);
+
+  const MINIDUMP_DIRECTORY* directory;
+  const MINIDUMP_HEADER* header =
+      MinidumpHeaderAtStart(file_contents, &directory);
+  ASSERT_NO_FATAL_FAILURE(VerifyMinidumpHeader(header, 1, 0));
+  ASSERT_TRUE(directory);
+
+  ASSERT_EQ(directory[0].StreamType,
+            kMinidumpStreamTypeCrashpadCaptureTruncation);
+  EXPECT_EQ(directory[0].Location.Rva, kCaptureTruncationStreamOffset);
+
+  *capture_truncation =
+      MinidumpWritableAtLocationDescriptor<MinidumpCaptureTruncation>(
+          file_contents, directory[0].Location);
+  ASSERT_TRUE(*capture_truncation);
+}
+
+TEST(MinidumpCaptureTruncationWriter, NotTruncated) {
+  CaptureDeadline deadline(3600 * static_cast<uint64_t>(1E9));
+  EXPECT_FALSE(deadline.Expired(CaptureDeadline::kPhaseThreads));
+
+  MinidumpFileWriter minidump_file_writer;
+  auto capture_truncation_writer =
+      std::make_unique<MinidumpCaptureTruncationWriter>();
+  capture_truncation_writer->InitializeFromDeadline(&deadline);
+  ASSERT_TRUE(
+      minidump_file_writer.AddStream(std::move(capture_truncation_writer)));
+
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+
+  ASSERT_EQ(string_file.string().size(),
+            sizeof(MINIDUMP_HEADER) + sizeof(MINIDUMP_DIRECTORY) +
+                sizeof(MinidumpCaptureTruncation));
+
+  const MinidumpCaptureTruncation* capture_truncation = nullptr;
+  ASSERT_NO_FATAL_FAILURE(
+      GetCaptureTruncationStream(string_file.string(), &capture_truncation));
+
+  EXPECT_EQ(capture_truncation->version, MinidumpCaptureTruncation::kVersion);
+  EXPECT_EQ(capture_truncation->truncated_phases, 0u);
+  EXPECT_EQ(capture_truncation->timeout_ms, 3600000u);
+}
+
+TEST(MinidumpCaptureTruncationWriter, Truncated) {
+  CaptureDeadline deadline(1);
+  while (deadline.ElapsedNanoseconds() < 1) {
+  }
+  EXPECT_TRUE(deadline.Expired(CaptureDeadline::kPhaseModules));
+
+  MinidumpFileWriter minidump_file_writer;
+  auto capture_truncation_writer =
+      std::make_unique<MinidumpCaptureTruncationWriter>();
+  capture_truncation_writer->InitializeFromDeadline(&deadline);
+  ASSERT_TRUE(
+      minidump_file_writer.AddStream(std::move(capture_truncation_writer)));
+
+  // Phases cut short after the stream is initialized, but before it’s written,
+  // are recorded.
+  EXPECT_TRUE(deadline.Expired(CaptureDeadline::kPhaseUserStreams));
+
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+
+  const MinidumpCaptureTruncation* capture_truncation = nullptr;
+  ASSERT_NO_FATAL_FAILURE(
+      GetCaptureTruncationStream(string_file.string(), &capture_truncation));
+
+  EXPECT_EQ(capture_truncation->version, MinidumpCaptureTruncation::kVersion);
+  EXPECT_EQ(capture_truncation->truncated_phases,
+            static_cast<uint32_t>(kMinidumpCapturePhaseModules |
+                                  kMinidumpCapturePhaseUserStreams));
+  EXPECT_EQ(capture_truncation->timeout_ms, 0u);
+}
+
+// Memory that can’t be read, for streams whose contents are never read.
+class UnreadableProcessMemory : public ProcessMemory {
+ public:
+  UnreadableProcessMemory() : ProcessMemory() {}
+  ~UnreadableProcessMemory() {}
+
+ private:
+  ssize_t ReadUpTo(VMAddress address,
+                   size_t size,
+                   void* buffer) const override {
+    return -1;
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(UnreadableProcessMemory);
+};
+
+TEST(MinidumpCaptureTruncationWriter, TruncatedAfterWritten) {
+  CaptureDeadline deadline(1);
+  while (deadline.ElapsedNanoseconds() < 1) {
+  }
+
+  MinidumpFileWriter minidump_file_writer;
+  auto capture_truncation_writer =
+      std::make_unique<MinidumpCaptureTruncationWriter>();
+  capture_truncation_writer->InitializeFromDeadline(&deadline);
+  ASSERT_TRUE(
+      minidump_file_writer.AddStream(std::move(capture_truncation_writer)));
+
+  // The contents of a memory64 list are written after every other stream, and
+  // this one’s are cut short by the deadline.
+  UnreadableProcessMemory memory;
+  auto memory64_list_writer = std::make_unique<MinidumpMemory64ListWriter>();
+  memory64_list_writer->InitializeFromRanges(
+      &memory,
+      std::vector<CheckedRange<uint64_t>>(
+          1, CheckedRange<uint64_t>(0x1000, 0x1000)),
+      &deadline);
+  ASSERT_TRUE(minidump_file_writer.AddStream(std::move(memory64_list_writer)));
+
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+
+  const MINIDUMP_DIRECTORY* directory;
+  const MINIDUMP_HEADER* header =
+      MinidumpHeaderAtStart(string_file.string(), &directory);
+  ASSERT_NO_FATAL_FAILURE(VerifyMinidumpHeader(header, 2, 0));
+  ASSERT_TRUE(directory);
+  ASSERT_EQ(directory[0].StreamType,
+            kMinidumpStreamTypeCrashpadCaptureTruncation);
+
+  const MinidumpCaptureTruncation* capture_truncation =
+      MinidumpWritableAtLocationDescriptor<MinidumpCaptureTruncation>(
+          string_file.string(), directory[0].Location);
+  ASSERT_TRUE(capture_truncation);
+  EXPECT_EQ(capture_truncation->truncated_phases,
+            static_cast<uint32_t>(kMinidumpCapturePhaseSerialization));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -72,6 +72,11 @@ enum MinidumpStreamType : uint32_t {
   //! \sa SystemInfoStream
   kMinidumpStreamTypeSystemInfo = SystemInfoStream,
 
+  //! \brief The stream type for MINIDUMP_MEMORY64_LIST.
+  //!
+  //! \sa Memory64ListStream
+  kMinidumpStreamTypeMemory64List = Memory64ListStream,
+
   //! \brief The stream type for MINIDUMP_HANDLE_DATA_STREAM.
   //!
   //! \sa HandleDataStream
@@ -103,6 +108,12 @@ enum MinidumpStreamType : uint32_t {
   //! \brief The stream type for MinidumpCrashpadInfo.
   kMinidumpStreamTypeCrashpadInfo = 0x43500001,
 
+  //! \brief The stream type for MinidumpOmittedMemoryList.
+  kMinidumpStreamTypeCrashpadOmittedMemoryList = 0x43500002,
+
+  //! \brief The stream type for MinidumpCaptureTruncation.
+  kMinidumpStreamTypeCrashpadCaptureTruncation = 0x43500003,
+
   //! \brief The last reserved crashpad stream.
   kMinidumpStreamTypeCrashpadLastReservedStream = 0x4350ffff,
 };
@@ -497,6 +508,100 @@ struct ALIGNAS(4) PACKED MinidumpCrashpadInfo {
   MINIDUMP_LOCATION_DESCRIPTOR module_list;
 };
 
+//! \brief A range of memory that was not captured because its contents are
+//!     the same as in the file of a module in the module list.
+struct ALIGNAS(4) PACKED MinidumpOmittedMemoryDescriptor {
+  //! \brief The base address of the range.
+  uint64_t base;
+
+  //! \brief The size of the range.
+  uint64_t size;
+};
+
+//! \brief A list of ranges of memory that were not captured because they could
+//!     be recovered from module files.
+//!
+//! A reader that has the module files, such as a symbol server, can restore
+//! the contents of these ranges by locating the module in the
+//! MINIDUMP_MODULE_LIST whose image contains each range.
+struct ALIGNAS(4) PACKED MinidumpOmittedMemoryList {
+  //! \brief The number of entries in #ranges.
+  uint32_t count;
+
+  //! \brief The ranges, sorted by address and not overlapping.
+  MinidumpOmittedMemoryDescriptor ranges[0];
+};
+
+//! \brief The phases of a capture that may be cut short when the capture’s
+//!     deadline passes.
+//!
+//! These values are bits in MinidumpCaptureTruncation::truncated_phases.
+enum MinidumpCapturePhase : uint32_t {
+  //! \brief Some threads were not captured.
+  kMinidumpCapturePhaseThreads = 1 << 0,
+
+  //! \brief Some modules were not captured.
+  kMinidumpCapturePhaseModules = 1 << 1,
+
+  //! \brief Some memory referenced by thread registers and stacks was not
+  //!     captured.
+  kMinidumpCapturePhaseIndirectlyReferencedMemory = 1 << 2,
+
+  //! \brief Some writable memory was not captured.
+  kMinidumpCapturePhaseWritableMemory = 1 << 3,
+
+  //! \brief Some user extension streams were not produced.
+  kMinidumpCapturePhaseUserStreams = 1 << 4,
+
+  //! \brief Some memory was not read while the minidump was written.
+  kMinidumpCapturePhaseSerialization = 1 << 5,
+};
+
+//! \brief Records how long a capture took and which of its phases were cut
+//!     short because the capture’s deadline passed.
+//!
+//! A minidump containing this stream was captured with a deadline. Parts of
+//! the minidump that correspond to a phase in #truncated_phases are
+//! incomplete.
+//!
+//! This structure is versioned. When changing this structure, leave the
+//! existing structure intact so that earlier parsers will be able to understand
+//! the fields they are aware of, and make additions at the end of the
+//! structure. Revise #kVersion and document each field’s validity based on
+//! #version, so that newer parsers will be able to determine whether the added
+//! fields are valid or not.
+struct ALIGNAS(4) PACKED MinidumpCaptureTruncation {
+  //! \brief The structure’s currently-defined version number.
+  //!
+  //! \sa version
+  static constexpr uint32_t kVersion = 1;
+
+  //! \brief The structure’s version number.
+  //!
+  //! Readers can use this field to determine which other fields in the
+  //! structure are valid. Upon encountering a value greater than #kVersion, a
+  //! reader should assume that the structure’s layout is compatible with the
+  //! structure defined as having value #kVersion.
+  uint32_t version;
+
+  //! \brief The phases that were cut short, as a bitwise combination of
+  //!     MinidumpCapturePhase values.
+  //!
+  //! This field is present when #version is at least `1`.
+  uint32_t truncated_phases;
+
+  //! \brief The time allowed for the capture, in milliseconds.
+  //!
+  //! This field is present when #version is at least `1`.
+  uint32_t timeout_ms;
+
+  //! \brief The time the capture had taken when this structure was written,
+  //!     in milliseconds.
+  //!
+  //! This field is present when #version is at least `1`.
+  uint32_t elapsed_ms;
+};
+
 #if defined(COMPILER_MSVC)
 #pragma pack(pop)
 #pragma warning(pop)  // C4200
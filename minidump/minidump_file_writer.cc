@@ -240,6 +240,12 @@ bool MinidumpFileWriter::WriteMinidump(FileWriterInterface* file_writer,
     return false;
   }
 
+  for (const auto& stream : streams_) {
+    if (!stream->WriteUpdate(file_writer, start_offset)) {
+      return false;
+    }
+  }
+
   // Now that the entire minidump file has been completely written, go back to
   // the beginning and rewrite the header with the correct signature to identify
   // it as a valid minidump file.
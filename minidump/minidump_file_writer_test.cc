@@ -19,6 +19,7 @@
 
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "base/stl_util.h"
 #include "build/build_config.h"
@@ -28,6 +29,7 @@
 #include "minidump/test/minidump_file_writer_test_util.h"
 #include "minidump/test/minidump_user_extension_stream_util.h"
 #include "minidump/test/minidump_writable_test_util.h"
+#include "snapshot/minidump/process_snapshot_minidump.h"
 #include "snapshot/test/test_cpu_context.h"
 #include "snapshot/test/test_exception_snapshot.h"
 #include "snapshot/test/test_memory_snapshot.h"
@@ -550,6 +552,106 @@ TEST(MinidumpFileWriter, InitializeFromSnapshot_CrashpadInfo) {
                   string_file.string(), directory[6].Location));
 }
 
+class ReadToString : public MemorySnapshot::Delegate {
+ public:
+  explicit ReadToString(std::string* result) : result_(result) {}
+  ~ReadToString() {}
+
+  bool MemorySnapshotDelegateRead(void* data, size_t size) override {
+    result_->assign(static_cast<char*>(data), size);
+    return true;
+  }
+
+ private:
+  std::string* result_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReadToString);
+};
+
+TEST(MinidumpFileWriter, InitializeFromSnapshot_IdenticalStacks) {
+  TestProcessSnapshot process_snapshot;
+
+  auto system_snapshot = std::make_unique<TestSystemSnapshot>();
+  system_snapshot->SetCPUArchitecture(kCPUArchitectureX86_64);
+  system_snapshot->SetOperatingSystem(SystemSnapshot::kOperatingSystemLinux);
+  process_snapshot.SetSystem(std::move(system_snapshot));
+
+  // The first two stacks have the same contents at different addresses, so
+  // only one copy should be written.
+  constexpr size_t kStackSize = 0x1000;
+  static constexpr struct {
+    uint64_t thread_id;
+    uint64_t stack_address;
+    char value;
+  } kThreads[] = {
+      {1, 0x7fff00000000, 's'},
+      {2, 0x7fff00100000, 's'},
+      {3, 0x7fff00200000, 'd'},
+  };
+  for (const auto& thread : kThreads) {
+    auto thread_snapshot = std::make_unique<TestThreadSnapshot>();
+    thread_snapshot->SetThreadID(thread.thread_id);
+    InitializeCPUContextX86_64(thread_snapshot->MutableContext(),
+                               static_cast<uint32_t>(thread.thread_id));
+    auto stack = std::make_unique<TestMemorySnapshot>();
+    stack->SetAddress(thread.stack_address);
+    stack->SetSize(kStackSize);
+    stack->SetValue(thread.value);
+    thread_snapshot->SetStack(std::move(stack));
+    process_snapshot.AddThread(std::move(thread_snapshot));
+  }
+
+  MinidumpFileWriter minidump_file_writer;
+  minidump_file_writer.InitializeFromSnapshot(&process_snapshot);
+
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+
+  const MINIDUMP_DIRECTORY* directory;
+  const MINIDUMP_HEADER* header =
+      MinidumpHeaderAtStart(string_file.string(), &directory);
+  ASSERT_TRUE(header);
+  ASSERT_TRUE(directory);
+
+  const MINIDUMP_MEMORY_LIST* memory_list = nullptr;
+  for (size_t index = 0; index < header->NumberOfStreams; ++index) {
+    if (directory[index].StreamType == kMinidumpStreamTypeMemoryList) {
+      memory_list = MinidumpWritableAtLocationDescriptor<MINIDUMP_MEMORY_LIST>(
+          string_file.string(), directory[index].Location);
+    }
+  }
+  ASSERT_TRUE(memory_list);
+  ASSERT_EQ(memory_list->NumberOfMemoryRanges, base::size(kThreads));
+  EXPECT_EQ(memory_list->MemoryRanges[0].Memory.Rva,
+            memory_list->MemoryRanges[1].Memory.Rva);
+  EXPECT_NE(memory_list->MemoryRanges[0].Memory.Rva,
+            memory_list->MemoryRanges[2].Memory.Rva);
+  EXPECT_EQ(memory_list->MemoryRanges[2].Memory.Rva + kStackSize,
+            string_file.string().size());
+
+  ASSERT_TRUE(string_file.SeekSet(0));
+  ProcessSnapshotMinidump minidump_snapshot;
+  ASSERT_TRUE(minidump_snapshot.Initialize(&string_file));
+
+  const std::vector<const ThreadSnapshot*> threads =
+      minidump_snapshot.Threads();
+  ASSERT_EQ(threads.size(), base::size(kThreads));
+  for (size_t index = 0; index < threads.size(); ++index) {
+    SCOPED_TRACE(index);
+    EXPECT_EQ(threads[index]->ThreadID(), kThreads[index].thread_id);
+
+    const MemorySnapshot* stack = threads[index]->Stack();
+    ASSERT_TRUE(stack);
+    EXPECT_EQ(stack->Address(), kThreads[index].stack_address);
+    EXPECT_EQ(stack->Size(), kStackSize);
+
+    std::string contents;
+    ReadToString delegate(&contents);
+    ASSERT_TRUE(stack->Read(&delegate));
+    EXPECT_EQ(contents, std::string(kStackSize, kThreads[index].value));
+  }
+}
+
 TEST(MinidumpFileWriter, SameStreamType) {
   MinidumpFileWriter minidump_file;
 
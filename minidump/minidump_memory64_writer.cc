@@ -0,0 +1,255 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "minidump/minidump_memory64_writer.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "util/file/file_writer.h"
+#include "util/misc/capture_deadline.h"
+#include "util/numeric/safe_assignment.h"
+
+namespace crashpad {
+
+namespace internal {
+
+//! \brief Writes the contents of the memory ranges in a MINIDUMP_MEMORY64_LIST.
+class MinidumpMemory64DataWriter final : public MinidumpWritable {
+ public:
+  MinidumpMemory64DataWriter(
+      const ProcessMemory* memory,
+      const std::vector<MINIDUMP_MEMORY_DESCRIPTOR64>* descriptors,
+      RVA64* base_rva,
+      CaptureDeadline* deadline)
+      : MinidumpWritable(),
+        memory_(memory),
+        descriptors_(descriptors),
+        base_rva_(base_rva),
+        deadline_(deadline),
+        size_(0) {}
+
+  ~MinidumpMemory64DataWriter() override {}
+
+ protected:
+  // MinidumpWritable:
+
+  bool Freeze() override {
+    DCHECK_EQ(state(), kStateMutable);
+
+    if (!MinidumpWritable::Freeze()) {
+      return false;
+    }
+
+    uint64_t size = 0;
+    for (const auto& descriptor : *descriptors_) {
+      size += descriptor.DataSize;
+    }
+    if (!AssignIfInRange(&size_, size)) {
+      LOG(ERROR) << "size " << size << " out of range";
+      return false;
+    }
+
+    return true;
+  }
+
+  size_t SizeOfObject() override {
+    DCHECK_GE(state(), kStateFrozen);
+    return size_;
+  }
+
+  // Memory contents are aligned like the regions in a MINIDUMP_MEMORY_LIST.
+  size_t Alignment() override { return 16; }
+
+  bool WillWriteAtOffsetImpl(FileOffset offset) override {
+    *base_rva_ = offset;
+    return MinidumpWritable::WillWriteAtOffsetImpl(offset);
+  }
+
+  // The contents are written after everything else, because they may be
+  // located beyond the range of an RVA.
+  Phase WritePhase() override { return kPhaseLate; }
+
+  bool WriteObject(FileWriterInterface* file_writer) override {
+    DCHECK_EQ(state(), kStateWritable);
+
+    // Memory is read into a buffer of at most kChunkSize bytes, so the
+    // memory used to write the contents doesn’t depend on their size.
+    constexpr uint64_t kChunkSize = 1024 * 1024;
+    std::vector<uint8_t> buffer;
+
+    // The size of the contents was fixed when the stream was laid out, so once
+    // the deadline passes, the rest is filled instead of read.
+    bool expired = false;
+    for (const auto& descriptor : *descriptors_) {
+      VMAddress address = descriptor.StartOfMemoryRange;
+      uint64_t remaining = descriptor.DataSize;
+      while (remaining > 0) {
+        const size_t chunk_size =
+            static_cast<size_t>(std::min(remaining, kChunkSize));
+        buffer.resize(chunk_size);
+        if (!expired && deadline_ &&
+            deadline_->Expired(CaptureDeadline::kPhaseSerialization)) {
+          expired = true;
+        }
+        if (expired) {
+          memset(buffer.data(), 0xfe, chunk_size);
+        } else {
+          ReadChunk(address, chunk_size, buffer.data());
+        }
+        if (!file_writer->Write(buffer.data(), chunk_size)) {
+          return false;
+        }
+        address += chunk_size;
+        remaining -= chunk_size;
+      }
+    }
+
+    return true;
+  }
+
+ private:
+  // Reads |size| bytes at |address| into |buffer|. If the memory has become
+  // unreadable since the ranges were captured, only the parts that can’t be
+  // read are filled with 0xfe, as SnapshotMinidumpMemoryWriter does for
+  // entire regions.
+  void ReadChunk(VMAddress address, size_t size, uint8_t* buffer) {
+    if (memory_->Read(address, size, buffer)) {
+      return;
+    }
+
+    constexpr VMSize kRetrySize = 4096;
+    size_t offset = 0;
+    while (offset < size) {
+      const size_t piece_size = static_cast<size_t>(
+          std::min<VMSize>(kRetrySize - (address + offset) % kRetrySize,
+                           size - offset));
+      if (!memory_->Read(address + offset, piece_size, buffer + offset)) {
+        memset(buffer + offset, 0xfe, piece_size);
+      }
+      offset += piece_size;
+    }
+  }
+
+  const ProcessMemory* memory_;  // weak
+  const std::vector<MINIDUMP_MEMORY_DESCRIPTOR64>* descriptors_;  // weak
+  RVA64* base_rva_;  // weak
+  CaptureDeadline* deadline_;  // weak
+  size_t size_;
+
+  DISALLOW_COPY_AND_ASSIGN(MinidumpMemory64DataWriter);
+};
+
+}  // namespace internal
+
+MinidumpMemory64ListWriter::MinidumpMemory64ListWriter()
+    : MinidumpStreamWriter(), memory64_list_base_(), descriptors_(), data_() {}
+
+MinidumpMemory64ListWriter::~MinidumpMemory64ListWriter() {}
+
+void MinidumpMemory64ListWriter::InitializeFromRanges(
+    const ProcessMemory* memory,
+    const std::vector<CheckedRange<uint64_t>>& ranges,
+    CaptureDeadline* deadline) {
+  DCHECK_EQ(state(), kStateMutable);
+  DCHECK(!data_);
+
+  std::vector<CheckedRange<uint64_t>> sorted_ranges;
+  for (const auto& range : ranges) {
+    if (range.IsValid() && range.size() != 0) {
+      sorted_ranges.push_back(range);
+    }
+  }
+  std::sort(sorted_ranges.begin(),
+            sorted_ranges.end(),
+            [](const CheckedRange<uint64_t>& lhs,
+               const CheckedRange<uint64_t>& rhs) {
+              return lhs.base() < rhs.base();
+            });
+
+  for (const auto& range : sorted_ranges) {
+    if (!descriptors_.empty() &&
+        range.base() <= descriptors_.back().StartOfMemoryRange +
+                            descriptors_.back().DataSize) {
+      MINIDUMP_MEMORY_DESCRIPTOR64& last = descriptors_.back();
+      last.DataSize =
+          std::max(last.StartOfMemoryRange + last.DataSize, range.end()) -
+          last.StartOfMemoryRange;
+      continue;
+    }
+
+    MINIDUMP_MEMORY_DESCRIPTOR64 descriptor;
+    descriptor.StartOfMemoryRange = range.base();
+    descriptor.DataSize = range.size();
+    descriptors_.push_back(descriptor);
+  }
+
+  data_ = std::make_unique<internal::MinidumpMemory64DataWriter>(
+      memory, &descriptors_, &memory64_list_base_.BaseRva, deadline);
+}
+
+bool MinidumpMemory64ListWriter::Freeze() {
+  DCHECK_EQ(state(), kStateMutable);
+
+  if (!MinidumpStreamWriter::Freeze()) {
+    return false;
+  }
+
+  memory64_list_base_.NumberOfMemoryRanges = descriptors_.size();
+
+  return true;
+}
+
+size_t MinidumpMemory64ListWriter::SizeOfObject() {
+  DCHECK_GE(state(), kStateFrozen);
+  return sizeof(memory64_list_base_) +
+         descriptors_.size() * sizeof(MINIDUMP_MEMORY_DESCRIPTOR64);
+}
+
+std::vector<internal::MinidumpWritable*>
+MinidumpMemory64ListWriter::Children() {
+  DCHECK_GE(state(), kStateFrozen);
+
+  std::vector<MinidumpWritable*> children;
+  if (data_) {
+    children.push_back(data_.get());
+  }
+  return children;
+}
+
+bool MinidumpMemory64ListWriter::WriteObject(
+    FileWriterInterface* file_writer) {
+  DCHECK_EQ(state(), kStateWritable);
+
+  WritableIoVec iov;
+  iov.iov_base = &memory64_list_base_;
+  iov.iov_len = sizeof(memory64_list_base_);
+  std::vector<WritableIoVec> iovecs(1, iov);
+
+  if (!descriptors_.empty()) {
+    iov.iov_base = &descriptors_[0];
+    iov.iov_len = descriptors_.size() * sizeof(MINIDUMP_MEMORY_DESCRIPTOR64);
+    iovecs.push_back(iov);
+  }
+
+  return file_writer->WriteIoVec(&iovecs);
+}
+
+MinidumpStreamType MinidumpMemory64ListWriter::StreamType() const {
+  return kMinidumpStreamTypeMemory64List;
+}
+
+}  // namespace crashpad
@@ -0,0 +1,93 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_MINIDUMP_MINIDUMP_MEMORY64_WRITER_H_
+#define CRASHPAD_MINIDUMP_MINIDUMP_MEMORY64_WRITER_H_
+
+#include <windows.h>
+#include <dbghelp.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/macros.h"
+#include "minidump/minidump_stream_writer.h"
+#include "minidump/minidump_writable.h"
+#include "util/numeric/checked_range.h"
+#include "util/process/process_memory.h"
+
+namespace crashpad {
+
+class CaptureDeadline;
+
+namespace internal {
+class MinidumpMemory64DataWriter;
+}  // namespace internal
+
+//! \brief The writer for a MINIDUMP_MEMORY64_LIST stream in a minidump file.
+//!
+//! The contents of every memory range are written as a single contiguous block
+//! at the end of the minidump file. They are read from the target process
+//! while they’re written, a chunk at a time, so the memory used to write them
+//! doesn’t grow with their size.
+//!
+//! Because its data is located after everything else in the minidump file,
+//! this stream must be added to a MinidumpFileWriter after all other streams.
+class MinidumpMemory64ListWriter final : public internal::MinidumpStreamWriter {
+ public:
+  MinidumpMemory64ListWriter();
+  ~MinidumpMemory64ListWriter() override;
+
+  //! \brief Initializes a MINIDUMP_MEMORY64_LIST based on \a ranges.
+  //!
+  //! Overlapping and adjacent ranges are merged, and empty ranges are dropped.
+  //! Memory that can’t be read when the minidump file is written is filled
+  //! with `0xfe` bytes.
+  //!
+  //! \param[in] memory The memory of the process to read the ranges from. The
+  //!     caller retains ownership, and \a memory must outlive this object.
+  //! \param[in] ranges The ranges of memory to write, in any order.
+  //! \param[in] deadline The deadline of the capture that the minidump is
+  //!     written from. Once it has passed, memory is no longer read, and the
+  //!     rest of the contents are filled with `0xfe` bytes. The caller retains
+  //!     ownership, and \a deadline must outlive this object. Optional.
+  //!
+  //! \note Valid in #kStateMutable.
+  void InitializeFromRanges(const ProcessMemory* memory,
+                            const std::vector<CheckedRange<uint64_t>>& ranges,
+                            CaptureDeadline* deadline = nullptr);
+
+ protected:
+  // MinidumpWritable:
+  bool Freeze() override;
+  size_t SizeOfObject() override;
+  std::vector<internal::MinidumpWritable*> Children() override;
+  bool WriteObject(FileWriterInterface* file_writer) override;
+
+  // MinidumpStreamWriter:
+  MinidumpStreamType StreamType() const override;
+
+ private:
+  MINIDUMP_MEMORY64_LIST memory64_list_base_;
+  std::vector<MINIDUMP_MEMORY_DESCRIPTOR64> descriptors_;
+  std::unique_ptr<internal::MinidumpMemory64DataWriter> data_;
+
+  DISALLOW_COPY_AND_ASSIGN(MinidumpMemory64ListWriter);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_MINIDUMP_MINIDUMP_MEMORY64_WRITER_H_
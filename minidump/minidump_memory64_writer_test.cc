@@ -0,0 +1,195 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "minidump/minidump_memory64_writer.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "minidump/minidump_file_writer.h"
+#include "minidump/test/minidump_file_writer_test_util.h"
+#include "minidump/test/minidump_writable_test_util.h"
+#include "util/file/string_file.h"
+#include "util/misc/capture_deadline.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// Memory whose bytes are the low byte of their address, except for one page
+// that can’t be read.
+class PatternProcessMemory : public ProcessMemory {
+ public:
+  PatternProcessMemory(VMAddress unreadable_address, VMSize unreadable_size)
+      : ProcessMemory(),
+        unreadable_address_(unreadable_address),
+        unreadable_size_(unreadable_size) {}
+  ~PatternProcessMemory() {}
+
+ private:
+  ssize_t ReadUpTo(VMAddress address,
+                   size_t size,
+                   void* buffer) const override {
+    if (address < unreadable_address_ + unreadable_size_ &&
+        unreadable_address_ < address + size) {
+      return -1;
+    }
+
+    uint8_t* buffer_u8 = static_cast<uint8_t*>(buffer);
+    for (size_t index = 0; index < size; ++index) {
+      buffer_u8[index] = static_cast<uint8_t>(address + index);
+    }
+    return size;
+  }
+
+  VMAddress unreadable_address_;
+  VMSize unreadable_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(PatternProcessMemory);
+};
+
+// The memory64 list is expected to be the only stream.
+void GetMemory64ListStream(const std::string& file_contents,
+                           const MINIDUMP_MEMORY64_LIST** memory64_list) {
+  constexpr size_t kDirectoryOffset = sizeof(MINIDUMP_HEADER);
+  constexpr size_t kMemory64ListStreamOffset =
+      kDirectoryOffset + sizeof(MINIDUMP_DIRECTORY);
+
+  const MINIDUMP_DIRECTORY* directory;
+  const MINIDUMP_HEADER* header =
+      MinidumpHeaderAtStart(file_contents, &directory);
+  ASSERT_NO_FATAL_FAILURE(VerifyMinidumpHeader(header, 1, 0));
+  ASSERT_TRUE(directory);
+
+  ASSERT_EQ(directory[0].StreamType, kMinidumpStreamTypeMemory64List);
+  EXPECT_EQ(directory[0].Location.Rva, kMemory64ListStreamOffset);
+
+  *memory64_list = MinidumpWritableAtLocationDescriptor<MINIDUMP_MEMORY64_LIST>(
+      file_contents, directory[0].Location);
+  ASSERT_TRUE(*memory64_list);
+}
+
+TEST(MinidumpMemory64Writer, Empty) {
+  PatternProcessMemory memory(0, 0);
+  MinidumpFileWriter minidump_file_writer;
+  auto memory64_list_writer = std::make_unique<MinidumpMemory64ListWriter>();
+  memory64_list_writer->InitializeFromRanges(
+      &memory, std::vector<CheckedRange<uint64_t>>());
+  ASSERT_TRUE(minidump_file_writer.AddStream(std::move(memory64_list_writer)));
+
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+
+  ASSERT_EQ(string_file.string().size(),
+            sizeof(MINIDUMP_HEADER) + sizeof(MINIDUMP_DIRECTORY) +
+                sizeof(MINIDUMP_MEMORY64_LIST));
+
+  const MINIDUMP_MEMORY64_LIST* memory64_list = nullptr;
+  ASSERT_NO_FATAL_FAILURE(
+      GetMemory64ListStream(string_file.string(), &memory64_list));
+
+  EXPECT_EQ(memory64_list->NumberOfMemoryRanges, 0u);
+}
+
+TEST(MinidumpMemory64Writer, ContiguousDataWithUnreadablePage) {
+  constexpr uint64_t kUnreadableAddress = 0x121000;
+  constexpr uint64_t kUnreadableSize = 0x1000;
+  PatternProcessMemory memory(kUnreadableAddress, kUnreadableSize);
+
+  MinidumpFileWriter minidump_file_writer;
+  auto memory64_list_writer = std::make_unique<MinidumpMemory64ListWriter>();
+
+  // The second range is larger than the chunks that memory is read in, and
+  // one of those chunks contains the unreadable page.
+  const std::vector<CheckedRange<uint64_t>> ranges = {
+      {0x120000, 0x200010},
+      {0x10000, 0x2000},
+      {0x11000, 0x2000},  // Overlaps the previous range.
+      {0x30000, 0},  // Empty.
+  };
+  memory64_list_writer->InitializeFromRanges(&memory, ranges);
+  ASSERT_TRUE(minidump_file_writer.AddStream(std::move(memory64_list_writer)));
+
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+  const std::string& file_contents = string_file.string();
+
+  const MINIDUMP_MEMORY64_LIST* memory64_list = nullptr;
+  ASSERT_NO_FATAL_FAILURE(GetMemory64ListStream(file_contents, &memory64_list));
+
+  ASSERT_EQ(memory64_list->NumberOfMemoryRanges, 2u);
+  EXPECT_EQ(memory64_list->MemoryRanges[0].StartOfMemoryRange, 0x10000u);
+  EXPECT_EQ(memory64_list->MemoryRanges[0].DataSize, 0x3000u);
+  EXPECT_EQ(memory64_list->MemoryRanges[1].StartOfMemoryRange, 0x120000u);
+  EXPECT_EQ(memory64_list->MemoryRanges[1].DataSize, 0x200010u);
+
+  // The contents of both ranges follow one another at the end of the file.
+  const uint64_t base_rva = memory64_list->BaseRva;
+  EXPECT_EQ(base_rva % 16, 0u);
+  ASSERT_EQ(file_contents.size(), base_rva + 0x3000 + 0x200010);
+
+  uint64_t offset = base_rva;
+  for (size_t index = 0; index < memory64_list->NumberOfMemoryRanges;
+       ++index) {
+    const MINIDUMP_MEMORY_DESCRIPTOR64& descriptor =
+        memory64_list->MemoryRanges[index];
+    for (uint64_t address = descriptor.StartOfMemoryRange;
+         address < descriptor.StartOfMemoryRange + descriptor.DataSize;
+         ++address, ++offset) {
+      const uint8_t expected =
+          address >= kUnreadableAddress &&
+                  address < kUnreadableAddress + kUnreadableSize
+              ? 0xfe
+              : static_cast<uint8_t>(address);
+      ASSERT_EQ(static_cast<uint8_t>(file_contents[offset]), expected)
+          << "address 0x" << std::hex << address;
+    }
+  }
+}
+
+TEST(MinidumpMemory64Writer, ExpiredDeadline) {
+  PatternProcessMemory memory(0, 0);
+  CaptureDeadline deadline(1);
+  while (deadline.ElapsedNanoseconds() < 1) {
+  }
+
+  MinidumpFileWriter minidump_file_writer;
+  auto memory64_list_writer = std::make_unique<MinidumpMemory64ListWriter>();
+  memory64_list_writer->InitializeFromRanges(
+      &memory, {{0x10000, 0x2000}}, &deadline);
+  ASSERT_TRUE(minidump_file_writer.AddStream(std::move(memory64_list_writer)));
+
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+  const std::string& file_contents = string_file.string();
+
+  const MINIDUMP_MEMORY64_LIST* memory64_list = nullptr;
+  ASSERT_NO_FATAL_FAILURE(GetMemory64ListStream(file_contents, &memory64_list));
+
+  // The range is still described, but its contents aren’t read.
+  ASSERT_EQ(memory64_list->NumberOfMemoryRanges, 1u);
+  EXPECT_EQ(memory64_list->MemoryRanges[0].DataSize, 0x2000u);
+  ASSERT_EQ(file_contents.size(), memory64_list->BaseRva + 0x2000);
+  EXPECT_EQ(file_contents.substr(memory64_list->BaseRva),
+            std::string(0x2000, '\xfe'));
+  EXPECT_EQ(deadline.TruncatedPhases(),
+            static_cast<uint32_t>(CaptureDeadline::kPhaseSerialization));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -14,8 +14,11 @@
 
 #include "minidump/minidump_memory_writer.h"
 
+#include <string.h>
+
 #include <algorithm>
 #include <iterator>
+#include <map>
 #include <utility>
 
 #include "base/auto_reset.h"
@@ -25,12 +28,66 @@
 
 namespace crashpad {
 
+namespace {
+
+class MemoryReadDelegate final : public MemorySnapshot::Delegate {
+ public:
+  explicit MemoryReadDelegate(std::vector<uint8_t>* contents)
+      : contents_(contents) {}
+  ~MemoryReadDelegate() {}
+
+  // MemorySnapshot::Delegate:
+  bool MemorySnapshotDelegateRead(void* data, size_t size) override {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    contents_->assign(bytes, bytes + size);
+    return true;
+  }
+
+ private:
+  std::vector<uint8_t>* contents_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(MemoryReadDelegate);
+};
+
+bool ReadMemorySnapshot(const MemorySnapshot& memory_snapshot,
+                        std::vector<uint8_t>* contents) {
+  contents->clear();
+  MemoryReadDelegate delegate(contents);
+  return memory_snapshot.Read(&delegate) &&
+         contents->size() == memory_snapshot.Size();
+}
+
+// The most memory that ShareIdenticalMemory() keeps for comparisons among
+// regions of any one size.
+constexpr size_t kMaxOriginalContentsSize = 32 * 1024 * 1024;
+
+// A 64-bit FNV-1a hash, computed a word at a time.
+uint64_t HashMemory(const std::vector<uint8_t>& contents) {
+  constexpr uint64_t kPrime = 0x100000001b3;
+  uint64_t hash = 0xcbf29ce484222325;
+  size_t offset = 0;
+  for (; offset + sizeof(uint64_t) <= contents.size();
+       offset += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, &contents[offset], sizeof(word));
+    hash = (hash ^ word) * kPrime;
+  }
+  for (; offset < contents.size(); ++offset) {
+    hash = (hash ^ contents[offset]) * kPrime;
+  }
+  return hash;
+}
+
+}  // namespace
+
 SnapshotMinidumpMemoryWriter::SnapshotMinidumpMemoryWriter(
     const MemorySnapshot* memory_snapshot)
     : internal::MinidumpWritable(),
       MemorySnapshot::Delegate(),
       memory_descriptor_(),
       registered_memory_descriptors_(),
+      sharing_writers_(),
+      original_(nullptr),
       memory_snapshot_(memory_snapshot),
       file_writer_(nullptr) {}
 
@@ -48,6 +105,11 @@ bool SnapshotMinidumpMemoryWriter::WriteObject(
   DCHECK_EQ(state(), kStateWritable);
   DCHECK(!file_writer_);
 
+  // The data is written by the original.
+  if (original_) {
+    return true;
+  }
+
   base::AutoReset<FileWriterInterface*> file_writer_reset(&file_writer_,
                                                           file_writer);
 
@@ -76,8 +138,24 @@ void SnapshotMinidumpMemoryWriter::RegisterMemoryDescriptor(
     MINIDUMP_MEMORY_DESCRIPTOR* memory_descriptor) {
   DCHECK_LE(state(), kStateFrozen);
 
+  // The location of the data isn’t registered with RegisterLocationDescriptor()
+  // because it may be written by another object. WillWriteAtOffsetImpl() sets
+  // it instead.
   registered_memory_descriptors_.push_back(memory_descriptor);
-  RegisterLocationDescriptor(&memory_descriptor->Memory);
+}
+
+void SnapshotMinidumpMemoryWriter::ShareDataWith(
+    SnapshotMinidumpMemoryWriter* original) {
+  DCHECK_LE(state(), kStateFrozen);
+  DCHECK_NE(original, this);
+  DCHECK(!original->original_);
+  DCHECK(!original_);
+  DCHECK(sharing_writers_.empty());
+  DCHECK_EQ(original->UnderlyingSnapshot()->Size(),
+            UnderlyingSnapshot()->Size());
+
+  original_ = original;
+  original->sharing_writers_.push_back(this);
 }
 
 bool SnapshotMinidumpMemoryWriter::Freeze() {
@@ -101,7 +179,7 @@ size_t SnapshotMinidumpMemoryWriter::Alignment() {
 size_t SnapshotMinidumpMemoryWriter::SizeOfObject() {
   DCHECK_GE(state(), kStateFrozen);
 
-  return UnderlyingSnapshot()->Size();
+  return original_ ? 0 : UnderlyingSnapshot()->Size();
 }
 
 bool SnapshotMinidumpMemoryWriter::WillWriteAtOffsetImpl(FileOffset offset) {
@@ -123,6 +201,32 @@ bool SnapshotMinidumpMemoryWriter::WillWriteAtOffsetImpl(FileOffset offset) {
     memory_descriptor->StartOfMemoryRange = local_address;
   }
 
+  // Writers sharing this object’s data have their locations set here, because
+  // they don’t write anything of their own.
+  if (!original_) {
+    MINIDUMP_LOCATION_DESCRIPTOR location;
+    if (!AssignIfInRange(&location.Rva, offset)) {
+      LOG(ERROR) << "offset " << offset << " out of range";
+      return false;
+    }
+    if (!AssignIfInRange(&location.DataSize, UnderlyingSnapshot()->Size())) {
+      LOG(ERROR) << "size " << UnderlyingSnapshot()->Size() << " out of range";
+      return false;
+    }
+
+    for (MINIDUMP_MEMORY_DESCRIPTOR* memory_descriptor :
+             registered_memory_descriptors_) {
+      memory_descriptor->Memory = location;
+    }
+    for (const SnapshotMinidumpMemoryWriter* sharing_writer :
+             sharing_writers_) {
+      for (MINIDUMP_MEMORY_DESCRIPTOR* memory_descriptor :
+               sharing_writer->registered_memory_descriptors_) {
+        memory_descriptor->Memory = location;
+      }
+    }
+  }
+
   return MinidumpWritable::WillWriteAtOffsetImpl(offset);
 }
 
@@ -230,6 +334,8 @@ bool MinidumpMemoryListWriter::Freeze() {
   for (const auto& ptr : children_)
     all_memory_writers_.push_back(ptr.get());
 
+  ShareIdenticalMemory();
+
   if (!MinidumpStreamWriter::Freeze()) {
     return false;
   }
@@ -308,4 +414,62 @@ void MinidumpMemoryListWriter::DropRangesThatOverlapNonOwned() {
   std::swap(children_, non_overlapping);
 }
 
+void MinidumpMemoryListWriter::ShareIdenticalMemory() {
+  // Only memory of the same size can be identical, so only the contents of
+  // writers whose size matches another writer’s need to be read.
+  std::map<size_t, std::vector<SnapshotMinidumpMemoryWriter*>> writers_by_size;
+  for (SnapshotMinidumpMemoryWriter* writer : all_memory_writers_) {
+    const size_t size = writer->UnderlyingSnapshot()->Size();
+    if (size) {
+      writers_by_size[size].push_back(writer);
+    }
+  }
+
+  std::vector<uint8_t> contents;
+  for (const auto& same_size : writers_by_size) {
+    const std::vector<SnapshotMinidumpMemoryWriter*>& writers =
+        same_size.second;
+    if (writers.size() < 2) {
+      continue;
+    }
+
+    // Each writer’s memory is read once. The contents of the originals are
+    // kept, so that hash matches can be confirmed without reading them again.
+    // Once kMaxOriginalContentsSize is reached, later writers may still share
+    // the data of originals already kept, but don’t become originals.
+    std::vector<std::pair<SnapshotMinidumpMemoryWriter*, std::vector<uint8_t>>>
+        originals;
+    std::multimap<uint64_t, size_t> original_indices_by_hash;
+    size_t original_contents_size = 0;
+    for (SnapshotMinidumpMemoryWriter* writer : writers) {
+      if (writer->original_ ||
+          !ReadMemorySnapshot(*writer->UnderlyingSnapshot(), &contents)) {
+        continue;
+      }
+
+      const uint64_t hash = HashMemory(contents);
+      bool shared = false;
+      const auto candidates = original_indices_by_hash.equal_range(hash);
+      for (auto candidate = candidates.first; candidate != candidates.second;
+           ++candidate) {
+        // The hash only identifies likely matches. Compare the contents before
+        // sharing them.
+        const auto& original = originals[candidate->second];
+        if (original.second == contents) {
+          writer->ShareDataWith(original.first);
+          shared = true;
+          break;
+        }
+      }
+
+      if (!shared && contents.size() <=
+                         kMaxOriginalContentsSize - original_contents_size) {
+        original_contents_size += contents.size();
+        original_indices_by_hash.insert(std::make_pair(hash, originals.size()));
+        originals.push_back(std::make_pair(writer, std::move(contents)));
+      }
+    }
+  }
+}
+
 }  // namespace crashpad
@@ -105,10 +105,22 @@ class SnapshotMinidumpMemoryWriter : public internal::MinidumpWritable,
   //!     write to the minidump.
   const MemorySnapshot* UnderlyingSnapshot() const { return memory_snapshot_; }
 
+  //! \brief Makes this object’s memory descriptors point to the data written
+  //!     by \a original instead of writing its own copy.
+  //!
+  //! The caller must ensure that \a original writes data that is identical to
+  //! this object’s. MINIDUMP_MEMORY_DESCRIPTOR::StartOfMemoryRange will still
+  //! be set to this object’s address.
+  //!
+  //! \note Valid in #kStateFrozen or any preceding state.
+  void ShareDataWith(SnapshotMinidumpMemoryWriter* original);
+
   MINIDUMP_MEMORY_DESCRIPTOR memory_descriptor_;
 
   // weak
   std::vector<MINIDUMP_MEMORY_DESCRIPTOR*> registered_memory_descriptors_;
+  std::vector<SnapshotMinidumpMemoryWriter*> sharing_writers_;  // weak
+  SnapshotMinidumpMemoryWriter* original_;  // weak
   const MemorySnapshot* memory_snapshot_;
   FileWriterInterface* file_writer_;
 
@@ -191,6 +203,15 @@ class MinidumpMemoryListWriter final : public internal::MinidumpStreamWriter {
   //! \brief Drops children_ ranges that overlap non_owned_memory_writers_.
   void DropRangesThatOverlapNonOwned();
 
+  //! \brief Arranges for memory writers with byte-identical contents to write
+  //!     a single copy of their data, which all of their memory descriptors
+  //!     point to.
+  //!
+  //! This is expected to be called from Freeze(), after all_memory_writers_ is
+  //! populated. Thread pools often have many idle threads whose stacks are
+  //! identical, so this can significantly reduce the size of a minidump.
+  void ShareIdenticalMemory();
+
   std::vector<SnapshotMinidumpMemoryWriter*> non_owned_memory_writers_;  // weak
   std::vector<std::unique_ptr<SnapshotMinidumpMemoryWriter>> children_;
   std::vector<std::unique_ptr<const MemorySnapshot>>
@@ -394,6 +394,110 @@ TEST(MinidumpMemoryWriter, AddFromSnapshot) {
   }
 }
 
+TEST(MinidumpMemoryWriter, IdenticalMemoryShared) {
+  MinidumpFileWriter minidump_file_writer;
+  auto memory_list_writer = std::make_unique<MinidumpMemoryListWriter>();
+
+  // The first two regions have the same contents, so only one copy should be
+  // written, with both descriptors pointing to it.
+  constexpr uint64_t kBaseAddress0 = 0x1000;
+  constexpr uint64_t kBaseAddress1 = 0x5000;
+  constexpr uint64_t kBaseAddress2 = 0x9000;
+  constexpr size_t kSize = 0x0100;
+  constexpr uint8_t kValue0 = 's';
+  constexpr uint8_t kValue2 = 'd';
+
+  memory_list_writer->AddMemory(std::make_unique<TestMinidumpMemoryWriter>(
+      kBaseAddress0, kSize, kValue0));
+  memory_list_writer->AddMemory(std::make_unique<TestMinidumpMemoryWriter>(
+      kBaseAddress1, kSize, kValue0));
+  memory_list_writer->AddMemory(std::make_unique<TestMinidumpMemoryWriter>(
+      kBaseAddress2, kSize, kValue2));
+
+  ASSERT_TRUE(minidump_file_writer.AddStream(std::move(memory_list_writer)));
+
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+
+  const MINIDUMP_MEMORY_LIST* memory_list = nullptr;
+  ASSERT_NO_FATAL_FAILURE(
+      GetMemoryListStream(string_file.string(), &memory_list, 1));
+
+  ASSERT_EQ(memory_list->NumberOfMemoryRanges, 3u);
+
+  MINIDUMP_MEMORY_DESCRIPTOR expected;
+  expected.Memory.DataSize = kSize;
+  expected.Memory.Rva =
+      sizeof(MINIDUMP_HEADER) + sizeof(MINIDUMP_DIRECTORY) +
+      sizeof(MINIDUMP_MEMORY_LIST) +
+      memory_list->NumberOfMemoryRanges * sizeof(MINIDUMP_MEMORY_DESCRIPTOR);
+
+  {
+    SCOPED_TRACE("region 0");
+
+    expected.StartOfMemoryRange = kBaseAddress0;
+    ExpectMinidumpMemoryDescriptorAndContents(&expected,
+                                              &memory_list->MemoryRanges[0],
+                                              string_file.string(),
+                                              kValue0,
+                                              false);
+  }
+
+  {
+    SCOPED_TRACE("region 1");
+
+    expected.StartOfMemoryRange = kBaseAddress1;
+    ExpectMinidumpMemoryDescriptorAndContents(&expected,
+                                              &memory_list->MemoryRanges[1],
+                                              string_file.string(),
+                                              kValue0,
+                                              false);
+  }
+
+  {
+    SCOPED_TRACE("region 2");
+
+    expected.StartOfMemoryRange = kBaseAddress2;
+    expected.Memory.Rva = memory_list->MemoryRanges[0].Memory.Rva + kSize;
+    ExpectMinidumpMemoryDescriptorAndContents(&expected,
+                                              &memory_list->MemoryRanges[2],
+                                              string_file.string(),
+                                              kValue2,
+                                              true);
+  }
+}
+
+TEST(MinidumpMemoryWriter, IdenticalMemoryReadOnce) {
+  // Three regions of the same size, two of them identical.
+  constexpr uint8_t kValues[] = {'s', 's', 'd'};
+  std::vector<std::unique_ptr<TestMemorySnapshot>> memory_snapshots_owner;
+  std::vector<const MemorySnapshot*> memory_snapshots;
+  for (size_t index = 0; index < base::size(kValues); ++index) {
+    memory_snapshots_owner.push_back(std::make_unique<TestMemorySnapshot>());
+    TestMemorySnapshot* memory_snapshot = memory_snapshots_owner.back().get();
+    memory_snapshot->SetAddress(0x1000 + index * 0x4000);
+    memory_snapshot->SetSize(0x100);
+    memory_snapshot->SetValue(kValues[index]);
+    memory_snapshots.push_back(memory_snapshot);
+  }
+
+  auto memory_list_writer = std::make_unique<MinidumpMemoryListWriter>();
+  memory_list_writer->AddFromSnapshot(memory_snapshots);
+
+  MinidumpFileWriter minidump_file_writer;
+  ASSERT_TRUE(minidump_file_writer.AddStream(std::move(memory_list_writer)));
+
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+
+  // Each region is read once to look for identical memory, and the regions
+  // that are written are read again to write them. Confirming the match
+  // doesn’t read the first region again.
+  EXPECT_EQ(memory_snapshots_owner[0]->read_count(), 2u);
+  EXPECT_EQ(memory_snapshots_owner[1]->read_count(), 1u);
+  EXPECT_EQ(memory_snapshots_owner[2]->read_count(), 2u);
+}
+
 TEST(MinidumpMemoryWriter, CoalesceExplicitMultiple) {
   MINIDUMP_MEMORY_DESCRIPTOR expect_memory_descriptors[4] = {};
   uint8_t values[base::size(expect_memory_descriptors)] = {};
@@ -0,0 +1,112 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "minidump/minidump_omitted_memory_writer.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "util/file/file_writer.h"
+#include "util/numeric/safe_assignment.h"
+
+namespace crashpad {
+
+MinidumpOmittedMemoryListWriter::MinidumpOmittedMemoryListWriter()
+    : omitted_memory_list_base_(), ranges_() {}
+
+MinidumpOmittedMemoryListWriter::~MinidumpOmittedMemoryListWriter() {}
+
+void MinidumpOmittedMemoryListWriter::InitializeFromRanges(
+    const std::vector<CheckedRange<uint64_t>>& ranges) {
+  DCHECK_EQ(state(), kStateMutable);
+  DCHECK(ranges_.empty());
+
+  std::vector<CheckedRange<uint64_t>> sorted_ranges;
+  for (const auto& range : ranges) {
+    if (range.IsValid() && range.size() != 0) {
+      sorted_ranges.push_back(range);
+    }
+  }
+  std::sort(sorted_ranges.begin(),
+            sorted_ranges.end(),
+            [](const CheckedRange<uint64_t>& lhs,
+               const CheckedRange<uint64_t>& rhs) {
+              return lhs.base() < rhs.base();
+            });
+
+  for (const auto& range : sorted_ranges) {
+    if (!ranges_.empty() &&
+        range.base() <= ranges_.back().base + ranges_.back().size) {
+      MinidumpOmittedMemoryDescriptor& last = ranges_.back();
+      last.size = std::max(last.base + last.size, range.end()) - last.base;
+      continue;
+    }
+
+    MinidumpOmittedMemoryDescriptor descriptor;
+    descriptor.base = range.base();
+    descriptor.size = range.size();
+    ranges_.push_back(descriptor);
+  }
+}
+
+bool MinidumpOmittedMemoryListWriter::Freeze() {
+  DCHECK_EQ(state(), kStateMutable);
+
+  if (!MinidumpStreamWriter::Freeze()) {
+    return false;
+  }
+
+  if (!AssignIfInRange(&omitted_memory_list_base_.count, ranges_.size())) {
+    LOG(ERROR) << "count " << ranges_.size() << " out of range";
+    return false;
+  }
+
+  return true;
+}
+
+size_t MinidumpOmittedMemoryListWriter::SizeOfObject() {
+  DCHECK_GE(state(), kStateFrozen);
+  return sizeof(omitted_memory_list_base_) +
+         ranges_.size() * sizeof(MinidumpOmittedMemoryDescriptor);
+}
+
+std::vector<internal::MinidumpWritable*>
+MinidumpOmittedMemoryListWriter::Children() {
+  DCHECK_GE(state(), kStateFrozen);
+  return std::vector<internal::MinidumpWritable*>();
+}
+
+bool MinidumpOmittedMemoryListWriter::WriteObject(
+    FileWriterInterface* file_writer) {
+  DCHECK_EQ(state(), kStateWritable);
+
+  WritableIoVec iov;
+  iov.iov_base = &omitted_memory_list_base_;
+  iov.iov_len = sizeof(omitted_memory_list_base_);
+  std::vector<WritableIoVec> iovecs(1, iov);
+
+  if (!ranges_.empty()) {
+    iov.iov_base = &ranges_[0];
+    iov.iov_len = ranges_.size() * sizeof(MinidumpOmittedMemoryDescriptor);
+    iovecs.push_back(iov);
+  }
+
+  return file_writer->WriteIoVec(&iovecs);
+}
+
+MinidumpStreamType MinidumpOmittedMemoryListWriter::StreamType() const {
+  return kMinidumpStreamTypeCrashpadOmittedMemoryList;
+}
+
+}  // namespace crashpad
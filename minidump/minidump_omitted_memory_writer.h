@@ -0,0 +1,68 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_MINIDUMP_MINIDUMP_OMITTED_MEMORY_WRITER_H_
+#define CRASHPAD_MINIDUMP_MINIDUMP_OMITTED_MEMORY_WRITER_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <vector>
+
+#include "base/macros.h"
+#include "minidump/minidump_extensions.h"
+#include "minidump/minidump_stream_writer.h"
+#include "minidump/minidump_writable.h"
+#include "util/numeric/checked_range.h"
+
+namespace crashpad {
+
+//! \brief The writer for a MinidumpOmittedMemoryList stream in a minidump
+//!     file.
+class MinidumpOmittedMemoryListWriter final
+    : public internal::MinidumpStreamWriter {
+ public:
+  MinidumpOmittedMemoryListWriter();
+  ~MinidumpOmittedMemoryListWriter() override;
+
+  //! \brief Initializes a MinidumpOmittedMemoryList based on \a ranges.
+  //!
+  //! Overlapping and adjacent ranges are merged, and empty ranges are dropped.
+  //!
+  //! \param[in] ranges The ranges of memory that were omitted from the
+  //!     minidump, in any order.
+  //!
+  //! \note Valid in #kStateMutable.
+  void InitializeFromRanges(const std::vector<CheckedRange<uint64_t>>& ranges);
+
+ protected:
+  // MinidumpWritable:
+  bool Freeze() override;
+  size_t SizeOfObject() override;
+  std::vector<internal::MinidumpWritable*> Children() override;
+  bool WriteObject(FileWriterInterface* file_writer) override;
+
+  // MinidumpStreamWriter:
+  MinidumpStreamType StreamType() const override;
+
+ private:
+  MinidumpOmittedMemoryList omitted_memory_list_base_;
+  std::vector<MinidumpOmittedMemoryDescriptor> ranges_;
+
+  DISALLOW_COPY_AND_ASSIGN(MinidumpOmittedMemoryListWriter);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_MINIDUMP_MINIDUMP_OMITTED_MEMORY_WRITER_H_
@@ -0,0 +1,119 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "minidump/minidump_omitted_memory_writer.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "minidump/minidump_file_writer.h"
+#include "minidump/test/minidump_file_writer_test_util.h"
+#include "minidump/test/minidump_writable_test_util.h"
+#include "util/file/string_file.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// The omitted memory list is expected to be the only stream.
+void GetOmittedMemoryListStream(
+    const std::string& file_contents,
+    const MinidumpOmittedMemoryList** omitted_memory_list) {
+  constexpr size_t kDirectoryOffset = sizeof(MINIDUMP_HEADER);
+  constexpr size_t kOmittedMemoryListStreamOffset =
+      kDirectoryOffset + sizeof(MINIDUMP_DIRECTORY);
+
+  const MINIDUMP_DIRECTORY* directory;
+  const MINIDUMP_HEADER* header =
+      MinidumpHeaderAtStart(file_contents, &directory);
+  ASSERT_NO_FATAL_FAILURE(VerifyMinidumpHeader(header, 1, 0));
+  ASSERT_TRUE(directory);
+
+  ASSERT_EQ(directory[0].StreamType,
+            kMinidumpStreamTypeCrashpadOmittedMemoryList);
+  EXPECT_EQ(directory[0].Location.Rva, kOmittedMemoryListStreamOffset);
+
+  *omitted_memory_list =
+      MinidumpWritableAtLocationDescriptor<MinidumpOmittedMemoryList>(
+          file_contents, directory[0].Location);
+  ASSERT_TRUE(*omitted_memory_list);
+}
+
+TEST(MinidumpOmittedMemoryWriter, Empty) {
+  MinidumpFileWriter minidump_file_writer;
+  auto omitted_memory_list_writer =
+      std::make_unique<MinidumpOmittedMemoryListWriter>();
+  ASSERT_TRUE(
+      minidump_file_writer.AddStream(std::move(omitted_memory_list_writer)));
+
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+
+  ASSERT_EQ(string_file.string().size(),
+            sizeof(MINIDUMP_HEADER) + sizeof(MINIDUMP_DIRECTORY) +
+                sizeof(MinidumpOmittedMemoryList));
+
+  const MinidumpOmittedMemoryList* omitted_memory_list = nullptr;
+  ASSERT_NO_FATAL_FAILURE(
+      GetOmittedMemoryListStream(string_file.string(), &omitted_memory_list));
+
+  EXPECT_EQ(omitted_memory_list->count, 0u);
+}
+
+TEST(MinidumpOmittedMemoryWriter, SortsAndMergesRanges) {
+  MinidumpFileWriter minidump_file_writer;
+  auto omitted_memory_list_writer =
+      std::make_unique<MinidumpOmittedMemoryListWriter>();
+
+  const std::vector<CheckedRange<uint64_t>> ranges = {
+      {0x30000, 0x1000},
+      {0x10000, 0x2000},
+      {0x11000, 0x4000},  // Overlaps the previous range.
+      {0x15000, 0x1000},  // Adjacent to the merged range.
+      {0x20000, 0},  // Empty.
+      {0x31000, 0x800},  // Adjacent to the first range.
+      {0x40000, 0x10},
+  };
+  omitted_memory_list_writer->InitializeFromRanges(ranges);
+  ASSERT_TRUE(
+      minidump_file_writer.AddStream(std::move(omitted_memory_list_writer)));
+
+  StringFile string_file;
+  ASSERT_TRUE(minidump_file_writer.WriteEverything(&string_file));
+
+  constexpr size_t kExpectedRanges = 3;
+  ASSERT_EQ(string_file.string().size(),
+            sizeof(MINIDUMP_HEADER) + sizeof(MINIDUMP_DIRECTORY) +
+                sizeof(MinidumpOmittedMemoryList) +
+                kExpectedRanges * sizeof(MinidumpOmittedMemoryDescriptor));
+
+  const MinidumpOmittedMemoryList* omitted_memory_list = nullptr;
+  ASSERT_NO_FATAL_FAILURE(
+      GetOmittedMemoryListStream(string_file.string(), &omitted_memory_list));
+
+  ASSERT_EQ(omitted_memory_list->count, kExpectedRanges);
+  EXPECT_EQ(omitted_memory_list->ranges[0].base, 0x10000u);
+  EXPECT_EQ(omitted_memory_list->ranges[0].size, 0x6000u);
+  EXPECT_EQ(omitted_memory_list->ranges[1].base, 0x30000u);
+  EXPECT_EQ(omitted_memory_list->ranges[1].size, 0x1800u);
+  EXPECT_EQ(omitted_memory_list->ranges[2].base, 0x40000u);
+  EXPECT_EQ(omitted_memory_list->ranges[2].size, 0x10u);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
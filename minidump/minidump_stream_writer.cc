@@ -28,6 +28,13 @@ const MINIDUMP_DIRECTORY* MinidumpStreamWriter::DirectoryListEntry() const {
   return &directory_list_entry_;
 }
 
+bool MinidumpStreamWriter::WriteUpdate(FileWriterInterface* file_writer,
+                                       FileOffset start_offset) {
+  DCHECK_EQ(state(), kStateWritten);
+
+  return true;
+}
+
 MinidumpStreamWriter::MinidumpStreamWriter()
     : MinidumpWritable(), directory_list_entry_() {
 }
@@ -48,6 +48,25 @@ class MinidumpStreamWriter : public MinidumpWritable {
   //! \note Valid only in #kStateWritable.
   const MINIDUMP_DIRECTORY* DirectoryListEntry() const;
 
+  //! \brief Rewrites the stream after the entire minidump file has been
+  //!     written.
+  //!
+  //! This allows a stream to record state that changed while later parts of
+  //! the file were written. MinidumpFileWriter calls this for each of its
+  //! streams if it was able to seek in the file. The default implementation
+  //! does nothing.
+  //!
+  //! \param[in] file_writer The file that the minidump was written to.
+  //! \param[in] start_offset The offset in \a file_writer at which the
+  //!     minidump starts.
+  //!
+  //! \return `true` on success. `false` on failure, with an appropriate
+  //!     message logged.
+  //!
+  //! \note Valid only in #kStateWritten.
+  virtual bool WriteUpdate(FileWriterInterface* file_writer,
+                           FileOffset start_offset);
+
  protected:
   MinidumpStreamWriter();
 
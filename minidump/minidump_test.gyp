@@ -66,16 +66,19 @@
       'sources': [
         'minidump_annotation_writer_test.cc',
         'minidump_byte_array_writer_test.cc',
+        'minidump_capture_truncation_writer_test.cc',
         'minidump_context_writer_test.cc',
         'minidump_crashpad_info_writer_test.cc',
         'minidump_exception_writer_test.cc',
         'minidump_file_writer_test.cc',
         'minidump_handle_writer_test.cc',
+        'minidump_memory64_writer_test.cc',
         'minidump_memory_info_writer_test.cc',
         'minidump_memory_writer_test.cc',
         'minidump_misc_info_writer_test.cc',
         'minidump_module_crashpad_info_writer_test.cc',
         'minidump_module_writer_test.cc',
+        'minidump_omitted_memory_writer_test.cc',
         'minidump_rva_list_writer_test.cc',
         'minidump_simple_string_dictionary_writer_test.cc',
         'minidump_string_writer_test.cc',
@@ -167,6 +167,14 @@ struct MinidumpMemoryListTraits {
   }
 };
 
+struct MinidumpMemory64ListTraits {
+  using ListType = MINIDUMP_MEMORY64_LIST;
+  enum : size_t { kElementSize = sizeof(MINIDUMP_MEMORY_DESCRIPTOR64) };
+  static size_t ElementCount(const ListType* list) {
+    return static_cast<size_t>(list->NumberOfMemoryRanges);
+  }
+};
+
 struct MinidumpModuleListTraits {
   using ListType = MINIDUMP_MODULE_LIST;
   enum : size_t { kElementSize = sizeof(MINIDUMP_MODULE) };
@@ -225,6 +233,12 @@ struct MinidumpAnnotationListObjectsTraits {
   static size_t ElementCount(const ListType* list) { return list->count; }
 };
 
+struct MinidumpOmittedMemoryListTraits {
+  using ListType = MinidumpOmittedMemoryList;
+  enum : size_t { kElementSize = sizeof(MinidumpOmittedMemoryDescriptor) };
+  static size_t ElementCount(const ListType* list) { return list->count; }
+};
+
 template <typename T>
 const typename T::ListType* MinidumpListAtLocationDescriptor(
     const std::string& file_contents,
@@ -257,6 +271,15 @@ MinidumpWritableAtLocationDescriptor<MINIDUMP_MEMORY_LIST>(
       file_contents, location);
 }
 
+template <>
+const MINIDUMP_MEMORY64_LIST*
+MinidumpWritableAtLocationDescriptor<MINIDUMP_MEMORY64_LIST>(
+    const std::string& file_contents,
+    const MINIDUMP_LOCATION_DESCRIPTOR& location) {
+  return MinidumpListAtLocationDescriptor<MinidumpMemory64ListTraits>(
+      file_contents, location);
+}
+
 template <>
 const MINIDUMP_MODULE_LIST*
 MinidumpWritableAtLocationDescriptor<MINIDUMP_MODULE_LIST>(
@@ -329,6 +352,15 @@ MinidumpWritableAtLocationDescriptor<MinidumpAnnotationList>(
       file_contents, location);
 }
 
+template <>
+const MinidumpOmittedMemoryList*
+MinidumpWritableAtLocationDescriptor<MinidumpOmittedMemoryList>(
+    const std::string& file_contents,
+    const MINIDUMP_LOCATION_DESCRIPTOR& location) {
+  return MinidumpListAtLocationDescriptor<MinidumpOmittedMemoryListTraits>(
+      file_contents, location);
+}
+
 namespace {
 
 template <typename T>
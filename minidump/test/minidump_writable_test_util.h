@@ -88,6 +88,7 @@ MINIDUMP_ALLOW_OVERSIZED_DATA(MINIDUMP_DIRECTORY);
 // These types are permitted to be oversized because their final fields are
 // variable-sized lists.
 MINIDUMP_ALLOW_OVERSIZED_DATA(MINIDUMP_MEMORY_LIST);
+MINIDUMP_ALLOW_OVERSIZED_DATA(MINIDUMP_MEMORY64_LIST);
 MINIDUMP_ALLOW_OVERSIZED_DATA(MINIDUMP_MODULE_LIST);
 MINIDUMP_ALLOW_OVERSIZED_DATA(MINIDUMP_UNLOADED_MODULE_LIST);
 MINIDUMP_ALLOW_OVERSIZED_DATA(MINIDUMP_THREAD_LIST);
@@ -97,6 +98,7 @@ MINIDUMP_ALLOW_OVERSIZED_DATA(MinidumpModuleCrashpadInfoList);
 MINIDUMP_ALLOW_OVERSIZED_DATA(MinidumpRVAList);
 MINIDUMP_ALLOW_OVERSIZED_DATA(MinidumpSimpleStringDictionary);
 MINIDUMP_ALLOW_OVERSIZED_DATA(MinidumpAnnotationList);
+MINIDUMP_ALLOW_OVERSIZED_DATA(MinidumpOmittedMemoryList);
 
 // These types have final fields carrying variable-sized data (typically string
 // data).
@@ -185,6 +187,12 @@ MinidumpWritableAtLocationDescriptor<MINIDUMP_MEMORY_LIST>(
     const std::string& file_contents,
     const MINIDUMP_LOCATION_DESCRIPTOR& location);
 
+template <>
+const MINIDUMP_MEMORY64_LIST*
+MinidumpWritableAtLocationDescriptor<MINIDUMP_MEMORY64_LIST>(
+    const std::string& file_contents,
+    const MINIDUMP_LOCATION_DESCRIPTOR& location);
+
 template <>
 const MINIDUMP_MODULE_LIST*
 MinidumpWritableAtLocationDescriptor<MINIDUMP_MODULE_LIST>(
@@ -251,6 +259,12 @@ MinidumpWritableAtLocationDescriptor<MinidumpAnnotationList>(
     const std::string& file_contents,
     const MINIDUMP_LOCATION_DESCRIPTOR& location);
 
+template <>
+const MinidumpOmittedMemoryList*
+MinidumpWritableAtLocationDescriptor<MinidumpOmittedMemoryList>(
+    const std::string& file_contents,
+    const MINIDUMP_LOCATION_DESCRIPTOR& location);
+
 //! \brief Returns a typed minidump object located within a minidump file’s
 //!     contents, where the offset of the object is known.
 //!
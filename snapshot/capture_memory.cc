@@ -17,7 +17,6 @@
 #include <stdint.h>
 
 #include <limits>
-#include <memory>
 
 #include "base/stl_util.h"
 #include "snapshot/memory_snapshot.h"
@@ -118,7 +117,8 @@ void CaptureMemory::PointedToByContext(const CPUContext& context,
 
 // static
 void CaptureMemory::PointedToByMemoryRange(const MemorySnapshot& memory,
-                                           Delegate* delegate) {
+                                           Delegate* delegate,
+                                           std::vector<uint8_t>* scan_buffer) {
   if (memory.Size() == 0)
     return;
 
@@ -129,16 +129,21 @@ void CaptureMemory::PointedToByMemoryRange(const MemorySnapshot& memory,
     return;
   }
 
-  std::unique_ptr<uint8_t[]> buffer(new uint8_t[memory.Size()]);
-  if (!delegate->ReadMemory(memory.Address(), memory.Size(), buffer.get())) {
+  std::vector<uint8_t> local_buffer;
+  if (!scan_buffer)
+    scan_buffer = &local_buffer;
+  if (scan_buffer->size() < memory.Size())
+    scan_buffer->resize(memory.Size());
+  uint8_t* buffer = scan_buffer->data();
+  if (!delegate->ReadMemory(memory.Address(), memory.Size(), buffer)) {
     LOG(ERROR) << "ReadMemory";
     return;
   }
 
   if (delegate->Is64Bit())
-    CaptureAtPointersInRange<uint64_t>(buffer.get(), memory.Size(), delegate);
+    CaptureAtPointersInRange<uint64_t>(buffer, memory.Size(), delegate);
   else
-    CaptureAtPointersInRange<uint32_t>(buffer.get(), memory.Size(), delegate);
+    CaptureAtPointersInRange<uint32_t>(buffer, memory.Size(), delegate);
 }
 
 }  // namespace internal
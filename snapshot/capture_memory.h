@@ -85,8 +85,13 @@ class CaptureMemory {
   //!     pointers long.
   //! \param[in] delegate A Delegate that handles reading from the target
   //!     process and adding new ranges.
-  static void PointedToByMemoryRange(const MemorySnapshot& memory,
-                                     Delegate* delegate);
+  //! \param[in] scan_buffer If not `nullptr`, a buffer to read \a memory
+  //!     into, which is grown as needed. Passing the same buffer when scanning
+  //!     several ranges avoids allocating a new buffer for each.
+  static void PointedToByMemoryRange(
+      const MemorySnapshot& memory,
+      Delegate* delegate,
+      std::vector<uint8_t>* scan_buffer = nullptr);
 
  private:
   DISALLOW_IMPLICIT_CONSTRUCTORS(CaptureMemory);
@@ -17,6 +17,7 @@
 
 #include <stdint.h>
 
+#include "util/misc/capture_profile.h"
 #include "util/misc/tri_state.h"
 
 namespace crashpad {
@@ -65,6 +66,9 @@ struct CrashpadInfoClientOptions {
 
   //! \sa CrashpadInfo::set_gather_indirectly_referenced_memory()
   uint32_t indirectly_referenced_memory_cap;
+
+  //! \sa CrashpadInfo::set_capture_profile()
+  CaptureProfile capture_profile;
 };
 
 }  // namespace crashpad
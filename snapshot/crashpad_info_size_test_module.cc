@@ -47,12 +47,13 @@ struct TestCrashpadInfo {
   uint8_t crashpad_handler_behavior_;
   uint8_t system_crash_reporter_forwarding_;
   uint8_t gather_indirectly_referenced_memory_;
-  uint8_t padding_1_;
+  uint8_t capture_profile_;
   void* extra_memory_ranges_;
   void* simple_annotations_;
 #if !defined(CRASHPAD_INFO_SIZE_TEST_MODULE_SMALL)
   void* user_data_minidump_stream_head_;
   void* annotations_list_;
+  uint32_t simple_annotations_entries_;
 #endif  // CRASHPAD_INFO_SIZE_TEST_MODULE_SMALL
 #if defined(CRASHPAD_INFO_SIZE_TEST_MODULE_LARGE)
   uint8_t trailer_[64 * 1024];
@@ -95,6 +96,7 @@ TestCrashpadInfo g_test_crashpad_info = {'CPad',
 #if !defined(CRASHPAD_INFO_SIZE_TEST_MODULE_SMALL)
                                          nullptr,
                                          nullptr,
+                                         0,
 #endif  // CRASHPAD_INFO_SIZE_TEST_MODULE_SMALL
 #if defined(CRASHPAD_INFO_SIZE_TEST_MODULE_LARGE)
                                          {}
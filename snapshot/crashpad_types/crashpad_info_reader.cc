@@ -36,6 +36,19 @@ void UnsetIfNotValidTriState(TriState* value) {
   *value = TriState::kUnset;
 }
 
+void UnsetIfNotValidCaptureProfile(CaptureProfile* value) {
+  switch (AsUnderlyingType(*value)) {
+    case AsUnderlyingType(CaptureProfile::kUnset):
+    case AsUnderlyingType(CaptureProfile::kMinimal):
+    case AsUnderlyingType(CaptureProfile::kDefault):
+    case AsUnderlyingType(CaptureProfile::kFull):
+      return;
+  }
+  LOG(WARNING) << "Unsetting invalid CaptureProfile "
+               << AsUnderlyingType(*value);
+  *value = CaptureProfile::kUnset;
+}
+
 }  // namespace
 
 class CrashpadInfoReader::InfoContainer {
@@ -89,6 +102,7 @@ class CrashpadInfoReader::InfoContainerSpecific : public InfoContainer {
     UnsetIfNotValidTriState(&info.crashpad_handler_behavior);
     UnsetIfNotValidTriState(&info.system_crash_reporter_forwarding);
     UnsetIfNotValidTriState(&info.gather_indirectly_referenced_memory);
+    UnsetIfNotValidCaptureProfile(&info.capture_profile);
 
     return true;
   }
@@ -102,11 +116,12 @@ class CrashpadInfoReader::InfoContainerSpecific : public InfoContainer {
     TriState crashpad_handler_behavior;
     TriState system_crash_reporter_forwarding;
     TriState gather_indirectly_referenced_memory;
-    uint8_t padding_1;
+    CaptureProfile capture_profile;
     typename Traits::Address extra_memory_ranges;
     typename Traits::Address simple_annotations;
     typename Traits::Address user_data_minidump_stream_head;
     typename Traits::Address annotations_list;
+    uint32_t simple_annotations_entries;
   } info;
 
 #if defined(ARCH_CPU_64_BITS)
@@ -174,6 +189,8 @@ DEFINE_GETTER(uint32_t,
               IndirectlyReferencedMemoryCap,
               indirectly_referenced_memory_cap)
 
+DEFINE_GETTER(CaptureProfile, RequestedCaptureProfile, capture_profile)
+
 DEFINE_GETTER(VMAddress, ExtraMemoryRanges, extra_memory_ranges)
 
 DEFINE_GETTER(VMAddress, SimpleAnnotations, simple_annotations)
@@ -184,6 +201,19 @@ DEFINE_GETTER(VMAddress,
               UserDataMinidumpStreamHead,
               user_data_minidump_stream_head)
 
+uint32_t CrashpadInfoReader::SimpleAnnotationsEntries() {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  const uint32_t entries = GET_MEMBER(simple_annotations_entries);
+  if (entries == 0) {
+    return SimpleStringDictionary::num_entries;
+  }
+  if (entries > CrashpadInfo::kMaxSimpleAnnotationsEntries) {
+    LOG(WARNING) << "ignoring simple annotations entry count " << entries;
+    return SimpleStringDictionary::num_entries;
+  }
+  return entries;
+}
+
 #undef DEFINE_GETTER
 #undef GET_MEMBER
 
@@ -21,6 +21,7 @@
 
 #include "base/macros.h"
 #include "util/misc/address_types.h"
+#include "util/misc/capture_profile.h"
 #include "util/misc/initialization_state_dcheck.h"
 #include "util/misc/tri_state.h"
 #include "util/process/process_memory_range.h"
@@ -51,12 +52,20 @@ class CrashpadInfoReader {
   TriState SystemCrashReporterForwarding();
   TriState GatherIndirectlyReferencedMemory();
   uint32_t IndirectlyReferencedMemoryCap();
+  CaptureProfile RequestedCaptureProfile();
   VMAddress ExtraMemoryRanges();
   VMAddress SimpleAnnotations();
   VMAddress AnnotationsList();
   VMAddress UserDataMinidumpStreamHead();
   //! \}
 
+  //! \brief Returns the number of entries in the dictionary at
+  //!     SimpleAnnotations().
+  //!
+  //! This is SimpleStringDictionary::num_entries unless the module registered
+  //! a THashedSimpleStringDictionary with a valid number of entries.
+  uint32_t SimpleAnnotationsEntries();
+
  private:
   class InfoContainer;
 
@@ -14,9 +14,12 @@
 
 #include "snapshot/crashpad_types/crashpad_info_reader.h"
 
+#include <stdio.h>
 #include <sys/types.h>
 
+#include <map>
 #include <memory>
+#include <string>
 
 #include "build/build_config.h"
 #include "client/annotation_list.h"
@@ -24,6 +27,7 @@
 #include "client/simple_address_range_bag.h"
 #include "client/simple_string_dictionary.h"
 #include "gtest/gtest.h"
+#include "snapshot/crashpad_types/image_annotation_reader.h"
 #include "test/multiprocess_exec.h"
 #include "test/process_type.h"
 #include "util/file/file_io.h"
@@ -37,6 +41,7 @@ namespace {
 constexpr TriState kCrashpadHandlerBehavior = TriState::kEnabled;
 constexpr TriState kSystemCrashReporterForwarding = TriState::kDisabled;
 constexpr TriState kGatherIndirectlyReferencedMemory = TriState::kUnset;
+constexpr CaptureProfile kCaptureProfile = CaptureProfile::kMinimal;
 
 constexpr uint32_t kIndirectlyReferencedMemoryCap = 42;
 
@@ -50,6 +55,7 @@ class ScopedUnsetCrashpadInfo {
     crashpad_info_->set_system_crash_reporter_forwarding(TriState::kUnset);
     crashpad_info_->set_gather_indirectly_referenced_memory(TriState::kUnset,
                                                             0);
+    crashpad_info_->set_capture_profile(CaptureProfile::kUnset);
     crashpad_info_->set_extra_memory_ranges(nullptr);
     crashpad_info_->set_simple_annotations(nullptr);
     crashpad_info_->set_annotations_list(nullptr);
@@ -74,6 +80,7 @@ class CrashpadInfoTestDataSetup {
     info->set_system_crash_reporter_forwarding(kSystemCrashReporterForwarding);
     info->set_gather_indirectly_referenced_memory(
         kGatherIndirectlyReferencedMemory, kIndirectlyReferencedMemoryCap);
+    info->set_capture_profile(kCaptureProfile);
   }
 
   void GetAddresses(VMAddress* info_address,
@@ -117,8 +124,11 @@ void ExpectCrashpadInfo(ProcessType process,
             kGatherIndirectlyReferencedMemory);
   EXPECT_EQ(reader.IndirectlyReferencedMemoryCap(),
             kIndirectlyReferencedMemoryCap);
+  EXPECT_EQ(reader.RequestedCaptureProfile(), kCaptureProfile);
   EXPECT_EQ(reader.ExtraMemoryRanges(), extra_memory_address);
   EXPECT_EQ(reader.SimpleAnnotations(), simple_annotations_address);
+  EXPECT_EQ(reader.SimpleAnnotationsEntries(),
+            SimpleStringDictionary::num_entries);
   EXPECT_EQ(reader.AnnotationsList(), annotations_list_address);
 }
 
@@ -214,6 +224,55 @@ TEST(CrashpadInfoReader, ReadFromChild) {
   test.Run();
 }
 
+TEST(CrashpadInfoReader, HashedSimpleAnnotations) {
+#if defined(ARCH_CPU_64_BITS)
+  constexpr bool am_64_bit = true;
+#else
+  constexpr bool am_64_bit = false;
+#endif
+
+  // More entries than a SimpleStringDictionary holds, so that some are stored
+  // beyond the slots that it would have had.
+  constexpr size_t kNumEntries = SimpleStringDictionary::num_entries * 4;
+  using HashedDictionary =
+      THashedSimpleStringDictionary<SimpleStringDictionary::key_size,
+                                    SimpleStringDictionary::value_size,
+                                    kNumEntries>;
+  HashedDictionary simple_annotations;
+  std::map<std::string, std::string> expected;
+  for (size_t index = 0; index < kNumEntries; ++index) {
+    char key[16];
+    char value[16];
+    snprintf(key, sizeof(key), "key%zu", index);
+    snprintf(value, sizeof(value), "value%zu", index);
+    simple_annotations.SetKeyValue(key, value);
+    expected[key] = value;
+  }
+
+  CrashpadInfo* info = CrashpadInfo::GetCrashpadInfo();
+  ScopedUnsetCrashpadInfo unset(info);
+  info->set_simple_annotations(&simple_annotations);
+  EXPECT_FALSE(info->simple_annotations());
+
+  ProcessMemoryNative memory;
+  ASSERT_TRUE(memory.Initialize(GetSelfProcess()));
+  ProcessMemoryRange range;
+  ASSERT_TRUE(range.Initialize(&memory, am_64_bit));
+
+  CrashpadInfoReader reader;
+  ASSERT_TRUE(reader.Initialize(&range, FromPointerCast<VMAddress>(info)));
+  EXPECT_EQ(reader.SimpleAnnotations(),
+            FromPointerCast<VMAddress>(&simple_annotations));
+  EXPECT_EQ(reader.SimpleAnnotationsEntries(), kNumEntries);
+
+  ImageAnnotationReader annotation_reader(&range);
+  std::map<std::string, std::string> simple_map;
+  ASSERT_TRUE(annotation_reader.SimpleMap(reader.SimpleAnnotations(),
+                                          reader.SimpleAnnotationsEntries(),
+                                          &simple_map));
+  EXPECT_EQ(simple_map, expected);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace crashpad
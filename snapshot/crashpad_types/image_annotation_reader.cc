@@ -14,6 +14,7 @@
 
 #include "snapshot/crashpad_types/image_annotation_reader.h"
 
+#include <stddef.h>
 #include <string.h>
 #include <sys/types.h>
 
@@ -39,6 +40,13 @@ struct Annotation {
   typename Traits::Address value;
   uint32_t size;
   uint16_t type;
+  uint16_t sequence;
+};
+
+template <class Traits>
+struct AnnotationRegistry {
+  uint32_t count;
+  typename Traits::Address entries[AnnotationList::kRegistryCapacity];
 };
 
 template <class Traits>
@@ -46,6 +54,10 @@ struct AnnotationList {
   typename Traits::Address tail_pointer;
   Annotation<Traits> head;
   Annotation<Traits> tail;
+
+  // Only present when tail.value is non-zero. Older clients don’t have this,
+  // so it’s never read as part of this structure.
+  AnnotationRegistry<Traits> registry;
 };
 
 }  // namespace process_types
@@ -66,6 +78,129 @@ static_assert(sizeof(process_types::AnnotationList<NATIVE_TRAITS>) ==
 
 #undef NATIVE_TRAITS
 
+namespace {
+
+// Ranges of memory separated by no more than this many bytes are read
+// together.
+constexpr VMSize kMaxCoalescedGap = 256;
+
+// No single coalesced read will be larger than this.
+constexpr VMSize kMaxCoalescedReadSize = 64 * 1024;
+
+struct RangeRead {
+  VMAddress address;
+  VMSize size;
+  bool valid;
+  std::string data;
+};
+
+// Reads each of |reads| from |memory|, combining ranges that are close together
+// into a single read. Annotations are normally declared with static storage
+// duration, so their objects, names, and values tend to be clustered in a few
+// places, and this needs far fewer reads than reading each range on its own.
+// If a combined read fails, its ranges are retried individually. On return,
+// each RangeRead’s valid and data fields are set.
+void ReadRanges(const ProcessMemoryRange* memory,
+                std::vector<RangeRead>* reads) {
+  std::vector<RangeRead*> sorted;
+  sorted.reserve(reads->size());
+  for (RangeRead& read : *reads) {
+    read.valid = false;
+    read.data.clear();
+    if (read.address + read.size >= read.address) {
+      sorted.push_back(&read);
+    }
+  }
+  std::sort(sorted.begin(),
+            sorted.end(),
+            [](const RangeRead* lhs, const RangeRead* rhs) {
+              return lhs->address < rhs->address;
+            });
+
+  for (size_t first = 0; first < sorted.size();) {
+    const VMAddress start = sorted[first]->address;
+    VMAddress end = start + sorted[first]->size;
+    size_t last = first + 1;
+    for (; last < sorted.size(); ++last) {
+      const RangeRead* read = sorted[last];
+      const VMAddress read_end = std::max(end, read->address + read->size);
+      if (read->address > end && read->address - end > kMaxCoalescedGap) {
+        break;
+      }
+      if (read_end - start > kMaxCoalescedReadSize) {
+        break;
+      }
+      end = read_end;
+    }
+
+    std::string buffer;
+    if (last - first > 1) {
+      buffer.resize(end - start);
+      if (!memory->Read(start, buffer.size(), &buffer[0])) {
+        buffer.clear();
+      }
+    }
+
+    for (size_t index = first; index < last; ++index) {
+      RangeRead* read = sorted[index];
+      if (!buffer.empty()) {
+        read->data.assign(buffer, read->address - start, read->size);
+        read->valid = true;
+      } else {
+        read->data.resize(read->size);
+        read->valid = read->size == 0 ||
+                      memory->Read(read->address, read->size, &read->data[0]);
+      }
+    }
+
+    first = last;
+  }
+}
+
+// The number of times to reread an annotation that was being updated while it
+// was read.
+constexpr int kMaxSequencedReadAttempts = 3;
+
+// Annotations with a nonzero sequence counter are updated under a seqlock, as
+// described at Annotation::BeginSequencedUpdate(). Given |object| and |value|
+// as previously read for the annotation at |address|, checks that they weren’t
+// changing while they were read, and rereads them if they were. Returns false
+// if a consistent value couldn’t be obtained, which happens when a thread
+// stopped in the middle of an update, as is common when a process crashes.
+template <class Traits>
+bool ReadSequencedAnnotation(const ProcessMemoryRange* memory,
+                             VMAddress address,
+                             process_types::Annotation<Traits>* object,
+                             std::vector<uint8_t>* value) {
+  for (int attempt = 0;; ++attempt) {
+    process_types::Annotation<Traits> check;
+    if (!memory->Read(address, sizeof(check), &check)) {
+      return false;
+    }
+    if (!(object->sequence & 1) && check.sequence == object->sequence) {
+      return true;
+    }
+
+    // Each reread is verified by the next pass through the loop, so stop
+    // before rereading once there are no verifications left.
+    if (attempt == kMaxSequencedReadAttempts) {
+      return false;
+    }
+
+    *object = check;
+    if (object->sequence & 1) {
+      continue;
+    }
+    value->resize(
+        std::min(static_cast<size_t>(object->size), Annotation::kValueMaxSize));
+    if (!memory->Read(object->value, value->size(), value->data())) {
+      return false;
+    }
+  }
+}
+
+}  // namespace
+
 ImageAnnotationReader::ImageAnnotationReader(const ProcessMemoryRange* memory)
     : memory_(memory) {}
 
@@ -73,9 +208,9 @@ ImageAnnotationReader::~ImageAnnotationReader() = default;
 
 bool ImageAnnotationReader::SimpleMap(
     VMAddress address,
+    size_t num_entries,
     std::map<std::string, std::string>* annotations) const {
-  std::vector<SimpleStringDictionary::Entry> simple_annotations(
-      SimpleStringDictionary::num_entries);
+  std::vector<SimpleStringDictionary::Entry> simple_annotations(num_entries);
 
   if (!memory_->Read(address,
                      simple_annotations.size() * sizeof(simple_annotations[0]),
@@ -109,16 +244,26 @@ bool ImageAnnotationReader::ReadAnnotationList(
     VMAddress address,
     std::vector<AnnotationSnapshot>* annotations) const {
   process_types::AnnotationList<Traits> annotation_list;
-  if (!memory_->Read(address, sizeof(annotation_list), &annotation_list)) {
+  if (!memory_->Read(address,
+                     offsetof(process_types::AnnotationList<Traits>, registry),
+                     &annotation_list)) {
     LOG(ERROR) << "could not read annotation list";
     return false;
   }
 
+  std::vector<VMAddress> annotation_addresses;
+  if (annotation_list.tail.value &&
+      ReadAnnotationRegistry<Traits>(annotation_list.tail.value,
+                                     &annotation_addresses)) {
+    return ReadAnnotations<Traits>(annotation_addresses, annotations);
+  }
+
   process_types::Annotation<Traits> current = annotation_list.head;
   for (size_t index = 0; current.link_node != annotation_list.tail_pointer &&
                          index < kMaxNumberOfAnnotations;
        ++index) {
-    if (!memory_->Read(current.link_node, sizeof(current), &current)) {
+    const VMAddress current_address = current.link_node;
+    if (!memory_->Read(current_address, sizeof(current), &current)) {
       LOG(ERROR) << "could not read annotation at index " << index;
       return false;
     }
@@ -144,6 +289,155 @@ bool ImageAnnotationReader::ReadAnnotationList(
       continue;
     }
 
+    if (current.sequence != 0) {
+      process_types::Annotation<Traits> sequenced = current;
+      if (!ReadSequencedAnnotation(
+              memory_, current_address, &sequenced, &snapshot.value)) {
+        LOG(WARNING) << "discarding inconsistent annotation at index "
+                     << index;
+        continue;
+      }
+      if (sequenced.size == 0) {
+        continue;
+      }
+    }
+
+    annotations->push_back(std::move(snapshot));
+  }
+
+  return true;
+}
+
+template <class Traits>
+bool ImageAnnotationReader::ReadAnnotationRegistry(
+    VMAddress address,
+    std::vector<VMAddress>* annotation_addresses) const {
+  using Registry = process_types::AnnotationRegistry<Traits>;
+
+  uint32_t count;
+  if (!memory_->Read(address, sizeof(count), &count)) {
+    LOG(WARNING) << "could not read annotation registry";
+    return false;
+  }
+
+  // A full registry may be missing the most recently added annotations, so the
+  // list must be walked instead.
+  if (count > AnnotationList::kRegistryCapacity) {
+    return false;
+  }
+
+  // Only the most recently added annotations are of interest, matching the
+  // order in which they appear in the list.
+  const uint32_t first =
+      count > kMaxNumberOfAnnotations ? count - kMaxNumberOfAnnotations : 0;
+  std::vector<typename Traits::Address> entries(count - first);
+  if (!entries.empty() &&
+      !memory_->Read(address + offsetof(Registry, entries) +
+                         first * sizeof(entries[0]),
+                     entries.size() * sizeof(entries[0]),
+                     entries.data())) {
+    LOG(WARNING) << "could not read annotation registry entries";
+    return false;
+  }
+
+  annotation_addresses->clear();
+  for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+    // A slot that was claimed but not yet filled in belongs to an annotation
+    // that hadn’t been added to the list either.
+    if (*it) {
+      annotation_addresses->push_back(*it);
+    }
+  }
+  return true;
+}
+
+template <class Traits>
+bool ImageAnnotationReader::ReadAnnotations(
+    const std::vector<VMAddress>& annotation_addresses,
+    std::vector<AnnotationSnapshot>* annotations) const {
+  std::vector<RangeRead> object_reads(annotation_addresses.size());
+  for (size_t index = 0; index < annotation_addresses.size(); ++index) {
+    object_reads[index].address = annotation_addresses[index];
+    object_reads[index].size = sizeof(process_types::Annotation<Traits>);
+  }
+  ReadRanges(memory_, &object_reads);
+
+  std::vector<process_types::Annotation<Traits>> objects;
+  std::vector<VMAddress> object_addresses;
+  std::vector<RangeRead> name_reads;
+  std::vector<RangeRead> value_reads;
+  for (size_t index = 0; index < object_reads.size(); ++index) {
+    if (!object_reads[index].valid) {
+      LOG(WARNING) << "could not read annotation at index " << index;
+      continue;
+    }
+
+    process_types::Annotation<Traits> object;
+    memcpy(&object, object_reads[index].data.data(), sizeof(object));
+    if (object.size == 0) {
+      continue;
+    }
+
+    objects.push_back(object);
+    object_addresses.push_back(annotation_addresses[index]);
+
+    // The name’s length isn’t known until it’s been read, so read as much as
+    // it could occupy. Names near the end of a mapping may not be readable this
+    // way, and are retried below.
+    RangeRead name_read;
+    name_read.address = object.name;
+    name_read.size = Annotation::kNameMaxLength;
+    name_reads.push_back(name_read);
+
+    RangeRead value_read;
+    value_read.address = object.value;
+    value_read.size =
+        std::min(static_cast<size_t>(object.size), Annotation::kValueMaxSize);
+    value_reads.push_back(value_read);
+  }
+  ReadRanges(memory_, &name_reads);
+  ReadRanges(memory_, &value_reads);
+
+  for (size_t index = 0; index < objects.size(); ++index) {
+    AnnotationSnapshot snapshot;
+    snapshot.type = objects[index].type;
+
+    const RangeRead& name_read = name_reads[index];
+    const char* nul =
+        name_read.valid
+            ? static_cast<const char*>(
+                  memchr(name_read.data.data(), '\0', name_read.data.size()))
+            : nullptr;
+    if (nul) {
+      snapshot.name.assign(name_read.data.data(), nul);
+    } else if (!memory_->ReadCStringSizeLimited(objects[index].name,
+                                                Annotation::kNameMaxLength,
+                                                &snapshot.name)) {
+      LOG(WARNING) << "could not read annotation name at index " << index;
+      continue;
+    }
+
+    if (!value_reads[index].valid) {
+      LOG(WARNING) << "could not read annotation value at index " << index;
+      continue;
+    }
+    snapshot.value.assign(value_reads[index].data.begin(),
+                          value_reads[index].data.end());
+
+    if (objects[index].sequence != 0) {
+      if (!ReadSequencedAnnotation(memory_,
+                                   object_addresses[index],
+                                   &objects[index],
+                                   &snapshot.value)) {
+        LOG(WARNING) << "discarding inconsistent annotation at index "
+                     << index;
+        continue;
+      }
+      if (objects[index].size == 0) {
+        continue;
+      }
+    }
+
     annotations->push_back(std::move(snapshot));
   }
 
@@ -43,11 +43,15 @@ class ImageAnnotationReader {
   //!     keys and values are strings.
   //!
   //! \param[in] address The address in the target process' address space of a
-  //!     SimpleStringDictionary containing the annotations to read.
+  //!     SimpleStringDictionary or THashedSimpleStringDictionary containing the
+  //!     annotations to read.
+  //! \param[in] num_entries The number of entries in the dictionary, as given
+  //!     by CrashpadInfoReader::SimpleAnnotationsEntries().
   //! \param[out] annotations The annotations read, valid if this method
   //!     returns `true`.
   //! \return `true` on success. `false` on failure with a message logged.
   bool SimpleMap(VMAddress address,
+                 size_t num_entries,
                  std::map<std::string, std::string>* annotations) const;
 
   //! \brief Reads the module's annotations that are organized as a list of
@@ -66,6 +70,20 @@ class ImageAnnotationReader {
   bool ReadAnnotationList(VMAddress address,
                           std::vector<AnnotationSnapshot>* annotations) const;
 
+  // Reads the addresses of the annotations recorded in the registry at
+  // |address|, most recently added first. Returns false if the registry can’t
+  // be used, in which case the list must be walked instead.
+  template <class Traits>
+  bool ReadAnnotationRegistry(
+      VMAddress address,
+      std::vector<VMAddress>* annotation_addresses) const;
+
+  // Reads the annotations at |annotation_addresses|, batching reads of nearby
+  // objects, names, and values together.
+  template <class Traits>
+  bool ReadAnnotations(const std::vector<VMAddress>& annotation_addresses,
+                       std::vector<AnnotationSnapshot>* annotations) const;
+
   const ProcessMemoryRange* memory_;  // weak
 
   DISALLOW_COPY_AND_ASSIGN(ImageAnnotationReader);
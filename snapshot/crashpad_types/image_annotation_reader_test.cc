@@ -19,13 +19,17 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <string>
 
 #include "base/logging.h"
+#include "base/strings/stringprintf.h"
 #include "build/build_config.h"
 #include "client/annotation.h"
 #include "client/annotation_list.h"
 #include "client/simple_string_dictionary.h"
+#include "client/test/test_sequenced_string_annotation.h"
 #include "gtest/gtest.h"
+#include "snapshot/snapshot_constants.h"
 #include "test/multiprocess_exec.h"
 #include "test/process_type.h"
 #include "util/file/file_io.h"
@@ -105,7 +109,8 @@ void ExpectAnnotations(ProcessType process,
   ImageAnnotationReader reader(&range);
 
   std::map<std::string, std::string> simple_map;
-  ASSERT_TRUE(reader.SimpleMap(simple_map_address, &simple_map));
+  ASSERT_TRUE(reader.SimpleMap(
+      simple_map_address, SimpleStringDictionary::num_entries, &simple_map));
   ExpectSimpleMap(simple_map, expected_simple_map);
 
   std::vector<AnnotationSnapshot> annotation_list;
@@ -132,6 +137,162 @@ TEST(ImageAnnotationReader, ReadFromSelf) {
                     FromPointerCast<VMAddress>(&annotations));
 }
 
+// Reads an AnnotationList holding |count| annotations from this process, and
+// checks that the most recently added ones are returned, newest first.
+void ExpectManyAnnotations(size_t count) {
+  static constexpr char kValue[] = "value";
+
+  std::vector<std::string> names;
+  names.reserve(count);
+  std::vector<std::unique_ptr<Annotation>> storage;
+  AnnotationList annotations;
+  for (size_t index = 0; index < count; ++index) {
+    names.push_back(base::StringPrintf("annotation %zu", index));
+    storage.push_back(std::make_unique<Annotation>(
+        Annotation::Type::kString,
+        names.back().c_str(),
+        reinterpret_cast<void*>(const_cast<char*>(kValue))));
+
+    // Add to |annotations| before SetSize(), which would otherwise add the
+    // annotation to the global list instead.
+    annotations.Add(storage.back().get());
+
+    // Leave some annotations cleared. These aren’t reported.
+    if (index % 3 != 0) {
+      storage.back()->SetSize(sizeof(kValue));
+    }
+  }
+
+#if defined(ARCH_CPU_64_BITS)
+  constexpr bool am_64_bit = true;
+#else
+  constexpr bool am_64_bit = false;
+#endif
+
+  ProcessMemoryNative memory;
+  ASSERT_TRUE(memory.Initialize(GetSelfProcess()));
+  ProcessMemoryRange range;
+  ASSERT_TRUE(range.Initialize(&memory, am_64_bit));
+
+  ImageAnnotationReader reader(&range);
+  std::vector<AnnotationSnapshot> annotation_list;
+  ASSERT_TRUE(reader.AnnotationsList(FromPointerCast<VMAddress>(&annotations),
+                                     &annotation_list));
+
+  std::vector<std::string> expected_names;
+  for (size_t index = count;
+       index > count - std::min(count, kMaxNumberOfAnnotations);
+       --index) {
+    if ((index - 1) % 3 != 0) {
+      expected_names.push_back(names[index - 1]);
+    }
+  }
+
+  ASSERT_EQ(annotation_list.size(), expected_names.size());
+  for (size_t index = 0; index < annotation_list.size(); ++index) {
+    EXPECT_EQ(annotation_list[index].name, expected_names[index]);
+    EXPECT_EQ(annotation_list[index].type,
+              AsUnderlyingType(Annotation::Type::kString));
+    EXPECT_EQ(std::string(annotation_list[index].value.begin(),
+                          annotation_list[index].value.end()),
+              std::string(kValue, sizeof(kValue)));
+  }
+}
+
+TEST(ImageAnnotationReader, ReadFromRegistry) {
+  ExpectManyAnnotations(10);
+  ExpectManyAnnotations(kMaxNumberOfAnnotations + 10);
+}
+
+TEST(ImageAnnotationReader, ReadFromListWhenRegistryFull) {
+  ExpectManyAnnotations(AnnotationList::kRegistryCapacity + 10);
+}
+
+TEST(ImageAnnotationReader, SequencedAnnotations) {
+  TestSequencedStringAnnotation<16> complete("complete");
+  TestSequencedStringAnnotation<16> in_progress("in progress");
+
+  AnnotationList annotations;
+  annotations.Add(&complete);
+  annotations.Add(&in_progress);
+  ASSERT_TRUE(complete.Set("complete value"));
+  ASSERT_TRUE(in_progress.Set("old value"));
+
+  uint16_t sequence;
+  ASSERT_TRUE(in_progress.BeginUpdate(&sequence));
+
+#if defined(ARCH_CPU_64_BITS)
+  constexpr bool am_64_bit = true;
+#else
+  constexpr bool am_64_bit = false;
+#endif
+
+  ProcessMemoryNative memory;
+  ASSERT_TRUE(memory.Initialize(GetSelfProcess()));
+  ProcessMemoryRange range;
+  ASSERT_TRUE(range.Initialize(&memory, am_64_bit));
+  ImageAnnotationReader reader(&range);
+
+  // The annotation being updated is discarded rather than possibly being
+  // reported with a torn value.
+  std::vector<AnnotationSnapshot> annotation_list;
+  ASSERT_TRUE(reader.AnnotationsList(FromPointerCast<VMAddress>(&annotations),
+                                     &annotation_list));
+  ASSERT_EQ(annotation_list.size(), 1u);
+  EXPECT_EQ(annotation_list[0].name, "complete");
+  EXPECT_EQ(std::string(annotation_list[0].value.begin(),
+                        annotation_list[0].value.end()),
+            "complete value");
+
+  in_progress.EndUpdate(sequence);
+
+  annotation_list.clear();
+  ASSERT_TRUE(reader.AnnotationsList(FromPointerCast<VMAddress>(&annotations),
+                                     &annotation_list));
+  ASSERT_EQ(annotation_list.size(), 2u);
+  EXPECT_EQ(annotation_list[0].name, "in progress");
+  EXPECT_EQ(std::string(annotation_list[0].value.begin(),
+                        annotation_list[0].value.end()),
+            "old value");
+  EXPECT_EQ(annotation_list[1].name, "complete");
+}
+
+TEST(ImageAnnotationReader, BreadcrumbAnnotation) {
+  BreadcrumbAnnotation<16, 8> breadcrumbs("breadcrumbs");
+  AnnotationList annotations;
+  annotations.Add(&breadcrumbs);
+  for (size_t index = 0; index < 10; ++index) {
+    const std::string record = base::StringPrintf("record %zu", index);
+    breadcrumbs.Add(record.data(), record.size());
+  }
+
+#if defined(ARCH_CPU_64_BITS)
+  constexpr bool am_64_bit = true;
+#else
+  constexpr bool am_64_bit = false;
+#endif
+
+  ProcessMemoryNative memory;
+  ASSERT_TRUE(memory.Initialize(GetSelfProcess()));
+  ProcessMemoryRange range;
+  ASSERT_TRUE(range.Initialize(&memory, am_64_bit));
+  ImageAnnotationReader reader(&range);
+
+  // The whole ring buffer is captured, for a crash processor to decode.
+  std::vector<AnnotationSnapshot> annotation_list;
+  ASSERT_TRUE(reader.AnnotationsList(FromPointerCast<VMAddress>(&annotations),
+                                     &annotation_list));
+  ASSERT_EQ(annotation_list.size(), 1u);
+  EXPECT_EQ(annotation_list[0].name, "breadcrumbs");
+  EXPECT_EQ(annotation_list[0].type,
+            AsUnderlyingType(Annotation::Type::kBreadcrumbs));
+  ASSERT_EQ(annotation_list[0].value.size(), breadcrumbs.size());
+  EXPECT_EQ(memcmp(annotation_list[0].value.data(),
+                   breadcrumbs.value(),
+                   breadcrumbs.size()),
+            0);
+}
+
 CRASHPAD_CHILD_TEST_MAIN(ReadAnnotationsFromChildTestMain) {
   SimpleStringDictionary map;
   std::vector<std::unique_ptr<Annotation>> storage;
@@ -0,0 +1,69 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/elf/elf_module_metadata_cache.h"
+
+#include <tuple>
+
+#include "base/logging.h"
+
+namespace crashpad {
+
+bool ElfModuleMetadataCache::FileIdentity::operator<(
+    const FileIdentity& other) const {
+  return std::tie(device, inode, offset, size, build_id) <
+         std::tie(
+             other.device, other.inode, other.offset, other.size, other.build_id);
+}
+
+ElfModuleMetadataCache::Metadata::Metadata()
+    : crashpad_info_offset(0), has_crashpad_info(false) {}
+
+ElfModuleMetadataCache::Metadata::~Metadata() {}
+
+ElfModuleMetadataCache::ElfModuleMetadataCache(size_t capacity)
+    : entries_(), index_(), capacity_(capacity) {
+  DCHECK_GT(capacity_, 0u);
+}
+
+ElfModuleMetadataCache::~ElfModuleMetadataCache() {}
+
+bool ElfModuleMetadataCache::Lookup(const FileIdentity& file,
+                                    Metadata* metadata) {
+  auto index_iterator = index_.find(file);
+  if (index_iterator == index_.end()) {
+    return false;
+  }
+
+  entries_.splice(entries_.begin(), entries_, index_iterator->second);
+  *metadata = entries_.front().second;
+  return true;
+}
+
+void ElfModuleMetadataCache::Insert(const FileIdentity& file,
+                                    const Metadata& metadata) {
+  auto index_iterator = index_.find(file);
+  if (index_iterator != index_.end()) {
+    entries_.erase(index_iterator->second);
+    index_.erase(index_iterator);
+  } else if (entries_.size() >= capacity_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+
+  entries_.emplace_front(file, metadata);
+  index_[file] = entries_.begin();
+}
+
+}  // namespace crashpad
@@ -0,0 +1,116 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_SNAPSHOT_ELF_ELF_MODULE_METADATA_CACHE_H_
+#define CRASHPAD_SNAPSHOT_ELF_ELF_MODULE_METADATA_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <list>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "base/macros.h"
+#include "util/misc/address_types.h"
+
+namespace crashpad {
+
+//! \brief A bounded, least-recently-used cache of the parts of an ELF module
+//!     that are determined by its file alone.
+//!
+//! Many processes typically load the same shared libraries. Entries are keyed
+//! by the identity of the file a module was loaded from and by the module’s
+//! build ID, so that metadata read from a module in one process can be used
+//! for the same file loaded into any other process, wherever it was loaded.
+//! The build ID is read from each module, so a module whose contents don’t
+//! match its file can only share metadata with modules that agree with it.
+//!
+//! This class is not thread-safe.
+class ElfModuleMetadataCache {
+ public:
+  //! \brief Identifies the file that a module was loaded from.
+  struct FileIdentity {
+    //! \brief The device containing the file.
+    uint64_t device;
+
+    //! \brief The file’s inode.
+    uint64_t inode;
+
+    //! \brief The offset in the file of the module’s ELF header. This is
+    //!     nonzero for modules loaded directly from an archive.
+    uint64_t offset;
+
+    //! \brief The size of the module’s image in memory, used to tell apart
+    //!     files that have been rewritten in place.
+    uint64_t size;
+
+    //! \brief The module’s build ID, or empty if it has none.
+    std::vector<uint8_t> build_id;
+
+    bool operator<(const FileIdentity& other) const;
+  };
+
+  //! \brief Metadata that doesn’t vary with where or into which process a
+  //!     module is loaded.
+  struct Metadata {
+    Metadata();
+    ~Metadata();
+
+    //! \brief The offset of the module’s CrashpadInfo from the module’s ELF
+    //!     header, valid if #has_crashpad_info is `true`.
+    VMOffset crashpad_info_offset;
+
+    //! \brief Whether the module has a CrashpadInfo note.
+    bool has_crashpad_info;
+  };
+
+  //! \brief A capacity large enough for the libraries loaded by the processes
+  //!     on a typical system.
+  static constexpr size_t kDefaultCapacity = 1024;
+
+  //! \param[in] capacity The maximum number of files to cache metadata for.
+  explicit ElfModuleMetadataCache(size_t capacity);
+  ~ElfModuleMetadataCache();
+
+  //! \brief Retrieves cached metadata for a file.
+  //!
+  //! \param[in] file The file to retrieve metadata for.
+  //! \param[out] metadata The cached metadata.
+  //! \return `true` if metadata was found for \a file, `false` otherwise.
+  bool Lookup(const FileIdentity& file, Metadata* metadata);
+
+  //! \brief Caches metadata for a file, replacing any previously cached
+  //!     metadata for it and evicting the least recently used file if the
+  //!     cache is full.
+  void Insert(const FileIdentity& file, const Metadata& metadata);
+
+  //! \return The number of files that metadata is cached for.
+  size_t size() const { return entries_.size(); }
+
+ private:
+  using EntryList = std::list<std::pair<FileIdentity, Metadata>>;
+
+  // Ordered from most to least recently used.
+  EntryList entries_;
+  std::map<FileIdentity, EntryList::iterator> index_;
+  size_t capacity_;
+
+  DISALLOW_COPY_AND_ASSIGN(ElfModuleMetadataCache);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_SNAPSHOT_ELF_ELF_MODULE_METADATA_CACHE_H_
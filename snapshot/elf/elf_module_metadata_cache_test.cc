@@ -0,0 +1,92 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/elf/elf_module_metadata_cache.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+ElfModuleMetadataCache::FileIdentity File(uint64_t inode) {
+  ElfModuleMetadataCache::FileIdentity file;
+  file.device = 1;
+  file.inode = inode;
+  file.offset = 0;
+  file.size = 0x1000;
+  file.build_id.push_back(1);
+  return file;
+}
+
+ElfModuleMetadataCache::Metadata Metadata(VMOffset crashpad_info_offset) {
+  ElfModuleMetadataCache::Metadata metadata;
+  metadata.crashpad_info_offset = crashpad_info_offset;
+  metadata.has_crashpad_info = true;
+  return metadata;
+}
+
+TEST(ElfModuleMetadataCache, LookupAndInsert) {
+  ElfModuleMetadataCache cache(2);
+  ElfModuleMetadataCache::Metadata metadata;
+  EXPECT_FALSE(cache.Lookup(File(1), &metadata));
+
+  cache.Insert(File(1), Metadata(0x10));
+  ASSERT_TRUE(cache.Lookup(File(1), &metadata));
+  EXPECT_EQ(metadata.crashpad_info_offset, 0x10u);
+  EXPECT_TRUE(metadata.has_crashpad_info);
+
+  // Each part of the identity distinguishes files.
+  ElfModuleMetadataCache::FileIdentity other = File(1);
+  other.device = 2;
+  EXPECT_FALSE(cache.Lookup(other, &metadata));
+  other = File(1);
+  other.offset = 0x1000;
+  EXPECT_FALSE(cache.Lookup(other, &metadata));
+  other = File(1);
+  other.size = 0x2000;
+  EXPECT_FALSE(cache.Lookup(other, &metadata));
+  other = File(1);
+  other.build_id[0] = 2;
+  EXPECT_FALSE(cache.Lookup(other, &metadata));
+  other.build_id.clear();
+  EXPECT_FALSE(cache.Lookup(other, &metadata));
+
+  // Inserting replaces existing metadata.
+  cache.Insert(File(1), Metadata(0x20));
+  EXPECT_EQ(cache.size(), 1u);
+  ASSERT_TRUE(cache.Lookup(File(1), &metadata));
+  EXPECT_EQ(metadata.crashpad_info_offset, 0x20u);
+}
+
+TEST(ElfModuleMetadataCache, EvictsLeastRecentlyUsed) {
+  ElfModuleMetadataCache cache(2);
+  cache.Insert(File(1), Metadata(0x10));
+  cache.Insert(File(2), Metadata(0x20));
+
+  ElfModuleMetadataCache::Metadata metadata;
+  ASSERT_TRUE(cache.Lookup(File(1), &metadata));
+
+  cache.Insert(File(3), Metadata(0x30));
+  EXPECT_EQ(cache.size(), 2u);
+  EXPECT_TRUE(cache.Lookup(File(1), &metadata));
+  EXPECT_FALSE(cache.Lookup(File(2), &metadata));
+  EXPECT_TRUE(cache.Lookup(File(3), &metadata));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -17,6 +17,7 @@
 #include <endian.h>
 
 #include <algorithm>
+#include <utility>
 
 #include "base/files/file_path.h"
 #include "snapshot/crashpad_types/image_annotation_reader.h"
@@ -37,13 +38,16 @@ ModuleSnapshotElf::ModuleSnapshotElf(const std::string& name,
       process_memory_range_(process_memory_range),
       process_memory_(process_memory),
       crashpad_info_(),
+      build_id_(),
       type_(type),
       initialized_(),
       streams_() {}
 
 ModuleSnapshotElf::~ModuleSnapshotElf() = default;
 
-bool ModuleSnapshotElf::Initialize() {
+bool ModuleSnapshotElf::Initialize(
+    ElfModuleMetadataCache* metadata_cache,
+    const ElfModuleMetadataCache::FileIdentity* file) {
   INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
 
   if (!elf_reader_) {
@@ -51,6 +55,52 @@ bool ModuleSnapshotElf::Initialize() {
     return false;
   }
 
+  // The build ID is part of the cache key, so it’s always read from the
+  // module. Metadata is only cached if it was read without error, so that a
+  // transient failure to read one process’ memory doesn’t affect others.
+  std::unique_ptr<ElfImageReader::NoteReader> notes =
+      elf_reader_->NotesWithNameAndType(ELF_NOTE_GNU, NT_GNU_BUILD_ID, 64);
+  std::string desc;
+  VMAddress desc_address;
+  const ElfImageReader::NoteReader::Result build_id_result =
+      notes->NextNote(nullptr, nullptr, &desc, &desc_address);
+  if (build_id_result == ElfImageReader::NoteReader::Result::kSuccess) {
+    build_id_.assign(desc.begin(), desc.end());
+  }
+
+  ElfModuleMetadataCache::Metadata metadata;
+  const bool use_cache =
+      metadata_cache && file &&
+      build_id_result != ElfImageReader::NoteReader::Result::kError;
+  ElfModuleMetadataCache::FileIdentity key;
+  if (use_cache) {
+    key = *file;
+    key.build_id = build_id_;
+  }
+  if (!use_cache || !metadata_cache->Lookup(key, &metadata)) {
+    if (ReadMetadata(&metadata) && use_cache) {
+      metadata_cache->Insert(key, metadata);
+    }
+  }
+
+  if (metadata.has_crashpad_info) {
+    ProcessMemoryRange range;
+    if (range.Initialize(*elf_reader_->Memory())) {
+      auto info = std::make_unique<CrashpadInfoReader>();
+      if (info->Initialize(&range,
+                           elf_reader_->Address() +
+                               metadata.crashpad_info_offset)) {
+        crashpad_info_ = std::move(info);
+      }
+    }
+  }
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+bool ModuleSnapshotElf::ReadMetadata(
+    ElfModuleMetadataCache::Metadata* metadata) {
   // The data payload is only sizeof(VMAddress) in the note, but add a bit to
   // account for the name, header, and padding.
   constexpr ssize_t kMaxNoteSize = 256;
@@ -59,10 +109,10 @@ bool ModuleSnapshotElf::Initialize() {
                                         CRASHPAD_ELF_NOTE_TYPE_CRASHPAD_INFO,
                                         kMaxNoteSize);
   std::string desc;
-  VMAddress info_address;
   VMAddress desc_address;
-  if (notes->NextNote(nullptr, nullptr, &desc, &desc_address) ==
-      ElfImageReader::NoteReader::Result::kSuccess) {
+  const ElfImageReader::NoteReader::Result result =
+      notes->NextNote(nullptr, nullptr, &desc, &desc_address);
+  if (result == ElfImageReader::NoteReader::Result::kSuccess) {
     VMOffset offset;
     if (elf_reader_->Memory()->Is64Bit()) {
       offset = *reinterpret_cast<VMOffset*>(&desc[0]);
@@ -70,19 +120,15 @@ bool ModuleSnapshotElf::Initialize() {
       int32_t offset32 = *reinterpret_cast<int32_t*>(&desc[0]);
       offset = offset32;
     }
-    info_address = desc_address + offset;
 
-    ProcessMemoryRange range;
-    if (range.Initialize(*elf_reader_->Memory())) {
-      auto info = std::make_unique<CrashpadInfoReader>();
-      if (info->Initialize(&range, info_address)) {
-        crashpad_info_ = std::move(info);
-      }
-    }
+    // Recorded relative to the module so that it applies wherever the file is
+    // loaded.
+    metadata->crashpad_info_offset =
+        desc_address + offset - elf_reader_->Address();
+    metadata->has_crashpad_info = true;
   }
 
-  INITIALIZATION_STATE_SET_VALID(initialized_);
-  return true;
+  return result != ElfImageReader::NoteReader::Result::kError;
 }
 
 bool ModuleSnapshotElf::GetCrashpadOptions(CrashpadInfoClientOptions* options) {
@@ -100,6 +146,7 @@ bool ModuleSnapshotElf::GetCrashpadOptions(CrashpadInfoClientOptions* options) {
       crashpad_info_->GatherIndirectlyReferencedMemory();
   options->indirectly_referenced_memory_cap =
       crashpad_info_->IndirectlyReferencedMemoryCap();
+  options->capture_profile = crashpad_info_->RequestedCaptureProfile();
   return true;
 }
 
@@ -174,17 +221,7 @@ std::string ModuleSnapshotElf::DebugFileName() const {
 
 std::vector<uint8_t> ModuleSnapshotElf::BuildID() const {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
-
-  std::unique_ptr<ElfImageReader::NoteReader> notes =
-      elf_reader_->NotesWithNameAndType(ELF_NOTE_GNU, NT_GNU_BUILD_ID, 64);
-  std::string desc;
-  VMAddress desc_addr;
-  notes->NextNote(nullptr, nullptr, &desc, &desc_addr);
-
-  std::vector<uint8_t> build_id;
-  build_id.reserve(desc.size());
-  std::copy(desc.begin(), desc.end(), std::back_inserter(build_id));
-  return build_id;
+  return build_id_;
 }
 
 std::vector<std::string> ModuleSnapshotElf::AnnotationsVector() const {
@@ -198,7 +235,9 @@ std::map<std::string, std::string> ModuleSnapshotElf::AnnotationsSimpleMap()
   std::map<std::string, std::string> annotations;
   if (crashpad_info_ && crashpad_info_->SimpleAnnotations()) {
     ImageAnnotationReader reader(process_memory_range_);
-    reader.SimpleMap(crashpad_info_->SimpleAnnotations(), &annotations);
+    reader.SimpleMap(crashpad_info_->SimpleAnnotations(),
+                     crashpad_info_->SimpleAnnotationsEntries(),
+                     &annotations);
   }
   return annotations;
 }
@@ -27,6 +27,7 @@
 #include "snapshot/crashpad_info_client_options.h"
 #include "snapshot/crashpad_types/crashpad_info_reader.h"
 #include "snapshot/elf/elf_image_reader.h"
+#include "snapshot/elf/elf_module_metadata_cache.h"
 #include "snapshot/module_snapshot.h"
 #include "util/misc/initialization_state_dcheck.h"
 
@@ -54,9 +55,18 @@ class ModuleSnapshotElf final : public ModuleSnapshot {
 
   //! \brief Initializes the object.
   //!
+  //! \param[in] metadata_cache A cache of metadata for modules loaded from the
+  //!     same file with the same build ID, consulted before reading that
+  //!     metadata from the module and updated with what is read if it was read
+  //!     without error. Optional.
+  //! \param[in] file The file that the module was loaded from. The cache is
+  //!     only used if this is also provided.
+  //!
   //! \return `true` if the snapshot could be created, `false` otherwise with
   //!     an appropriate message logged.
-  bool Initialize();
+  bool Initialize(
+      ElfModuleMetadataCache* metadata_cache = nullptr,
+      const ElfModuleMetadataCache::FileIdentity* file = nullptr);
 
   //! \brief Returns options from the module’s CrashpadInfo structure.
   //!
@@ -89,11 +99,16 @@ class ModuleSnapshotElf final : public ModuleSnapshot {
   std::vector<const UserMinidumpStream*> CustomMinidumpStreams() const override;
 
  private:
+  // Returns false if the metadata couldn’t be read completely, in which case
+  // it shouldn’t be cached.
+  bool ReadMetadata(ElfModuleMetadataCache::Metadata* metadata);
+
   std::string name_;
   ElfImageReader* elf_reader_;
   ProcessMemoryRange* process_memory_range_;
   const ProcessMemory* process_memory_;
   std::unique_ptr<CrashpadInfoReader> crashpad_info_;
+  std::vector<uint8_t> build_id_;
   ModuleType type_;
   InitializationStateDcheck initialized_;
   // Too const-y: https://crashpad.chromium.org/bug/9.
@@ -0,0 +1,122 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/linux/capture_memory_delegate_linux.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/numerics/safe_conversions.h"
+#include "snapshot/memory_snapshot_generic.h"
+#include "util/linux/memory_map.h"
+
+namespace crashpad {
+namespace internal {
+
+CaptureMemoryDelegateLinux::CaptureMemoryDelegateLinux(
+    ProcessReaderLinux* process_reader,
+    const std::vector<CheckedRange<uint64_t>>& stacks,
+    std::vector<std::unique_ptr<MemorySnapshotGeneric>>* snapshots,
+    uint32_t* budget_remaining,
+    uint64_t* bytes_dropped)
+    : stacks_(stacks),
+      captured_(),
+      process_reader_(process_reader),
+      snapshots_(snapshots),
+      budget_remaining_(budget_remaining),
+      bytes_dropped_(bytes_dropped) {}
+
+CaptureMemoryDelegateLinux::~CaptureMemoryDelegateLinux() = default;
+
+bool CaptureMemoryDelegateLinux::Is64Bit() const {
+  return process_reader_->Is64Bit();
+}
+
+bool CaptureMemoryDelegateLinux::ReadMemory(uint64_t at,
+                                            uint64_t num_bytes,
+                                            void* into) const {
+  return process_reader_->Memory()->Read(
+      at, base::checked_cast<size_t>(num_bytes), into);
+}
+
+std::vector<CheckedRange<uint64_t>>
+CaptureMemoryDelegateLinux::GetReadableRanges(
+    const CheckedRange<uint64_t, uint64_t>& range) const {
+  std::vector<CheckedRange<uint64_t>> readable_ranges;
+  if (!range.IsValid() || range.size() == 0) {
+    return readable_ranges;
+  }
+
+  // Mappings are sorted by address and don’t overlap, so the first mapping
+  // that could contain part of |range| is the first one ending above its base.
+  const std::vector<MemoryMap::Mapping>& mappings =
+      process_reader_->GetMemoryMap()->Mappings();
+  auto mapping = std::upper_bound(
+      mappings.begin(),
+      mappings.end(),
+      range.base(),
+      [](uint64_t address, const MemoryMap::Mapping& mapping) {
+        return address < mapping.range.End();
+      });
+  for (; mapping != mappings.end() && mapping->range.Base() < range.end();
+       ++mapping) {
+    if (!mapping->readable) {
+      continue;
+    }
+
+    const uint64_t base = std::max(range.base(), mapping->range.Base());
+    const uint64_t end = std::min(range.end(), mapping->range.End());
+    if (!readable_ranges.empty() && readable_ranges.back().end() == base) {
+      readable_ranges.back().SetRange(readable_ranges.back().base(),
+                                      end - readable_ranges.back().base());
+    } else {
+      readable_ranges.emplace_back(base, end - base);
+    }
+  }
+  return readable_ranges;
+}
+
+void CaptureMemoryDelegateLinux::AddNewMemorySnapshot(
+    const CheckedRange<uint64_t, uint64_t>& range) {
+  if (range.size() == 0) {
+    return;
+  }
+
+  // Don't bother storing memory that is already in the snapshot.
+  for (const auto& stack : stacks_) {
+    if (stack.ContainsRange(range)) {
+      return;
+    }
+  }
+  for (const auto& captured : captured_) {
+    if (captured.ContainsRange(range)) {
+      return;
+    }
+  }
+
+  const uint64_t size = std::min(range.size(), uint64_t{*budget_remaining_});
+  *bytes_dropped_ += range.size() - size;
+  if (size == 0) {
+    return;
+  }
+  *budget_remaining_ -= static_cast<uint32_t>(size);
+
+  snapshots_->push_back(std::make_unique<internal::MemorySnapshotGeneric>());
+  snapshots_->back()->Initialize(
+      process_reader_->Memory(), range.base(), size);
+  captured_.emplace_back(range.base(), size);
+}
+
+}  // namespace internal
+}  // namespace crashpad
@@ -0,0 +1,83 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_SNAPSHOT_LINUX_CAPTURE_MEMORY_DELEGATE_LINUX_H_
+#define CRASHPAD_SNAPSHOT_LINUX_CAPTURE_MEMORY_DELEGATE_LINUX_H_
+
+#include "snapshot/capture_memory.h"
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/macros.h"
+#include "snapshot/linux/process_reader_linux.h"
+#include "util/numeric/checked_range.h"
+
+namespace crashpad {
+namespace internal {
+
+class MemorySnapshotGeneric;
+
+//! \brief A CaptureMemory::Delegate for Linux.
+//!
+//! A single delegate can be used to capture memory pointed to by several
+//! threads, with all captures drawing from the same budget. Callers should
+//! capture the most useful memory first, because memory found after the budget
+//! is spent is dropped.
+class CaptureMemoryDelegateLinux : public CaptureMemory::Delegate {
+ public:
+  //! \param[in] process_reader A ProcessReaderLinux for the target process.
+  //! \param[in] stacks The stacks already captured in the snapshot. Memory
+  //!     ranges within these are ignored.
+  //! \param[in] snapshots A vector of MemorySnapshotGeneric to which the
+  //!     captured memory will be added.
+  //! \param[in] budget_remaining A pointer to the remaining number of bytes to
+  //!     capture. Captured ranges are shortened to fit within the budget, and
+  //!     once it reaches `0`, no further memory will be captured.
+  //! \param[out] bytes_dropped A count of bytes that weren’t captured because
+  //!     the budget was spent, which is incremented as ranges are dropped.
+  CaptureMemoryDelegateLinux(
+      ProcessReaderLinux* process_reader,
+      const std::vector<CheckedRange<uint64_t>>& stacks,
+      std::vector<std::unique_ptr<MemorySnapshotGeneric>>* snapshots,
+      uint32_t* budget_remaining,
+      uint64_t* bytes_dropped);
+
+  ~CaptureMemoryDelegateLinux() override;
+
+  // CaptureMemory::Delegate:
+  bool Is64Bit() const override;
+  bool ReadMemory(uint64_t at, uint64_t num_bytes, void* into) const override;
+  std::vector<CheckedRange<uint64_t>> GetReadableRanges(
+      const CheckedRange<uint64_t, uint64_t>& range) const override;
+  void AddNewMemorySnapshot(
+      const CheckedRange<uint64_t, uint64_t>& range) override;
+
+ private:
+  std::vector<CheckedRange<uint64_t>> stacks_;
+  std::vector<CheckedRange<uint64_t>> captured_;
+  ProcessReaderLinux* process_reader_;  // weak
+  std::vector<std::unique_ptr<MemorySnapshotGeneric>>* snapshots_;  // weak
+  uint32_t* budget_remaining_;  // weak
+  uint64_t* bytes_dropped_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(CaptureMemoryDelegateLinux);
+};
+
+}  // namespace internal
+}  // namespace crashpad
+
+#endif  // CRASHPAD_SNAPSHOT_LINUX_CAPTURE_MEMORY_DELEGATE_LINUX_H_
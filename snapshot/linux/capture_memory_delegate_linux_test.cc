@@ -0,0 +1,125 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/linux/capture_memory_delegate_linux.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "snapshot/memory_snapshot_generic.h"
+#include "test/linux/fake_ptrace_connection.h"
+#include "util/misc/from_pointer_cast.h"
+#include "util/posix/scoped_mmap.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+TEST(CaptureMemoryDelegateLinux, GetReadableRanges) {
+  const size_t page_size = getpagesize();
+  ScopedMmap mapping;
+  ASSERT_TRUE(mapping.ResetMmap(nullptr,
+                                page_size * 3,
+                                PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS,
+                                -1,
+                                0));
+  ASSERT_EQ(
+      mprotect(mapping.addr_as<char*>() + page_size, page_size, PROT_NONE), 0);
+
+  FakePtraceConnection connection;
+  ASSERT_TRUE(connection.Initialize(getpid()));
+  ProcessReaderLinux process_reader;
+  ASSERT_TRUE(process_reader.Initialize(&connection));
+
+  std::vector<std::unique_ptr<internal::MemorySnapshotGeneric>> snapshots;
+  uint32_t budget_remaining = 0;
+  uint64_t bytes_dropped = 0;
+  internal::CaptureMemoryDelegateLinux delegate(&process_reader,
+                                                {},
+                                                &snapshots,
+                                                &budget_remaining,
+                                                &bytes_dropped);
+
+  const uint64_t base = mapping.addr_as<uint64_t>();
+  std::vector<CheckedRange<uint64_t>> ranges = delegate.GetReadableRanges(
+      CheckedRange<uint64_t>(base + page_size - 256, page_size + 512));
+  ASSERT_EQ(ranges.size(), 2u);
+  EXPECT_EQ(ranges[0].base(), base + page_size - 256);
+  EXPECT_EQ(ranges[0].size(), 256u);
+  EXPECT_EQ(ranges[1].base(), base + page_size * 2);
+  EXPECT_EQ(ranges[1].size(), 256u);
+
+  ranges = delegate.GetReadableRanges(
+      CheckedRange<uint64_t>(base + page_size, page_size));
+  EXPECT_TRUE(ranges.empty());
+
+  ranges = delegate.GetReadableRanges(CheckedRange<uint64_t>(base, 16));
+  ASSERT_EQ(ranges.size(), 1u);
+  EXPECT_EQ(ranges[0].base(), base);
+  EXPECT_EQ(ranges[0].size(), 16u);
+}
+
+TEST(CaptureMemoryDelegateLinux, Budget) {
+  FakePtraceConnection connection;
+  ASSERT_TRUE(connection.Initialize(getpid()));
+  ProcessReaderLinux process_reader;
+  ASSERT_TRUE(process_reader.Initialize(&connection));
+
+  static char buffer[4096];
+  const uint64_t base = FromPointerCast<uint64_t>(buffer);
+
+  std::vector<std::unique_ptr<internal::MemorySnapshotGeneric>> snapshots;
+  uint32_t budget_remaining = 1000;
+  uint64_t bytes_dropped = 0;
+  internal::CaptureMemoryDelegateLinux delegate(
+      &process_reader,
+      {CheckedRange<uint64_t>(base + 3072, 1024)},
+      &snapshots,
+      &budget_remaining,
+      &bytes_dropped);
+
+  delegate.AddNewMemorySnapshot(CheckedRange<uint64_t>(base, 512));
+  ASSERT_EQ(snapshots.size(), 1u);
+  EXPECT_EQ(snapshots[0]->Address(), base);
+  EXPECT_EQ(snapshots[0]->Size(), 512u);
+  EXPECT_EQ(budget_remaining, 488u);
+
+  // Ranges already in the snapshot don’t use any budget.
+  delegate.AddNewMemorySnapshot(CheckedRange<uint64_t>(base + 128, 256));
+  delegate.AddNewMemorySnapshot(CheckedRange<uint64_t>(base + 3072, 512));
+  EXPECT_EQ(snapshots.size(), 1u);
+  EXPECT_EQ(budget_remaining, 488u);
+  EXPECT_EQ(bytes_dropped, 0u);
+
+  // A range that doesn’t fit in the remaining budget is shortened.
+  delegate.AddNewMemorySnapshot(CheckedRange<uint64_t>(base + 1024, 512));
+  ASSERT_EQ(snapshots.size(), 2u);
+  EXPECT_EQ(snapshots[1]->Address(), base + 1024);
+  EXPECT_EQ(snapshots[1]->Size(), 488u);
+  EXPECT_EQ(budget_remaining, 0u);
+  EXPECT_EQ(bytes_dropped, 24u);
+
+  delegate.AddNewMemorySnapshot(CheckedRange<uint64_t>(base + 2048, 512));
+  EXPECT_EQ(snapshots.size(), 2u);
+  EXPECT_EQ(bytes_dropped, 536u);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
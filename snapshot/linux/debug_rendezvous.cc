@@ -52,6 +52,37 @@ struct LinkEntrySpecific {
   typename Traits::Address l_prev;
 };
 
+// RT_CONSISTENT from <link.h>.
+constexpr int kRTConsistent = 0;
+
+template <typename Traits>
+bool ReadDebugRendezvous(const ProcessMemoryRange& memory,
+                         LinuxVMAddress address,
+                         DebugRendezvousSpecific<Traits>* debug) {
+  if (!memory.Read(address, sizeof(*debug), debug)) {
+    return false;
+  }
+  if (debug->r_version != 1) {
+    LOG(ERROR) << "unexpected version " << debug->r_version;
+    return false;
+  }
+  return true;
+}
+
+template <typename Traits>
+bool ReadStateSpecific(const ProcessMemoryRange& memory,
+               LinuxVMAddress address,
+               LinuxVMAddress* link_map,
+               bool* consistent) {
+  DebugRendezvousSpecific<Traits> debug;
+  if (!ReadDebugRendezvous(memory, address, &debug)) {
+    return false;
+  }
+  *link_map = debug.r_map;
+  *consistent = debug.r_state == kRTConsistent;
+  return true;
+}
+
 template <typename Traits>
 bool ReadLinkEntry(const ProcessMemoryRange& memory,
                    LinuxVMAddress* address,
@@ -95,6 +126,17 @@ bool DebugRendezvous::Initialize(const ProcessMemoryRange& memory,
   return true;
 }
 
+// static
+bool DebugRendezvous::ReadState(const ProcessMemoryRange& memory,
+                                LinuxVMAddress address,
+                                LinuxVMAddress* link_map,
+                                bool* consistent) {
+  return memory.Is64Bit() ? ReadStateSpecific<Traits64>(
+                                memory, address, link_map, consistent)
+                          : ReadStateSpecific<Traits32>(
+                                memory, address, link_map, consistent);
+}
+
 const DebugRendezvous::LinkEntry* DebugRendezvous::Executable() const {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
   return &executable_;
@@ -110,11 +152,7 @@ template <typename Traits>
 bool DebugRendezvous::InitializeSpecific(const ProcessMemoryRange& memory,
                                          LinuxVMAddress address) {
   DebugRendezvousSpecific<Traits> debug;
-  if (!memory.Read(address, sizeof(debug), &debug)) {
-    return false;
-  }
-  if (debug.r_version != 1) {
-    LOG(ERROR) << "unexpected version " << debug.r_version;
+  if (!ReadDebugRendezvous(memory, address, &debug)) {
     return false;
   }
 
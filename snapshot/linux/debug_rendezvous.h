@@ -62,6 +62,21 @@ class DebugRendezvous {
   //! \return `true` on success. `false` on failure with a message logged.
   bool Initialize(const ProcessMemoryRange& memory, LinuxVMAddress address);
 
+  //! \brief Reads the head of the link map and the dynamic linker’s state from
+  //!     an `r_debug` struct, without walking the link map.
+  //!
+  //! \param[in] memory A memory reader for the remote process.
+  //! \param[in] address The address of an `r_debug` struct in the remote
+  //!     process.
+  //! \param[out] link_map The address of the first entry in the link map.
+  //! \param[out] consistent `true` if the dynamic linker reports that the link
+  //!     map is consistent, `false` if an object is being added or removed.
+  //! \return `true` on success. `false` on failure with a message logged.
+  static bool ReadState(const ProcessMemoryRange& memory,
+                        LinuxVMAddress address,
+                        LinuxVMAddress* link_map,
+                        bool* consistent);
+
   //! \brief Returns the LinkEntry for the main executable.
   const LinkEntry* Executable() const;
 
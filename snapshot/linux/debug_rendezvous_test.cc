@@ -78,6 +78,13 @@ void TestAgainstTarget(PtraceConnection* connection) {
   DebugRendezvous debug;
   ASSERT_TRUE(debug.Initialize(range, debug_address));
 
+  LinuxVMAddress link_map;
+  bool consistent;
+  ASSERT_TRUE(
+      DebugRendezvous::ReadState(range, debug_address, &link_map, &consistent));
+  EXPECT_NE(link_map, 0u);
+  EXPECT_TRUE(consistent);
+
 #if defined(OS_ANDROID)
   const int android_runtime_api = android_get_device_api_level();
   ASSERT_GE(android_runtime_api, 1);
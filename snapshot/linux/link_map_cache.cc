@@ -0,0 +1,173 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/linux/link_map_cache.h"
+
+#include <utility>
+
+#include "base/logging.h"
+#include "snapshot/linux/debug_rendezvous.h"
+#include "util/misc/metrics.h"
+
+namespace crashpad {
+
+namespace {
+
+// The maximum number of processes to cache modules for. Entries for processes
+// that have exited are only removed by eviction.
+constexpr size_t kMaxEntries = 32;
+
+}  // namespace
+
+LinkMapCache::Module::Module()
+    : name(),
+      address(0),
+      device(0),
+      inode(0),
+      offset(0),
+      type(ModuleSnapshot::kModuleTypeUnknown) {}
+
+LinkMapCache::Module::~Module() {}
+
+LinkMapCache::Entry::Entry()
+    : start_time(),
+      debug_address(0),
+      link_map(0),
+      mappings(),
+      modules(),
+      last_used(0) {}
+
+LinkMapCache::Entry::~Entry() {}
+
+LinkMapCache::LinkMapCache() : entries_(), use_count_(0) {}
+
+LinkMapCache::~LinkMapCache() {}
+
+const std::vector<LinkMapCache::Module>* LinkMapCache::Lookup(
+    pid_t pid,
+    const timeval& start_time,
+    const ProcessMemoryRange& memory,
+    const MemoryMap& memory_map) {
+  auto iterator = entries_.find(pid);
+  if (iterator == entries_.end()) {
+    Metrics::LinkMapCacheLookup(Metrics::LinkMapCacheResult::kMiss);
+    return nullptr;
+  }
+
+  Entry& entry = iterator->second;
+  if (timercmp(&entry.start_time, &start_time, !=)) {
+    // The process ID was reused by a different process.
+    entries_.erase(iterator);
+    Metrics::LinkMapCacheLookup(Metrics::LinkMapCacheResult::kMiss);
+    return nullptr;
+  }
+
+  if (!IsCurrent(entry, memory, memory_map)) {
+    entries_.erase(iterator);
+    Metrics::LinkMapCacheLookup(Metrics::LinkMapCacheResult::kStale);
+    return nullptr;
+  }
+
+  entry.last_used = ++use_count_;
+  return &entry.modules;
+}
+
+void LinkMapCache::Insert(pid_t pid,
+                          const timeval& start_time,
+                          const ProcessMemoryRange& memory,
+                          const MemoryMap& memory_map,
+                          LinuxVMAddress debug_address,
+                          std::vector<Module> modules) {
+  Remove(pid);
+
+  Entry entry;
+  bool consistent;
+  if (!DebugRendezvous::ReadState(
+          memory, debug_address, &entry.link_map, &consistent) ||
+      !consistent) {
+    return;
+  }
+
+  if (entries_.size() >= kMaxEntries) {
+    auto least_recently_used = entries_.begin();
+    for (auto iterator = entries_.begin(); iterator != entries_.end();
+         ++iterator) {
+      if (iterator->second.last_used < least_recently_used->second.last_used) {
+        least_recently_used = iterator;
+      }
+    }
+    entries_.erase(least_recently_used);
+  }
+
+  entry.start_time = start_time;
+  entry.debug_address = debug_address;
+  entry.mappings = ExecutableFileMappings(memory_map);
+  entry.modules = std::move(modules);
+  entry.last_used = ++use_count_;
+  entries_[pid] = std::move(entry);
+}
+
+void LinkMapCache::Remove(pid_t pid) {
+  entries_.erase(pid);
+}
+
+// static
+std::vector<LinkMapCache::MappingIdentity> LinkMapCache::ExecutableFileMappings(
+    const MemoryMap& memory_map) {
+  // Loading or unloading a module always adds or removes an executable mapping
+  // of its file. Restricting the comparison to these mappings keeps unrelated
+  // changes, such as heap growth or data files being mapped, from invalidating
+  // the cache.
+  std::vector<MappingIdentity> mappings;
+  for (const MemoryMap::Mapping& mapping : memory_map.Mappings()) {
+    if (mapping.executable && mapping.inode != 0) {
+      MappingIdentity identity;
+      identity.address = mapping.range.Base();
+      identity.device = mapping.device;
+      identity.inode = mapping.inode;
+      mappings.push_back(identity);
+    }
+  }
+  return mappings;
+}
+
+// static
+bool LinkMapCache::IsCurrent(const Entry& entry,
+                             const ProcessMemoryRange& memory,
+                             const MemoryMap& memory_map) {
+  LinuxVMAddress link_map;
+  bool consistent;
+  if (!DebugRendezvous::ReadState(
+          memory, entry.debug_address, &link_map, &consistent) ||
+      !consistent || link_map != entry.link_map) {
+    return false;
+  }
+
+  if (ExecutableFileMappings(memory_map) != entry.mappings) {
+    return false;
+  }
+
+  for (const Module& module : entry.modules) {
+    const MemoryMap::Mapping* mapping = memory_map.FindMapping(module.address);
+    if (!mapping || mapping->range.Base() != module.address ||
+        mapping->device != module.device || mapping->inode != module.inode ||
+        mapping->offset != module.offset) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+}  // namespace crashpad
@@ -0,0 +1,156 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_SNAPSHOT_LINUX_LINK_MAP_CACHE_H_
+#define CRASHPAD_SNAPSHOT_LINUX_LINK_MAP_CACHE_H_
+
+#include <stdint.h>
+#include <sys/time.h>
+#include <sys/types.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "snapshot/module_snapshot.h"
+#include "util/linux/address_types.h"
+#include "util/linux/memory_map.h"
+#include "util/process/process_memory_range.h"
+
+namespace crashpad {
+
+//! \brief Caches the modules that ProcessReaderLinux identifies in a process,
+//!     so that they needn’t be located again for subsequent snapshots of the
+//!     same process.
+//!
+//! Locating modules requires walking the dynamic linker’s link map and parsing
+//! several candidate ELF images for each entry. A cached result is reused as
+//! long as the process appears not to have loaded or unloaded anything since:
+//! the link map must start at the same entry and be consistent, every
+//! executable file-backed mapping must be unchanged, and each module’s base
+//! mapping must still come from the same file.
+//!
+//! This class is not thread-safe.
+class LinkMapCache {
+ public:
+  //! \brief Information about a module that remains valid for as long as the
+  //!     module stays loaded.
+  struct Module {
+    Module();
+    ~Module();
+
+    //! \brief The module’s name, as reported by ProcessReaderLinux::Module.
+    std::string name;
+
+    //! \brief The address of the module’s ELF header.
+    LinuxVMAddress address;
+
+    //! \brief The device of the file mapped at #address.
+    dev_t device;
+
+    //! \brief The inode of the file mapped at #address.
+    ino_t inode;
+
+    //! \brief The offset in the file of the mapping at #address.
+    off64_t offset;
+
+    //! \brief The module’s type.
+    ModuleSnapshot::ModuleType type;
+  };
+
+  LinkMapCache();
+  ~LinkMapCache();
+
+  //! \brief Returns the cached modules for a process, if they are still
+  //!     current.
+  //!
+  //! Stale entries are removed. A LinkMapCacheLookup metric is recorded if no
+  //! current modules are found; the caller is responsible for recording the
+  //! outcome otherwise.
+  //!
+  //! \param[in] pid The process ID.
+  //! \param[in] start_time The process’ start time, used to distinguish
+  //!     processes that reuse a process ID.
+  //! \param[in] memory A memory reader for the process.
+  //! \param[in] memory_map The process’ current memory map.
+  //! \return The cached modules, or `nullptr` if there are none or they are
+  //!     stale. The returned vector is valid until the cache is next modified.
+  const std::vector<Module>* Lookup(pid_t pid,
+                                    const timeval& start_time,
+                                    const ProcessMemoryRange& memory,
+                                    const MemoryMap& memory_map);
+
+  //! \brief Caches the modules for a process, replacing any that were
+  //!     previously cached.
+  //!
+  //! Nothing is cached if the dynamic linker reports that its link map is in
+  //! the process of being modified. If the cache is full, the least recently
+  //! used process is evicted.
+  //!
+  //! \param[in] pid The process ID.
+  //! \param[in] start_time The process’ start time.
+  //! \param[in] memory A memory reader for the process.
+  //! \param[in] memory_map The memory map that \a modules were located with.
+  //! \param[in] debug_address The address of the process’ `r_debug` struct.
+  //! \param[in] modules The modules to cache.
+  void Insert(pid_t pid,
+              const timeval& start_time,
+              const ProcessMemoryRange& memory,
+              const MemoryMap& memory_map,
+              LinuxVMAddress debug_address,
+              std::vector<Module> modules);
+
+  //! \brief Removes the cached modules for a process, if any.
+  void Remove(pid_t pid);
+
+ private:
+  struct MappingIdentity {
+    LinuxVMAddress address;
+    dev_t device;
+    ino_t inode;
+
+    bool operator==(const MappingIdentity& other) const {
+      return address == other.address && device == other.device &&
+             inode == other.inode;
+    }
+  };
+
+  struct Entry {
+    Entry();
+    ~Entry();
+
+    timeval start_time;
+    LinuxVMAddress debug_address;
+    LinuxVMAddress link_map;
+    std::vector<MappingIdentity> mappings;
+    std::vector<Module> modules;
+    uint64_t last_used;
+  };
+
+  static std::vector<MappingIdentity> ExecutableFileMappings(
+      const MemoryMap& memory_map);
+  static bool IsCurrent(const Entry& entry,
+                        const ProcessMemoryRange& memory,
+                        const MemoryMap& memory_map);
+
+  std::map<pid_t, Entry> entries_;
+  uint64_t use_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(LinkMapCache);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_SNAPSHOT_LINUX_LINK_MAP_CACHE_H_
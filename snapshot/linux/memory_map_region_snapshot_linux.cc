@@ -0,0 +1,58 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/linux/memory_map_region_snapshot_linux.h"
+
+namespace crashpad {
+namespace internal {
+
+namespace {
+
+uint32_t ProtectionFromMapping(const MemoryMap::Mapping& mapping) {
+  if (mapping.executable) {
+    if (mapping.writable) {
+      return PAGE_EXECUTE_READWRITE;
+    }
+    return mapping.readable ? PAGE_EXECUTE_READ : PAGE_EXECUTE;
+  }
+  if (mapping.writable) {
+    return PAGE_READWRITE;
+  }
+  return mapping.readable ? PAGE_READONLY : PAGE_NOACCESS;
+}
+
+}  // namespace
+
+MemoryMapRegionSnapshotLinux::MemoryMapRegionSnapshotLinux(
+    const MemoryMap::Mapping& mapping)
+    : memory_info_() {
+  memory_info_.BaseAddress = mapping.range.Base();
+  memory_info_.AllocationBase = mapping.range.Base();
+  memory_info_.AllocationProtect = ProtectionFromMapping(mapping);
+  memory_info_.RegionSize = mapping.range.Size();
+  memory_info_.State = MEM_COMMIT;
+  memory_info_.Protect = memory_info_.AllocationProtect;
+  memory_info_.Type =
+      mapping.inode == 0 && !mapping.shareable ? MEM_PRIVATE : MEM_MAPPED;
+}
+
+MemoryMapRegionSnapshotLinux::~MemoryMapRegionSnapshotLinux() {}
+
+const MINIDUMP_MEMORY_INFO& MemoryMapRegionSnapshotLinux::AsMinidumpMemoryInfo()
+    const {
+  return memory_info_;
+}
+
+}  // namespace internal
+}  // namespace crashpad
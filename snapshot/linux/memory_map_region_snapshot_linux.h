@@ -0,0 +1,49 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_SNAPSHOT_LINUX_MEMORY_MAP_REGION_SNAPSHOT_LINUX_H_
+#define CRASHPAD_SNAPSHOT_LINUX_MEMORY_MAP_REGION_SNAPSHOT_LINUX_H_
+
+#include "base/macros.h"
+#include "snapshot/memory_map_region_snapshot.h"
+#include "util/linux/memory_map.h"
+
+namespace crashpad {
+namespace internal {
+
+//! \brief A MemoryMapRegionSnapshot of a mapping in a process on a Linux
+//!     system.
+//!
+//! The mapping’s permissions are translated to the closest `PAGE_*` protection
+//! value. Private anonymous mappings have type `MEM_PRIVATE`, and all other
+//! mappings have type `MEM_MAPPED`.
+class MemoryMapRegionSnapshotLinux final : public MemoryMapRegionSnapshot {
+ public:
+  explicit MemoryMapRegionSnapshotLinux(const MemoryMap::Mapping& mapping);
+  ~MemoryMapRegionSnapshotLinux() override;
+
+  // MemoryMapRegionSnapshot:
+
+  const MINIDUMP_MEMORY_INFO& AsMinidumpMemoryInfo() const override;
+
+ private:
+  MINIDUMP_MEMORY_INFO memory_info_;
+
+  DISALLOW_COPY_AND_ASSIGN(MemoryMapRegionSnapshotLinux);
+};
+
+}  // namespace internal
+}  // namespace crashpad
+
+#endif  // CRASHPAD_SNAPSHOT_LINUX_MEMORY_MAP_REGION_SNAPSHOT_LINUX_H_
@@ -0,0 +1,336 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/linux/module_file_mappings.h"
+
+#include <elf.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <utility>
+
+#include "base/logging.h"
+#include "base/posix/eintr_wrapper.h"
+
+namespace crashpad {
+
+namespace {
+
+using FileID = std::pair<dev_t, ino_t>;
+
+// Opens the file that |mapping| maps, if it can be opened by name and is the
+// same file, and returns its size in |size|.
+ScopedFileHandle OpenFile(const MemoryMap::Mapping& mapping, uint64_t* size) {
+  // Failing to open the file is expected for deleted files and for processes
+  // in other mount namespaces, so it isn’t logged. The name may now refer to
+  // something other than a regular file, such as a FIFO, so it’s opened
+  // without blocking.
+  ScopedFileHandle handle(HANDLE_EINTR(open(
+      mapping.name.c_str(), O_RDONLY | O_NONBLOCK | O_NOCTTY | O_CLOEXEC)));
+  if (!handle.is_valid()) {
+    return ScopedFileHandle();
+  }
+
+  struct stat st;
+  if (fstat(handle.get(), &st) != 0) {
+    PLOG(ERROR) << "fstat";
+    return ScopedFileHandle();
+  }
+
+  if (!S_ISREG(st.st_mode) || st.st_dev != mapping.device ||
+      st.st_ino != mapping.inode || st.st_size <= 0) {
+    return ScopedFileHandle();
+  }
+
+  *size = st.st_size;
+  return handle;
+}
+
+// Reads |size| bytes at |offset| in |file|. A short read, which is expected if
+// the file has been truncated, is a failure.
+bool ReadFileAt(int file, uint64_t offset, void* buffer, size_t size) {
+  const ssize_t bytes_read = HANDLE_EINTR(pread64(file, buffer, size, offset));
+  if (bytes_read < 0) {
+    PLOG(ERROR) << "pread64";
+    return false;
+  }
+  return static_cast<size_t>(bytes_read) == size;
+}
+
+// Returns true if |size| bytes at |address| in the process are mapped without
+// write permission from the file mapped by |base_mapping|, beginning at
+// |file_offset|.
+bool MappedFromFile(const MemoryMap& memory_map,
+                    const MemoryMap::Mapping& base_mapping,
+                    VMAddress address,
+                    VMSize size,
+                    uint64_t file_offset) {
+  const VMAddress end = address + size;
+  if (end < address) {
+    return false;
+  }
+
+  VMAddress current = address;
+  while (current < end) {
+    const MemoryMap::Mapping* mapping = memory_map.FindMapping(current);
+    if (!mapping || !mapping->readable || mapping->writable ||
+        mapping->device != base_mapping.device ||
+        mapping->inode != base_mapping.inode ||
+        static_cast<uint64_t>(mapping->offset) +
+                (current - mapping->range.Base()) !=
+            file_offset + (current - address)) {
+      return false;
+    }
+    current = mapping->range.End();
+  }
+  return true;
+}
+
+// Adds regions for the read-only segments of the ELF module whose header is
+// mapped by |base_mapping| from |file|, which is |file_size| bytes long,
+// leaving out pages that |page_map| shows have been modified.
+template <typename Ehdr, typename Phdr>
+void AddSegments(const MemoryMap& memory_map,
+                 const MemoryMap::Mapping& base_mapping,
+                 int file,
+                 uint64_t file_size,
+                 const PageMap& page_map,
+                 std::vector<ProcessMemoryOverlay::Region>* regions) {
+  const uint64_t elf_offset = base_mapping.offset;
+  if (elf_offset > file_size || file_size - elf_offset < sizeof(Ehdr)) {
+    return;
+  }
+  const uint64_t elf_size = file_size - elf_offset;
+
+  Ehdr ehdr;
+  if (!ReadFileAt(file, elf_offset, &ehdr, sizeof(ehdr)) ||
+      ehdr.e_phentsize != sizeof(Phdr) || ehdr.e_phoff > elf_size ||
+      ehdr.e_phnum > (elf_size - ehdr.e_phoff) / sizeof(Phdr)) {
+    return;
+  }
+
+  std::vector<Phdr> phdrs(ehdr.e_phnum);
+  if (!ReadFileAt(file,
+                  elf_offset + ehdr.e_phoff,
+                  phdrs.data(),
+                  phdrs.size() * sizeof(Phdr))) {
+    return;
+  }
+
+  const Phdr* first_load = nullptr;
+  VMAddress relro_start = 0;
+  VMAddress relro_end = 0;
+  for (const Phdr& phdr : phdrs) {
+    if (phdr.p_type == PT_LOAD && !first_load) {
+      first_load = &phdr;
+    } else if (phdr.p_type == PT_GNU_RELRO) {
+      relro_start = phdr.p_vaddr;
+      relro_end = relro_start + phdr.p_memsz;
+    }
+  }
+
+  // The base mapping must map the start of the first segment, which contains
+  // the ELF header.
+  if (!first_load || first_load->p_offset != 0) {
+    return;
+  }
+  const VMAddress page_mask = ~static_cast<VMAddress>(getpagesize() - 1);
+  const VMAddress load_bias =
+      base_mapping.range.Base() - (first_load->p_vaddr & page_mask);
+
+  for (const Phdr& phdr : phdrs) {
+    if (phdr.p_type != PT_LOAD || (phdr.p_flags & PF_W) ||
+        phdr.p_filesz == 0 || phdr.p_offset > elf_size ||
+        phdr.p_filesz > elf_size - phdr.p_offset) {
+      continue;
+    }
+
+    // Split the segment around the part of it that is relocated and then made
+    // read-only, which differs from the file.
+    const VMAddress segment_start = phdr.p_vaddr;
+    const VMAddress segment_end = segment_start + phdr.p_filesz;
+    std::pair<VMAddress, VMAddress> pieces[] = {
+        {segment_start, std::min(segment_end, relro_start)},
+        {std::max(segment_start, relro_end), segment_end},
+    };
+    if (relro_start == relro_end) {
+      pieces[0].second = segment_end;
+      pieces[1].first = segment_end;
+    }
+
+    for (const auto& piece : pieces) {
+      if (piece.first >= piece.second) {
+        continue;
+      }
+
+      const VMAddress address = load_bias + piece.first;
+      const VMSize size = piece.second - piece.first;
+      const uint64_t file_offset =
+          elf_offset + phdr.p_offset + (piece.first - segment_start);
+      const CheckedRange<VMAddress, VMSize> range(address, size);
+      std::vector<CheckedRange<VMAddress, VMSize>> file_backed;
+      if (!range.IsValid() ||
+          !MappedFromFile(
+              memory_map, base_mapping, address, size, file_offset) ||
+          !page_map.FileBackedRanges(range, &file_backed)) {
+        continue;
+      }
+
+      for (const auto& unmodified : file_backed) {
+        ProcessMemoryOverlay::Region region;
+        region.address = unmodified.base();
+        region.size = unmodified.size();
+        region.data = nullptr;
+        region.file = file;
+        region.file_offset = file_offset + (unmodified.base() - address);
+        regions->push_back(region);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+ModuleFileMappings::ModuleFileMappings()
+    : files_(), unmodified_ranges_(), memory_(), initialized_() {}
+
+ModuleFileMappings::~ModuleFileMappings() {}
+
+bool ModuleFileMappings::Initialize(const MemoryMap& memory_map,
+                                    const ProcessMemory* memory,
+                                    const PageMap* page_map) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+
+  // Only files with executable mappings are considered, to avoid opening data
+  // files that the process has mapped. Without a page map, there’s no way to
+  // tell whether the process has modified its modules, so none are used.
+  std::set<FileID> module_files;
+  for (const MemoryMap::Mapping& mapping : memory_map.Mappings()) {
+    if (page_map && mapping.executable && mapping.inode != 0) {
+      module_files.insert(FileID(mapping.device, mapping.inode));
+    }
+  }
+
+  // A file that couldn’t be opened is recorded with a size of 0.
+  std::map<FileID, std::pair<int, uint64_t>> opened_files;
+  std::vector<ProcessMemoryOverlay::Region> regions;
+  for (const MemoryMap::Mapping& mapping : memory_map.Mappings()) {
+    const FileID file_id(mapping.device, mapping.inode);
+    if (!mapping.readable || mapping.writable ||
+        !module_files.count(file_id)) {
+      continue;
+    }
+
+    auto opened_file = opened_files.find(file_id);
+    if (opened_file == opened_files.end()) {
+      uint64_t size = 0;
+      ScopedFileHandle file = OpenFile(mapping, &size);
+      opened_file =
+          opened_files
+              .insert(std::make_pair(file_id, std::make_pair(file.get(), size)))
+              .first;
+      if (file.is_valid()) {
+        files_.push_back(std::move(file));
+      }
+    }
+
+    const int file = opened_file->second.first;
+    const uint64_t file_size = opened_file->second.second;
+    unsigned char e_ident[EI_NIDENT];
+    if (file_size == 0 || mapping.offset < 0 ||
+        static_cast<uint64_t>(mapping.offset) > file_size ||
+        file_size - mapping.offset < EI_NIDENT ||
+        !ReadFileAt(file, mapping.offset, e_ident, sizeof(e_ident)) ||
+        memcmp(e_ident, ELFMAG, SELFMAG) != 0) {
+      continue;
+    }
+
+    if (e_ident[EI_CLASS] == ELFCLASS64) {
+      AddSegments<Elf64_Ehdr, Elf64_Phdr>(
+          memory_map, mapping, file, file_size, *page_map, &regions);
+    } else if (e_ident[EI_CLASS] == ELFCLASS32) {
+      AddSegments<Elf32_Ehdr, Elf32_Phdr>(
+          memory_map, mapping, file, file_size, *page_map, &regions);
+    }
+  }
+
+  // Mappings that look like they begin modules may overlap, for example if
+  // they’re made to look like modules deliberately. Keep the first of any
+  // overlapping regions.
+  std::sort(regions.begin(),
+            regions.end(),
+            [](const ProcessMemoryOverlay::Region& lhs,
+               const ProcessMemoryOverlay::Region& rhs) {
+              return lhs.address < rhs.address;
+            });
+  std::vector<ProcessMemoryOverlay::Region> disjoint_regions;
+  for (const ProcessMemoryOverlay::Region& region : regions) {
+    if (disjoint_regions.empty() ||
+        disjoint_regions.back().address + disjoint_regions.back().size <=
+            region.address) {
+      disjoint_regions.push_back(region);
+      unmodified_ranges_.push_back(
+          CheckedRange<VMAddress, VMSize>(region.address, region.size));
+    }
+  }
+
+  if (!memory_.Initialize(memory, disjoint_regions)) {
+    return false;
+  }
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+const ProcessMemory* ModuleFileMappings::Memory() const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return &memory_;
+}
+
+std::vector<CheckedRange<VMAddress, VMSize>>
+ModuleFileMappings::UnmodifiedRanges(
+    const CheckedRange<VMAddress, VMSize>& range) const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  DCHECK(range.IsValid());
+
+  std::vector<CheckedRange<VMAddress, VMSize>> ranges;
+  auto unmodified = std::upper_bound(
+      unmodified_ranges_.begin(),
+      unmodified_ranges_.end(),
+      range.base(),
+      [](VMAddress value, const CheckedRange<VMAddress, VMSize>& unmodified) {
+        return value < unmodified.base();
+      });
+  if (unmodified != unmodified_ranges_.begin()) {
+    --unmodified;
+  }
+
+  for (; unmodified != unmodified_ranges_.end() &&
+         unmodified->base() < range.end();
+       ++unmodified) {
+    const VMAddress base = std::max(unmodified->base(), range.base());
+    const VMAddress end = std::min(unmodified->end(), range.end());
+    if (base < end) {
+      ranges.push_back(CheckedRange<VMAddress, VMSize>(base, end - base));
+    }
+  }
+  return ranges;
+}
+
+}  // namespace crashpad
@@ -0,0 +1,95 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_SNAPSHOT_LINUX_MODULE_FILE_MAPPINGS_H_
+#define CRASHPAD_SNAPSHOT_LINUX_MODULE_FILE_MAPPINGS_H_
+
+#include <vector>
+
+#include "base/macros.h"
+#include "util/file/file_io.h"
+#include "util/linux/memory_map.h"
+#include "util/linux/page_map.h"
+#include "util/misc/address_types.h"
+#include "util/misc/initialization_state_dcheck.h"
+#include "util/numeric/checked_range.h"
+#include "util/process/process_memory.h"
+#include "util/process/process_memory_overlay.h"
+
+namespace crashpad {
+
+//! \brief Opens the files that a process’ modules were loaded from, so that
+//!     the unmodified parts of the modules can be read locally instead of from
+//!     the process.
+//!
+//! Only the `PT_LOAD` segments of an ELF module that aren’t writable and
+//! aren’t covered by `PT_GNU_RELRO` are read from the file. The dynamic linker
+//! doesn’t modify these after mapping them, so their contents in the process
+//! are the same as in the file, unless the process has written to them after
+//! changing their protection, or a debugger has. This covers the ELF header,
+//! program headers, notes, and dynamic symbol and string tables. Everything
+//! else, including the dynamic array, is read from the process.
+//!
+//! A module’s file is only used if it can be opened by the name in the memory
+//! map and has the same device and inode as the mapped file, and if the
+//! process’ mappings of the segments match the file. Pages that the process’
+//! page map shows have been copied on write are read from the process.
+//!
+//! Files are read with `pread()` rather than mapped, so that a file being
+//! truncated while it’s in use results in failed reads rather than `SIGBUS`.
+class ModuleFileMappings {
+ public:
+  ModuleFileMappings();
+  ~ModuleFileMappings();
+
+  //! \brief Initializes this object.
+  //!
+  //! Modules whose files can’t be used are silently left to be read from \a
+  //! memory.
+  //!
+  //! \param[in] memory_map The memory map of the process.
+  //! \param[in] memory A memory reader for the process.
+  //! \param[in] page_map A page map of the process, used to find the pages of
+  //!     modules that the process has modified. If `nullptr`, nothing is read
+  //!     from module files.
+  //! \return `true` on success, `false` on failure with a message logged.
+  bool Initialize(const MemoryMap& memory_map,
+                  const ProcessMemory* memory,
+                  const PageMap* page_map);
+
+  //! \brief Returns a memory reader for the process that reads the unmodified
+  //!     parts of modules from their files.
+  const ProcessMemory* Memory() const;
+
+  //! \brief Returns the parts of a range in the process that are read from
+  //!     module files.
+  //!
+  //! \param[in] range The range to examine.
+  //! \return The parts of \a range whose contents are the same as in a module
+  //!     file, sorted by address.
+  std::vector<CheckedRange<VMAddress, VMSize>> UnmodifiedRanges(
+      const CheckedRange<VMAddress, VMSize>& range) const;
+
+ private:
+  std::vector<ScopedFileHandle> files_;
+  std::vector<CheckedRange<VMAddress, VMSize>> unmodified_ranges_;
+  ProcessMemoryOverlay memory_;
+  InitializationStateDcheck initialized_;
+
+  DISALLOW_COPY_AND_ASSIGN(ModuleFileMappings);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_SNAPSHOT_LINUX_MODULE_FILE_MAPPINGS_H_
@@ -0,0 +1,186 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/linux/module_file_mappings.h"
+
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test/errors.h"
+#include "test/linux/fake_ptrace_connection.h"
+#include "test/multiprocess.h"
+#include "util/file/file_io.h"
+#include "util/linux/page_map.h"
+#include "util/misc/from_pointer_cast.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+constexpr char kReadOnlyData[] = "read-only data in a module file";
+const char kModifiedData[] = "read-only data modified in memory";
+char g_writable_data[] = "writable data";
+
+void ExpectReadFromFile(const ModuleFileMappings& module_files,
+                        const ProcessMemory* memory,
+                        VMAddress address,
+                        VMSize size) {
+  const std::vector<CheckedRange<VMAddress, VMSize>> unmodified =
+      module_files.UnmodifiedRanges(
+          CheckedRange<VMAddress, VMSize>(address, size));
+  ASSERT_EQ(unmodified.size(), 1u);
+  EXPECT_EQ(unmodified[0].base(), address);
+  EXPECT_EQ(unmodified[0].size(), size);
+
+  std::vector<char> from_file(size);
+  ASSERT_TRUE(module_files.Memory()->Read(address, size, from_file.data()));
+  std::vector<char> from_process(size);
+  ASSERT_TRUE(memory->Read(address, size, from_process.data()));
+  EXPECT_EQ(from_file, from_process);
+}
+
+TEST(ModuleFileMappings, Self) {
+  FakePtraceConnection connection;
+  ASSERT_TRUE(connection.Initialize(getpid()));
+
+  MemoryMap memory_map;
+  ASSERT_TRUE(memory_map.Initialize(&connection));
+
+  PageMap page_map;
+  ASSERT_TRUE(page_map.Initialize(getpid()));
+
+  ModuleFileMappings module_files;
+  ASSERT_TRUE(
+      module_files.Initialize(memory_map, connection.Memory(), &page_map));
+
+  ASSERT_NO_FATAL_FAILURE(
+      ExpectReadFromFile(module_files,
+                         connection.Memory(),
+                         FromPointerCast<VMAddress>(kReadOnlyData),
+                         sizeof(kReadOnlyData)));
+  ASSERT_NO_FATAL_FAILURE(
+      ExpectReadFromFile(module_files,
+                         connection.Memory(),
+                         FromPointerCast<VMAddress>(ExpectReadFromFile),
+                         16));
+
+  // Writable module data and stack memory are read from the process.
+  EXPECT_TRUE(module_files
+                  .UnmodifiedRanges(CheckedRange<VMAddress, VMSize>(
+                      FromPointerCast<VMAddress>(g_writable_data),
+                      sizeof(g_writable_data)))
+                  .empty());
+
+  char stack_data[16];
+  memset(stack_data, 0, sizeof(stack_data));
+  EXPECT_TRUE(module_files
+                  .UnmodifiedRanges(CheckedRange<VMAddress, VMSize>(
+                      FromPointerCast<VMAddress>(stack_data),
+                      sizeof(stack_data)))
+                  .empty());
+  char from_process[sizeof(stack_data)];
+  ASSERT_TRUE(
+      module_files.Memory()->Read(FromPointerCast<VMAddress>(stack_data),
+                                  sizeof(from_process),
+                                  from_process));
+  EXPECT_EQ(memcmp(from_process, stack_data, sizeof(stack_data)), 0);
+}
+
+// Modifies module memory in a child process, so that the test process’
+// modules stay unmodified for other tests.
+class ModifiedPageTest : public Multiprocess {
+ public:
+  ModifiedPageTest() : Multiprocess() {}
+  ~ModifiedPageTest() {}
+
+ private:
+  void MultiprocessParent() override {
+    CheckedReadFileAtEOF(ReadPipeHandle());
+  }
+
+  void MultiprocessChild() override {
+    FakePtraceConnection connection;
+    ASSERT_TRUE(connection.Initialize(getpid()));
+
+    // Write to a page of read-only module data, as a debugger might, so that
+    // it’s copied on write and no longer matches the file.
+    const VMAddress address = FromPointerCast<VMAddress>(kModifiedData);
+    {
+      MemoryMap memory_map;
+      ASSERT_TRUE(memory_map.Initialize(&connection));
+      const MemoryMap::Mapping* mapping = memory_map.FindMapping(address);
+      ASSERT_TRUE(mapping);
+      ASSERT_FALSE(mapping->writable);
+      const int protection = PROT_READ | (mapping->executable ? PROT_EXEC : 0);
+
+      const size_t page_size = getpagesize();
+      void* page = reinterpret_cast<void*>(address & ~(page_size - 1));
+      ASSERT_EQ(mprotect(page, page_size, protection | PROT_WRITE), 0)
+          << ErrnoMessage("mprotect");
+      const_cast<volatile char*>(kModifiedData)[0] = 'R';
+      ASSERT_EQ(mprotect(page, page_size, protection), 0)
+          << ErrnoMessage("mprotect");
+    }
+
+    MemoryMap memory_map;
+    ASSERT_TRUE(memory_map.Initialize(&connection));
+
+    PageMap page_map;
+    ASSERT_TRUE(page_map.Initialize(getpid()));
+
+    ModuleFileMappings module_files;
+    ASSERT_TRUE(
+        module_files.Initialize(memory_map, connection.Memory(), &page_map));
+
+    const CheckedRange<VMAddress, VMSize> modified(address, 1);
+    EXPECT_TRUE(module_files.UnmodifiedRanges(modified).empty());
+    char from_process[sizeof(kModifiedData)];
+    ASSERT_TRUE(module_files.Memory()->Read(
+        address, sizeof(from_process), from_process));
+    EXPECT_EQ(from_process[0], 'R');
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(ModifiedPageTest);
+};
+
+TEST(ModuleFileMappings, ModifiedPage) {
+  ModifiedPageTest test;
+  test.Run();
+}
+
+TEST(ModuleFileMappings, NoPageMap) {
+  FakePtraceConnection connection;
+  ASSERT_TRUE(connection.Initialize(getpid()));
+
+  MemoryMap memory_map;
+  ASSERT_TRUE(memory_map.Initialize(&connection));
+
+  // Without a page map, nothing is read from module files.
+  ModuleFileMappings module_files;
+  ASSERT_TRUE(
+      module_files.Initialize(memory_map, connection.Memory(), nullptr));
+  EXPECT_TRUE(module_files
+                  .UnmodifiedRanges(CheckedRange<VMAddress, VMSize>(
+                      FromPointerCast<VMAddress>(kReadOnlyData),
+                      sizeof(kReadOnlyData)))
+                  .empty());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -22,12 +22,14 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <map>
 
 #include "base/logging.h"
 #include "build/build_config.h"
 #include "snapshot/linux/debug_rendezvous.h"
 #include "util/linux/auxiliary_vector.h"
 #include "util/linux/proc_stat_reader.h"
+#include "util/misc/metrics.h"
 
 #if defined(OS_ANDROID)
 #include <android/api-level.h>
@@ -52,12 +54,32 @@ ProcessReaderLinux::Thread::Thread()
     : thread_info(),
       stack_region_address(0),
       stack_region_size(0),
+      omitted_stack_memory(),
       tid(-1),
       static_priority(-1),
-      nice_value(-1) {}
+      nice_value(-1),
+      cpu_time(),
+      runnable(false) {}
 
 ProcessReaderLinux::Thread::~Thread() {}
 
+void ProcessReaderLinux::Thread::InitializeActivity(
+    PtraceConnection* connection) {
+  ProcStatReader stat;
+  if (!stat.Initialize(connection, tid)) {
+    return;
+  }
+
+  char state;
+  runnable = stat.State(&state) && state == 'R';
+
+  timeval user_time;
+  timeval system_time;
+  if (stat.UserCPUTime(&user_time) && stat.SystemCPUTime(&system_time)) {
+    timeradd(&user_time, &system_time, &cpu_time);
+  }
+}
+
 bool ProcessReaderLinux::Thread::InitializePtrace(
     PtraceConnection* connection) {
   if (!connection->GetThreadInfo(tid, &thread_info)) {
@@ -183,31 +205,62 @@ void ProcessReaderLinux::Thread::InitializeStackFromSP(
     stack_region_size =
         thread_info.thread_specific_data_address - stack_region_address;
   }
+
+  reader->TrimUnpopulatedMemory(&stack_region_address, &stack_region_size);
+  omitted_stack_memory.clear();
+  reader->TrimUnmodifiedModuleMemory(
+      &stack_region_address, &stack_region_size, &omitted_stack_memory);
 }
 
 ProcessReaderLinux::Module::Module()
-    : name(), elf_reader(nullptr), type(ModuleSnapshot::kModuleTypeUnknown) {}
+    : name(),
+      elf_reader(nullptr),
+      type(ModuleSnapshot::kModuleTypeUnknown),
+      device(0),
+      inode(0),
+      offset(0) {}
 
 ProcessReaderLinux::Module::~Module() = default;
 
 ProcessReaderLinux::ProcessReaderLinux()
     : connection_(),
+      memory_(),
+      link_map_cache_(),
+      deadline_(),
       process_info_(),
       memory_map_(),
+      module_files_(),
+      page_map_(),
       threads_(),
       modules_(),
       elf_readers_(),
+      exception_thread_id_(-1),
+      max_threads_(0),
       is_64_bit_(false),
+      read_module_files_(false),
+      omit_unmodified_module_memory_(false),
+      initialized_module_files_(false),
+      module_files_valid_(false),
+      initialized_page_map_(false),
+      page_map_valid_(false),
       initialized_threads_(false),
       initialized_modules_(false),
       initialized_() {}
 
 ProcessReaderLinux::~ProcessReaderLinux() {}
 
-bool ProcessReaderLinux::Initialize(PtraceConnection* connection) {
+bool ProcessReaderLinux::Initialize(PtraceConnection* connection,
+                                    LinkMapCache* link_map_cache,
+                                    bool read_module_files,
+                                    bool omit_unmodified_module_memory,
+                                    CaptureDeadline* deadline) {
   INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
   DCHECK(connection);
   connection_ = connection;
+  link_map_cache_ = link_map_cache;
+  deadline_ = deadline;
+  read_module_files_ = read_module_files;
+  omit_unmodified_module_memory_ = omit_unmodified_module_memory;
 
   if (!process_info_.InitializeWithPtrace(connection_)) {
     return false;
@@ -280,6 +333,140 @@ const std::vector<ProcessReaderLinux::Module>& ProcessReaderLinux::Modules() {
   return modules_;
 }
 
+const ModuleFileMappings* ProcessReaderLinux::ModuleFiles() {
+  if (!initialized_module_files_) {
+    initialized_module_files_ = true;
+    module_files_valid_ =
+        module_files_.Initialize(memory_map_, Memory(), GetPageMap());
+  }
+  return module_files_valid_ ? &module_files_ : nullptr;
+}
+
+const PageMap* ProcessReaderLinux::GetPageMap() {
+  if (!initialized_page_map_) {
+    initialized_page_map_ = true;
+    page_map_valid_ = page_map_.Initialize(ProcessID());
+  }
+  return page_map_valid_ ? &page_map_ : nullptr;
+}
+
+void ProcessReaderLinux::TrimUnmodifiedModuleMemory(
+    LinuxVMAddress* address,
+    LinuxVMSize* size,
+    std::vector<CheckedRange<VMAddress, VMSize>>* omitted) {
+  if (!omit_unmodified_module_memory_ || *size == 0) {
+    return;
+  }
+
+  const ModuleFileMappings* module_files = ModuleFiles();
+  const PageMap* page_map = GetPageMap();
+  const CheckedRange<VMAddress, VMSize> range(*address, *size);
+  if (!module_files || !page_map || !range.IsValid()) {
+    return;
+  }
+
+  // Memory is only left out if the page map still shows it backed by the
+  // module’s file now, as the stack is read, so that pages copied on write
+  // since the module files were examined are captured.
+  std::vector<CheckedRange<VMAddress, VMSize>> unmodified;
+  for (const auto& candidate : module_files->UnmodifiedRanges(range)) {
+    std::vector<CheckedRange<VMAddress, VMSize>> file_backed;
+    if (!page_map->FileBackedRanges(candidate, &file_backed)) {
+      return;
+    }
+    unmodified.insert(unmodified.end(), file_backed.begin(), file_backed.end());
+  }
+
+  // The range must stay contiguous, so only unmodified memory at its ends can
+  // be left out.
+  VMAddress start = range.base();
+  size_t first = 0;
+  while (first < unmodified.size() && unmodified[first].base() == start) {
+    start = unmodified[first].end();
+    ++first;
+  }
+
+  VMAddress end = range.end();
+  size_t last = unmodified.size();
+  while (last > first && unmodified[last - 1].end() == end) {
+    end = unmodified[last - 1].base();
+    --last;
+  }
+
+  omitted->insert(
+      omitted->end(), unmodified.begin(), unmodified.begin() + first);
+  omitted->insert(omitted->end(), unmodified.begin() + last, unmodified.end());
+  *address = start;
+  *size = end - start;
+}
+
+void ProcessReaderLinux::TrimUnpopulatedMemory(LinuxVMAddress* address,
+                                               LinuxVMSize* size) {
+  if (*size == 0) {
+    return;
+  }
+
+  const CheckedRange<VMAddress, VMSize> range(*address, *size);
+  if (!range.IsValid()) {
+    return;
+  }
+
+  // Unpopulated pages are only known to read as zero in private anonymous
+  // mappings, so only those at the ends of the range can be left out. Find how
+  // far such mappings extend into the range from each end. Special mappings
+  // such as [vvar] aren’t writable, and are excluded too.
+  auto is_private_anonymous = [](const MemoryMap::Mapping* mapping) {
+    return mapping && mapping->inode == 0 && mapping->writable &&
+           !mapping->shareable;
+  };
+
+  VMAddress anonymous_low_end = range.base();
+  while (anonymous_low_end < range.end()) {
+    const MemoryMap::Mapping* mapping =
+        memory_map_.FindMapping(anonymous_low_end);
+    if (!is_private_anonymous(mapping)) {
+      break;
+    }
+    anonymous_low_end = mapping->range.End();
+  }
+  anonymous_low_end = std::min(anonymous_low_end, range.end());
+
+  VMAddress anonymous_high_base = range.end();
+  while (anonymous_high_base > range.base()) {
+    const MemoryMap::Mapping* mapping =
+        memory_map_.FindMapping(anonymous_high_base - 1);
+    if (!is_private_anonymous(mapping)) {
+      break;
+    }
+    anonymous_high_base = mapping->range.Base();
+  }
+  anonymous_high_base = std::max(anonymous_high_base, range.base());
+
+  if (anonymous_low_end == range.base() &&
+      anonymous_high_base == range.end()) {
+    return;
+  }
+
+  const PageMap* page_map = GetPageMap();
+  std::vector<CheckedRange<VMAddress, VMSize>> populated;
+  if (!page_map || !page_map->PopulatedRanges(range, &populated)) {
+    return;
+  }
+
+  VMAddress start = populated.empty() ? range.end() : populated.front().base();
+  start = std::min(start, anonymous_low_end);
+  VMAddress end = populated.empty() ? range.base() : populated.back().end();
+  end = std::max(end, anonymous_high_base);
+  if (start >= end) {
+    // Nothing in the range has ever been touched.
+    *size = 0;
+    return;
+  }
+
+  *address = start;
+  *size = end - start;
+}
+
 void ProcessReaderLinux::InitializeAbortMessage() {
 #if defined(OS_ANDROID)
   const MemoryMap::Mapping* mapping =
@@ -371,17 +558,18 @@ void ProcessReaderLinux::InitializeThreads() {
 
   Thread main_thread;
   main_thread.tid = pid;
-  if (main_thread.InitializePtrace(connection_)) {
-    main_thread.InitializeStack(this);
-    threads_.push_back(main_thread);
-  } else {
-    LOG(WARNING) << "Couldn't initialize main thread.";
-  }
+  main_thread.InitializeActivity(connection_);
 
   bool main_thread_found = false;
   std::vector<pid_t> thread_ids;
   bool result = connection_->Threads(&thread_ids);
   DCHECK(result);
+
+  // A thread’s activity is read before attaching to it, because attaching
+  // stops it. The other threads are then attached together, so that they stop
+  // concurrently.
+  std::map<pid_t, Thread> other_threads;
+  std::vector<pid_t> other_thread_ids;
   for (pid_t tid : thread_ids) {
     if (tid == pid) {
       DCHECK(!main_thread_found);
@@ -389,14 +577,76 @@ void ProcessReaderLinux::InitializeThreads() {
       continue;
     }
 
-    Thread thread;
+    Thread& thread = other_threads[tid];
     thread.tid = tid;
-    if (connection_->Attach(tid) && thread.InitializePtrace(connection_)) {
+    thread.InitializeActivity(connection_);
+    if (tid != exception_thread_id_) {
+      other_thread_ids.push_back(tid);
+    }
+  }
+  DCHECK(main_thread_found);
+
+  // The exception thread is read first, regardless of the deadline and the
+  // thread limit, because it’s the thread most likely to be relevant to a
+  // crash.
+  auto exception_thread = other_threads.find(exception_thread_id_);
+  if (exception_thread != other_threads.end()) {
+    Thread& thread = exception_thread->second;
+    if (connection_->Attach(thread.tid) &&
+        thread.InitializePtrace(connection_)) {
+      thread.InitializeStack(this);
+      threads_.push_back(thread);
+    }
+  }
+
+  // The main thread is placed first, whether or not it was read first.
+  if (!max_threads_ || threads_.size() < max_threads_ ||
+      exception_thread_id_ == pid) {
+    if (main_thread.InitializePtrace(connection_)) {
+      main_thread.InitializeStack(this);
+      threads_.insert(threads_.begin(), main_thread);
+    } else {
+      LOG(WARNING) << "Couldn't initialize main thread.";
+    }
+  }
+
+  if (max_threads_) {
+    // Only the threads most likely to be relevant to a crash are attached to:
+    // those that were runnable, and then those that have spent the most time
+    // running.
+    const size_t max_other_threads =
+        max_threads_ > threads_.size() ? max_threads_ - threads_.size() : 0;
+    if (other_thread_ids.size() > max_other_threads) {
+      std::stable_sort(other_thread_ids.begin(),
+                       other_thread_ids.end(),
+                       [&other_threads](pid_t lhs_tid, pid_t rhs_tid) {
+                         const Thread& lhs = other_threads[lhs_tid];
+                         const Thread& rhs = other_threads[rhs_tid];
+                         if (lhs.runnable != rhs.runnable) {
+                           return lhs.runnable;
+                         }
+                         return timercmp(&lhs.cpu_time, &rhs.cpu_time, >);
+                       });
+      other_thread_ids.resize(max_other_threads);
+    }
+  }
+
+  std::vector<pid_t> attached_thread_ids;
+  if (!deadline_ || !deadline_->Expired(CaptureDeadline::kPhaseThreads)) {
+    connection_->AttachThreads(other_thread_ids, &attached_thread_ids);
+  }
+
+  for (pid_t tid : attached_thread_ids) {
+    if (deadline_ && deadline_->Expired(CaptureDeadline::kPhaseThreads)) {
+      break;
+    }
+
+    Thread& thread = other_threads[tid];
+    if (thread.InitializePtrace(connection_)) {
       thread.InitializeStack(this);
       threads_.push_back(thread);
     }
   }
-  DCHECK(main_thread_found);
 }
 
 void ProcessReaderLinux::InitializeModules() {
@@ -413,8 +663,22 @@ void ProcessReaderLinux::InitializeModules() {
     return;
   }
 
+  const ProcessMemory* memory = Memory();
+  if (read_module_files_) {
+    const ModuleFileMappings* module_files = ModuleFiles();
+    if (module_files) {
+      memory = module_files->Memory();
+    }
+  }
+
   ProcessMemoryRange range;
-  if (!range.Initialize(Memory(), is_64_bit_)) {
+  if (!range.Initialize(memory, is_64_bit_)) {
+    return;
+  }
+
+  timeval start_time;
+  const bool use_cache = link_map_cache_ && StartTime(&start_time);
+  if (use_cache && InitializeModulesFromCache(range, start_time)) {
     return;
   }
 
@@ -468,6 +732,19 @@ void ProcessReaderLinux::InitializeModules() {
                                                : exe_mapping->name;
   exe.elf_reader = exe_reader.get();
   exe.type = ModuleSnapshot::ModuleType::kModuleTypeExecutable;
+  exe.device = exe_mapping->device;
+  exe.inode = exe_mapping->inode;
+  exe.offset = exe_mapping->offset;
+
+  std::vector<LinkMapCache::Module> cached_modules;
+  LinkMapCache::Module cached_exe;
+  cached_exe.name = exe.name;
+  cached_exe.address = exe_reader->Address();
+  cached_exe.device = exe.device;
+  cached_exe.inode = exe.inode;
+  cached_exe.offset = exe.offset;
+  cached_exe.type = exe.type;
+  cached_modules.push_back(cached_exe);
 
   modules_.push_back(exe);
   elf_readers_.push_back(std::move(exe_reader));
@@ -475,7 +752,15 @@ void ProcessReaderLinux::InitializeModules() {
   LinuxVMAddress loader_base = 0;
   aux.GetValue(AT_BASE, &loader_base);
 
+  // A partial module list isn’t cached, so that later snapshots of this
+  // process locate all of its modules.
+  bool expired = false;
   for (const DebugRendezvous::LinkEntry& entry : debug.Modules()) {
+    if (deadline_ && deadline_->Expired(CaptureDeadline::kPhaseModules)) {
+      expired = true;
+      break;
+    }
+
     const MemoryMap::Mapping* module_mapping = nullptr;
     std::unique_ptr<ElfImageReader> elf_reader;
     {
@@ -534,9 +819,65 @@ void ProcessReaderLinux::InitializeModules() {
     module.type = loader_base && elf_reader->Address() == loader_base
                       ? ModuleSnapshot::kModuleTypeDynamicLoader
                       : ModuleSnapshot::kModuleTypeSharedLibrary;
+    module.device = module_mapping->device;
+    module.inode = module_mapping->inode;
+    module.offset = module_mapping->offset;
+
+    LinkMapCache::Module cached_module;
+    cached_module.name = module.name;
+    cached_module.address = elf_reader->Address();
+    cached_module.device = module.device;
+    cached_module.inode = module.inode;
+    cached_module.offset = module.offset;
+    cached_module.type = module.type;
+    cached_modules.push_back(cached_module);
+
     modules_.push_back(module);
     elf_readers_.push_back(std::move(elf_reader));
   }
+
+  if (use_cache && !expired) {
+    link_map_cache_->Insert(ProcessID(),
+                            start_time,
+                            range,
+                            memory_map_,
+                            debug_address,
+                            std::move(cached_modules));
+  }
+}
+
+bool ProcessReaderLinux::InitializeModulesFromCache(
+    const ProcessMemoryRange& range,
+    const timeval& start_time) {
+  const std::vector<LinkMapCache::Module>* cached_modules =
+      link_map_cache_->Lookup(ProcessID(), start_time, range, memory_map_);
+  if (!cached_modules) {
+    return false;
+  }
+
+  for (const LinkMapCache::Module& cached_module : *cached_modules) {
+    auto elf_reader = std::make_unique<ElfImageReader>();
+    if (!elf_reader->Initialize(range, cached_module.address)) {
+      modules_.clear();
+      elf_readers_.clear();
+      link_map_cache_->Remove(ProcessID());
+      Metrics::LinkMapCacheLookup(Metrics::LinkMapCacheResult::kReadFailed);
+      return false;
+    }
+
+    Module module = {};
+    module.name = cached_module.name;
+    module.elf_reader = elf_reader.get();
+    module.type = cached_module.type;
+    module.device = cached_module.device;
+    module.inode = cached_module.inode;
+    module.offset = cached_module.offset;
+    modules_.push_back(module);
+    elf_readers_.push_back(std::move(elf_reader));
+  }
+
+  Metrics::LinkMapCacheLookup(Metrics::LinkMapCacheResult::kHit);
+  return true;
 }
 
 }  // namespace crashpad
@@ -24,12 +24,18 @@
 
 #include "base/macros.h"
 #include "snapshot/elf/elf_image_reader.h"
+#include "snapshot/linux/link_map_cache.h"
+#include "snapshot/linux/module_file_mappings.h"
 #include "snapshot/module_snapshot.h"
 #include "util/linux/address_types.h"
 #include "util/linux/memory_map.h"
+#include "util/linux/page_map.h"
 #include "util/linux/ptrace_connection.h"
 #include "util/linux/thread_info.h"
+#include "util/misc/address_types.h"
+#include "util/misc/capture_deadline.h"
 #include "util/misc/initialization_state_dcheck.h"
+#include "util/numeric/checked_range.h"
 #include "util/posix/process_info.h"
 #include "util/process/process_memory.h"
 
@@ -53,6 +59,9 @@ class ProcessReaderLinux {
     //! may execute on a different stack than was used before the signal was
     //! received.
     //!
+    //! Pages at the ends of the stack region that have never been touched are
+    //! left out of it, because they only contain zeroes.
+    //!
     //! \param[in] reader A process reader for the target process.
     //! \param[in] stack_pointer The stack pointer for the stack to initialize.
     void InitializeStackFromSP(ProcessReaderLinux* reader,
@@ -61,6 +70,11 @@ class ProcessReaderLinux {
     ThreadInfo thread_info;
     LinuxVMAddress stack_region_address;
     LinuxVMSize stack_region_size;
+
+    //! \brief The ranges of memory left out of the ends of the stack region
+    //!     because their contents are the same as in module files.
+    std::vector<CheckedRange<VMAddress, VMSize>> omitted_stack_memory;
+
     pid_t tid;
     int sched_policy;
     int static_priority;
@@ -70,9 +84,17 @@ class ProcessReaderLinux {
     //!     all valid.
     bool have_priorities;
 
+    //! \brief The time the thread has spent executing in user and system mode.
+    timeval cpu_time;
+
+    //! \brief `true` if the thread was running or runnable before it was
+    //!     stopped to be read.
+    bool runnable;
+
    private:
     friend class ProcessReaderLinux;
 
+    void InitializeActivity(PtraceConnection* connection);
     bool InitializePtrace(PtraceConnection* connection);
     void InitializeStack(ProcessReaderLinux* reader);
   };
@@ -96,6 +118,16 @@ class ProcessReaderLinux {
 
     //! \brief The module's type.
     ModuleSnapshot::ModuleType type;
+
+    //! \brief The device of the file that the module was loaded from.
+    dev_t device;
+
+    //! \brief The inode of the file that the module was loaded from, or `0` if
+    //!     the module wasn't loaded from a file.
+    ino_t inode;
+
+    //! \brief The offset in the file of the module's ELF header.
+    off64_t offset;
   };
 
   ProcessReaderLinux();
@@ -107,8 +139,30 @@ class ProcessReaderLinux {
   //! this class and may only be called once.
   //!
   //! \param[in] connection A PtraceConnection to the target process.
+  //! \param[in] link_map_cache A cache of modules located in previous
+  //!     snapshots, used to avoid locating them again if the target process
+  //!     hasn’t loaded or unloaded any modules since. The modules located by
+  //!     this object are added to the cache. Optional.
+  //! \param[in] read_module_files `true` if the parts of modules that the
+  //!     target process hasn’t modified should be read from the modules’ files
+  //!     when possible, instead of from the target process. See
+  //!     ModuleFileMappings.
+  //! \param[in] omit_unmodified_module_memory `true` if parts of thread stacks
+  //!     that are unmodified module memory should be left out of the stacks
+  //!     and reported by Thread::omitted_stack_memory instead. Only unmodified
+  //!     memory at the ends of a stack can be left out, and only if the
+  //!     process’ page map confirms that it’s still backed by the module’s
+  //!     file.
+  //! \param[in] deadline The deadline of the capture that this object is used
+  //!     for. Once it has passed, no more threads are captured and no more
+  //!     modules are located, although the exception thread, the main thread,
+  //!     and the main executable always are. Optional.
   //! \return `true` on success. `false` on failure with a message logged.
-  bool Initialize(PtraceConnection* connection);
+  bool Initialize(PtraceConnection* connection,
+                  LinkMapCache* link_map_cache = nullptr,
+                  bool read_module_files = false,
+                  bool omit_unmodified_module_memory = false,
+                  CaptureDeadline* deadline = nullptr);
 
   //! \brief Return `true` if the target task is a 64-bit process.
   bool Is64Bit() const { return is_64_bit_; }
@@ -120,11 +174,51 @@ class ProcessReaderLinux {
   pid_t ParentProcessID() const { return process_info_.ParentProcessID(); }
 
   //! \brief Return a memory reader for the target process.
-  const ProcessMemory* Memory() const { return connection_->Memory(); }
+  const ProcessMemory* Memory() const {
+    return memory_ ? memory_ : connection_->Memory();
+  }
+
+  //! \brief Sets the memory reader returned by Memory().
+  //!
+  //! This allows some of the target process’ memory to be read from elsewhere,
+  //! such as through a ProcessMemoryOverlay. It should be called before threads
+  //! or modules are read.
+  //!
+  //! \param[in] memory A memory reader for the target process, which must
+  //!     outlive this object. If `nullptr`, memory is read through the
+  //!     PtraceConnection.
+  void SetMemory(const ProcessMemory* memory) { memory_ = memory; }
+
+  //! \brief Limits the number of threads that Threads() reads.
+  //!
+  //! The exception thread set by SetExceptionThreadID() is read first,
+  //! followed by the main thread and then the threads that were most recently
+  //! active. Threads beyond the limit aren’t attached to or read. This should
+  //! be called before threads are read.
+  //!
+  //! \param[in] max_threads The maximum number of threads to read, or `0` for
+  //!     no limit.
+  void SetMaxThreads(size_t max_threads) { max_threads_ = max_threads; }
+
+  //! \brief Sets the thread that raised an exception, which Threads() reads
+  //!     before any other thread.
+  //!
+  //! The exception thread is read even once the deadline passed to
+  //! Initialize() has passed. This should be called before threads are read.
+  //!
+  //! \param[in] exception_thread_id The exception thread’s ID, or `-1` if
+  //!     there is no exception thread.
+  void SetExceptionThreadID(pid_t exception_thread_id) {
+    exception_thread_id_ = exception_thread_id;
+  }
 
   //! \brief Return a memory map of the target process.
   MemoryMap* GetMemoryMap() { return &memory_map_; }
 
+  //! \brief Return a page map of the target process, or `nullptr` if it can’t
+  //!     be read.
+  const PageMap* GetPageMap();
+
   //! \brief Determines the target process’ start time.
   //!
   //! \param[out] start_time The time that the process started.
@@ -160,18 +254,39 @@ class ProcessReaderLinux {
  private:
   void InitializeThreads();
   void InitializeModules();
+  bool InitializeModulesFromCache(const ProcessMemoryRange& range,
+                                  const timeval& start_time);
   void InitializeAbortMessage();
+  const ModuleFileMappings* ModuleFiles();
+  void TrimUnmodifiedModuleMemory(
+      LinuxVMAddress* address,
+      LinuxVMSize* size,
+      std::vector<CheckedRange<VMAddress, VMSize>>* omitted);
+  void TrimUnpopulatedMemory(LinuxVMAddress* address, LinuxVMSize* size);
   template <bool Is64Bit>
   void ReadAbortMessage(const MemoryMap::Mapping* mapping);
 
   PtraceConnection* connection_;  // weak
+  const ProcessMemory* memory_;  // weak
+  LinkMapCache* link_map_cache_;  // weak
+  CaptureDeadline* deadline_;  // weak
   ProcessInfo process_info_;
   MemoryMap memory_map_;
+  ModuleFileMappings module_files_;
+  PageMap page_map_;
   std::vector<Thread> threads_;
   std::vector<Module> modules_;
   std::string abort_message_;
   std::vector<std::unique_ptr<ElfImageReader>> elf_readers_;
+  pid_t exception_thread_id_;
+  size_t max_threads_;
   bool is_64_bit_;
+  bool read_module_files_;
+  bool omit_unmodified_module_memory_;
+  bool initialized_module_files_;
+  bool module_files_valid_;
+  bool initialized_page_map_;
+  bool page_map_valid_;
   bool initialized_threads_;
   bool initialized_modules_;
   InitializationStateDcheck initialized_;
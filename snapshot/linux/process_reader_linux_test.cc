@@ -21,15 +21,19 @@
 #include <pthread.h>
 #include <sched.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/mman.h>
 #include <sys/resource.h>
 #include <sys/syscall.h>
+#include <ucontext.h>
 #include <unistd.h>
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "base/format_macros.h"
 #include "base/memory/free_deleter.h"
@@ -50,7 +54,9 @@
 #include "util/misc/address_sanitizer.h"
 #include "util/misc/from_pointer_cast.h"
 #include "util/misc/memory_sanitizer.h"
+#include "util/posix/scoped_mmap.h"
 #include "util/synchronization/semaphore.h"
+#include "util/thread/thread.h"
 
 #if defined(OS_ANDROID)
 #include <android/api-level.h>
@@ -388,6 +394,128 @@ TEST(ProcessReaderLinux, ChildThreadsWithSmallUserStacks) {
   test.Run();
 }
 
+// Returns the ID of the process tracing thread |tid| of process |pid|, or 0 if
+// it isn’t being traced.
+pid_t TracerPID(pid_t pid, pid_t tid) {
+  std::string status;
+  if (!LoggingReadEntireFile(
+          base::FilePath(
+              base::StringPrintf("/proc/%d/task/%d/status", pid, tid)),
+          &status)) {
+    ADD_FAILURE();
+    return -1;
+  }
+  static constexpr char kTracerPid[] = "\nTracerPid:\t";
+  const size_t position = status.find(kTracerPid);
+  if (position == std::string::npos) {
+    ADD_FAILURE();
+    return -1;
+  }
+  return atoi(status.c_str() + position + strlen(kTracerPid));
+}
+
+class SpinningThread : public Thread {
+ public:
+  SpinningThread() : ready_(0), exit_(false), tid_(-1) {}
+  ~SpinningThread() {}
+
+  pid_t WaitUntilReady() {
+    ready_.Wait();
+    return tid_;
+  }
+  void Exit() { exit_ = true; }
+
+ private:
+  void ThreadMain() override {
+    tid_ = gettid();
+    ready_.Signal();
+    while (!exit_) {
+    }
+  }
+
+  Semaphore ready_;
+  std::atomic<bool> exit_;
+  pid_t tid_;
+
+  DISALLOW_COPY_AND_ASSIGN(SpinningThread);
+};
+
+class ChildMaxThreadsTest : public Multiprocess {
+ public:
+  ChildMaxThreadsTest() : Multiprocess() {}
+  ~ChildMaxThreadsTest() {}
+
+ private:
+  void MultiprocessParent() override {
+    pid_t spinning_tid;
+    CheckedReadFileExactly(
+        ReadPipeHandle(), &spinning_tid, sizeof(spinning_tid));
+    pid_t waiting_tids[kThreadCount];
+    CheckedReadFileExactly(
+        ReadPipeHandle(), waiting_tids, sizeof(waiting_tids));
+
+    DirectPtraceConnection connection;
+    ASSERT_TRUE(connection.Initialize(ChildPID()));
+
+    ProcessReaderLinux process_reader;
+    ASSERT_TRUE(process_reader.Initialize(&connection));
+    process_reader.SetMaxThreads(2);
+
+    // The main thread is read, followed by the only thread that was running.
+    // The others are never attached to.
+    const std::vector<ProcessReaderLinux::Thread>& threads =
+        process_reader.Threads();
+    ASSERT_EQ(threads.size(), 2u);
+    EXPECT_EQ(threads[0].tid, ChildPID());
+    EXPECT_EQ(threads[1].tid, spinning_tid);
+    for (pid_t tid : waiting_tids) {
+      EXPECT_EQ(TracerPID(ChildPID(), tid), 0);
+    }
+
+    // The exception thread is read first, even if it leaves no room for the
+    // main thread.
+    ProcessReaderLinux exception_process_reader;
+    ASSERT_TRUE(exception_process_reader.Initialize(&connection));
+    exception_process_reader.SetMaxThreads(1);
+    exception_process_reader.SetExceptionThreadID(waiting_tids[1]);
+    const std::vector<ProcessReaderLinux::Thread>& exception_threads =
+        exception_process_reader.Threads();
+    ASSERT_EQ(exception_threads.size(), 1u);
+    EXPECT_EQ(exception_threads[0].tid, waiting_tids[1]);
+    EXPECT_EQ(TracerPID(ChildPID(), waiting_tids[0]), 0);
+    EXPECT_EQ(TracerPID(ChildPID(), waiting_tids[2]), 0);
+  }
+
+  void MultiprocessChild() override {
+    TestThreadPool thread_pool;
+    thread_pool.StartThreads(kThreadCount);
+
+    SpinningThread spinning_thread;
+    spinning_thread.Start();
+    pid_t tid = spinning_thread.WaitUntilReady();
+    CheckedWriteFile(WritePipeHandle(), &tid, sizeof(tid));
+    for (size_t thread_index = 0; thread_index < kThreadCount; ++thread_index) {
+      TestThreadPool::ThreadExpectation expectation;
+      tid = thread_pool.GetThreadExpectation(thread_index, &expectation);
+      CheckedWriteFile(WritePipeHandle(), &tid, sizeof(tid));
+    }
+
+    CheckedReadFileAtEOF(ReadPipeHandle());
+
+    spinning_thread.Exit();
+    spinning_thread.Join();
+  }
+
+  static constexpr size_t kThreadCount = 3;
+
+  DISALLOW_COPY_AND_ASSIGN(ChildMaxThreadsTest);
+};
+
+TEST(ProcessReaderLinux, ChildMaxThreads) {
+  ChildMaxThreadsTest test;
+  test.Run();
+}
+
 // Tests a thread with a stack that spans multiple mappings.
 class ChildWithSplitStackTest : public Multiprocess {
  public:
@@ -480,6 +608,115 @@ TEST(ProcessReaderLinux, MAYBE_ChildWithSplitStack) {
   test.Run();
 }
 
+#if defined(__GLIBC__)
+// Tests a main thread running on a stack at the bottom of a larger mapping, so
+// that the stack region extends past the stack into pages that have never been
+// touched. Those pages are left out of the stack.
+class ChildWithUntouchedStackTest : public Multiprocess {
+ public:
+  ChildWithUntouchedStackTest() : Multiprocess(), page_size_(getpagesize()) {}
+  ~ChildWithUntouchedStackTest() {}
+
+ private:
+  static constexpr size_t kStackPages = 16;
+  static constexpr size_t kMappingPages = 64;
+
+  void MultiprocessParent() override {
+    LinuxVMAddress stack_address;
+    LinuxVMAddress untouched_address;
+    CheckedReadFileExactly(
+        ReadPipeHandle(), &stack_address, sizeof(stack_address));
+    CheckedReadFileExactly(
+        ReadPipeHandle(), &untouched_address, sizeof(untouched_address));
+
+    DirectPtraceConnection connection;
+    ASSERT_TRUE(connection.Initialize(ChildPID()));
+
+    ProcessReaderLinux process_reader;
+    ASSERT_TRUE(process_reader.Initialize(&connection));
+
+    const std::vector<ProcessReaderLinux::Thread>& threads =
+        process_reader.Threads();
+    ASSERT_EQ(threads.size(), 1u);
+
+    const LinuxVMAddress stack_start = threads[0].stack_region_address;
+    const LinuxVMAddress stack_end =
+        stack_start + threads[0].stack_region_size;
+    EXPECT_LE(stack_start, stack_address);
+    EXPECT_GT(stack_end, stack_address);
+    EXPECT_LE(stack_end, untouched_address);
+  }
+
+  void MultiprocessChild() override {
+    // A guard page at the end keeps the mapping from being merged with the
+    // next one.
+    ScopedMmap mapping;
+    ASSERT_TRUE(mapping.ResetMmap(nullptr,
+                                  (kMappingPages + 1) * page_size_,
+                                  PROT_READ | PROT_WRITE,
+                                  MAP_PRIVATE | MAP_ANONYMOUS,
+                                  -1,
+                                  0));
+    ASSERT_EQ(mprotect(mapping.addr_as<char*>() + kMappingPages * page_size_,
+                       page_size_,
+                       PROT_NONE),
+              0)
+        << ErrnoMessage("mprotect");
+    // Transparent huge pages would populate more than the pages touched.
+    ASSERT_EQ(madvise(mapping.addr(), mapping.len(), MADV_NOHUGEPAGE), 0)
+        << ErrnoMessage("madvise");
+
+    ucontext_t stack_context;
+    ASSERT_EQ(getcontext(&stack_context), 0) << ErrnoMessage("getcontext");
+    stack_context.uc_stack.ss_sp = mapping.addr();
+    stack_context.uc_stack.ss_size = kStackPages * page_size_;
+    stack_context.uc_link = &main_context_;
+    makecontext(&stack_context, &RunOnStack, 0);
+
+    untouched_address_ =
+        mapping.addr_as<LinuxVMAddress>() + kStackPages * page_size_;
+    current_test_ = this;
+    ASSERT_EQ(swapcontext(&main_context_, &stack_context), 0)
+        << ErrnoMessage("swapcontext");
+  }
+
+  static void RunOnStack() {
+    ChildWithUntouchedStackTest* test = current_test_;
+    const LinuxVMAddress stack_address = FromPointerCast<LinuxVMAddress>(&test);
+    CheckedWriteFile(
+        test->WritePipeHandle(), &stack_address, sizeof(stack_address));
+    CheckedWriteFile(test->WritePipeHandle(),
+                     &test->untouched_address_,
+                     sizeof(test->untouched_address_));
+
+    // Wait for the parent to read the stack.
+    CheckedReadFileAtEOF(test->ReadPipeHandle());
+  }
+
+  static ChildWithUntouchedStackTest* current_test_;
+
+  ucontext_t main_context_;
+  LinuxVMAddress untouched_address_;
+  const size_t page_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(ChildWithUntouchedStackTest);
+};
+
+ChildWithUntouchedStackTest* ChildWithUntouchedStackTest::current_test_;
+
+// AddressSanitizer with use-after-return detection causes stack variables to
+// be allocated on the heap.
+#if defined(ADDRESS_SANITIZER)
+#define MAYBE_ChildWithUntouchedStack DISABLED_ChildWithUntouchedStack
+#else
+#define MAYBE_ChildWithUntouchedStack ChildWithUntouchedStack
+#endif
+TEST(ProcessReaderLinux, MAYBE_ChildWithUntouchedStack) {
+  ChildWithUntouchedStackTest test;
+  test.Run();
+}
+#endif  // __GLIBC__
+
 // Android doesn't provide dl_iterate_phdr on ARM until API 21.
 #if !defined(OS_ANDROID) || !defined(ARCH_CPU_ARMEL) || __ANDROID_API__ >= 21
 int ExpectFindModule(dl_phdr_info* info, size_t size, void* data) {
@@ -799,6 +1036,91 @@ TEST(ProcessReaderLinux, ChildModules) {
   test.Run();
 }
 
+TEST(ProcessReaderLinux, SelfModulesCached) {
+  FakePtraceConnection connection;
+  ASSERT_TRUE(connection.Initialize(getpid()));
+
+  LinkMapCache cache;
+  ProcessReaderLinux uncached_reader;
+  ASSERT_TRUE(uncached_reader.Initialize(&connection, &cache));
+  const std::vector<ProcessReaderLinux::Module>& uncached_modules =
+      uncached_reader.Modules();
+
+  ProcessReaderLinux cached_reader;
+  ASSERT_TRUE(cached_reader.Initialize(&connection, &cache));
+  const std::vector<ProcessReaderLinux::Module>& cached_modules =
+      cached_reader.Modules();
+
+  ASSERT_EQ(cached_modules.size(), uncached_modules.size());
+  for (size_t index = 0; index < cached_modules.size(); ++index) {
+    SCOPED_TRACE(base::StringPrintf("index %" PRIuS, index));
+    EXPECT_EQ(cached_modules[index].name, uncached_modules[index].name);
+    EXPECT_EQ(cached_modules[index].type, uncached_modules[index].type);
+    ASSERT_TRUE(cached_modules[index].elf_reader);
+    ASSERT_TRUE(uncached_modules[index].elf_reader);
+    EXPECT_NE(cached_modules[index].elf_reader,
+              uncached_modules[index].elf_reader);
+    EXPECT_EQ(cached_modules[index].elf_reader->Address(),
+              uncached_modules[index].elf_reader->Address());
+    EXPECT_EQ(cached_modules[index].elf_reader->Size(),
+              uncached_modules[index].elf_reader->Size());
+  }
+  ExpectModulesFromSelf(cached_modules);
+
+  // Loading a module makes the cached modules stale.
+  const std::string module_name = "test_module.so";
+  ScopedModuleHandle test_module(LoadTestModule(module_name));
+  ASSERT_TRUE(test_module.valid());
+
+  ProcessReaderLinux reader_after_load;
+  ASSERT_TRUE(reader_after_load.Initialize(&connection, &cache));
+  ExpectModulesFromSelf(reader_after_load.Modules());
+  ExpectTestModule(&reader_after_load, module_name);
+}
+
+TEST(ProcessReaderLinux, SelfModulesFromFiles) {
+  const std::string module_name = "test_module.so";
+  ScopedModuleHandle test_module(LoadTestModule(module_name));
+  ASSERT_TRUE(test_module.valid());
+
+  FakePtraceConnection connection;
+  ASSERT_TRUE(connection.Initialize(getpid()));
+
+  ProcessReaderLinux remote_reader;
+  ASSERT_TRUE(remote_reader.Initialize(&connection));
+  const std::vector<ProcessReaderLinux::Module>& remote_modules =
+      remote_reader.Modules();
+
+  ProcessReaderLinux file_reader;
+  ASSERT_TRUE(file_reader.Initialize(&connection, nullptr, true));
+  const std::vector<ProcessReaderLinux::Module>& file_modules =
+      file_reader.Modules();
+
+  ASSERT_EQ(file_modules.size(), remote_modules.size());
+  for (size_t index = 0; index < file_modules.size(); ++index) {
+    SCOPED_TRACE(base::StringPrintf("index %" PRIuS, index));
+    EXPECT_EQ(file_modules[index].name, remote_modules[index].name);
+    EXPECT_EQ(file_modules[index].type, remote_modules[index].type);
+    if (!remote_modules[index].elf_reader) {
+      EXPECT_FALSE(file_modules[index].elf_reader);
+      continue;
+    }
+    ASSERT_TRUE(file_modules[index].elf_reader);
+    EXPECT_EQ(file_modules[index].elf_reader->Address(),
+              remote_modules[index].elf_reader->Address());
+    EXPECT_EQ(file_modules[index].elf_reader->Size(),
+              remote_modules[index].elf_reader->Size());
+
+    std::string file_soname;
+    std::string remote_soname;
+    EXPECT_EQ(file_modules[index].elf_reader->SoName(&file_soname),
+              remote_modules[index].elf_reader->SoName(&remote_soname));
+    EXPECT_EQ(file_soname, remote_soname);
+  }
+  ExpectModulesFromSelf(file_modules);
+  ExpectTestModule(&file_reader, module_name);
+}
+
 #if defined(OS_ANDROID)
 const char kTestAbortMessage[] = "test abort message";
 
@@ -14,37 +14,148 @@
 
 #include "snapshot/linux/process_snapshot_linux.h"
 
+#include <inttypes.h>
+
+#include <algorithm>
 #include <utility>
 
 #include "base/logging.h"
+#include "base/strings/stringprintf.h"
+#include "snapshot/capture_memory.h"
+#include "snapshot/linux/capture_memory_delegate_linux.h"
 #include "util/linux/exception_information.h"
+#include "util/misc/tri_state.h"
 
 namespace crashpad {
 
+namespace {
+
+// Stacks captured from the stack pointer may not start at a pointer-aligned
+// address, so only the pointer-aligned portion of |stack| is scanned.
+void CaptureMemoryPointedToByStack(const ProcessMemory* memory,
+                                   const MemorySnapshot& stack,
+                                   internal::CaptureMemory::Delegate* delegate,
+                                   std::vector<uint8_t>* scan_buffer) {
+  const uint64_t alignment =
+      delegate->Is64Bit() ? sizeof(uint64_t) : sizeof(uint32_t);
+  const uint64_t base = (stack.Address() + alignment - 1) & ~(alignment - 1);
+  const uint64_t end = (stack.Address() + stack.Size()) & ~(alignment - 1);
+  if (end <= base) {
+    return;
+  }
+
+  internal::MemorySnapshotGeneric aligned_stack;
+  aligned_stack.Initialize(memory, base, end - base);
+  internal::CaptureMemory::PointedToByMemoryRange(
+      aligned_stack, delegate, scan_buffer);
+}
+
+// Adds the parts of |range| that aren’t in |excluded|, which must be sorted by
+// base address, to |ranges|.
+void AddRangeExcluding(
+    const CheckedRange<VMAddress, VMSize>& range,
+    const std::vector<CheckedRange<VMAddress, VMSize>>& excluded,
+    std::vector<CheckedRange<uint64_t>>* ranges) {
+  auto add = [ranges](VMAddress base, VMAddress end) {
+    ranges->emplace_back(base, end - base);
+  };
+
+  VMAddress base = range.base();
+  for (const auto& exclusion : excluded) {
+    if (exclusion.end() <= base) {
+      continue;
+    }
+    if (exclusion.base() >= range.end()) {
+      break;
+    }
+    if (exclusion.base() > base) {
+      add(base, exclusion.base());
+    }
+    base = exclusion.end();
+  }
+  if (base < range.end()) {
+    add(base, range.end());
+  }
+}
+
+}  // namespace
+
 ProcessSnapshotLinux::ProcessSnapshotLinux() = default;
 
 ProcessSnapshotLinux::~ProcessSnapshotLinux() = default;
 
-bool ProcessSnapshotLinux::Initialize(PtraceConnection* connection) {
+bool ProcessSnapshotLinux::Initialize(
+    PtraceConnection* connection,
+    const ProcessMemoryOverlay::Region* shared_annotations,
+    LinkMapCache* link_map_cache,
+    ElfModuleMetadataCache* module_metadata_cache,
+    bool omit_unmodified_module_memory,
+    CaptureDeadline* deadline,
+    const std::vector<ProcessMemoryOverlay::Region>* crashing_thread_state,
+    CaptureProfile default_capture_profile,
+    LinuxVMAddress exception_info_address) {
   INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+  deadline_ = deadline;
 
   if (gettimeofday(&snapshot_time_, nullptr) != 0) {
     PLOG(ERROR) << "gettimeofday";
     return false;
   }
 
-  if (!process_reader_.Initialize(connection) ||
-      !memory_range_.Initialize(process_reader_.Memory(),
+  if (!process_reader_.Initialize(connection,
+                                  link_map_cache,
+                                  true,
+                                  omit_unmodified_module_memory,
+                                  deadline)) {
+    return false;
+  }
+
+  // Shared annotations and the crashing thread’s state are read locally
+  // through the overlay. Everything in the snapshot reads memory through
+  // |process_reader_|, so it’s set to read through the overlay too.
+  std::vector<ProcessMemoryOverlay::Region> regions;
+  if (shared_annotations) {
+    regions.push_back(*shared_annotations);
+  }
+  if (crashing_thread_state) {
+    regions.insert(regions.end(),
+                   crashing_thread_state->begin(),
+                   crashing_thread_state->end());
+  }
+  if (!regions.empty()) {
+    if (!memory_overlay_.Initialize(process_reader_.Memory(), regions)) {
+      return false;
+    }
+    process_reader_.SetMemory(&memory_overlay_);
+  }
+
+  if (!memory_range_.Initialize(process_reader_.Memory(),
                                 process_reader_.Is64Bit())) {
     return false;
   }
 
   system_.Initialize(&process_reader_, &snapshot_time_);
 
-  InitializeThreads();
-  InitializeModules();
+  InitializeModules(module_metadata_cache);
   InitializeAnnotations();
 
+  // The capture profile can be set by a module, so modules are read first to
+  // find out how many threads to read.
+  CaptureProfile capture_profile = ModulesCaptureProfile();
+  if (capture_profile == CaptureProfile::kUnset) {
+    capture_profile = default_capture_profile;
+  }
+  process_reader_.SetMaxThreads(
+      CaptureLimitsForProfile(capture_profile).max_threads);
+  if (exception_info_address) {
+    ExceptionInformation info;
+    if (process_reader_.Memory()->Read(
+            exception_info_address, sizeof(info), &info)) {
+      process_reader_.SetExceptionThreadID(info.thread_id);
+    }
+  }
+  InitializeThreads();
+
   INITIALIZATION_STATE_SET_VALID(initialized_);
   return true;
 }
@@ -117,8 +228,21 @@ bool ProcessSnapshotLinux::InitializeException(
     }
   }
 
-  LOG(ERROR) << "thread not found " << info.thread_id;
-  return false;
+  // The exception thread may not have been attached to, or have been left out
+  // once the deadline passed. Its context is known from the exception, so it’s
+  // still captured, with the stack found from the exception context.
+  ProcessReaderLinux::Thread thread;
+  thread.tid = info.thread_id;
+  thread.InitializeStackFromSP(&process_reader_,
+                               exception_->Context()->StackPointer());
+
+  auto exc_thread_snapshot = std::make_unique<internal::ThreadSnapshotLinux>();
+  if (!exc_thread_snapshot->InitializeWithContext(
+          &process_reader_, thread, *exception_->Context())) {
+    return false;
+  }
+  threads_.push_back(std::move(exc_thread_snapshot));
+  return true;
 }
 
 void ProcessSnapshotLinux::GetCrashpadOptions(
@@ -147,12 +271,16 @@ void ProcessSnapshotLinux::GetCrashpadOptions(
       local_options.indirectly_referenced_memory_cap =
           module_options.indirectly_referenced_memory_cap;
     }
+    if (local_options.capture_profile == CaptureProfile::kUnset) {
+      local_options.capture_profile = module_options.capture_profile;
+    }
 
     // If non-default values have been found for all options, the loop can end
     // early.
     if (local_options.crashpad_handler_behavior != TriState::kUnset &&
         local_options.system_crash_reporter_forwarding != TriState::kUnset &&
-        local_options.gather_indirectly_referenced_memory != TriState::kUnset) {
+        local_options.gather_indirectly_referenced_memory != TriState::kUnset &&
+        local_options.capture_profile != CaptureProfile::kUnset) {
       break;
     }
   }
@@ -160,6 +288,125 @@ void ProcessSnapshotLinux::GetCrashpadOptions(
   *options = local_options;
 }
 
+void ProcessSnapshotLinux::ApplyCaptureProfile(CaptureProfile profile) {
+  ApplyCaptureLimits(CaptureLimitsForProfile(profile));
+}
+
+void ProcessSnapshotLinux::ApplyCaptureLimits(const CaptureLimits& limits) {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  DCHECK(memory_map_.empty());
+
+  capture_limits_ = limits;
+  OrderThreads();
+  if (capture_limits_.max_threads &&
+      threads_.size() > capture_limits_.max_threads) {
+    threads_.resize(capture_limits_.max_threads);
+  }
+  if (capture_limits_.max_stack_size || capture_limits_.max_thread_stacks) {
+    LimitThreadStacks(capture_limits_.max_stack_size,
+                      capture_limits_.max_thread_stacks);
+  }
+  if (capture_limits_.include_memory_map) {
+    InitializeMemoryMap();
+  }
+  if (capture_limits_.include_writable_memory) {
+    GatherWritableMemory();
+  }
+}
+
+void ProcessSnapshotLinux::GatherIndirectlyReferencedMemory() {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  CrashpadInfoClientOptions options;
+  GetCrashpadOptions(&options);
+  if (options.gather_indirectly_referenced_memory != TriState::kEnabled ||
+      capture_limits_.max_indirectly_referenced_memory == 0) {
+    return;
+  }
+  DCHECK(extra_memory_.empty());
+
+  std::vector<CheckedRange<uint64_t>> stacks;
+  const ThreadSnapshot* exception_thread = nullptr;
+  for (const auto& thread : threads_) {
+    stacks.emplace_back(thread->Stack()->Address(), thread->Stack()->Size());
+    if (exception_ && thread->ThreadID() == exception_->ThreadID()) {
+      exception_thread = thread.get();
+    }
+  }
+
+  uint32_t budget_remaining =
+      std::min(options.indirectly_referenced_memory_cap,
+               capture_limits_.max_indirectly_referenced_memory);
+  uint64_t bytes_dropped = 0;
+  internal::CaptureMemoryDelegateLinux delegate(&process_reader_,
+                                                stacks,
+                                                &extra_memory_,
+                                                &budget_remaining,
+                                                &bytes_dropped);
+
+  // One buffer is reused to scan every stack. The deadline is checked before
+  // each stack is scanned, because scanning stacks is the slowest part.
+  std::vector<uint8_t> scan_buffer;
+  if (exception_) {
+    internal::CaptureMemory::PointedToByContext(*exception_->Context(),
+                                                &delegate);
+    if (exception_thread &&
+        !Expired(CaptureDeadline::kPhaseIndirectlyReferencedMemory)) {
+      CaptureMemoryPointedToByStack(process_reader_.Memory(),
+                                    *exception_thread->Stack(),
+                                    &delegate,
+                                    &scan_buffer);
+    }
+  }
+
+  for (const auto& thread : threads_) {
+    if (thread.get() != exception_thread) {
+      internal::CaptureMemory::PointedToByContext(*thread->Context(),
+                                                  &delegate);
+    }
+  }
+
+  for (const auto& thread : threads_) {
+    if (thread.get() != exception_thread) {
+      if (Expired(CaptureDeadline::kPhaseIndirectlyReferencedMemory)) {
+        break;
+      }
+      CaptureMemoryPointedToByStack(process_reader_.Memory(),
+                                    *thread->Stack(),
+                                    &delegate,
+                                    &scan_buffer);
+    }
+  }
+
+  if (bytes_dropped) {
+    annotations_simple_map_["indirectly_referenced_memory_dropped"] =
+        base::StringPrintf("%" PRIu64, bytes_dropped);
+  }
+}
+
+std::vector<CheckedRange<uint64_t>> ProcessSnapshotLinux::OmittedMemory()
+    const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  // Only the stacks of the threads in the snapshot, as last replaced or
+  // limited, count.
+  std::vector<CheckedRange<uint64_t>> omitted_memory;
+  for (const auto& thread : threads_) {
+    const std::vector<CheckedRange<uint64_t>>& omitted_stack_memory =
+        thread->OmittedStackMemory();
+    omitted_memory.insert(omitted_memory.end(),
+                          omitted_stack_memory.begin(),
+                          omitted_stack_memory.end());
+  }
+  return omitted_memory;
+}
+
+const std::vector<CheckedRange<uint64_t>>&
+ProcessSnapshotLinux::WritableMemory() const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return writable_memory_;
+}
+
 crashpad::ProcessID ProcessSnapshotLinux::ProcessID() const {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
   return process_reader_.ProcessID();
@@ -240,8 +487,11 @@ const ExceptionSnapshot* ProcessSnapshotLinux::Exception() const {
 std::vector<const MemoryMapRegionSnapshot*> ProcessSnapshotLinux::MemoryMap()
     const {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
-  // TODO(jperaza): do this.
-  return std::vector<const MemoryMapRegionSnapshot*>();
+  std::vector<const MemoryMapRegionSnapshot*> memory_map;
+  for (const auto& region : memory_map_) {
+    memory_map.push_back(region.get());
+  }
+  return memory_map;
 }
 
 std::vector<HandleSnapshot> ProcessSnapshotLinux::Handles() const {
@@ -251,7 +501,11 @@ std::vector<HandleSnapshot> ProcessSnapshotLinux::Handles() const {
 
 std::vector<const MemorySnapshot*> ProcessSnapshotLinux::ExtraMemory() const {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
-  return std::vector<const MemorySnapshot*>();
+  std::vector<const MemorySnapshot*> extra_memory;
+  for (const auto& memory : extra_memory_) {
+    extra_memory.push_back(memory.get());
+  }
+  return extra_memory;
 }
 
 const ProcessMemory* ProcessSnapshotLinux::Memory() const {
@@ -271,21 +525,216 @@ void ProcessSnapshotLinux::InitializeThreads() {
   }
 }
 
-void ProcessSnapshotLinux::InitializeModules() {
+std::map<uint64_t, const ProcessReaderLinux::Thread*>
+ProcessSnapshotLinux::ReaderThreadsByID() {
+  std::map<uint64_t, const ProcessReaderLinux::Thread*> reader_threads;
+  for (const auto& reader_thread : process_reader_.Threads()) {
+    reader_threads[reader_thread.tid] = &reader_thread;
+  }
+  return reader_threads;
+}
+
+void ProcessSnapshotLinux::OrderThreads() {
+  // The exception thread comes first, followed by the threads that were
+  // runnable when they were read, and then the rest. Within each group,
+  // threads that have spent more time running come first. Threads are captured
+  // and limited in this order, so the threads most likely to be relevant to a
+  // crash are the last to be left out.
+  const std::map<uint64_t, const ProcessReaderLinux::Thread*> reader_threads =
+      ReaderThreadsByID();
+  auto find = [&reader_threads](uint64_t thread_id) {
+    auto it = reader_threads.find(thread_id);
+    return it != reader_threads.end() ? it->second : nullptr;
+  };
+  const internal::ExceptionSnapshotLinux* exception = exception_.get();
+
+  std::stable_sort(
+      threads_.begin(),
+      threads_.end(),
+      [exception, &find](
+          const std::unique_ptr<internal::ThreadSnapshotLinux>& lhs,
+          const std::unique_ptr<internal::ThreadSnapshotLinux>& rhs) {
+        if (exception) {
+          const bool lhs_excepted = lhs->ThreadID() == exception->ThreadID();
+          const bool rhs_excepted = rhs->ThreadID() == exception->ThreadID();
+          if (lhs_excepted != rhs_excepted) {
+            return lhs_excepted;
+          }
+        }
+
+        const ProcessReaderLinux::Thread* lhs_thread = find(lhs->ThreadID());
+        const ProcessReaderLinux::Thread* rhs_thread = find(rhs->ThreadID());
+        if (!lhs_thread || !rhs_thread) {
+          return lhs_thread && !rhs_thread;
+        }
+        if (lhs_thread->runnable != rhs_thread->runnable) {
+          return lhs_thread->runnable;
+        }
+        return timercmp(&lhs_thread->cpu_time, &rhs_thread->cpu_time, >);
+      });
+}
+
+void ProcessSnapshotLinux::LimitThreadStacks(uint64_t max_stack_size,
+                                             size_t max_thread_stacks) {
+  const std::map<uint64_t, const ProcessReaderLinux::Thread*> reader_threads =
+      ReaderThreadsByID();
+
+  // Thread snapshots can’t be changed after they’re initialized, so a thread
+  // whose stack is too large is replaced by a snapshot of a shorter stack, or of
+  // no stack for threads beyond |max_thread_stacks|.
+  for (size_t index = 0; index < threads_.size(); ++index) {
+    auto& thread_snapshot = threads_[index];
+    const MemorySnapshot* stack = thread_snapshot->Stack();
+    uint64_t stack_size = stack->Size();
+    if (max_thread_stacks && index >= max_thread_stacks) {
+      stack_size = 0;
+    } else if (max_stack_size) {
+      stack_size = std::min(stack_size, max_stack_size);
+    }
+    if (stack_size == stack->Size()) {
+      continue;
+    }
+
+    // An exception thread that wasn’t read by |process_reader_| takes its
+    // context from the exception.
+    auto it = reader_threads.find(thread_snapshot->ThreadID());
+    const bool from_exception =
+        it == reader_threads.end() && exception_ &&
+        thread_snapshot->ThreadID() == exception_->ThreadID();
+    if (it == reader_threads.end() && !from_exception) {
+      continue;
+    }
+
+    // Stacks start at the stack pointer, so the most recent frames are kept.
+    ProcessReaderLinux::Thread thread;
+    if (from_exception) {
+      thread.tid = thread_snapshot->ThreadID();
+    } else {
+      thread = *it->second;
+    }
+    thread.stack_region_address = stack->Address();
+    thread.stack_region_size = stack_size;
+
+    // Omitted memory beyond the end of a shortened stack no longer adjoins it,
+    // and none is left out of a stack that isn’t captured.
+    thread.omitted_stack_memory.clear();
+    if (stack_size) {
+      for (const auto& range : thread_snapshot->OmittedStackMemory()) {
+        if (range.end() <= stack->Address()) {
+          thread.omitted_stack_memory.push_back(range);
+        }
+      }
+    }
+
+    auto limited_thread_snapshot =
+        std::make_unique<internal::ThreadSnapshotLinux>();
+    if (from_exception
+            ? limited_thread_snapshot->InitializeWithContext(
+                  &process_reader_, thread, *exception_->Context())
+            : limited_thread_snapshot->Initialize(&process_reader_, thread)) {
+      thread_snapshot = std::move(limited_thread_snapshot);
+    }
+  }
+}
+
+void ProcessSnapshotLinux::InitializeMemoryMap() {
+  for (const auto& mapping : process_reader_.GetMemoryMap()->Mappings()) {
+    memory_map_.push_back(
+        std::make_unique<internal::MemoryMapRegionSnapshotLinux>(mapping));
+  }
+}
+
+void ProcessSnapshotLinux::GatherWritableMemory() {
+  // Thread stacks are already in the snapshot, so they’re left out.
+  std::vector<CheckedRange<VMAddress, VMSize>> stacks;
+  for (const auto& thread : threads_) {
+    stacks.emplace_back(thread->Stack()->Address(), thread->Stack()->Size());
+  }
+  std::sort(stacks.begin(),
+            stacks.end(),
+            [](const CheckedRange<VMAddress, VMSize>& a,
+               const CheckedRange<VMAddress, VMSize>& b) {
+              return a.base() < b.base();
+            });
+
+  const PageMap* page_map = process_reader_.GetPageMap();
+  std::vector<CheckedRange<VMAddress, VMSize>> populated;
+  for (const auto& mapping : process_reader_.GetMemoryMap()->Mappings()) {
+    // Shared mappings may be device or graphics memory, and are left out.
+    if (!mapping.readable || !mapping.writable || mapping.shareable) {
+      continue;
+    }
+
+    if (Expired(CaptureDeadline::kPhaseWritableMemory)) {
+      break;
+    }
+
+    const CheckedRange<VMAddress, VMSize> range(mapping.range.Base(),
+                                                mapping.range.Size());
+
+    // Pages of anonymous mappings that have never been touched contain only
+    // zeroes, so only the populated parts of those mappings are captured.
+    if (mapping.inode == 0 && page_map &&
+        page_map->PopulatedRanges(range, &populated)) {
+      for (const auto& part : populated) {
+        AddRangeExcluding(part, stacks, &writable_memory_);
+      }
+    } else {
+      AddRangeExcluding(range, stacks, &writable_memory_);
+    }
+  }
+}
+
+void ProcessSnapshotLinux::InitializeModules(
+    ElfModuleMetadataCache* module_metadata_cache) {
   for (const ProcessReaderLinux::Module& reader_module :
        process_reader_.Modules()) {
+    // The main executable is always captured.
+    if (!modules_.empty() && Expired(CaptureDeadline::kPhaseModules)) {
+      break;
+    }
+
     auto module =
         std::make_unique<internal::ModuleSnapshotElf>(reader_module.name,
                                                       reader_module.elf_reader,
                                                       reader_module.type,
                                                       &memory_range_,
                                                       process_reader_.Memory());
-    if (module->Initialize()) {
+
+    // Modules that weren’t loaded from a file, such as the vDSO, can’t be
+    // identified across processes.
+    ElfModuleMetadataCache::FileIdentity file;
+    const bool identified = reader_module.elf_reader && reader_module.inode;
+    if (identified) {
+      file.device = reader_module.device;
+      file.inode = reader_module.inode;
+      file.offset = reader_module.offset;
+      file.size = reader_module.elf_reader->Size();
+    }
+
+    if (module->Initialize(module_metadata_cache,
+                           identified ? &file : nullptr)) {
       modules_.push_back(std::move(module));
     }
   }
 }
 
+bool ProcessSnapshotLinux::Expired(CaptureDeadline::Phase phase) {
+  return deadline_ && deadline_->Expired(phase);
+}
+
+CaptureProfile ProcessSnapshotLinux::ModulesCaptureProfile() {
+  // As in GetCrashpadOptions(), the first module to set a profile wins.
+  for (const auto& module : modules_) {
+    CrashpadInfoClientOptions module_options;
+    if (module->GetCrashpadOptions(&module_options) &&
+        module_options.capture_profile != CaptureProfile::kUnset) {
+      return module_options.capture_profile;
+    }
+  }
+  return CaptureProfile::kUnset;
+}
+
 void ProcessSnapshotLinux::InitializeAnnotations() {
 #if defined(OS_ANDROID)
   const std::string& abort_message = process_reader_.AbortMessage();
@@ -25,21 +25,29 @@
 
 #include "base/macros.h"
 #include "snapshot/crashpad_info_client_options.h"
+#include "snapshot/elf/elf_module_metadata_cache.h"
 #include "snapshot/elf/module_snapshot_elf.h"
 #include "snapshot/linux/exception_snapshot_linux.h"
+#include "snapshot/linux/link_map_cache.h"
+#include "snapshot/linux/memory_map_region_snapshot_linux.h"
 #include "snapshot/linux/process_reader_linux.h"
 #include "snapshot/linux/system_snapshot_linux.h"
 #include "snapshot/linux/thread_snapshot_linux.h"
 #include "snapshot/memory_map_region_snapshot.h"
+#include "snapshot/memory_snapshot_generic.h"
 #include "snapshot/module_snapshot.h"
 #include "snapshot/process_snapshot.h"
 #include "snapshot/system_snapshot.h"
 #include "snapshot/thread_snapshot.h"
 #include "snapshot/unloaded_module_snapshot.h"
 #include "util/linux/ptrace_connection.h"
+#include "util/misc/capture_deadline.h"
+#include "util/misc/capture_profile.h"
 #include "util/misc/initialization_state_dcheck.h"
 #include "util/misc/uuid.h"
+#include "util/numeric/checked_range.h"
 #include "util/process/process_id.h"
+#include "util/process/process_memory_overlay.h"
 #include "util/process/process_memory_range.h"
 
 namespace crashpad {
@@ -54,10 +62,50 @@ class ProcessSnapshotLinux final : public ProcessSnapshot {
   //! \brief Initializes the object.
   //!
   //! \param[in] connection A connection to the process to snapshot.
+  //! \param[in] shared_annotations Annotation storage that the process shares
+  //!     with this one, which is read from the local mapping instead of through
+  //!     \a connection. Optional.
+  //! \param[in] link_map_cache A cache of the modules located in previous
+  //!     snapshots. Optional.
+  //! \param[in] module_metadata_cache A cache of metadata read from modules
+  //!     loaded from the same files in previous snapshots of any process.
+  //!     Optional.
+  //! \param[in] omit_unmodified_module_memory `true` if memory whose contents
+  //!     are the same as in module files should be left out of the snapshot
+  //!     where possible, and reported by OmittedMemory() instead.
+  //! \param[in] deadline The deadline of the capture. Once it has passed,
+  //!     threads, modules, and memory that haven’t yet been captured are left
+  //!     out of the snapshot, and the phases that left them out are recorded
+  //!     in \a deadline. This object does not take ownership of \a deadline,
+  //!     which must outlive it. Optional.
+  //! \param[in] crashing_thread_state Copies of parts of the process’ memory
+  //!     describing its crashing thread, such as its exception information,
+  //!     context, and stack, which are read instead of the process’ memory.
+  //!     If the exception thread can’t be read through \a connection, its
+  //!     context is taken from these. Optional.
+  //! \param[in] default_capture_profile The capture profile whose limit on
+  //!     the number of threads applies if no module in the process sets a
+  //!     profile with CrashpadInfo::set_capture_profile(). Modules are read
+  //!     before threads, so that threads beyond the profile’s limit are never
+  //!     attached to or read. Pass the same profile to ApplyCaptureProfile().
+  //! \param[in] exception_info_address The address in the process of the
+  //!     ExceptionInformation that will be passed to InitializeException().
+  //!     Its thread is read before any other, so that it’s captured however
+  //!     many threads are left out. Optional.
   //!
   //! \return `true` if the snapshot could be created, `false` otherwise with
   //!     an appropriate message logged.
-  bool Initialize(PtraceConnection* connection);
+  bool Initialize(
+      PtraceConnection* connection,
+      const ProcessMemoryOverlay::Region* shared_annotations = nullptr,
+      LinkMapCache* link_map_cache = nullptr,
+      ElfModuleMetadataCache* module_metadata_cache = nullptr,
+      bool omit_unmodified_module_memory = false,
+      CaptureDeadline* deadline = nullptr,
+      const std::vector<ProcessMemoryOverlay::Region>* crashing_thread_state =
+          nullptr,
+      CaptureProfile default_capture_profile = CaptureProfile::kDefault,
+      LinuxVMAddress exception_info_address = 0);
 
   //! \brief Finds the thread whose stack contains \a stack_address.
   //!
@@ -110,6 +158,68 @@ class ProcessSnapshotLinux final : public ProcessSnapshot {
   //!     the process.
   void GetCrashpadOptions(CrashpadInfoClientOptions* options);
 
+  //! \brief Limits the snapshot to what a capture profile includes.
+  //!
+  //! Threads are ordered with the exception thread first, followed by those
+  //! that were most recently active. Threads beyond the profile’s limit are
+  //! removed, although a limit higher than that of the profile passed to
+  //! Initialize() can’t add threads that weren’t read. Thread stacks are
+  //! shortened to the profile’s limit. If the profile includes them, the
+  //! memory map is added to the snapshot and the ranges of writable memory
+  //! are returned by WritableMemory(). The profile’s limit on indirectly
+  //! referenced memory applies to GatherIndirectlyReferencedMemory().
+  //!
+  //! This method should be called after InitializeException(), if it is
+  //! called, and before GatherIndirectlyReferencedMemory(). It may only be
+  //! called once. If it isn’t called, the snapshot is captured as
+  //! CaptureProfile::kDefault specifies.
+  //!
+  //! \param[in] profile The profile to apply.
+  void ApplyCaptureProfile(CaptureProfile profile);
+
+  //! \brief Limits the snapshot to what \a limits allows.
+  //!
+  //! This is like ApplyCaptureProfile(), but allows limits that differ from
+  //! those of a profile.
+  //!
+  //! \param[in] limits The limits to apply.
+  void ApplyCaptureLimits(const CaptureLimits& limits);
+
+  //! \brief Captures memory near addresses found in thread registers and on
+  //!     thread stacks, if requested by CrashpadInfoClientOptions.
+  //!
+  //! Memory is captured until the limit set in the options is reached, in order
+  //! of how likely it is to be useful. Memory referenced by the exception
+  //! context is captured first, then memory referenced from the exception
+  //! thread’s stack, then memory referenced by other threads’ registers, and
+  //! finally memory referenced from other threads’ stacks. If the limit is
+  //! reached, the number of bytes left out is recorded in the
+  //! `indirectly_referenced_memory_dropped` annotation. The limit may be lowered
+  //! by the profile passed to ApplyCaptureProfile(). Once the deadline passed
+  //! to Initialize() has passed, no more stacks are scanned.
+  //!
+  //! The captured memory is returned by ExtraMemory(). This method should be
+  //! called after InitializeException(), if it is called, and may only be
+  //! called once.
+  void GatherIndirectlyReferencedMemory();
+
+  //! \brief Returns the ranges of memory that were left out of the snapshot
+  //!     because their contents are the same as in module files.
+  //!
+  //! These can be recorded in a minidump with a
+  //! MinidumpOmittedMemoryListWriter.
+  std::vector<CheckedRange<uint64_t>> OmittedMemory() const;
+
+  //! \brief Returns the ranges of writable memory that the capture profile
+  //!     passed to ApplyCaptureProfile() includes.
+  //!
+  //! The ranges are those of readable, writable, private mappings, leaving out
+  //! thread stacks and pages of anonymous mappings that have never been
+  //! touched. The contents of these ranges are expected to be read while a
+  //! minidump is written, with a MinidumpMemory64ListWriter, so they aren’t
+  //! held in memory and aren’t returned by ExtraMemory().
+  const std::vector<CheckedRange<uint64_t>>& WritableMemory() const;
+
   // ProcessSnapshot:
 
   crashpad::ProcessID ProcessID() const override;
@@ -133,8 +243,15 @@ class ProcessSnapshotLinux final : public ProcessSnapshot {
 
  private:
   void InitializeThreads();
-  void InitializeModules();
+  void InitializeModules(ElfModuleMetadataCache* module_metadata_cache);
   void InitializeAnnotations();
+  CaptureProfile ModulesCaptureProfile();
+  bool Expired(CaptureDeadline::Phase phase);
+  std::map<uint64_t, const ProcessReaderLinux::Thread*> ReaderThreadsByID();
+  void OrderThreads();
+  void LimitThreadStacks(uint64_t max_stack_size, size_t max_thread_stacks);
+  void InitializeMemoryMap();
+  void GatherWritableMemory();
 
   std::map<std::string, std::string> annotations_simple_map_;
   timeval snapshot_time_;
@@ -142,10 +259,18 @@ class ProcessSnapshotLinux final : public ProcessSnapshot {
   UUID client_id_;
   std::vector<std::unique_ptr<internal::ThreadSnapshotLinux>> threads_;
   std::vector<std::unique_ptr<internal::ModuleSnapshotElf>> modules_;
+  std::vector<std::unique_ptr<internal::MemorySnapshotGeneric>> extra_memory_;
+  std::vector<std::unique_ptr<internal::MemoryMapRegionSnapshotLinux>>
+      memory_map_;
+  std::vector<CheckedRange<uint64_t>> writable_memory_;
   std::unique_ptr<internal::ExceptionSnapshotLinux> exception_;
   internal::SystemSnapshotLinux system_;
   ProcessReaderLinux process_reader_;
+  ProcessMemoryOverlay memory_overlay_;
   ProcessMemoryRange memory_range_;
+  CaptureLimits capture_limits_ =
+      CaptureLimitsForProfile(CaptureProfile::kDefault);
+  CaptureDeadline* deadline_ = nullptr;  // weak
   InitializationStateDcheck initialized_;
 
   DISALLOW_COPY_AND_ASSIGN(ProcessSnapshotLinux);
@@ -0,0 +1,516 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/linux/process_snapshot_linux.h"
+
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "base/stl_util.h"
+#include "gtest/gtest.h"
+#include "test/errors.h"
+#include "test/multiprocess.h"
+#include "util/file/file_io.h"
+#include "util/linux/direct_ptrace_connection.h"
+#include "util/linux/exception_information.h"
+#include "util/misc/capture_context.h"
+#include "util/misc/from_pointer_cast.h"
+#include "util/synchronization/semaphore.h"
+#include "util/thread/thread.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+class WaitingThread : public Thread {
+ public:
+  WaitingThread() : ready_(0), exit_(0) {}
+  ~WaitingThread() {}
+
+  void WaitUntilReady() { ready_.Wait(); }
+  void Exit() { exit_.Signal(); }
+
+ private:
+  void ThreadMain() override {
+    ready_.Signal();
+    exit_.Wait();
+  }
+
+  Semaphore ready_;
+  Semaphore exit_;
+
+  DISALLOW_COPY_AND_ASSIGN(WaitingThread);
+};
+
+class SpinningThread : public Thread {
+ public:
+  SpinningThread() : ready_(0), exit_(false), tid_(-1) {}
+  ~SpinningThread() {}
+
+  pid_t WaitUntilReady() {
+    ready_.Wait();
+    return tid_;
+  }
+  void Exit() { exit_ = true; }
+
+ private:
+  void ThreadMain() override {
+    tid_ = syscall(SYS_gettid);
+    ready_.Signal();
+    while (!exit_) {
+    }
+  }
+
+  Semaphore ready_;
+  std::atomic<bool> exit_;
+  pid_t tid_;
+
+  DISALLOW_COPY_AND_ASSIGN(SpinningThread);
+};
+
+// The number of bytes of memory a snapshot captures, which is most of the
+// size of a minidump written from it.
+uint64_t CapturedBytes(const ProcessSnapshotLinux& snapshot) {
+  uint64_t bytes = 0;
+  for (const ThreadSnapshot* thread : snapshot.Threads()) {
+    bytes += thread->Stack()->Size();
+  }
+  for (const MemorySnapshot* memory : snapshot.ExtraMemory()) {
+    bytes += memory->Size();
+  }
+  for (const auto& range : snapshot.WritableMemory()) {
+    bytes += range.size();
+  }
+  return bytes;
+}
+
+bool WritableRangeCaptured(const ProcessSnapshotLinux& snapshot,
+                           VMAddress address,
+                           VMSize size) {
+  for (const auto& range : snapshot.WritableMemory()) {
+    if (address >= range.base() && address + size <= range.end()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+class CaptureProfileTest : public Multiprocess {
+ public:
+  CaptureProfileTest() : Multiprocess() {}
+  ~CaptureProfileTest() {}
+
+ private:
+  void MultiprocessParent() override {
+    VMAddress buffer_address;
+    CheckedReadFileExactly(
+        ReadPipeHandle(), &buffer_address, sizeof(buffer_address));
+    const size_t page_size = getpagesize();
+
+    DirectPtraceConnection connection;
+    ASSERT_TRUE(connection.Initialize(ChildPID()));
+
+    uint64_t captured_bytes[base::size(kProfiles)];
+    for (size_t index = 0; index < base::size(kProfiles); ++index) {
+      SCOPED_TRACE(index);
+
+      ProcessSnapshotLinux snapshot;
+      ASSERT_TRUE(snapshot.Initialize(&connection,
+                                      nullptr,
+                                      nullptr,
+                                      nullptr,
+                                      false,
+                                      nullptr,
+                                      nullptr,
+                                      kProfiles[index]));
+      snapshot.ApplyCaptureProfile(kProfiles[index]);
+
+      const CaptureLimits limits = CaptureLimitsForProfile(kProfiles[index]);
+      const std::vector<const ThreadSnapshot*> threads = snapshot.Threads();
+      if (limits.max_threads) {
+        EXPECT_EQ(threads.size(), limits.max_threads);
+      } else {
+        EXPECT_EQ(threads.size(), kThreadCount + 1);
+      }
+      if (limits.max_stack_size) {
+        for (const ThreadSnapshot* thread : threads) {
+          EXPECT_LE(thread->Stack()->Size(), limits.max_stack_size);
+        }
+      }
+      EXPECT_EQ(!snapshot.MemoryMap().empty(), limits.include_memory_map);
+
+      if (limits.include_writable_memory) {
+        // Only the touched page of the buffer is captured, and memory already
+        // captured as a stack isn’t captured again.
+        EXPECT_TRUE(WritableRangeCaptured(
+            snapshot, buffer_address + kTouchedPage * page_size, page_size));
+        EXPECT_FALSE(
+            WritableRangeCaptured(snapshot, buffer_address, page_size));
+        for (const auto& range : snapshot.WritableMemory()) {
+          for (const ThreadSnapshot* thread : threads) {
+            const MemorySnapshot* stack = thread->Stack();
+            EXPECT_FALSE(range.base() < stack->Address() + stack->Size() &&
+                         stack->Address() < range.end());
+          }
+        }
+      } else {
+        EXPECT_TRUE(snapshot.WritableMemory().empty());
+      }
+      EXPECT_TRUE(snapshot.ExtraMemory().empty());
+
+      captured_bytes[index] = CapturedBytes(snapshot);
+    }
+
+    EXPECT_LT(captured_bytes[0], captured_bytes[1]);
+    EXPECT_LT(captured_bytes[1], captured_bytes[2]);
+  }
+
+  void MultiprocessChild() override {
+    const size_t page_size = getpagesize();
+    const size_t buffer_size = kBufferPages * page_size;
+    void* buffer = mmap(nullptr,
+                        buffer_size,
+                        PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS,
+                        -1,
+                        0);
+    ASSERT_NE(buffer, MAP_FAILED) << ErrnoMessage("mmap");
+    ASSERT_EQ(madvise(buffer, buffer_size, MADV_NOHUGEPAGE), 0)
+        << ErrnoMessage("madvise");
+    memset(static_cast<char*>(buffer) + kTouchedPage * page_size,
+           'x',
+           page_size);
+
+    WaitingThread threads[kThreadCount];
+    for (WaitingThread& thread : threads) {
+      thread.Start();
+      thread.WaitUntilReady();
+    }
+
+    VMAddress buffer_address = FromPointerCast<VMAddress>(buffer);
+    CheckedWriteFile(
+        WritePipeHandle(), &buffer_address, sizeof(buffer_address));
+
+    CheckedReadFileAtEOF(ReadPipeHandle());
+
+    for (WaitingThread& thread : threads) {
+      thread.Exit();
+      thread.Join();
+    }
+    ASSERT_EQ(munmap(buffer, buffer_size), 0) << ErrnoMessage("munmap");
+  }
+
+  static constexpr CaptureProfile kProfiles[] = {
+      CaptureProfile::kMinimal, CaptureProfile::kDefault, CaptureProfile::kFull};
+  static constexpr size_t kThreadCount = 3;
+  static constexpr size_t kBufferPages = 16;
+  static constexpr size_t kTouchedPage = 5;
+
+  DISALLOW_COPY_AND_ASSIGN(CaptureProfileTest);
+};
+
+constexpr CaptureProfile CaptureProfileTest::kProfiles[];
+
+// Each profile is captured from the same child, so the bytes each captures can
+// be compared.
+TEST(ProcessSnapshotLinux, CaptureProfiles) {
+  CaptureProfileTest test;
+  test.Run();
+}
+
+class ThreadStackLimitTest : public Multiprocess {
+ public:
+  ThreadStackLimitTest() : Multiprocess() {}
+  ~ThreadStackLimitTest() {}
+
+ private:
+  void MultiprocessParent() override {
+    pid_t spinning_tid;
+    CheckedReadFileExactly(
+        ReadPipeHandle(), &spinning_tid, sizeof(spinning_tid));
+
+    DirectPtraceConnection connection;
+    ASSERT_TRUE(connection.Initialize(ChildPID()));
+
+    ProcessSnapshotLinux snapshot;
+    ASSERT_TRUE(snapshot.Initialize(&connection));
+    CaptureLimits limits = CaptureLimitsForProfile(CaptureProfile::kDefault);
+    limits.max_thread_stacks = kMaxThreadStacks;
+    snapshot.ApplyCaptureLimits(limits);
+
+    // Every thread is captured, but only the first threads’ stacks are. The
+    // only thread that was running comes first.
+    const std::vector<const ThreadSnapshot*> threads = snapshot.Threads();
+    ASSERT_EQ(threads.size(), kThreadCount + 2);
+    EXPECT_EQ(threads[0]->ThreadID(), static_cast<uint64_t>(spinning_tid));
+    for (size_t index = 0; index < threads.size(); ++index) {
+      SCOPED_TRACE(index);
+      EXPECT_EQ(threads[index]->Stack()->Size() != 0,
+                index < kMaxThreadStacks);
+    }
+  }
+
+  void MultiprocessChild() override {
+    WaitingThread threads[kThreadCount];
+    for (WaitingThread& thread : threads) {
+      thread.Start();
+      thread.WaitUntilReady();
+    }
+    SpinningThread spinning_thread;
+    spinning_thread.Start();
+    pid_t spinning_tid = spinning_thread.WaitUntilReady();
+
+    CheckedWriteFile(WritePipeHandle(), &spinning_tid, sizeof(spinning_tid));
+
+    CheckedReadFileAtEOF(ReadPipeHandle());
+
+    spinning_thread.Exit();
+    spinning_thread.Join();
+    for (WaitingThread& thread : threads) {
+      thread.Exit();
+      thread.Join();
+    }
+  }
+
+  static constexpr size_t kThreadCount = 3;
+  static constexpr size_t kMaxThreadStacks = 2;
+
+  DISALLOW_COPY_AND_ASSIGN(ThreadStackLimitTest);
+};
+
+TEST(ProcessSnapshotLinux, ThreadStackLimit) {
+  ThreadStackLimitTest test;
+  test.Run();
+}
+
+class ExpiredDeadlineTest : public Multiprocess {
+ public:
+  ExpiredDeadlineTest() : Multiprocess() {}
+  ~ExpiredDeadlineTest() {}
+
+ private:
+  void MultiprocessParent() override {
+    char c;
+    CheckedReadFileExactly(ReadPipeHandle(), &c, sizeof(c));
+
+    DirectPtraceConnection connection;
+    ASSERT_TRUE(connection.Initialize(ChildPID()));
+
+    CaptureDeadline deadline(1);
+    while (deadline.ElapsedNanoseconds() < 1) {
+    }
+
+    ProcessSnapshotLinux snapshot;
+    ASSERT_TRUE(snapshot.Initialize(
+        &connection, nullptr, nullptr, nullptr, false, &deadline));
+
+    // Only the main thread and the main executable are captured once the
+    // deadline has passed.
+    const std::vector<const ThreadSnapshot*> threads = snapshot.Threads();
+    ASSERT_EQ(threads.size(), 1u);
+    EXPECT_EQ(threads[0]->ThreadID(), static_cast<uint64_t>(ChildPID()));
+    const std::vector<const ModuleSnapshot*> modules = snapshot.Modules();
+    ASSERT_EQ(modules.size(), 1u);
+    EXPECT_EQ(modules[0]->GetModuleType(),
+              ModuleSnapshot::kModuleTypeExecutable);
+
+    EXPECT_EQ(deadline.TruncatedPhases(),
+              static_cast<uint32_t>(CaptureDeadline::kPhaseThreads |
+                                    CaptureDeadline::kPhaseModules));
+  }
+
+  void MultiprocessChild() override {
+    WaitingThread threads[kThreadCount];
+    for (WaitingThread& thread : threads) {
+      thread.Start();
+      thread.WaitUntilReady();
+    }
+
+    char c = 0;
+    CheckedWriteFile(WritePipeHandle(), &c, sizeof(c));
+
+    CheckedReadFileAtEOF(ReadPipeHandle());
+
+    for (WaitingThread& thread : threads) {
+      thread.Exit();
+      thread.Join();
+    }
+  }
+
+  static constexpr size_t kThreadCount = 2;
+
+  DISALLOW_COPY_AND_ASSIGN(ExpiredDeadlineTest);
+};
+
+TEST(ProcessSnapshotLinux, ExpiredDeadline) {
+  ExpiredDeadlineTest test;
+  test.Run();
+}
+
+// A thread that sets up an ExceptionInformation for itself, as a signal handler
+// would, and then waits.
+class ExceptionThread : public Thread {
+ public:
+  ExceptionThread()
+      : ready_(0), exit_(0), exception_information_(), siginfo_(), context_() {}
+  ~ExceptionThread() {}
+
+  void WaitUntilReady() { ready_.Wait(); }
+  void Exit() { exit_.Signal(); }
+
+  ExceptionInformation* exception_information() {
+    return &exception_information_;
+  }
+
+ private:
+  void ThreadMain() override {
+    CaptureContext(&context_);
+    exception_information_.siginfo_address =
+        FromPointerCast<VMAddress>(&siginfo_);
+    exception_information_.context_address =
+        FromPointerCast<VMAddress>(&context_);
+    exception_information_.thread_id = syscall(SYS_gettid);
+    ready_.Signal();
+    exit_.Wait();
+  }
+
+  Semaphore ready_;
+  Semaphore exit_;
+  ExceptionInformation exception_information_;
+  siginfo_t siginfo_;
+  NativeCPUContext context_;
+
+  DISALLOW_COPY_AND_ASSIGN(ExceptionThread);
+};
+
+class CrashingThreadStateTest : public Multiprocess {
+ public:
+  // When |exception_thread_traced| is true, the exception thread is already
+  // traced by another connection, so the snapshot can’t attach to it.
+  // Otherwise, it’s left out because the deadline has passed.
+  explicit CrashingThreadStateTest(bool exception_thread_traced)
+      : Multiprocess(), exception_thread_traced_(exception_thread_traced) {}
+  ~CrashingThreadStateTest() {}
+
+ private:
+  void MultiprocessParent() override {
+    VMAddress exception_information_address;
+    CheckedReadFileExactly(ReadPipeHandle(),
+                           &exception_information_address,
+                           sizeof(exception_information_address));
+    ExceptionInformation exception_information;
+    CheckedReadFileExactly(ReadPipeHandle(),
+                           &exception_information,
+                           sizeof(exception_information));
+
+    DirectPtraceConnection connection;
+    ASSERT_TRUE(connection.Initialize(ChildPID()));
+
+    DirectPtraceConnection other_tracer;
+    CaptureDeadline deadline(1);
+    if (exception_thread_traced_) {
+      ASSERT_TRUE(other_tracer.Initialize(ChildPID()));
+      ASSERT_TRUE(other_tracer.Attach(exception_information.thread_id));
+    } else {
+      while (deadline.ElapsedNanoseconds() < 1) {
+      }
+    }
+
+    std::vector<ProcessMemoryOverlay::Region> crashing_thread_state(1);
+    crashing_thread_state[0].address = exception_information_address;
+    crashing_thread_state[0].size = sizeof(exception_information);
+    crashing_thread_state[0].data = &exception_information;
+
+    ProcessSnapshotLinux snapshot;
+    ASSERT_TRUE(snapshot.Initialize(&connection,
+                                    nullptr,
+                                    nullptr,
+                                    nullptr,
+                                    false,
+                                    exception_thread_traced_ ? nullptr
+                                                             : &deadline,
+                                    &crashing_thread_state,
+                                    CaptureProfile::kDefault,
+                                    exception_thread_traced_
+                                        ? exception_information_address
+                                        : 0));
+
+    // The child’s copy of the ExceptionInformation was cleared, so the
+    // exception can only be found through the crashing thread state. The
+    // exception thread is captured with the exception context.
+    ASSERT_TRUE(snapshot.InitializeException(exception_information_address));
+    const ExceptionSnapshot* exception = snapshot.Exception();
+    ASSERT_TRUE(exception);
+    EXPECT_EQ(exception->ThreadID(),
+              static_cast<uint64_t>(exception_information.thread_id));
+
+    const std::vector<const ThreadSnapshot*> threads = snapshot.Threads();
+    ASSERT_EQ(threads.size(), 2u);
+    EXPECT_EQ(threads[0]->ThreadID(), static_cast<uint64_t>(ChildPID()));
+    EXPECT_EQ(threads[1]->ThreadID(), exception->ThreadID());
+    EXPECT_EQ(threads[1]->Context()->InstructionPointer(),
+              exception->Context()->InstructionPointer());
+    EXPECT_EQ(threads[1]->Context()->StackPointer(),
+              exception->Context()->StackPointer());
+    EXPECT_NE(threads[1]->Stack()->Size(), 0u);
+  }
+
+  void MultiprocessChild() override {
+    ExceptionThread thread;
+    thread.Start();
+    thread.WaitUntilReady();
+
+    ExceptionInformation* exception_information =
+        thread.exception_information();
+    VMAddress exception_information_address =
+        FromPointerCast<VMAddress>(exception_information);
+    CheckedWriteFile(WritePipeHandle(),
+                     &exception_information_address,
+                     sizeof(exception_information_address));
+    CheckedWriteFile(WritePipeHandle(),
+                     exception_information,
+                     sizeof(*exception_information));
+    memset(exception_information, 0, sizeof(*exception_information));
+
+    CheckedReadFileAtEOF(ReadPipeHandle());
+
+    thread.Exit();
+    thread.Join();
+  }
+
+  bool exception_thread_traced_;
+
+  DISALLOW_COPY_AND_ASSIGN(CrashingThreadStateTest);
+};
+
+TEST(ProcessSnapshotLinux, CrashingThreadState) {
+  CrashingThreadStateTest test(false);
+  test.Run();
+}
+
+TEST(ProcessSnapshotLinux, CrashingThreadStateAttachFails) {
+  CrashingThreadStateTest test(true);
+  test.Run();
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
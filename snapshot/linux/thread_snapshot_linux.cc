@@ -131,6 +131,7 @@ ThreadSnapshotLinux::ThreadSnapshotLinux()
       context_union_(),
       context_(),
       stack_(),
+      omitted_stack_memory_(),
       thread_specific_data_address_(0),
       thread_id_(-1),
       priority_(-1),
@@ -190,9 +191,66 @@ bool ThreadSnapshotLinux::Initialize(ProcessReaderLinux* process_reader,
 #error Port.
 #endif
 
+  InitializeThread(process_reader, thread);
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+bool ThreadSnapshotLinux::InitializeWithContext(
+    ProcessReaderLinux* process_reader,
+    const ProcessReaderLinux::Thread& thread,
+    const CPUContext& context) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+
+  context_.architecture = context.architecture;
+  switch (context.architecture) {
+#if defined(ARCH_CPU_X86_FAMILY)
+    case kCPUArchitectureX86:
+      context_union_.x86 = *context.x86;
+      context_.x86 = &context_union_.x86;
+      break;
+    case kCPUArchitectureX86_64:
+      context_union_.x86_64 = *context.x86_64;
+      context_.x86_64 = &context_union_.x86_64;
+      break;
+#elif defined(ARCH_CPU_ARM_FAMILY)
+    case kCPUArchitectureARM:
+      context_union_.arm = *context.arm;
+      context_.arm = &context_union_.arm;
+      break;
+    case kCPUArchitectureARM64:
+      context_union_.arm64 = *context.arm64;
+      context_.arm64 = &context_union_.arm64;
+      break;
+#elif defined(ARCH_CPU_MIPS_FAMILY)
+    case kCPUArchitectureMIPSEL:
+      context_union_.mipsel = *context.mipsel;
+      context_.mipsel = &context_union_.mipsel;
+      break;
+    case kCPUArchitectureMIPS64EL:
+      context_union_.mips64 = *context.mips64;
+      context_.mips64 = &context_union_.mips64;
+      break;
+#endif  // ARCH_CPU_X86_FAMILY
+    default:
+      LOG(ERROR) << "unexpected architecture " << context.architecture;
+      return false;
+  }
+
+  InitializeThread(process_reader, thread);
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+void ThreadSnapshotLinux::InitializeThread(
+    ProcessReaderLinux* process_reader,
+    const ProcessReaderLinux::Thread& thread) {
   stack_.Initialize(process_reader->Memory(),
                     thread.stack_region_address,
                     thread.stack_region_size);
+  omitted_stack_memory_ = thread.omitted_stack_memory;
 
   thread_specific_data_address_ =
       thread.thread_info.thread_specific_data_address;
@@ -204,9 +262,12 @@ bool ThreadSnapshotLinux::Initialize(ProcessReaderLinux* process_reader,
           ? ComputeThreadPriority(
                 thread.static_priority, thread.sched_policy, thread.nice_value)
           : -1;
+}
 
-  INITIALIZATION_STATE_SET_VALID(initialized_);
-  return true;
+const std::vector<CheckedRange<uint64_t>>&
+ThreadSnapshotLinux::OmittedStackMemory() const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return omitted_stack_memory_;
 }
 
 const CPUContext* ThreadSnapshotLinux::Context() const {
@@ -17,6 +17,8 @@
 
 #include <stdint.h>
 
+#include <vector>
+
 #include "base/macros.h"
 #include "build/build_config.h"
 #include "snapshot/cpu_context.h"
@@ -25,6 +27,7 @@
 #include "snapshot/memory_snapshot_generic.h"
 #include "snapshot/thread_snapshot.h"
 #include "util/misc/initialization_state_dcheck.h"
+#include "util/numeric/checked_range.h"
 
 namespace crashpad {
 namespace internal {
@@ -47,6 +50,26 @@ class ThreadSnapshotLinux final : public ThreadSnapshot {
   bool Initialize(ProcessReaderLinux* process_reader,
                   const ProcessReaderLinux::Thread& thread);
 
+  //! \brief Initializes the object with a CPU context obtained elsewhere.
+  //!
+  //! This is used for a thread whose registers couldn’t be read through
+  //! \a process_reader, but whose context is known from an exception.
+  //!
+  //! \param[in] process_reader A ProcessReaderLinux for the process containing
+  //!     the thread.
+  //! \param[in] thread The thread to snapshot. Its registers are ignored.
+  //! \param[in] context The thread’s CPU context, which is copied.
+  //!
+  //! \return `true` if the snapshot could be created, `false` otherwise with
+  //!     a message logged.
+  bool InitializeWithContext(ProcessReaderLinux* process_reader,
+                             const ProcessReaderLinux::Thread& thread,
+                             const CPUContext& context);
+
+  //! \brief Returns the ranges of memory left out of the ends of the stack
+  //!     because their contents are the same as in module files.
+  const std::vector<CheckedRange<uint64_t>>& OmittedStackMemory() const;
+
   // ThreadSnapshot:
 
   const CPUContext* Context() const override;
@@ -58,6 +81,9 @@ class ThreadSnapshotLinux final : public ThreadSnapshot {
   std::vector<const MemorySnapshot*> ExtraMemory() const override;
 
  private:
+  void InitializeThread(ProcessReaderLinux* process_reader,
+                        const ProcessReaderLinux::Thread& thread);
+
   union {
 #if defined(ARCH_CPU_X86_FAMILY)
     CPUContextX86 x86;
@@ -74,6 +100,7 @@ class ThreadSnapshotLinux final : public ThreadSnapshot {
   } context_union_;
   CPUContext context_;
   MemorySnapshotGeneric stack_;
+  std::vector<CheckedRange<uint64_t>> omitted_stack_memory_;
   LinuxVMAddress thread_specific_data_address_;
   pid_t thread_id_;
   int priority_;
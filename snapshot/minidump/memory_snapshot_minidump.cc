@@ -25,6 +25,8 @@ MemorySnapshotMinidump::MemorySnapshotMinidump()
     : MemorySnapshot(),
       address_(0),
       data_(),
+      mapped_data_(nullptr),
+      mapped_size_(0),
       initialized_() {}
 
 MemorySnapshotMinidump::~MemorySnapshotMinidump() {}
@@ -44,6 +46,16 @@ bool MemorySnapshotMinidump::Initialize(FileReaderInterface* file_reader,
   }
 
   address_ = descriptor.StartOfMemoryRange;
+
+  const void* mapped_data = file_reader->MappedData(descriptor.Memory.Rva,
+                                                    descriptor.Memory.DataSize);
+  if (mapped_data) {
+    mapped_data_ = static_cast<const uint8_t*>(mapped_data);
+    mapped_size_ = descriptor.Memory.DataSize;
+    INITIALIZATION_STATE_SET_VALID(initialized_);
+    return true;
+  }
+
   data_.resize(descriptor.Memory.DataSize);
 
   if (!file_reader->SeekSet(descriptor.Memory.Rva)) {
@@ -65,13 +77,13 @@ uint64_t MemorySnapshotMinidump::Address() const {
 
 size_t MemorySnapshotMinidump::Size() const {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
-  return data_.size();
+  return size();
 }
 
 bool MemorySnapshotMinidump::Read(Delegate* delegate) const {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
-  return delegate->MemorySnapshotDelegateRead(
-      const_cast<uint8_t*>(data_.data()), data_.size());
+  return delegate->MemorySnapshotDelegateRead(const_cast<uint8_t*>(data()),
+                                              size());
 }
 
 const MemorySnapshot* MemorySnapshotMinidump::MergeWithOtherSnapshot(
@@ -92,9 +104,11 @@ const MemorySnapshot* MemorySnapshotMinidump::MergeWithOtherSnapshot(
     return nullptr;
   }
 
+  // The merged contents aren’t contiguous in the file, so they’re always
+  // copied.
   auto result = std::make_unique<MemorySnapshotMinidump>();
   result->address_ = merged.base();
-  result->data_ = data_;
+  result->data_.assign(data(), data() + size());
 
   if (result->data_.size() == merged.size()) {
     return result.release();
@@ -102,8 +116,9 @@ const MemorySnapshot* MemorySnapshotMinidump::MergeWithOtherSnapshot(
 
   result->data_.resize(
       base::checked_cast<size_t>(other_cast->address_ - address_));
-  result->data_.insert(result->data_.end(), other_cast->data_.begin(),
-                       other_cast->data_.end());
+  result->data_.insert(result->data_.end(),
+                       other_cast->data(),
+                       other_cast->data() + other_cast->size());
   return result.release();
 }
 
@@ -34,6 +34,10 @@ class MemorySnapshotMinidump : public MemorySnapshot {
 
   //! \brief Initializes the object.
   //!
+  //! If \a file_reader is able to provide the memory’s contents through
+  //! FileReaderInterface::MappedData(), this object refers to them there
+  //! rather than copying them, and \a file_reader must outlive this object.
+  //!
   //! \param[in] file_reader A file reader corresponding to a minidump file.
   //!     The file reader must support seeking.
   //! \param[in] location The location within the file where we will find a
@@ -50,8 +54,18 @@ class MemorySnapshotMinidump : public MemorySnapshot {
       const MemorySnapshot* other) const override;
 
  private:
+  const uint8_t* data() const {
+    return mapped_data_ ? mapped_data_ : data_.data();
+  }
+  size_t size() const { return mapped_data_ ? mapped_size_ : data_.size(); }
+
   uint64_t address_;
+
+  // The memory’s contents are held in data_ unless they were available from the
+  // file reader without copying, in which case mapped_data_ points to them.
   std::vector<uint8_t> data_;
+  const uint8_t* mapped_data_;  // weak
+  size_t mapped_size_;
   InitializationStateDcheck initialized_;
 
   DISALLOW_COPY_AND_ASSIGN(MemorySnapshotMinidump);
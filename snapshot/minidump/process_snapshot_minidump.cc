@@ -62,11 +62,23 @@ ProcessSnapshotMinidump::ProcessSnapshotMinidump()
       create_time_(0),
       user_time_(0),
       kernel_time_(0),
+      deferred_streams_(0),
       initialized_() {}
 
 ProcessSnapshotMinidump::~ProcessSnapshotMinidump() {}
 
 bool ProcessSnapshotMinidump::Initialize(FileReaderInterface* file_reader) {
+  return InitializeInternal(file_reader, false);
+}
+
+bool ProcessSnapshotMinidump::InitializeLazily(
+    FileReaderInterface* file_reader) {
+  return InitializeInternal(file_reader, true);
+}
+
+bool ProcessSnapshotMinidump::InitializeInternal(
+    FileReaderInterface* file_reader,
+    bool lazy) {
   INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
 
   file_reader_ = file_reader;
@@ -112,10 +124,22 @@ bool ProcessSnapshotMinidump::Initialize(FileReaderInterface* file_reader) {
     stream_map_[stream_type] = &directory.Location;
   }
 
-  if (!InitializeCrashpadInfo() || !InitializeMiscInfo() ||
-      !InitializeModules() || !InitializeSystemSnapshot() ||
-      !InitializeMemoryInfo() || !InitializeThreads() ||
-      !InitializeCustomMinidumpStreams() || !InitializeExceptionSnapshot()) {
+  if (lazy) {
+    // The system snapshot is still read now, because the thread list and
+    // exception streams need its CPU architecture to interpret their contexts.
+    if (!InitializeCrashpadInfo() || !InitializeMiscInfo() ||
+        !InitializeSystemSnapshot()) {
+      return false;
+    }
+
+    deferred_streams_ = kDeferredModules | kDeferredThreads |
+                        kDeferredMemoryInfo | kDeferredCustomStreams |
+                        kDeferredException;
+  } else if (!InitializeCrashpadInfo() || !InitializeMiscInfo() ||
+             !InitializeModules() || !InitializeSystemSnapshot() ||
+             !InitializeMemoryInfo() || !InitializeThreads() ||
+             !InitializeCustomMinidumpStreams() ||
+             !InitializeExceptionSnapshot()) {
     return false;
   }
 
@@ -184,6 +208,7 @@ const SystemSnapshot* ProcessSnapshotMinidump::System() const {
 
 std::vector<const ThreadSnapshot*> ProcessSnapshotMinidump::Threads() const {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  ReadDeferredStream(kDeferredThreads);
   std::vector<const ThreadSnapshot*> threads;
   for (const auto& thread : threads_) {
     threads.push_back(thread.get());
@@ -193,6 +218,7 @@ std::vector<const ThreadSnapshot*> ProcessSnapshotMinidump::Threads() const {
 
 std::vector<const ModuleSnapshot*> ProcessSnapshotMinidump::Modules() const {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  ReadDeferredStream(kDeferredModules);
   std::vector<const ModuleSnapshot*> modules;
   for (const auto& module : modules_) {
     modules.push_back(module.get());
@@ -209,6 +235,7 @@ std::vector<UnloadedModuleSnapshot> ProcessSnapshotMinidump::UnloadedModules()
 
 const ExceptionSnapshot* ProcessSnapshotMinidump::Exception() const {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  ReadDeferredStream(kDeferredException);
   if (exception_snapshot_.IsValid()) {
     return &exception_snapshot_;
   }
@@ -219,6 +246,7 @@ const ExceptionSnapshot* ProcessSnapshotMinidump::Exception() const {
 std::vector<const MemoryMapRegionSnapshot*> ProcessSnapshotMinidump::MemoryMap()
     const {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  ReadDeferredStream(kDeferredMemoryInfo);
   return mem_regions_exposed_;
 }
 
@@ -243,6 +271,7 @@ const ProcessMemory* ProcessSnapshotMinidump::Memory() const {
 std::vector<const MinidumpStream*>
 ProcessSnapshotMinidump::CustomMinidumpStreams() const {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  ReadDeferredStream(kDeferredCustomStreams);
 
   std::vector<const MinidumpStream*> result;
   result.reserve(custom_streams_.size());
@@ -252,6 +281,56 @@ ProcessSnapshotMinidump::CustomMinidumpStreams() const {
   return result;
 }
 
+void ProcessSnapshotMinidump::ReadDeferredStream(DeferredStream stream) const {
+  if (!(deferred_streams_ & stream)) {
+    return;
+  }
+  deferred_streams_ &= ~stream;
+
+  // The ProcessSnapshot interface requires accessors to be const, so reading a
+  // stream on first use has to modify this object through a non-const pointer.
+  // See the TODO in AnnotationsSimpleMap().
+  ProcessSnapshotMinidump* self = const_cast<ProcessSnapshotMinidump*>(this);
+  switch (stream) {
+    case kDeferredModules:
+      if (!self->InitializeModules()) {
+        LOG(ERROR) << "discarding module_list";
+        self->modules_.clear();
+      }
+      break;
+
+    case kDeferredThreads:
+      if (!self->InitializeThreads()) {
+        LOG(ERROR) << "discarding thread_list";
+        self->threads_.clear();
+      }
+      break;
+
+    case kDeferredMemoryInfo:
+      if (!self->InitializeMemoryInfo()) {
+        LOG(ERROR) << "discarding memory_info_list";
+        self->mem_regions_exposed_.clear();
+        self->mem_regions_.clear();
+      }
+      break;
+
+    case kDeferredCustomStreams:
+      if (!self->InitializeCustomMinidumpStreams()) {
+        LOG(ERROR) << "discarding custom streams";
+        self->custom_streams_.clear();
+      }
+      break;
+
+    case kDeferredException:
+      // If this fails, exception_snapshot_ won’t be valid, and Exception() will
+      // report that there was no exception.
+      if (!self->InitializeExceptionSnapshot()) {
+        LOG(ERROR) << "discarding exception";
+      }
+      break;
+  }
+}
+
 bool ProcessSnapshotMinidump::InitializeCrashpadInfo() {
   const auto& stream_it = stream_map_.find(kMinidumpStreamTypeCrashpadInfo);
   if (stream_it == stream_map_.end()) {
@@ -58,6 +58,12 @@ class ProcessSnapshotMinidump final : public ProcessSnapshot {
 
   //! \brief Initializes the object.
   //!
+  //! If \a file_reader is able to provide views of its contents through
+  //! FileReaderInterface::MappedData(), as MappedFileReader does, memory
+  //! snapshots such as thread stacks refer to those views instead of copying
+  //! their contents. \a file_reader must then outlive this object, and its
+  //! contents must not be modified while this object exists.
+  //!
   //! \param[in] file_reader A file reader corresponding to a minidump file.
   //!     The file reader must support seeking.
   //!
@@ -65,6 +71,31 @@ class ProcessSnapshotMinidump final : public ProcessSnapshot {
   //!     an appropriate message logged.
   bool Initialize(FileReaderInterface* file_reader);
 
+  //! \brief Initializes the object, deferring the reading of most streams
+  //!     until they’re first needed.
+  //!
+  //! Only the header, the stream directory, and the Crashpad info,
+  //! miscellaneous info, and system info streams are read by this method. The
+  //! module list, thread list, memory info list, exception, and custom streams
+  //! are each read the first time that the corresponding accessor is called.
+  //! This makes it cheap to consult a few properties of a large minidump, such
+  //! as its annotations, without reading everything else that it contains.
+  //!
+  //! A deferred stream that can’t be read doesn’t cause initialization to fail.
+  //! Instead, a message is logged when it’s first needed, and the accessor
+  //! behaves as though the stream were absent.
+  //!
+  //! Objects initialized this way must not have their accessors called
+  //! concurrently, because they may modify the object.
+  //!
+  //! \param[in] file_reader A file reader corresponding to a minidump file.
+  //!     The file reader must support seeking, must outlive this object, and
+  //!     must not have its contents modified while this object exists.
+  //!
+  //! \return `true` if the snapshot could be created, `false` otherwise with
+  //!     an appropriate message logged.
+  bool InitializeLazily(FileReaderInterface* file_reader);
+
   // ProcessSnapshot:
 
   crashpad::ProcessID ProcessID() const override;
@@ -97,6 +128,23 @@ class ProcessSnapshotMinidump final : public ProcessSnapshot {
   std::vector<const MinidumpStream*> CustomMinidumpStreams() const;
 
  private:
+  // Streams whose reading InitializeLazily() defers until they’re first needed.
+  enum DeferredStream : uint32_t {
+    kDeferredModules = 1 << 0,
+    kDeferredThreads = 1 << 1,
+    kDeferredMemoryInfo = 1 << 2,
+    kDeferredCustomStreams = 1 << 3,
+    kDeferredException = 1 << 4,
+  };
+
+  // The implementation of Initialize() and InitializeLazily().
+  bool InitializeInternal(FileReaderInterface* file_reader, bool lazy);
+
+  // Reads |stream| if its reading was deferred and it hasn’t been read yet. If
+  // it can’t be read, a message is logged and it’s treated as though it were
+  // absent.
+  void ReadDeferredStream(DeferredStream stream) const;
+
   // Initializes data carried in a MinidumpCrashpadInfo stream on behalf of
   // Initialize().
   bool InitializeCrashpadInfo();
@@ -156,6 +204,11 @@ class ProcessSnapshotMinidump final : public ProcessSnapshot {
   uint32_t create_time_;
   uint32_t user_time_;
   uint32_t kernel_time_;
+
+  // A bitmask of DeferredStream values for the streams that haven’t been read
+  // yet. This is only nonzero following InitializeLazily().
+  mutable uint32_t deferred_streams_;
+
   InitializationStateDcheck initialized_;
 
   DISALLOW_COPY_AND_ASSIGN(ProcessSnapshotMinidump);
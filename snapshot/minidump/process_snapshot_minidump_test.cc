@@ -20,6 +20,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <string>
 
 #include "base/numerics/safe_math.h"
 #include "base/stl_util.h"
@@ -1240,6 +1241,125 @@ TEST(ProcessSnapshotMinidump, Stacks) {
   EXPECT_EQ(delegate.result, minidump_stack);
 }
 
+class RecordPointer : public crashpad::MemorySnapshot::Delegate {
+ public:
+  const void* data = nullptr;
+  size_t size = 0;
+
+  bool MemorySnapshotDelegateRead(void* data, size_t size) override {
+    this->data = data;
+    this->size = size;
+    return true;
+  }
+};
+
+// Writes a minidump containing only a thread list with one thread to
+// |string_file|. If |valid| is false, the thread list stream’s size is wrong.
+void WriteThreadListMinidump(StringFile* string_file,
+                             const std::string& stack,
+                             bool valid,
+                             RVA* stack_rva) {
+  MINIDUMP_HEADER header = {};
+  ASSERT_TRUE(string_file->Write(&header, sizeof(header)));
+
+  MINIDUMP_THREAD minidump_thread = {};
+  minidump_thread.ThreadId = 42;
+  minidump_thread.Stack.StartOfMemoryRange = 0xbeefd00d;
+  minidump_thread.Stack.Memory.DataSize =
+      base::checked_cast<uint32_t>(stack.size());
+  *stack_rva = static_cast<RVA>(string_file->SeekGet());
+  minidump_thread.Stack.Memory.Rva = *stack_rva;
+  ASSERT_TRUE(string_file->Write(stack.data(), stack.size()));
+
+  const uint32_t minidump_thread_count = 1;
+  MINIDUMP_DIRECTORY minidump_thread_list_directory = {};
+  minidump_thread_list_directory.StreamType = kMinidumpStreamTypeThreadList;
+  minidump_thread_list_directory.Location.DataSize =
+      sizeof(MINIDUMP_THREAD_LIST) +
+      minidump_thread_count * sizeof(MINIDUMP_THREAD) + (valid ? 0 : 1);
+  minidump_thread_list_directory.Location.Rva =
+      static_cast<RVA>(string_file->SeekGet());
+  ASSERT_TRUE(string_file->Write(&minidump_thread_count,
+                                 sizeof(minidump_thread_count)));
+  ASSERT_TRUE(string_file->Write(&minidump_thread, sizeof(minidump_thread)));
+
+  header.StreamDirectoryRva = static_cast<RVA>(string_file->SeekGet());
+  ASSERT_TRUE(string_file->Write(&minidump_thread_list_directory,
+                                 sizeof(minidump_thread_list_directory)));
+
+  header.Signature = MINIDUMP_SIGNATURE;
+  header.Version = MINIDUMP_VERSION;
+  header.NumberOfStreams = 1;
+  ASSERT_TRUE(string_file->SeekSet(0));
+  ASSERT_TRUE(string_file->Write(&header, sizeof(header)));
+}
+
+TEST(ProcessSnapshotMinidump, StacksNotCopied) {
+  StringFile string_file;
+  const std::string stack = "0123456789abcdef";
+  RVA stack_rva;
+  ASSERT_NO_FATAL_FAILURE(
+      WriteThreadListMinidump(&string_file, stack, true, &stack_rva));
+
+  ProcessSnapshotMinidump process_snapshot;
+  ASSERT_TRUE(process_snapshot.Initialize(&string_file));
+
+  std::vector<const ThreadSnapshot*> threads = process_snapshot.Threads();
+  ASSERT_EQ(threads.size(), 1u);
+
+  // StringFile can provide views of its contents, so the stack should be read
+  // directly from it.
+  RecordPointer delegate;
+  ASSERT_TRUE(threads[0]->Stack()->Read(&delegate));
+  EXPECT_EQ(delegate.data, string_file.string().data() + stack_rva);
+  EXPECT_EQ(delegate.size, stack.size());
+}
+
+TEST(ProcessSnapshotMinidump, InitializeLazily) {
+  StringFile string_file;
+  const std::string stack = "0123456789abcdef";
+  RVA stack_rva;
+  ASSERT_NO_FATAL_FAILURE(
+      WriteThreadListMinidump(&string_file, stack, true, &stack_rva));
+
+  ProcessSnapshotMinidump process_snapshot;
+  ASSERT_TRUE(process_snapshot.InitializeLazily(&string_file));
+
+  EXPECT_TRUE(process_snapshot.Modules().empty());
+  EXPECT_TRUE(process_snapshot.MemoryMap().empty());
+  EXPECT_TRUE(process_snapshot.CustomMinidumpStreams().empty());
+  EXPECT_FALSE(process_snapshot.Exception());
+
+  std::vector<const ThreadSnapshot*> threads = process_snapshot.Threads();
+  ASSERT_EQ(threads.size(), 1u);
+  EXPECT_EQ(threads[0]->ThreadID(), 42u);
+
+  ReadToVector delegate;
+  ASSERT_TRUE(threads[0]->Stack()->Read(&delegate));
+  EXPECT_EQ(std::string(delegate.result.begin(), delegate.result.end()),
+            stack);
+
+  // The thread list is only read once.
+  EXPECT_EQ(process_snapshot.Threads(), threads);
+}
+
+TEST(ProcessSnapshotMinidump, InitializeLazilyInvalidStream) {
+  StringFile string_file;
+  RVA stack_rva;
+  ASSERT_NO_FATAL_FAILURE(
+      WriteThreadListMinidump(&string_file, "stack", false, &stack_rva));
+
+  // The thread list is read eagerly by Initialize(), so it fails.
+  ProcessSnapshotMinidump eager_process_snapshot;
+  EXPECT_FALSE(eager_process_snapshot.Initialize(&string_file));
+
+  // InitializeLazily() succeeds, and the bad thread list is discarded when it’s
+  // needed.
+  ProcessSnapshotMinidump lazy_process_snapshot;
+  ASSERT_TRUE(lazy_process_snapshot.InitializeLazily(&string_file));
+  EXPECT_TRUE(lazy_process_snapshot.Threads().empty());
+}
+
 TEST(ProcessSnapshotMinidump, CustomMinidumpStreams) {
   StringFile string_file;
 
@@ -16,6 +16,9 @@
 
 #include <string.h>
 
+#include <algorithm>
+#include <limits>
+
 namespace crashpad {
 namespace internal {
 
@@ -58,12 +61,7 @@ class MemorySanitizer : public MemorySnapshot::Delegate {
     size_t word_count = (size - aligned_offset) / sizeof(Pointer);
     auto words =
         reinterpret_cast<Pointer*>(static_cast<char*>(data) + aligned_offset);
-    for (size_t index = 0; index < word_count; ++index) {
-      if (words[index] > MemorySnapshotSanitized::kSmallWordMax &&
-          !ranges_->Contains(words[index])) {
-        words[index] = defaced;
-      }
-    }
+    SanitizeWords(words, word_count, defaced);
 
     // Sanitize trailing bytes beyond the word-sized items.
     const size_t sanitized_bytes =
@@ -73,6 +71,67 @@ class MemorySanitizer : public MemorySnapshot::Delegate {
            size - sanitized_bytes);
   }
 
+  template <typename Pointer>
+  void SanitizeWords(Pointer* words, size_t word_count, Pointer defaced) {
+    constexpr Pointer kSmallWordMax = MemorySnapshotSanitized::kSmallWordMax;
+    if (ranges_->IsEmpty() ||
+        ranges_->Lowest() > std::numeric_limits<Pointer>::max()) {
+      for (size_t index = 0; index < word_count; ++index) {
+        words[index] = words[index] > kSmallWordMax ? defaced : words[index];
+      }
+      return;
+    }
+
+    // Most words on a stack don’t fall between the lowest and highest address
+    // in |ranges_|, so check blocks of words against those bounds first. These
+    // loops have no data-dependent branches, so they can be vectorized. Only
+    // blocks with a word within the bounds need to be searched word by word.
+    // A word is within the bounds if (word - lowest) <= (highest - lowest),
+    // using unsigned arithmetic that wraps for words below the lowest address.
+    const Pointer lowest = static_cast<Pointer>(ranges_->Lowest());
+    const Pointer highest = static_cast<Pointer>(std::min(
+        ranges_->Highest(), VMAddress{std::numeric_limits<Pointer>::max()}));
+    const Pointer span = highest - lowest;
+    constexpr size_t kBlockSize = 16;
+    size_t index = 0;
+    for (; index + kBlockSize <= word_count; index += kBlockSize) {
+      Pointer* const block = words + index;
+      bool any_within_bounds = false;
+      for (size_t block_index = 0; block_index < kBlockSize; ++block_index) {
+        any_within_bounds |=
+            static_cast<Pointer>(block[block_index] - lowest) <= span;
+      }
+
+      if (!any_within_bounds) {
+        for (size_t block_index = 0; block_index < kBlockSize; ++block_index) {
+          block[block_index] =
+              block[block_index] > kSmallWordMax ? defaced : block[block_index];
+        }
+        continue;
+      }
+
+      for (size_t block_index = 0; block_index < kBlockSize; ++block_index) {
+        SanitizeWord(&block[block_index], lowest, span, defaced);
+      }
+    }
+
+    for (; index < word_count; ++index) {
+      SanitizeWord(&words[index], lowest, span, defaced);
+    }
+  }
+
+  template <typename Pointer>
+  void SanitizeWord(Pointer* word,
+                    Pointer lowest,
+                    Pointer span,
+                    Pointer defaced) {
+    if (*word > MemorySnapshotSanitized::kSmallWordMax &&
+        (static_cast<Pointer>(*word - lowest) > span ||
+         !ranges_->Contains(*word))) {
+      *word = defaced;
+    }
+  }
+
   MemorySnapshot::Delegate* delegate_;
   RangeSet* ranges_;
   VMAddress address_;
@@ -0,0 +1,214 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "snapshot/sanitized/memory_snapshot_sanitized.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+#include "base/macros.h"
+#include "base/stl_util.h"
+#include "gtest/gtest.h"
+#include "util/misc/range_set.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+// A MemorySnapshot of a local buffer, which may start at any offset into the
+// buffer to simulate stacks that aren’t pointer aligned.
+class BufferMemorySnapshot final : public MemorySnapshot {
+ public:
+  BufferMemorySnapshot(uint64_t address, const std::vector<char>& buffer)
+      : address_(address), buffer_(buffer) {}
+  ~BufferMemorySnapshot() override {}
+
+  // MemorySnapshot:
+
+  uint64_t Address() const override { return address_; }
+  size_t Size() const override { return buffer_.size(); }
+
+  bool Read(Delegate* delegate) const override {
+    std::vector<char> copy(buffer_);
+    return delegate->MemorySnapshotDelegateRead(copy.data(), copy.size());
+  }
+
+  const MemorySnapshot* MergeWithOtherSnapshot(
+      const MemorySnapshot* other) const override {
+    return nullptr;
+  }
+
+ private:
+  uint64_t address_;
+  const std::vector<char>& buffer_;
+
+  DISALLOW_COPY_AND_ASSIGN(BufferMemorySnapshot);
+};
+
+class ReadToVector : public MemorySnapshot::Delegate {
+ public:
+  explicit ReadToVector(std::vector<char>* result) : result_(result) {}
+  ~ReadToVector() {}
+
+  bool MemorySnapshotDelegateRead(void* data, size_t size) override {
+    result_->assign(static_cast<char*>(data), static_cast<char*>(data) + size);
+    return true;
+  }
+
+ private:
+  std::vector<char>* result_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReadToVector);
+};
+
+void InsertTestRanges(RangeSet* ranges) {
+  ranges->Insert(0x10000, 0x1000);
+  ranges->Insert(0x7f0000000000, 0x200000);
+  ranges->Insert(0x7f0000400000, 0x1000);
+  ranges->Insert(0x7fff00000000, 0x800000);
+  ranges->Insert(0xf0000000, 0x100000);
+}
+
+// Fills a buffer with a mix of small words, words within and around the
+// test ranges, and words that are far from any range, with runs of each so
+// that some blocks of words can be ruled out without searching the ranges.
+template <typename Pointer>
+std::vector<char> MakeStack(size_t size) {
+  static constexpr uint64_t kInteresting[] = {
+      0,
+      1,
+      4096,
+      4097,
+      0xffff,
+      0x10000,
+      0x10fff,
+      0x11000,
+      0xefffffff,
+      0xf0000000,
+      0xf00fffff,
+      0xf0100000,
+      0x7f0000000000,
+      0x7f00001fffff,
+      0x7f0000200000,
+      0x7f00003fffff,
+      0x7f0000400000,
+      0x7fff00000000,
+      0x7fff007fffff,
+      0x7fff00800000,
+      0xffffffffffffffff,
+  };
+
+  std::vector<char> buffer(size);
+  uint64_t state = 0x123456789abcdef;
+  size_t offset = 0;
+  while (offset + sizeof(Pointer) <= buffer.size()) {
+    state = state * 6364136223846793005 + 1442695040888963407;
+    const size_t run = (state >> 60) + 1;
+    const bool interesting = (state >> 32) % 4 == 0;
+    for (size_t index = 0;
+         index < run && offset + sizeof(Pointer) <= buffer.size();
+         ++index, offset += sizeof(Pointer)) {
+      state = state * 6364136223846793005 + 1442695040888963407;
+      const Pointer word = static_cast<Pointer>(
+          interesting ? kInteresting[(state >> 33) % base::size(kInteresting)]
+                      : state >> 7);
+      memcpy(&buffer[offset], &word, sizeof(word));
+    }
+  }
+  return buffer;
+}
+
+// The straightforward sanitization that the faster implementation must match.
+// Partial words before the first aligned word and after the last are replaced
+// with the leading bytes of the defaced value.
+template <typename Pointer>
+std::vector<char> ExpectedSanitization(const std::vector<char>& buffer,
+                                       uint64_t address,
+                                       const RangeSet& ranges) {
+  const Pointer defaced =
+      static_cast<Pointer>(internal::MemorySnapshotSanitized::kDefaced);
+  std::vector<char> expected(buffer);
+  const size_t aligned_offset =
+      ((address + sizeof(Pointer) - 1) & ~(sizeof(Pointer) - 1)) - address;
+  memcpy(expected.data(), &defaced, aligned_offset);
+
+  size_t offset = aligned_offset;
+  for (; offset + sizeof(Pointer) <= expected.size();
+       offset += sizeof(Pointer)) {
+    Pointer word;
+    memcpy(&word, &expected[offset], sizeof(word));
+    if (word > internal::MemorySnapshotSanitized::kSmallWordMax &&
+        !ranges.Contains(word)) {
+      memcpy(&expected[offset], &defaced, sizeof(defaced));
+    }
+  }
+  memcpy(&expected[offset], &defaced, expected.size() - offset);
+  return expected;
+}
+
+template <typename Pointer>
+void TestSanitization(bool is_64_bit) {
+  RangeSet reference_ranges;
+  InsertTestRanges(&reference_ranges);
+  RangeSet ranges;
+  InsertTestRanges(&ranges);
+  ranges.Freeze();
+
+  constexpr size_t kStackSize = 4 * 1024 * 1024 + 5;
+  const std::vector<char> buffer = MakeStack<Pointer>(kStackSize);
+
+  // The second address isn’t pointer aligned.
+  static constexpr uint64_t kAddresses[] = {0x7fff00001000, 0x7fff00001003};
+  for (uint64_t address : kAddresses) {
+    SCOPED_TRACE(address);
+
+    BufferMemorySnapshot snapshot(address, buffer);
+    internal::MemorySnapshotSanitized sanitized(&snapshot, &ranges, is_64_bit);
+    std::vector<char> result;
+    ReadToVector delegate(&result);
+    ASSERT_TRUE(sanitized.Read(&delegate));
+
+    // Compare with == to avoid printing megabytes of data on failure.
+    EXPECT_TRUE(result == ExpectedSanitization<Pointer>(
+                              buffer, address, reference_ranges));
+  }
+}
+
+TEST(MemorySnapshotSanitized, LargeStack64) {
+  TestSanitization<uint64_t>(true);
+}
+
+TEST(MemorySnapshotSanitized, LargeStack32) {
+  TestSanitization<uint32_t>(false);
+}
+
+TEST(MemorySnapshotSanitized, EmptyRanges) {
+  RangeSet ranges;
+  ranges.Freeze();
+
+  const std::vector<char> buffer = MakeStack<uint64_t>(64 * 1024);
+  BufferMemorySnapshot snapshot(0x1000, buffer);
+  internal::MemorySnapshotSanitized sanitized(&snapshot, &ranges, true);
+  std::vector<char> result;
+  ReadToVector delegate(&result);
+  ASSERT_TRUE(sanitized.Read(&delegate));
+
+  EXPECT_EQ(result, ExpectedSanitization<uint64_t>(buffer, 0x1000, ranges));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -60,8 +60,29 @@ class StackReferencesAddressRange : public MemorySnapshot::Delegate {
     auto words = reinterpret_cast<Pointer*>(static_cast<char*>(data) +
                                             aligned_sp_offset);
     size_t word_count = (size - aligned_sp_offset) / sizeof(Pointer);
-    for (size_t index = 0; index < word_count; ++index) {
-      if (words[index] >= low_ && words[index] < high_) {
+    if (high_ <= low_) {
+      return false;
+    }
+
+    // A word is in [low_, high_) if (word - low_) < (high_ - low_), using
+    // unsigned arithmetic that wraps for words below low_. Checking whole
+    // blocks of words without data-dependent branches allows the loop to be
+    // vectorized.
+    const VMSize span = high_ - low_;
+    constexpr size_t kBlockSize = 16;
+    size_t index = 0;
+    for (; index + kBlockSize <= word_count; index += kBlockSize) {
+      bool found = false;
+      for (size_t block_index = 0; block_index < kBlockSize; ++block_index) {
+        found |= VMAddress{words[index + block_index]} - low_ < span;
+      }
+      if (found) {
+        return true;
+      }
+    }
+
+    for (; index < word_count; ++index) {
+      if (VMAddress{words[index]} - low_ < span) {
         return true;
       }
     }
@@ -157,6 +178,7 @@ bool ProcessSnapshotSanitized::Initialize(
       threads_.emplace_back(std::make_unique<internal::ThreadSnapshotSanitized>(
           thread, &address_ranges_));
     }
+    address_ranges_.Freeze();
   }
 
   process_memory_.Initialize(snapshot_->Memory(), memory_range_whitelist.get());
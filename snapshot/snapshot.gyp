@@ -47,6 +47,8 @@
         'elf/elf_dynamic_array_reader.h',
         'elf/elf_image_reader.cc',
         'elf/elf_image_reader.h',
+        'elf/elf_module_metadata_cache.cc',
+        'elf/elf_module_metadata_cache.h',
         'elf/elf_symbol_table_reader.cc',
         'elf/elf_symbol_table_reader.h',
         'elf/module_snapshot_elf.cc',
@@ -54,12 +56,20 @@
         'exception_snapshot.h',
         'handle_snapshot.cc',
         'handle_snapshot.h',
+        'linux/capture_memory_delegate_linux.cc',
+        'linux/capture_memory_delegate_linux.h',
         'linux/cpu_context_linux.cc',
         'linux/cpu_context_linux.h',
         'linux/debug_rendezvous.cc',
         'linux/debug_rendezvous.h',
         'linux/exception_snapshot_linux.cc',
         'linux/exception_snapshot_linux.h',
+        'linux/link_map_cache.cc',
+        'linux/link_map_cache.h',
+        'linux/module_file_mappings.cc',
+        'linux/module_file_mappings.h',
+        'linux/memory_map_region_snapshot_linux.cc',
+        'linux/memory_map_region_snapshot_linux.h',
         'linux/process_reader_linux.cc',
         'linux/process_reader_linux.h',
         'linux/process_snapshot_linux.cc',
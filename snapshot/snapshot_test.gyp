@@ -76,8 +76,12 @@
         'crashpad_types/image_annotation_reader_test.cc',
         'elf/elf_image_reader_test.cc',
         'elf/elf_image_reader_test_note.S',
+        'elf/elf_module_metadata_cache_test.cc',
+        'linux/capture_memory_delegate_linux_test.cc',
         'linux/debug_rendezvous_test.cc',
         'linux/exception_snapshot_linux_test.cc',
+        'linux/module_file_mappings_test.cc',
+        'linux/process_snapshot_linux_test.cc',
         'linux/process_reader_linux_test.cc',
         'linux/system_snapshot_linux_test.cc',
         'mac/cpu_context_mac_test.cc',
@@ -89,6 +93,7 @@
         'mac/system_snapshot_mac_test.cc',
         'minidump/process_snapshot_minidump_test.cc',
         'posix/timezone_test.cc',
+        'sanitized/memory_snapshot_sanitized_test.cc',
         'sanitized/process_snapshot_sanitized_test.cc',
         'sanitized/sanitization_information_test.cc',
         'win/cpu_context_win_test.cc',
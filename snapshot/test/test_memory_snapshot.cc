@@ -21,7 +21,11 @@ namespace crashpad {
 namespace test {
 
 TestMemorySnapshot::TestMemorySnapshot()
-    : address_(0), size_(0), value_('\0'), should_fail_(false) {
+    : address_(0),
+      size_(0),
+      read_count_(0),
+      value_('\0'),
+      should_fail_(false) {
 }
 
 TestMemorySnapshot::~TestMemorySnapshot() {
@@ -36,6 +40,7 @@ size_t TestMemorySnapshot::Size() const {
 }
 
 bool TestMemorySnapshot::Read(Delegate* delegate) const {
+  ++read_count_;
   if (should_fail_) {
     return false;
   }
@@ -42,6 +42,9 @@ class TestMemorySnapshot final : public MemorySnapshot {
 
   void SetShouldFailRead(bool should_fail) { should_fail_ = true; }
 
+  //! \brief Returns the number of times that Read() has been called.
+  size_t read_count() const { return read_count_; }
+
   // MemorySnapshot:
 
   uint64_t Address() const override;
@@ -53,6 +56,7 @@ class TestMemorySnapshot final : public MemorySnapshot {
  private:
   uint64_t address_;
   size_t size_;
+  mutable size_t read_count_;
   char value_;
   bool should_fail_;
 
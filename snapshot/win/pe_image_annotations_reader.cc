@@ -20,6 +20,7 @@
 #include "base/stl_util.h"
 #include "base/strings/utf_string_conversions.h"
 #include "client/annotation.h"
+#include "client/crashpad_info.h"
 #include "client/simple_string_dictionary.h"
 #include "snapshot/snapshot_constants.h"
 #include "snapshot/win/pe_image_reader.h"
@@ -91,8 +92,16 @@ void PEImageAnnotationsReader::ReadCrashpadSimpleAnnotations(
     return;
   }
 
-  std::vector<SimpleStringDictionary::Entry>
-      simple_annotations(SimpleStringDictionary::num_entries);
+  // A module that registered a THashedSimpleStringDictionary records its
+  // number of entries.
+  size_t num_entries = SimpleStringDictionary::num_entries;
+  if (crashpad_info.simple_annotations_entries > 0 &&
+      crashpad_info.simple_annotations_entries <=
+          CrashpadInfo::kMaxSimpleAnnotationsEntries) {
+    num_entries = crashpad_info.simple_annotations_entries;
+  }
+
+  std::vector<SimpleStringDictionary::Entry> simple_annotations(num_entries);
   if (!process_reader_->Memory()->Read(
           crashpad_info.simple_annotations,
           simple_annotations.size() * sizeof(simple_annotations[0]),
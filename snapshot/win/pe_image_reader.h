@@ -49,6 +49,7 @@ struct CrashpadInfo {
   typename Traits::Pointer simple_annotations;
   typename Traits::Pointer user_data_minidump_stream_head;
   typename Traits::Pointer annotations_list;
+  uint32_t simple_annotations_entries;
 };
 
 }  // namespace process_types
@@ -61,6 +61,19 @@ bool FakePtraceConnection::Attach(pid_t tid) {
   return inserted;
 }
 
+bool FakePtraceConnection::AttachThreads(const std::vector<pid_t>& tids,
+                                         std::vector<pid_t>* attached_tids) {
+  bool success = true;
+  for (pid_t tid : tids) {
+    if (Attach(tid)) {
+      attached_tids->push_back(tid);
+    } else {
+      success = false;
+    }
+  }
+  return success;
+}
+
 bool FakePtraceConnection::Is64Bit() {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
   return is_64_bit_;
@@ -48,6 +48,8 @@ class FakePtraceConnection : public PtraceConnection {
 
   pid_t GetProcessID() override;
   bool Attach(pid_t tid) override;
+  bool AttachThreads(const std::vector<pid_t>& tids,
+                     std::vector<pid_t>* attached_tids) override;
 
   //! \brief Returns `true` if the current process is 64-bit.
   bool Is64Bit() override;
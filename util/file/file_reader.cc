@@ -47,6 +47,14 @@ bool FileReaderInterface::ReadExactly(void* data, size_t size) {
   return read_exactly.ReadExactly(data, size, true);
 }
 
+FileHandle FileReaderInterface::UnderlyingFileHandle() {
+  return kInvalidFileHandle;
+}
+
+const void* FileReaderInterface::MappedData(FileOffset offset, size_t size) {
+  return nullptr;
+}
+
 WeakFileHandleFileReader::WeakFileHandleFileReader(FileHandle file_handle)
     : file_handle_(file_handle) {
 }
@@ -67,6 +75,10 @@ FileOperationResult WeakFileHandleFileReader::Read(void* data, size_t size) {
   return rv;
 }
 
+FileHandle WeakFileHandleFileReader::UnderlyingFileHandle() {
+  return file_handle_;
+}
+
 FileOffset WeakFileHandleFileReader::Seek(FileOffset offset, int whence) {
   DCHECK_NE(file_handle_, kInvalidFileHandle);
   return LoggingSeekFile(file_handle_, offset, whence);
@@ -103,6 +115,11 @@ FileOperationResult FileReader::Read(void* data, size_t size) {
   return weak_file_handle_file_reader_.Read(data, size);
 }
 
+FileHandle FileReader::UnderlyingFileHandle() {
+  DCHECK(file_.is_valid());
+  return weak_file_handle_file_reader_.UnderlyingFileHandle();
+}
+
 FileOffset FileReader::Seek(FileOffset offset, int whence) {
   DCHECK(file_.is_valid());
   return weak_file_handle_file_reader_.Seek(offset, whence);
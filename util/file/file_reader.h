@@ -46,6 +46,33 @@ class FileReaderInterface : public virtual FileSeekerInterface {
   //! \return `true` if the operation succeeded, `false` if it failed, with an
   //!     error message logged. Short reads are treated as failures.
   bool ReadExactly(void* data, size_t size);
+
+  //! \brief Returns the file handle that this reader reads from, if any.
+  //!
+  //! Callers may use the returned handle to consume the reader’s data directly,
+  //! for example, with `sendfile()`, as long as they leave the handle’s file
+  //! position where an equivalent sequence of Read() calls would have left it.
+  //!
+  //! \return The underlying file handle, or kInvalidFileHandle if this reader
+  //!     is not backed by a file handle.
+  virtual FileHandle UnderlyingFileHandle();
+
+  //! \brief Returns a pointer to a range of the reader’s data that is already
+  //!     present in memory, if possible.
+  //!
+  //! Callers may use the returned pointer to consume the reader’s data without
+  //! copying it. This does not affect the reader’s file position. The returned
+  //! pointer remains valid for as long as the reader exists and its contents
+  //! are not modified.
+  //!
+  //! \param[in] offset The offset of the start of the range, relative to the
+  //!     beginning of the file.
+  //! \param[in] size The size of the range.
+  //!
+  //! \return A pointer to \a size bytes of data at \a offset, or `nullptr` if
+  //!     this reader cannot provide such a view, or if the range is not wholly
+  //!     within the file. No message is logged when `nullptr` is returned.
+  virtual const void* MappedData(FileOffset offset, size_t size);
 };
 
 //! \brief A file reader backed by a FileHandle.
@@ -69,6 +96,7 @@ class WeakFileHandleFileReader : public FileReaderInterface {
 
   // FileReaderInterface:
   FileOperationResult Read(void* data, size_t size) override;
+  FileHandle UnderlyingFileHandle() override;
 
   // FileSeekerInterface:
 
@@ -126,6 +154,12 @@ class FileReader : public FileReaderInterface {
   //!     a Close().
   FileOperationResult Read(void* data, size_t size) override;
 
+  //! \copydoc FileReaderInterface::UnderlyingFileHandle()
+  //!
+  //! \note It is only valid to call this method between a successful Open() and
+  //!     a Close().
+  FileHandle UnderlyingFileHandle() override;
+
   // FileSeekerInterface:
 
   //! \copydoc FileReaderInterface::Seek()
@@ -68,6 +68,17 @@ FileOperationResult StringFile::Read(void* data, size_t size) {
   return nread;
 }
 
+const void* StringFile::MappedData(FileOffset offset, size_t size) {
+  size_t offset_sizet;
+  if (!AssignIfInRange(&offset_sizet, offset) ||
+      offset_sizet > string_.size() ||
+      size > string_.size() - offset_sizet) {
+    return nullptr;
+  }
+
+  return string_.data() + offset_sizet;
+}
+
 bool StringFile::Write(const void* data, size_t size) {
   DCHECK(offset_.IsValid());
 
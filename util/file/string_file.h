@@ -53,6 +53,16 @@ class StringFile : public FileReaderInterface, public FileWriterInterface {
   // FileReaderInterface:
   FileOperationResult Read(void* data, size_t size) override;
 
+  //! \copydoc FileReaderInterface::MappedData()
+  //!
+  //! \warning The returned pointer refers to the storage of the `std::string`
+  //!     holding the virtual file’s contents, and dangles after any call that
+  //!     modifies them: SetString(), Reset(), Write(), or WriteIoVec(). A
+  //!     StringFile whose views are held, such as one given to
+  //!     ProcessSnapshotMinidump, must not be written to until they’re no
+  //!     longer used.
+  const void* MappedData(FileOffset offset, size_t size) override;
+
   // FileWriterInterface:
   bool Write(const void* data, size_t size) override;
   bool WriteIoVec(std::vector<WritableIoVec>* iovecs) override;
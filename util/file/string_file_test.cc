@@ -500,6 +500,23 @@ TEST(StringFile, SeekSet) {
   EXPECT_EQ(string_file.Seek(0, SEEK_CUR), 10);
 }
 
+TEST(StringFile, MappedData) {
+  StringFile string_file;
+  EXPECT_EQ(string_file.MappedData(0, 0), string_file.string().data());
+  EXPECT_FALSE(string_file.MappedData(0, 1));
+
+  string_file.SetString("abcdef");
+  EXPECT_EQ(string_file.MappedData(0, 6), string_file.string().data());
+  EXPECT_EQ(string_file.MappedData(2, 3), string_file.string().data() + 2);
+  EXPECT_EQ(string_file.MappedData(6, 0), string_file.string().data() + 6);
+  EXPECT_FALSE(string_file.MappedData(2, 5));
+  EXPECT_FALSE(string_file.MappedData(7, 0));
+  EXPECT_FALSE(string_file.MappedData(-1, 1));
+
+  // The file position isn’t affected.
+  EXPECT_EQ(string_file.Seek(0, SEEK_CUR), 0);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace crashpad
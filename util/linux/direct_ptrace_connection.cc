@@ -54,13 +54,41 @@ pid_t DirectPtraceConnection::GetProcessID() {
 
 bool DirectPtraceConnection::Attach(pid_t tid) {
   std::unique_ptr<ScopedPtraceAttach> attach(new ScopedPtraceAttach);
-  if (!attach->ResetAttach(tid)) {
+  if (!attach->ResetSeize(tid) || !attach->WaitForStop()) {
     return false;
   }
   attachments_.push_back(std::move(attach));
   return true;
 }
 
+bool DirectPtraceConnection::AttachThreads(const std::vector<pid_t>& tids,
+                                           std::vector<pid_t>* attached_tids) {
+  // Every thread is interrupted before waiting for any of them, so that they
+  // stop concurrently instead of one at a time.
+  std::vector<std::unique_ptr<ScopedPtraceAttach>> seized(tids.size());
+  bool success = true;
+  for (size_t index = 0; index < tids.size(); ++index) {
+    seized[index].reset(new ScopedPtraceAttach);
+    if (!seized[index]->ResetSeize(tids[index])) {
+      seized[index].reset();
+      success = false;
+    }
+  }
+
+  for (size_t index = 0; index < tids.size(); ++index) {
+    if (!seized[index]) {
+      continue;
+    }
+    if (!seized[index]->WaitForStop()) {
+      success = false;
+      continue;
+    }
+    attachments_.push_back(std::move(seized[index]));
+    attached_tids->push_back(tids[index]);
+  }
+  return success;
+}
+
 bool DirectPtraceConnection::Is64Bit() {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
   return ptracer_.Is64Bit();
@@ -0,0 +1,149 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/directory_watcher.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "base/logging.h"
+#include "base/posix/eintr_wrapper.h"
+#include "util/thread/thread.h"
+
+namespace crashpad {
+
+namespace internal {
+
+class DirectoryWatcherThread final : public Thread {
+ public:
+  explicit DirectoryWatcherThread(DirectoryWatcher* watcher)
+      : watcher_(watcher) {}
+  ~DirectoryWatcherThread() {}
+
+  void ThreadMain() override {
+    pollfd fds[2];
+    fds[0].fd = watcher_->inotify_fd_.get();
+    fds[0].events = POLLIN;
+    fds[1].fd = watcher_->stop_fd_.get();
+    fds[1].events = POLLIN;
+
+    while (true) {
+      fds[0].revents = 0;
+      fds[1].revents = 0;
+      if (HANDLE_EINTR(poll(fds, 2, -1)) < 0) {
+        PLOG(ERROR) << "poll";
+        return;
+      }
+
+      if (fds[1].revents) {
+        return;
+      }
+
+      if (fds[0].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+        LOG(ERROR) << "inotify fd error";
+        return;
+      }
+
+      if (DrainEvents()) {
+        watcher_->delegate_->FilesMovedIn();
+      }
+    }
+  }
+
+ private:
+  // Reads and discards all queued events, returning true if there were any. The
+  // events themselves aren’t interesting, only the fact that something arrived.
+  bool DrainEvents() {
+    bool any_events = false;
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+      ssize_t rv =
+          HANDLE_EINTR(read(watcher_->inotify_fd_.get(), buffer, sizeof(buffer)));
+      if (rv < 0) {
+        if (errno != EAGAIN) {
+          PLOG(ERROR) << "read";
+        }
+        return any_events;
+      }
+      if (rv == 0) {
+        return any_events;
+      }
+      any_events = true;
+    }
+  }
+
+  DirectoryWatcher* watcher_;  // weak, owns this
+
+  DISALLOW_COPY_AND_ASSIGN(DirectoryWatcherThread);
+};
+
+}  // namespace internal
+
+DirectoryWatcher::DirectoryWatcher(Delegate* delegate)
+    : inotify_fd_(), stop_fd_(), thread_(), delegate_(delegate) {}
+
+DirectoryWatcher::~DirectoryWatcher() {
+  DCHECK(!thread_);
+}
+
+bool DirectoryWatcher::AddDirectory(const base::FilePath& directory) {
+  DCHECK(!thread_);
+
+  if (!inotify_fd_.is_valid()) {
+    inotify_fd_.reset(inotify_init1(IN_NONBLOCK | IN_CLOEXEC));
+    if (!inotify_fd_.is_valid()) {
+      PLOG(ERROR) << "inotify_init1";
+      return false;
+    }
+  }
+
+  if (inotify_add_watch(inotify_fd_.get(),
+                        directory.value().c_str(),
+                        IN_MOVED_TO | IN_ONLYDIR) < 0) {
+    PLOG(ERROR) << "inotify_add_watch " << directory.value();
+    return false;
+  }
+
+  return true;
+}
+
+void DirectoryWatcher::Start() {
+  DCHECK(inotify_fd_.is_valid());
+  DCHECK(!thread_);
+
+  stop_fd_.reset(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK));
+  PCHECK(stop_fd_.is_valid()) << "eventfd";
+
+  thread_.reset(new internal::DirectoryWatcherThread(this));
+  thread_->Start();
+}
+
+void DirectoryWatcher::Stop() {
+  DCHECK(thread_);
+
+  uint64_t value = 1;
+  PCHECK(HANDLE_EINTR(write(stop_fd_.get(), &value, sizeof(value))) ==
+         sizeof(value))
+      << "write";
+
+  thread_->Join();
+  thread_.reset();
+  stop_fd_.reset();
+}
+
+}  // namespace crashpad
@@ -0,0 +1,86 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_LINUX_DIRECTORY_WATCHER_H_
+#define CRASHPAD_UTIL_LINUX_DIRECTORY_WATCHER_H_
+
+#include <memory>
+
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "util/file/file_io.h"
+
+namespace crashpad {
+
+namespace internal {
+class DirectoryWatcherThread;
+}  // namespace internal
+
+//! \brief Uses `inotify` to watch directories for files being moved into them.
+//!
+//! A dedicated thread sleeps until a file is moved into one of the watched
+//! directories, so no periodic wakeups are needed to notice new files.
+class DirectoryWatcher {
+ public:
+  //! \brief An interface for receiving notifications from a DirectoryWatcher.
+  class Delegate {
+   public:
+    //! \brief Called on the watcher’s thread after one or more files have been
+    //!     moved into a watched directory.
+    //!
+    //! Notifications for events that arrive together are coalesced into a
+    //! single call. This is also called if the kernel’s event queue overflowed,
+    //! in which case events may have been lost.
+    virtual void FilesMovedIn() = 0;
+
+   protected:
+    virtual ~Delegate() {}
+  };
+
+  //! \param[in] delegate The delegate to notify of new files.
+  explicit DirectoryWatcher(Delegate* delegate);
+  ~DirectoryWatcher();
+
+  //! \brief Adds a directory to the set being watched.
+  //!
+  //! This must not be called after Start().
+  //!
+  //! \return `true` on success. `false` on failure, with a message logged.
+  bool AddDirectory(const base::FilePath& directory);
+
+  //! \brief Starts the watcher thread.
+  //!
+  //! AddDirectory() must have succeeded at least once before this is called.
+  void Start();
+
+  //! \brief Stops the watcher thread.
+  //!
+  //! This must be called after Start() and before the object is destroyed. No
+  //! notifications will be delivered after this method returns.
+  void Stop();
+
+ private:
+  friend class internal::DirectoryWatcherThread;
+
+  ScopedFileHandle inotify_fd_;
+  ScopedFileHandle stop_fd_;
+  std::unique_ptr<internal::DirectoryWatcherThread> thread_;
+  Delegate* delegate_;  // weak
+
+  DISALLOW_COPY_AND_ASSIGN(DirectoryWatcher);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_LINUX_DIRECTORY_WATCHER_H_
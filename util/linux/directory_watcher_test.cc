@@ -0,0 +1,97 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/directory_watcher.h"
+
+#include "gtest/gtest.h"
+#include "test/scoped_temp_dir.h"
+#include "util/file/file_io.h"
+#include "util/file/filesystem.h"
+#include "util/synchronization/semaphore.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+class TestDelegate : public DirectoryWatcher::Delegate {
+ public:
+  TestDelegate() : semaphore_(0) {}
+  ~TestDelegate() {}
+
+  // DirectoryWatcher::Delegate:
+  void FilesMovedIn() override { semaphore_.Signal(); }
+
+  bool WaitForNotification(double seconds) {
+    return semaphore_.TimedWait(seconds);
+  }
+
+ private:
+  Semaphore semaphore_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestDelegate);
+};
+
+void CreateFile(const base::FilePath& path) {
+  ScopedFileHandle handle(LoggingOpenFileForWrite(
+      path, FileWriteMode::kCreateOrFail, FilePermissions::kOwnerOnly));
+  ASSERT_TRUE(handle.is_valid());
+}
+
+TEST(DirectoryWatcher, FilesMovedIn) {
+  ScopedTempDir temp_dir;
+  const base::FilePath watched = temp_dir.path().Append("watched");
+  ASSERT_TRUE(
+      LoggingCreateDirectory(watched, FilePermissions::kOwnerOnly, false));
+
+  TestDelegate delegate;
+  DirectoryWatcher watcher(&delegate);
+  ASSERT_TRUE(watcher.AddDirectory(watched));
+  watcher.Start();
+
+  // Files created in place in the watched directory, and files moved into
+  // directories that aren’t watched, don’t cause notifications.
+  ASSERT_NO_FATAL_FAILURE(CreateFile(watched.Append("created")));
+  const base::FilePath outside_1 = temp_dir.path().Append("outside_1");
+  ASSERT_NO_FATAL_FAILURE(CreateFile(outside_1));
+  ASSERT_TRUE(
+      MoveFileOrDirectory(outside_1, temp_dir.path().Append("outside_2")));
+  EXPECT_FALSE(delegate.WaitForNotification(0.1));
+
+  ASSERT_TRUE(MoveFileOrDirectory(temp_dir.path().Append("outside_2"),
+                                  watched.Append("moved")));
+  EXPECT_TRUE(delegate.WaitForNotification(5));
+
+  watcher.Stop();
+}
+
+TEST(DirectoryWatcher, NonexistentDirectory) {
+  ScopedTempDir temp_dir;
+  TestDelegate delegate;
+  DirectoryWatcher watcher(&delegate);
+  EXPECT_FALSE(watcher.AddDirectory(temp_dir.path().Append("nonexistent")));
+}
+
+TEST(DirectoryWatcher, StopWithoutEvents) {
+  ScopedTempDir temp_dir;
+  TestDelegate delegate;
+  DirectoryWatcher watcher(&delegate);
+  ASSERT_TRUE(watcher.AddDirectory(temp_dir.path()));
+  watcher.Start();
+  watcher.Stop();
+  EXPECT_FALSE(delegate.WaitForNotification(0));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
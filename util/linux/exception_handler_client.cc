@@ -15,16 +15,22 @@
 #include "util/linux/exception_handler_client.h"
 
 #include <errno.h>
+#include <fcntl.h>
 #include <signal.h>
+#include <sys/mman.h>
 #include <sys/prctl.h>
 #include <sys/wait.h>
+#include <ucontext.h>
 #include <unistd.h>
 
+#include <algorithm>
+
 #include "base/logging.h"
 #include "base/posix/eintr_wrapper.h"
 #include "build/build_config.h"
 #include "third_party/lss/lss.h"
 #include "util/file/file_io.h"
+#include "util/linux/exception_information.h"
 #include "util/linux/ptrace_broker.h"
 #include "util/linux/socket.h"
 #include "util/misc/from_pointer_cast.h"
@@ -60,17 +66,175 @@ class ScopedSigprocmaskRestore {
   DISALLOW_COPY_AND_ASSIGN(ScopedSigprocmaskRestore);
 };
 
+// The most recently used part of the crashing thread’s stack, above its stack
+// pointer, that is copied into its crashing thread state.
+constexpr VMSize kCrashingThreadStackSize = 32 * 1024;
+
+VMAddress StackPointerFromContext(const ucontext_t& context) {
+#if defined(ARCH_CPU_X86)
+  return context.uc_mcontext.gregs[REG_ESP];
+#elif defined(ARCH_CPU_X86_64)
+  return context.uc_mcontext.gregs[REG_RSP];
+#elif defined(ARCH_CPU_ARMEL)
+  return context.uc_mcontext.arm_sp;
+#elif defined(ARCH_CPU_ARM64)
+  return context.uc_mcontext.sp;
+#elif defined(ARCH_CPU_MIPS_FAMILY)
+  return context.uc_mcontext.gregs[29];
+#else
+#error Port.
+#endif
+}
+
+// Collects the regions of this process’ memory that describe a crashing
+// thread, without allocating memory, so that it can be used in a signal
+// handler.
+class CrashingThreadStateRegions {
+ public:
+  CrashingThreadStateRegions() : regions_(), count_(0) {}
+  ~CrashingThreadStateRegions() {}
+
+  // Adds a region, shortened so that it doesn’t overlap a region that was
+  // added before it. A region that starts within one that was added before it
+  // is left out.
+  void Add(VMAddress address, VMSize size) {
+    if (!address || !size || count_ == kMaxRegions ||
+        address + size < address) {
+      return;
+    }
+    for (size_t index = 0; index < count_; ++index) {
+      const VMAddress other_address = regions_[index].address;
+      if (address >= other_address &&
+          address - other_address < regions_[index].size) {
+        return;
+      }
+      if (other_address > address && other_address - address < size) {
+        size = other_address - address;
+      }
+    }
+    regions_[count_].address = address;
+    regions_[count_].size = size;
+    ++count_;
+  }
+
+  // Writes the regions to |fd| as a crashing thread state file, returning
+  // `true` on success. Regions that can’t be read entirely are shortened to
+  // the part that could be.
+  bool Write(int fd) {
+    const size_t table_size =
+        sizeof(ExceptionHandlerProtocol::CrashingThreadStateHeader) +
+        count_ * sizeof(ExceptionHandlerProtocol::CrashingThreadStateRegion);
+    if (lseek(fd, table_size, SEEK_SET) < 0) {
+      return false;
+    }
+
+    for (size_t index = 0; index < count_; ++index) {
+      // write() fails with EFAULT instead of raising a signal if it reaches
+      // memory that can’t be read, such as the end of a stack.
+      const char* data = reinterpret_cast<const char*>(regions_[index].address);
+      VMSize written = 0;
+      while (written < regions_[index].size) {
+        const ssize_t rv = HANDLE_EINTR(
+            write(fd, data + written, regions_[index].size - written));
+        if (rv <= 0) {
+          break;
+        }
+        written += rv;
+      }
+      regions_[index].size = written;
+    }
+
+    struct {
+      ExceptionHandlerProtocol::CrashingThreadStateHeader header;
+      ExceptionHandlerProtocol::CrashingThreadStateRegion
+          regions[kMaxRegions];
+    } table;
+    table.header.version =
+        ExceptionHandlerProtocol::CrashingThreadStateHeader::kVersion;
+    table.header.region_count = count_;
+    for (size_t index = 0; index < count_; ++index) {
+      table.regions[index] = regions_[index];
+    }
+    return lseek(fd, 0, SEEK_SET) == 0 &&
+           HANDLE_EINTR(write(fd, &table, table_size)) ==
+               static_cast<ssize_t>(table_size);
+  }
+
+ private:
+  static constexpr size_t kMaxRegions = 5;
+
+  ExceptionHandlerProtocol::CrashingThreadStateRegion regions_[kMaxRegions];
+  size_t count_;
+
+  DISALLOW_COPY_AND_ASSIGN(CrashingThreadStateRegions);
+};
+
+// Copies the state of the crashing thread described by |info| into a new
+// memory file, returning a file descriptor for it, or -1 on failure.
+int CreateCrashingThreadState(
+    const ExceptionHandlerProtocol::ClientInformation& info) {
+  const ExceptionInformation* exception_information =
+      reinterpret_cast<const ExceptionInformation*>(
+          info.exception_information_address);
+  const ucontext_t* context = reinterpret_cast<const ucontext_t*>(
+      exception_information->context_address);
+
+  CrashingThreadStateRegions regions;
+  regions.Add(info.exception_information_address,
+              sizeof(*exception_information));
+  regions.Add(exception_information->siginfo_address, sizeof(siginfo_t));
+  regions.Add(exception_information->context_address, sizeof(*context));
+
+#if defined(ARCH_CPU_X86_FAMILY)
+  // The floating-point context is outside of the ucontext_t. On 32-bit x86, it
+  // may be followed by an fxsave area.
+#if defined(ARCH_CPU_X86)
+  constexpr VMSize kFxsaveSize = 512;
+#else
+  constexpr VMSize kFxsaveSize = 0;
+#endif  // ARCH_CPU_X86
+  regions.Add(FromPointerCast<VMAddress>(context->uc_mcontext.fpregs),
+              sizeof(*context->uc_mcontext.fpregs) + kFxsaveSize);
+#endif  // ARCH_CPU_X86_FAMILY
+
+  VMAddress stack_address = StackPointerFromContext(*context);
+#if defined(ARCH_CPU_X86_64)
+  // Include the red zone, which the handler also captures.
+  constexpr VMSize kRedZoneSize = 128;
+  stack_address -= std::min(kRedZoneSize, stack_address);
+#endif  // ARCH_CPU_X86_64
+  regions.Add(stack_address, kCrashingThreadStackSize);
+
+  // The file is sealed once written, so that the handler can rely on its
+  // contents not changing while it reads them.
+  const int fd = HANDLE_EINTR(memfd_create("crashpad_crashing_thread",
+                                           MFD_CLOEXEC | MFD_ALLOW_SEALING));
+  if (fd < 0) {
+    return -1;
+  }
+  if (!regions.Write(fd) ||
+      fcntl(fd,
+            F_ADD_SEALS,
+            F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
 }  // namespace
 
 ExceptionHandlerClient::ExceptionHandlerClient(int sock, bool multiple_clients)
     : server_sock_(sock),
       ptracer_(-1),
       can_set_ptracer_(true),
-      multiple_clients_(multiple_clients) {}
+      multiple_clients_(multiple_clients),
+      send_crashing_thread_state_(false) {}
 
 ExceptionHandlerClient::~ExceptionHandlerClient() = default;
 
-bool ExceptionHandlerClient::GetHandlerCredentials(ucred* creds) {
+bool ExceptionHandlerClient::GetHandlerCredentials(ucred* creds,
+                                                   uint32_t* features) {
   ExceptionHandlerProtocol::ClientToServerMessage message = {};
   message.type =
       ExceptionHandlerProtocol::ClientToServerMessage::kTypeCheckCredentials;
@@ -80,8 +244,14 @@ bool ExceptionHandlerClient::GetHandlerCredentials(ucred* creds) {
   }
 
   ExceptionHandlerProtocol::ServerToClientMessage response;
-  return UnixCredentialSocket::RecvMsg(
-      server_sock_, &response, sizeof(response), creds);
+  if (!UnixCredentialSocket::RecvMsg(
+          server_sock_, &response, sizeof(response), creds)) {
+    return false;
+  }
+  if (features) {
+    *features = response.features;
+  }
+  return true;
 }
 
 int ExceptionHandlerClient::RequestCrashDump(
@@ -99,6 +269,18 @@ int ExceptionHandlerClient::RequestCrashDump(
   return WaitForCrashDumpComplete();
 }
 
+int ExceptionHandlerClient::RegisterSharedAnnotations(int fd,
+                                                      VMAddress address,
+                                                      VMSize size) {
+  ExceptionHandlerProtocol::ClientToServerMessage message;
+  message.type =
+      ExceptionHandlerProtocol::ClientToServerMessage::kTypeSharedAnnotations;
+  message.shared_annotations.address = address;
+  message.shared_annotations.size = size;
+  return UnixCredentialSocket::SendMsg(
+      server_sock_, &message, sizeof(message), &fd, 1);
+}
+
 int ExceptionHandlerClient::SetPtracer(pid_t pid) {
   if (ptracer_ == pid) {
     return 0;
@@ -118,6 +300,11 @@ void ExceptionHandlerClient::SetCanSetPtracer(bool can_set_ptracer) {
   can_set_ptracer_ = can_set_ptracer;
 }
 
+void ExceptionHandlerClient::SetSendCrashingThreadState(
+    bool send_crashing_thread_state) {
+  send_crashing_thread_state_ = send_crashing_thread_state;
+}
+
 int ExceptionHandlerClient::SignalCrashDump(
     const ExceptionHandlerProtocol::ClientInformation& info,
     VMAddress stack_pointer) {
@@ -151,7 +338,20 @@ int ExceptionHandlerClient::SendCrashDumpRequest(
       ExceptionHandlerProtocol::ClientToServerMessage::kTypeCrashDumpRequest;
   message.requesting_thread_stack_address = stack_pointer;
   message.client_info = info;
-  return UnixCredentialSocket::SendMsg(server_sock_, &message, sizeof(message));
+
+  // The crashing thread’s state is optional, so failing to copy it isn’t
+  // fatal.
+  const int state_fd =
+      send_crashing_thread_state_ ? CreateCrashingThreadState(info) : -1;
+  if (state_fd < 0) {
+    return UnixCredentialSocket::SendMsg(
+        server_sock_, &message, sizeof(message));
+  }
+
+  const int result = UnixCredentialSocket::SendMsg(
+      server_sock_, &message, sizeof(message), &state_fd, 1);
+  close(state_fd);
+  return result;
 }
 
 int ExceptionHandlerClient::WaitForCrashDumpComplete() {
@@ -15,6 +15,7 @@
 #ifndef CRASHPAD_UTIL_LINUX_EXCEPTION_HANDLER_CLIENT_H_
 #define CRASHPAD_UTIL_LINUX_EXCEPTION_HANDLER_CLIENT_H_
 
+#include <stdint.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 
@@ -43,8 +44,12 @@ class ExceptionHandlerClient {
   //!
   //! \param[out] creds The handler process' credentials, valid if this method
   //!     returns `true`.
+  //! \param[out] features If not `nullptr`, the optional features that the
+  //!     handler supports, a bitwise OR of
+  //!     ExceptionHandlerProtocol::ServerToClientMessage::Feature values,
+  //!     valid if this method returns `true`.
   //! \return `true` on success. Otherwise, `false` with a message logged.
-  bool GetHandlerCredentials(ucred* creds);
+  bool GetHandlerCredentials(ucred* creds, uint32_t* features = nullptr);
 
   //! \brief Request a crash dump from the ExceptionHandlerServer.
   //!
@@ -54,6 +59,20 @@ class ExceptionHandlerClient {
   //! \return 0 on success or an error code on failure.
   int RequestCrashDump(const ExceptionHandlerProtocol::ClientInformation& info);
 
+  //! \brief Shares this client’s annotation storage with the
+  //!     ExceptionHandlerServer.
+  //!
+  //! The handler reads the storage from its own mapping when it captures a
+  //! crash dump for this client, instead of reading it from this process.
+  //!
+  //! \param[in] fd A file descriptor for a memory file holding the storage,
+  //!     which must be sealed against shrinking.
+  //! \param[in] address The address at which this process has mapped the
+  //!     file.
+  //! \param[in] size The size of the mapping.
+  //! \return 0 on success or an error code on failure.
+  int RegisterSharedAnnotations(int fd, VMAddress address, VMSize size);
+
   //! \brief Uses `prctl(PR_SET_PTRACER, ...)` to set the process with
   //!     process ID \a pid as the ptracer for this process.
   //!
@@ -66,6 +85,24 @@ class ExceptionHandlerClient {
   //! \param[in] can_set_ptracer Whether SetPtracer should be enabled.
   void SetCanSetPtracer(bool can_set_ptracer);
 
+  //! \brief Enables or disables sending the crashing thread’s state with
+  //!     crash dump requests.
+  //!
+  //! When enabled, RequestCrashDump() copies the crashing thread’s
+  //! ExceptionInformation, the `siginfo_t` and `ucontext_t` it refers to, and
+  //! the most recently used part of the thread’s stack into a sealed memory
+  //! file, which is passed to the handler with the request. The handler reads
+  //! these from the file instead of from this process. If the handler can’t
+  //! attach to the crashing thread, it captures that thread with the context
+  //! and stack from the file instead. The
+  //! ClientInformation::exception_information_address passed to
+  //! RequestCrashDump() must then point to a valid ExceptionInformation in
+  //! this process. This is disabled by default.
+  //!
+  //! \param[in] send_crashing_thread_state Whether to send the crashing
+  //!     thread’s state.
+  void SetSendCrashingThreadState(bool send_crashing_thread_state);
+
  private:
   int SendCrashDumpRequest(
       const ExceptionHandlerProtocol::ClientInformation& info,
@@ -78,6 +115,7 @@ class ExceptionHandlerClient {
   pid_t ptracer_;
   bool can_set_ptracer_;
   bool multiple_clients_;
+  bool send_crashing_thread_state_;
 
   DISALLOW_COPY_AND_ASSIGN(ExceptionHandlerClient);
 };
@@ -60,6 +60,51 @@ class ExceptionHandlerProtocol {
 #endif
   };
 
+  //! \brief Describes annotation storage that a client shares with the
+  //!     handler.
+  //!
+  //! The storage is a memory file, passed with the message that carries this
+  //! structure, which the client has mapped at #address. The file must be
+  //! sealed against shrinking.
+  struct SharedAnnotationsInformation {
+    //! \brief The address in the client’s address space of the mapping.
+    VMAddress address;
+
+    //! \brief The size of the mapping.
+    VMSize size;
+  };
+
+  //! \brief The header of a file holding copies of a crashing thread’s state.
+  //!
+  //! A client may pass a memory file with a crash dump request, holding copies
+  //! of the parts of its memory that describe the crashing thread: its
+  //! ExceptionInformation, the `siginfo_t` and `ucontext_t` passed to its
+  //! signal handler, and the most recently used part of its stack. The handler
+  //! reads these regions from the file instead of from the client.
+  //!
+  //! The file begins with this header, followed by #region_count
+  //! CrashingThreadStateRegion structures, followed by the contents of each
+  //! region in the same order.
+  struct CrashingThreadStateHeader {
+    static constexpr uint32_t kVersion = 1;
+
+    //! \brief The version of the file’s format, kVersion.
+    uint32_t version;
+
+    //! \brief The number of regions in the file.
+    uint32_t region_count;
+  };
+
+  //! \brief Describes a region of the client’s memory copied into a crashing
+  //!     thread state file.
+  struct CrashingThreadStateRegion {
+    //! \brief The address of the region in the client’s address space.
+    VMAddress address;
+
+    //! \brief The size of the region’s contents in the file, which may be 0.
+    VMSize size;
+  };
+
   //! \brief The signal used to indicate a crash dump is complete.
   //!
   //! When multiple clients share a single socket connection with the handler,
@@ -81,8 +126,15 @@ class ExceptionHandlerProtocol {
       //! \brief Request that the server respond with its credentials.
       kTypeCheckCredentials,
 
-      //! \brief Used to request a crash dump for the sending client.
-      kTypeCrashDumpRequest
+      //! \brief Used to request a crash dump for the sending client. A file
+      //!     descriptor for a crashing thread state file, described by
+      //!     CrashingThreadStateHeader, may be passed with the message.
+      kTypeCrashDumpRequest,
+
+      //! \brief Shares the sending client’s annotation storage with the
+      //!     handler. A file descriptor for the storage is passed with the
+      //!     message.
+      kTypeSharedAnnotations
     };
 
     Type type;
@@ -93,6 +145,9 @@ class ExceptionHandlerProtocol {
     union {
       //! \brief Valid for type == kCrashDumpRequest
       ClientInformation client_info;
+
+      //! \brief Valid for type == kTypeSharedAnnotations
+      SharedAnnotationsInformation shared_annotations;
     };
   };
 
@@ -118,10 +173,25 @@ class ExceptionHandlerProtocol {
       kTypeCrashDumpFailed
     };
 
+    //! \brief Optional features that the handler supports, reported with
+    //!     kTypeCredentials.
+    enum Feature : uint32_t {
+      //! \brief The handler accepts
+      //!     ClientToServerMessage::kTypeSharedAnnotations.
+      kFeatureSharedAnnotations = 1 << 0,
+    };
+
     Type type;
 
-    //! \brief The handler's process ID. Valid for kTypeSetPtracer.
-    pid_t pid;
+    union {
+      //! \brief The handler's process ID. Valid for kTypeSetPtracer.
+      pid_t pid;
+
+      //! \brief A bitwise OR of Feature values. Valid for kTypeCredentials.
+      //!
+      //! Handlers that predate this field send `0`.
+      uint32_t features;
+    };
   };
 
 #pragma pack(pop)
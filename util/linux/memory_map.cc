@@ -305,6 +305,11 @@ const MemoryMap::Mapping* MemoryMap::FindMapping(LinuxVMAddress address) const {
   return nullptr;
 }
 
+const std::vector<MemoryMap::Mapping>& MemoryMap::Mappings() const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  return mappings_;
+}
+
 const MemoryMap::Mapping* MemoryMap::FindMappingWithName(
     const std::string& name) const {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
@@ -77,6 +77,10 @@ class MemoryMap {
   //!     it was obtained from.
   const Mapping* FindMappingWithName(const std::string& name) const;
 
+  //! \return All of the mappings in the MemoryMap, in increasing order of base
+  //!     address.
+  const std::vector<Mapping>& Mappings() const;
+
   //! \brief An abstract base class for iterating over ordered sets of mappings
   //!   in a MemoryMap.
   class Iterator {
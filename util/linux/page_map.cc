@@ -0,0 +1,154 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/page_map.h"
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+
+#include "base/logging.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/process/process_metrics.h"
+#include "base/stl_util.h"
+#include "base/strings/stringprintf.h"
+
+namespace crashpad {
+
+namespace {
+
+// See Documentation/admin-guide/mm/pagemap.rst in the Linux source. The other
+// bits of an entry, including the page frame number, aren’t needed here.
+constexpr uint64_t kPagePresent = uint64_t{1} << 63;
+constexpr uint64_t kPageSwapped = uint64_t{1} << 62;
+constexpr uint64_t kPageFileOrSharedAnonymous = uint64_t{1} << 61;
+
+bool IsPopulated(uint64_t entry) {
+  return (entry & (kPagePresent | kPageSwapped)) != 0;
+}
+
+bool IsFileBacked(uint64_t entry) {
+  return !(entry & kPageSwapped) &&
+         (!(entry & kPagePresent) || (entry & kPageFileOrSharedAnonymous));
+}
+
+}  // namespace
+
+PageMap::PageMap() : pagemap_fd_(), page_size_(0), initialized_() {}
+
+PageMap::~PageMap() {}
+
+bool PageMap::Initialize(pid_t pid) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+
+  const std::string path = base::StringPrintf("/proc/%d/pagemap", pid);
+  pagemap_fd_.reset(
+      HANDLE_EINTR(open(path.c_str(), O_RDONLY | O_NOCTTY | O_CLOEXEC)));
+  if (!pagemap_fd_.is_valid()) {
+    PLOG(WARNING) << "open " << path;
+    return false;
+  }
+  page_size_ = base::GetPageSize();
+
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+bool PageMap::PopulatedRanges(
+    const CheckedRange<VMAddress, VMSize>& range,
+    std::vector<CheckedRange<VMAddress, VMSize>>* populated) const {
+  return MatchingRanges(range, &IsPopulated, populated);
+}
+
+bool PageMap::FileBackedRanges(
+    const CheckedRange<VMAddress, VMSize>& range,
+    std::vector<CheckedRange<VMAddress, VMSize>>* file_backed) const {
+  return MatchingRanges(range, &IsFileBacked, file_backed);
+}
+
+bool PageMap::MatchingRanges(
+    const CheckedRange<VMAddress, VMSize>& range,
+    bool (*matches)(uint64_t entry),
+    std::vector<CheckedRange<VMAddress, VMSize>>* ranges) const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+  DCHECK(range.IsValid());
+
+  ranges->clear();
+  if (range.size() == 0) {
+    return true;
+  }
+
+  const VMAddress first_page = range.base() / page_size_;
+  const VMAddress end_page = (range.end() - 1) / page_size_ + 1;
+
+  // Each page has an 8-byte entry, so reading in chunks keeps the buffer small
+  // even for very large ranges.
+  uint64_t entries[512];
+  VMAddress run_start = 0;
+  bool in_run = false;
+  for (VMAddress chunk = first_page; chunk < end_page;) {
+    const size_t count = static_cast<size_t>(
+        std::min(end_page - chunk, VMAddress{base::size(entries)}));
+    ssize_t bytes_read =
+        HANDLE_EINTR(pread64(pagemap_fd_.get(),
+                             entries,
+                             count * sizeof(entries[0]),
+                             chunk * sizeof(entries[0])));
+    if (bytes_read < 0) {
+      PLOG(ERROR) << "pread64";
+      return false;
+    }
+    if (bytes_read < static_cast<ssize_t>(sizeof(entries[0]))) {
+      LOG(ERROR) << "unexpected end of pagemap";
+      return false;
+    }
+
+    const size_t entries_read = bytes_read / sizeof(entries[0]);
+    for (size_t index = 0; index < entries_read; ++index) {
+      const bool page_matches = matches(entries[index]);
+      const VMAddress page = chunk + index;
+      if (page_matches && !in_run) {
+        run_start = page;
+        in_run = true;
+      } else if (!page_matches && in_run) {
+        ranges->push_back(CheckedRange<VMAddress, VMSize>(
+            run_start * page_size_, (page - run_start) * page_size_));
+        in_run = false;
+      }
+    }
+    chunk += entries_read;
+  }
+  if (in_run) {
+    ranges->push_back(CheckedRange<VMAddress, VMSize>(
+        run_start * page_size_, (end_page - run_start) * page_size_));
+  }
+
+  // The first and last pages may extend beyond the range.
+  if (!ranges->empty()) {
+    CheckedRange<VMAddress, VMSize>& front = ranges->front();
+    if (front.base() < range.base()) {
+      front.SetRange(range.base(), front.end() - range.base());
+    }
+    CheckedRange<VMAddress, VMSize>& back = ranges->back();
+    if (back.end() > range.end()) {
+      back.SetRange(back.base(), range.end() - back.base());
+    }
+  }
+  return true;
+}
+
+}  // namespace crashpad
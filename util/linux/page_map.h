@@ -0,0 +1,102 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_LINUX_PAGE_MAP_H_
+#define CRASHPAD_UTIL_LINUX_PAGE_MAP_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <vector>
+
+#include "base/macros.h"
+#include "util/file/file_io.h"
+#include "util/misc/address_types.h"
+#include "util/misc/initialization_state_dcheck.h"
+#include "util/numeric/checked_range.h"
+
+namespace crashpad {
+
+//! \brief Reads `/proc/<pid>/pagemap` to determine which pages of a process’
+//!     address space are populated, and which are backed by files.
+//!
+//! A page is populated if it is present in memory or has been swapped out.
+//! Pages of a private anonymous mapping that have never been touched are not
+//! populated, and read as zero. Pages of file-backed or shared mappings may
+//! have contents even when they aren’t populated in the process.
+//!
+//! A page of a private file mapping is backed by the file until it’s written
+//! to, when it’s replaced by a private anonymous copy.
+class PageMap {
+ public:
+  PageMap();
+  ~PageMap();
+
+  //! \brief Initializes this object to read the page map of a process.
+  //!
+  //! This method must be called successfully prior to calling any other method
+  //! in this class. This method may only be called once.
+  //!
+  //! The caller must be able to read the process’ memory, for example by being
+  //! attached to it with `ptrace()`.
+  //!
+  //! \param[in] pid The process ID of the process to read.
+  //! \return `true` on success, `false` on failure with a message logged.
+  bool Initialize(pid_t pid);
+
+  //! \brief Determines the populated parts of a range.
+  //!
+  //! \param[in] range The range of addresses to check.
+  //! \param[out] populated The populated parts of \a range, clipped to \a
+  //!     range, in increasing order. Adjacent populated pages are merged into
+  //!     a single range.
+  //! \return `true` on success, `false` on failure with a message logged.
+  bool PopulatedRanges(
+      const CheckedRange<VMAddress, VMSize>& range,
+      std::vector<CheckedRange<VMAddress, VMSize>>* populated) const;
+
+  //! \brief Determines the parts of a range that are backed by files or shared
+  //!     memory.
+  //!
+  //! In a private file mapping, these are the pages that haven’t been copied
+  //! on write, so their contents are the same as in the file. Pages that
+  //! haven’t been populated are included, since they’ll be read from the file
+  //! when touched, so this is only meaningful for file mappings.
+  //!
+  //! \param[in] range The range of addresses to check.
+  //! \param[out] file_backed The file-backed parts of \a range, clipped to \a
+  //!     range, in increasing order. Adjacent file-backed pages are merged into
+  //!     a single range.
+  //! \return `true` on success, `false` on failure with a message logged.
+  bool FileBackedRanges(
+      const CheckedRange<VMAddress, VMSize>& range,
+      std::vector<CheckedRange<VMAddress, VMSize>>* file_backed) const;
+
+ private:
+  // Finds the parts of |range| whose page map entries satisfy |matches|.
+  bool MatchingRanges(const CheckedRange<VMAddress, VMSize>& range,
+                      bool (*matches)(uint64_t entry),
+                      std::vector<CheckedRange<VMAddress, VMSize>>* ranges)
+      const;
+
+  ScopedFileHandle pagemap_fd_;
+  VMSize page_size_;
+  InitializationStateDcheck initialized_;
+
+  DISALLOW_COPY_AND_ASSIGN(PageMap);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_LINUX_PAGE_MAP_H_
@@ -0,0 +1,183 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/linux/page_map.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "test/errors.h"
+#include "test/multiprocess.h"
+#include "util/file/file_io.h"
+#include "util/linux/direct_ptrace_connection.h"
+#include "util/misc/address_types.h"
+#include "util/posix/scoped_mmap.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+using Range = CheckedRange<VMAddress, VMSize>;
+
+void ExpectRangesEqual(const std::vector<Range>& actual,
+                       const std::vector<Range>& expected) {
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t index = 0; index < actual.size(); ++index) {
+    SCOPED_TRACE(index);
+    EXPECT_EQ(actual[index].base(), expected[index].base());
+    EXPECT_EQ(actual[index].size(), expected[index].size());
+  }
+}
+
+TEST(PageMap, Self) {
+  const size_t page_size = getpagesize();
+  ScopedMmap mapping;
+  ASSERT_TRUE(mapping.ResetMmap(nullptr,
+                                16 * page_size,
+                                PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS,
+                                -1,
+                                0));
+  // Transparent huge pages would populate more than the pages touched.
+  ASSERT_EQ(madvise(mapping.addr(), mapping.len(), MADV_NOHUGEPAGE), 0)
+      << ErrnoMessage("madvise");
+  char* pages = mapping.addr_as<char*>();
+  pages[2 * page_size] = 1;
+  pages[3 * page_size] = 1;
+  pages[10 * page_size] = 1;
+
+  PageMap page_map;
+  ASSERT_TRUE(page_map.Initialize(getpid()));
+
+  const VMAddress base = mapping.addr_as<VMAddress>();
+  std::vector<Range> populated;
+  ASSERT_TRUE(
+      page_map.PopulatedRanges(Range(base, 16 * page_size), &populated));
+  ExpectRangesEqual(populated,
+                    {Range(base + 2 * page_size, 2 * page_size),
+                     Range(base + 10 * page_size, page_size)});
+
+  // Ranges that don’t start or end on page boundaries are clipped.
+  ASSERT_TRUE(page_map.PopulatedRanges(
+      Range(base + 3 * page_size - 8, 7 * page_size + 16), &populated));
+  ExpectRangesEqual(populated,
+                    {Range(base + 3 * page_size - 8, page_size + 8),
+                     Range(base + 10 * page_size, 8)});
+
+  ASSERT_TRUE(
+      page_map.PopulatedRanges(Range(base + 4 * page_size, 6 * page_size),
+                               &populated));
+  EXPECT_TRUE(populated.empty());
+
+  ASSERT_TRUE(page_map.PopulatedRanges(Range(base, 0), &populated));
+  EXPECT_TRUE(populated.empty());
+}
+
+TEST(PageMap, FileBacked) {
+  const size_t page_size = getpagesize();
+  ScopedFileHandle memfd(memfd_create("test", MFD_CLOEXEC));
+  ASSERT_TRUE(memfd.is_valid()) << ErrnoMessage("memfd_create");
+  ASSERT_EQ(ftruncate(memfd.get(), 4 * page_size), 0)
+      << ErrnoMessage("ftruncate");
+
+  ScopedMmap mapping;
+  ASSERT_TRUE(mapping.ResetMmap(nullptr,
+                                4 * page_size,
+                                PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE,
+                                memfd.get(),
+                                0));
+  volatile char* pages = mapping.addr_as<volatile char*>();
+
+  // Reading a page maps the file’s page, but writing to one replaces it with
+  // a private copy.
+  EXPECT_EQ(pages[0], 0);
+  pages[page_size] = 1;
+
+  PageMap page_map;
+  ASSERT_TRUE(page_map.Initialize(getpid()));
+
+  const VMAddress base = mapping.addr_as<VMAddress>();
+  std::vector<Range> file_backed;
+  ASSERT_TRUE(
+      page_map.FileBackedRanges(Range(base, 4 * page_size), &file_backed));
+  ExpectRangesEqual(file_backed,
+                    {Range(base, page_size),
+                     Range(base + 2 * page_size, 2 * page_size)});
+}
+
+class SparseMappingChildTest : public Multiprocess {
+ public:
+  SparseMappingChildTest() : Multiprocess() {}
+  ~SparseMappingChildTest() {}
+
+ private:
+  static constexpr size_t kMappingSize = 1 << 30;
+
+  void MultiprocessParent() override {
+    VMAddress base;
+    CheckedReadFileExactly(ReadPipeHandle(), &base, sizeof(base));
+
+    DirectPtraceConnection connection;
+    ASSERT_TRUE(connection.Initialize(ChildPID()));
+
+    PageMap page_map;
+    ASSERT_TRUE(page_map.Initialize(ChildPID()));
+
+    const size_t page_size = getpagesize();
+    std::vector<Range> populated;
+    ASSERT_TRUE(page_map.PopulatedRanges(Range(base, kMappingSize), &populated));
+    ExpectRangesEqual(populated,
+                      {Range(base, page_size),
+                       Range(base + kMappingSize / 2, 2 * page_size),
+                       Range(base + kMappingSize - page_size, page_size)});
+  }
+
+  void MultiprocessChild() override {
+    const size_t page_size = getpagesize();
+    ScopedMmap mapping;
+    ASSERT_TRUE(mapping.ResetMmap(nullptr,
+                                  kMappingSize,
+                                  PROT_READ | PROT_WRITE,
+                                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                                  -1,
+                                  0));
+    ASSERT_EQ(madvise(mapping.addr(), mapping.len(), MADV_NOHUGEPAGE), 0)
+        << ErrnoMessage("madvise");
+    char* pages = mapping.addr_as<char*>();
+    pages[0] = 1;
+    pages[kMappingSize / 2] = 1;
+    pages[kMappingSize / 2 + page_size] = 1;
+    pages[kMappingSize - 1] = 1;
+
+    const VMAddress base = mapping.addr_as<VMAddress>();
+    CheckedWriteFile(WritePipeHandle(), &base, sizeof(base));
+
+    CheckedReadFileAtEOF(ReadPipeHandle());
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(SparseMappingChildTest);
+};
+
+TEST(PageMap, SparseMappingChild) {
+  SparseMappingChildTest test;
+  test.Run();
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -75,6 +75,17 @@ bool ProcStatReader::Initialize(PtraceConnection* connection, pid_t tid) {
   return true;
 }
 
+bool ProcStatReader::State(char* state) const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  const char* state_ptr;
+  if (!FindColumn(2, &state_ptr)) {
+    return false;
+  }
+  *state = *state_ptr;
+  return true;
+}
+
 bool ProcStatReader::UserCPUTime(timeval* user_time) const {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
   return ReadTimeAtIndex(13, user_time);
@@ -42,6 +42,16 @@ class ProcStatReader {
   //! \param[in] tid The thread ID to read the stat file for.
   bool Initialize(PtraceConnection* connection, pid_t tid);
 
+  //! \brief Determines the target thread’s scheduling state.
+  //!
+  //! \param[out] state The state character, such as `'R'` for a thread that is
+  //!     running or runnable, or `'S'` for a thread sleeping in an
+  //!     interruptible wait.
+  //!
+  //! \return `true` on success, with \a state set. Otherwise, `false` with a
+  //!     message logged.
+  bool State(char* state) const;
+
   //! \brief Determines the time the thread has spent executing in user mode.
   //!
   //! \param[out] user_time The time spent executing in user mode.
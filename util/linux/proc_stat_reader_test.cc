@@ -56,6 +56,11 @@ TEST(ProcStatReader, Basic) {
   timeval system_time;
   ASSERT_TRUE(stat.SystemCPUTime(&system_time));
   EXPECT_LE(system_time.tv_sec, elapsed_sec);
+
+  // This thread is running while it reads its own state.
+  char state;
+  ASSERT_TRUE(stat.State(&state));
+  EXPECT_EQ(state, 'R');
 }
 
 pid_t gettid() {
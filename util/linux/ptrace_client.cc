@@ -189,6 +189,19 @@ bool PtraceClient::Attach(pid_t tid) {
   return AttachImpl(sock_, tid);
 }
 
+bool PtraceClient::AttachThreads(const std::vector<pid_t>& tids,
+                                 std::vector<pid_t>* attached_tids) {
+  bool success = true;
+  for (pid_t tid : tids) {
+    if (Attach(tid)) {
+      attached_tids->push_back(tid);
+    } else {
+      success = false;
+    }
+  }
+  return success;
+}
+
 bool PtraceClient::Is64Bit() {
   INITIALIZATION_STATE_DCHECK_VALID(initialized_);
   return is_64_bit_;
@@ -56,6 +56,8 @@ class PtraceClient : public PtraceConnection {
 
   pid_t GetProcessID() override;
   bool Attach(pid_t tid) override;
+  bool AttachThreads(const std::vector<pid_t>& tids,
+                     std::vector<pid_t>* attached_tids) override;
   bool Is64Bit() override;
   bool GetThreadInfo(pid_t tid, ThreadInfo* info) override;
   bool ReadFileContents(const base::FilePath& path,
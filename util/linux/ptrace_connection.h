@@ -41,6 +41,20 @@ class PtraceConnection {
   //! \return `true` on success. `false` on failure with a message logged.
   virtual bool Attach(pid_t tid) = 0;
 
+  //! \brief Adds several new threads to this connection.
+  //!
+  //! This is equivalent to calling Attach() for each thread, but
+  //! implementations may stop the threads concurrently, which is faster when
+  //! there are many of them.
+  //!
+  //! \param[in] tids The thread IDs of the threads to attach.
+  //! \param[out] attached_tids The thread IDs of the threads that were
+  //!     attached, in the order they appear in \a tids.
+  //! \return `true` if every thread was attached. `false` with a message
+  //!     logged for each thread that couldn’t be attached.
+  virtual bool AttachThreads(const std::vector<pid_t>& tids,
+                             std::vector<pid_t>* attached_tids) = 0;
+
   //! \brief Returns `true` if connected to a 64-bit process.
   virtual bool Is64Bit() = 0;
 
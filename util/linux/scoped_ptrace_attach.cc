@@ -14,6 +14,7 @@
 
 #include "util/linux/scoped_ptrace_attach.h"
 
+#include <errno.h>
 #include <sys/ptrace.h>
 #include <sys/wait.h>
 
@@ -22,19 +23,43 @@
 
 namespace crashpad {
 
+namespace {
+
+bool WaitForPtraceStop(pid_t pid) {
+  int status;
+  if (HANDLE_EINTR(waitpid(pid, &status, __WALL)) < 0) {
+    PLOG(ERROR) << "waitpid";
+    return false;
+  }
+  if (!WIFSTOPPED(status)) {
+    LOG(ERROR) << "process not stopped";
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
 ScopedPtraceAttach::ScopedPtraceAttach()
-    : pid_(-1) {}
+    : pid_(-1), stop_pending_(false) {}
 
 ScopedPtraceAttach::~ScopedPtraceAttach() {
   Reset();
 }
 
 bool ScopedPtraceAttach::Reset() {
+  // A tracee can only be detached while it’s stopped.
+  if (stop_pending_ && !WaitForStop()) {
+    LOG(ERROR) << "not detaching from " << pid_;
+    pid_ = -1;
+    return false;
+  }
   if (pid_ >= 0 && ptrace(PTRACE_DETACH, pid_, nullptr, nullptr) != 0) {
     PLOG(ERROR) << "ptrace";
     return false;
   }
   pid_ = -1;
+  stop_pending_ = false;
   return true;
 }
 
@@ -47,16 +72,39 @@ bool ScopedPtraceAttach::ResetAttach(pid_t pid) {
   }
   pid_ = pid;
 
-  int status;
-  if (HANDLE_EINTR(waitpid(pid_, &status, __WALL)) < 0) {
-    PLOG(ERROR) << "waitpid";
+  return WaitForPtraceStop(pid_);
+}
+
+bool ScopedPtraceAttach::ResetSeize(pid_t pid) {
+  Reset();
+
+  if (ptrace(PTRACE_SEIZE, pid, nullptr, nullptr) != 0) {
+    // PTRACE_SEIZE was added in Linux 3.4. Older kernels fail with EIO.
+    if (errno == EIO) {
+      return ResetAttach(pid);
+    }
+    PLOG(ERROR) << "ptrace";
     return false;
   }
-  if (!WIFSTOPPED(status)) {
-    LOG(ERROR) << "process not stopped";
+
+  if (ptrace(PTRACE_INTERRUPT, pid, nullptr, nullptr) != 0) {
+    // Without a stop to wait for, the tracee can’t be detached. It remains
+    // seized until it or this process exits.
+    PLOG(ERROR) << "ptrace";
+    LOG(ERROR) << "leaving " << pid << " seized";
     return false;
   }
+  pid_ = pid;
+  stop_pending_ = true;
   return true;
 }
 
+bool ScopedPtraceAttach::WaitForStop() {
+  if (!stop_pending_) {
+    return pid_ >= 0;
+  }
+  stop_pending_ = false;
+  return WaitForPtraceStop(pid_);
+}
+
 }  // namespace crashpad
@@ -31,6 +31,9 @@ class ScopedPtraceAttach {
 
   //! \brief Detaches from the process by calling `ptrace()`.
   //!
+  //! If a stop requested by ResetSeize() is still pending, this waits for it
+  //! first. A process that doesn’t stop can’t be detached, and is forgotten.
+  //!
   //! \return `true` on success. `false` on failure, with a message logged.
   bool Reset();
 
@@ -41,8 +44,37 @@ class ScopedPtraceAttach {
   //! \return `true` on success. `false` on failure, with a message logged.
   bool ResetAttach(pid_t pid);
 
+  //! \brief Detaches from any previously attached process, and attaches to
+  //!     and interrupts the process with process ID \a pid without waiting for
+  //!     it to stop.
+  //!
+  //! This uses `PTRACE_SEIZE` and `PTRACE_INTERRUPT`, which, unlike
+  //! ResetAttach(), don’t send `SIGSTOP`, and so don’t stop the other threads
+  //! in the process. Because this doesn’t wait, several threads can be
+  //! interrupted before waiting for any of them, so that they stop
+  //! concurrently. WaitForStop() must be called before the process is used.
+  //! Reset() calls it if it hasn’t been called.
+  //!
+  //! If the kernel doesn’t support `PTRACE_SEIZE`, this falls back to
+  //! ResetAttach(), and waits for the process to stop.
+  //!
+  //! A process that is seized but can’t be interrupted can’t be detached
+  //! either, so on that failure it remains seized.
+  //!
+  //! \return `true` on success. `false` on failure, with a message logged.
+  bool ResetSeize(pid_t pid);
+
+  //! \brief Blocks until the process attached by ResetSeize() has stopped by
+  //!     calling `waitpid()`.
+  //!
+  //! This returns immediately if the process has already been waited for.
+  //!
+  //! \return `true` on success. `false` on failure, with a message logged.
+  bool WaitForStop();
+
  private:
   pid_t pid_;
+  bool stop_pending_;
 
   DISALLOW_COPY_AND_ASSIGN(ScopedPtraceAttach);
 };
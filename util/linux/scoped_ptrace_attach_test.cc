@@ -91,6 +91,55 @@ TEST(ScopedPtraceAttach, AttachChild) {
   test.Run();
 }
 
+class SeizeChildTest : public AttachTest {
+ public:
+  SeizeChildTest() : AttachTest() {}
+  ~SeizeChildTest() {}
+
+ private:
+  void MultiprocessParent() override {
+    // Wait for the child to set the parent as its ptracer.
+    char c;
+    CheckedReadFileExactly(ReadPipeHandle(), &c, sizeof(c));
+
+    pid_t pid = ChildPID();
+
+    ScopedPtraceAttach attachment;
+    ASSERT_EQ(attachment.ResetSeize(pid), true);
+    ASSERT_EQ(attachment.WaitForStop(), true);
+    EXPECT_EQ(ptrace(PTRACE_PEEKDATA, pid, &kWord, nullptr), kWord)
+        << ErrnoMessage("ptrace");
+    EXPECT_EQ(attachment.WaitForStop(), true);
+    ASSERT_EQ(attachment.Reset(), true);
+
+    ASSERT_EQ(ptrace(PTRACE_PEEKDATA, pid, &kWord, nullptr), -1);
+    EXPECT_EQ(errno, ESRCH) << ErrnoMessage("ptrace");
+
+    // Detaching doesn’t require waiting for the stop first.
+    ASSERT_EQ(attachment.ResetSeize(pid), true);
+    ASSERT_EQ(attachment.Reset(), true);
+
+    ASSERT_EQ(ptrace(PTRACE_PEEKDATA, pid, &kWord, nullptr), -1);
+    EXPECT_EQ(errno, ESRCH) << ErrnoMessage("ptrace");
+  }
+
+  void MultiprocessChild() override {
+    ScopedPrSetPtracer set_ptracer(getppid(), /* may_log= */ true);
+
+    char c = '\0';
+    CheckedWriteFile(WritePipeHandle(), &c, sizeof(c));
+
+    CheckedReadFileAtEOF(ReadPipeHandle());
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(SeizeChildTest);
+};
+
+TEST(ScopedPtraceAttach, SeizeChild) {
+  SeizeChildTest test;
+  test.Run();
+}
+
 class AttachToParentResetTest : public AttachTest {
  public:
   AttachToParentResetTest() : AttachTest() {}
@@ -0,0 +1,40 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/misc/capture_deadline.h"
+
+#include "util/misc/clock.h"
+
+namespace crashpad {
+
+CaptureDeadline::CaptureDeadline(uint64_t timeout_nanoseconds)
+    : start_nanoseconds_(ClockMonotonicNanoseconds()),
+      timeout_nanoseconds_(timeout_nanoseconds),
+      truncated_phases_(0) {}
+
+CaptureDeadline::~CaptureDeadline() {}
+
+bool CaptureDeadline::Expired(Phase phase) {
+  if (!IsSet() || ElapsedNanoseconds() < timeout_nanoseconds_) {
+    return false;
+  }
+  truncated_phases_ |= phase;
+  return true;
+}
+
+uint64_t CaptureDeadline::ElapsedNanoseconds() const {
+  return ClockMonotonicNanoseconds() - start_nanoseconds_;
+}
+
+}  // namespace crashpad
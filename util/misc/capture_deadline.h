@@ -0,0 +1,95 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_MISC_CAPTURE_DEADLINE_H_
+#define CRASHPAD_UTIL_MISC_CAPTURE_DEADLINE_H_
+
+#include <stdint.h>
+
+#include "base/macros.h"
+
+namespace crashpad {
+
+//! \brief Limits the time that capturing a crash report may take.
+//!
+//! Each phase of a capture checks the deadline before doing work that can be
+//! left out, and leaves it out once the deadline has passed. The phases that
+//! left out work are recorded, so that a crash report can indicate which of
+//! its parts are incomplete.
+class CaptureDeadline {
+ public:
+  //! \brief The phases of a capture that can be cut short.
+  //!
+  //! These values are bits in the value returned by TruncatedPhases().
+  enum Phase : uint32_t {
+    //! \brief Some threads were not captured.
+    kPhaseThreads = 1 << 0,
+
+    //! \brief Some modules were not captured.
+    kPhaseModules = 1 << 1,
+
+    //! \brief Some indirectly referenced memory was not captured.
+    kPhaseIndirectlyReferencedMemory = 1 << 2,
+
+    //! \brief Some writable memory was not captured.
+    kPhaseWritableMemory = 1 << 3,
+
+    //! \brief Some user extension streams were not produced.
+    kPhaseUserStreams = 1 << 4,
+
+    //! \brief Some memory was not read while the crash report was written.
+    kPhaseSerialization = 1 << 5,
+  };
+
+  //! \brief Starts a capture that must finish within \a timeout_nanoseconds.
+  //!
+  //! \param[in] timeout_nanoseconds The time allowed for the capture, starting
+  //!     now. If `0`, the capture has no deadline and never expires.
+  explicit CaptureDeadline(uint64_t timeout_nanoseconds);
+
+  ~CaptureDeadline();
+
+  //! \brief Returns `true` if the capture has a deadline.
+  bool IsSet() const { return timeout_nanoseconds_ != 0; }
+
+  //! \brief Returns `true` if the deadline has passed.
+  //!
+  //! If it has, \a phase is recorded as having been cut short, so this should
+  //! only be called by a phase that will leave out work if the deadline has
+  //! passed.
+  //!
+  //! \param[in] phase The phase checking the deadline.
+  bool Expired(Phase phase);
+
+  //! \brief Returns the phases that were cut short, as a bitwise combination
+  //!     of Phase values.
+  uint32_t TruncatedPhases() const { return truncated_phases_; }
+
+  //! \brief Returns the time allowed for the capture, in nanoseconds.
+  uint64_t TimeoutNanoseconds() const { return timeout_nanoseconds_; }
+
+  //! \brief Returns the time since the capture started, in nanoseconds.
+  uint64_t ElapsedNanoseconds() const;
+
+ private:
+  uint64_t start_nanoseconds_;
+  uint64_t timeout_nanoseconds_;
+  uint32_t truncated_phases_;
+
+  DISALLOW_COPY_AND_ASSIGN(CaptureDeadline);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_MISC_CAPTURE_DEADLINE_H_
@@ -0,0 +1,54 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/misc/capture_deadline.h"
+
+#include "gtest/gtest.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+TEST(CaptureDeadline, Unset) {
+  CaptureDeadline deadline(0);
+  EXPECT_FALSE(deadline.IsSet());
+  EXPECT_FALSE(deadline.Expired(CaptureDeadline::kPhaseThreads));
+  EXPECT_EQ(deadline.TruncatedPhases(), 0u);
+}
+
+TEST(CaptureDeadline, NotExpired) {
+  // An hour is long enough that the deadline won’t pass during the test.
+  CaptureDeadline deadline(3600 * static_cast<uint64_t>(1E9));
+  EXPECT_TRUE(deadline.IsSet());
+  EXPECT_FALSE(deadline.Expired(CaptureDeadline::kPhaseModules));
+  EXPECT_EQ(deadline.TruncatedPhases(), 0u);
+}
+
+TEST(CaptureDeadline, Expired) {
+  CaptureDeadline deadline(1);
+  while (deadline.ElapsedNanoseconds() < 1) {
+  }
+
+  // Only the phases that checked the deadline after it passed are recorded.
+  EXPECT_TRUE(deadline.Expired(CaptureDeadline::kPhaseModules));
+  EXPECT_TRUE(deadline.Expired(CaptureDeadline::kPhaseUserStreams));
+  EXPECT_TRUE(deadline.Expired(CaptureDeadline::kPhaseModules));
+  EXPECT_EQ(deadline.TruncatedPhases(),
+            static_cast<uint32_t>(CaptureDeadline::kPhaseModules |
+                                  CaptureDeadline::kPhaseUserStreams));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -0,0 +1,73 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/misc/capture_profile.h"
+
+#include <limits>
+
+namespace crashpad {
+
+CaptureLimits CaptureLimitsForProfile(CaptureProfile profile) {
+  CaptureLimits limits;
+  switch (profile) {
+    case CaptureProfile::kMinimal:
+      limits.max_threads = 1;
+      limits.max_thread_stacks = 0;
+      limits.max_stack_size = 64 * 1024;
+      limits.max_indirectly_referenced_memory = 0;
+      limits.include_memory_map = false;
+      limits.include_writable_memory = false;
+      break;
+
+    case CaptureProfile::kFull:
+      // Indirectly referenced memory is left out, because it is either in the
+      // writable memory that is captured or in a module file.
+      limits.max_threads = 0;
+      limits.max_thread_stacks = 0;
+      limits.max_stack_size = 0;
+      limits.max_indirectly_referenced_memory = 0;
+      limits.include_memory_map = true;
+      limits.include_writable_memory = true;
+      break;
+
+    case CaptureProfile::kUnset:
+    case CaptureProfile::kDefault:
+    default:
+      limits.max_threads = 0;
+      limits.max_thread_stacks = 0;
+      limits.max_stack_size = 0;
+      limits.max_indirectly_referenced_memory =
+          std::numeric_limits<uint32_t>::max();
+      limits.include_memory_map = false;
+      limits.include_writable_memory = false;
+      break;
+  }
+  return limits;
+}
+
+bool StringToCaptureProfile(const std::string& string,
+                            CaptureProfile* profile) {
+  if (string == "minimal") {
+    *profile = CaptureProfile::kMinimal;
+  } else if (string == "default") {
+    *profile = CaptureProfile::kDefault;
+  } else if (string == "full") {
+    *profile = CaptureProfile::kFull;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+}  // namespace crashpad
@@ -0,0 +1,103 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_MISC_CAPTURE_PROFILE_H_
+#define CRASHPAD_UTIL_MISC_CAPTURE_PROFILE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+namespace crashpad {
+
+//! \brief How much of a process a crash handler captures in a snapshot.
+//!
+//! More detailed profiles produce larger crash reports, which take longer to
+//! capture and upload.
+enum class CaptureProfile : uint8_t {
+  //! \brief No profile has been selected, so the handler’s default is used.
+  //!
+  //! To allow a zero-initialized value to have this behavior, this must have
+  //! the value `0`.
+  kUnset = 0,
+
+  //! \brief Only the crashing thread, the start of its stack, and the module
+  //!     list are captured.
+  kMinimal,
+
+  //! \brief Every thread and its stack are captured, along with indirectly
+  //!     referenced memory if the client requested it.
+  kDefault,
+
+  //! \brief In addition to what kDefault captures, the memory map and the
+  //!     contents of all writable private memory are captured.
+  kFull,
+};
+
+//! \brief The limits that a CaptureProfile places on a snapshot.
+struct CaptureLimits {
+  //! \brief The maximum number of threads to capture, or `0` for no limit.
+  //!
+  //! The thread that raised an exception is always captured. The other
+  //! threads that are captured are those that were most recently active.
+  size_t max_threads;
+
+  //! \brief The maximum number of threads whose stacks are captured, or `0` for
+  //!     no limit.
+  //!
+  //! Only the registers of threads beyond this limit are captured. The stack
+  //! of the thread that raised an exception is always captured, followed by
+  //! those of the threads that were most recently active.
+  size_t max_thread_stacks;
+
+  //! \brief The maximum number of bytes of each thread’s stack to capture,
+  //!     or `0` for no limit.
+  //!
+  //! The part of the stack nearest the stack pointer is captured.
+  uint64_t max_stack_size;
+
+  //! \brief The maximum number of bytes of indirectly referenced memory to
+  //!     capture.
+  //!
+  //! This only further limits the cap that the client sets with
+  //! CrashpadInfo::set_gather_indirectly_referenced_memory(). No memory is
+  //! gathered unless the client enables it.
+  uint32_t max_indirectly_referenced_memory;
+
+  //! \brief Whether to capture the process’ memory map.
+  bool include_memory_map;
+
+  //! \brief Whether to capture the contents of all readable, writable, private
+  //!     memory.
+  bool include_writable_memory;
+};
+
+//! \brief Returns the limits that \a profile places on a snapshot.
+//!
+//! CaptureProfile::kUnset has the same limits as CaptureProfile::kDefault.
+CaptureLimits CaptureLimitsForProfile(CaptureProfile profile);
+
+//! \brief Converts a profile name to a CaptureProfile.
+//!
+//! \param[in] string The name of a profile: `"minimal"`, `"default"`, or
+//!     `"full"`.
+//! \param[out] profile The profile named by \a string.
+//! \return `true` on success, `false` if \a string doesn’t name a profile.
+bool StringToCaptureProfile(const std::string& string,
+                            CaptureProfile* profile);
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_MISC_CAPTURE_PROFILE_H_
@@ -0,0 +1,80 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/misc/capture_profile.h"
+
+#include "gtest/gtest.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+TEST(CaptureProfile, StringToCaptureProfile) {
+  CaptureProfile profile = CaptureProfile::kUnset;
+  EXPECT_TRUE(StringToCaptureProfile("minimal", &profile));
+  EXPECT_EQ(profile, CaptureProfile::kMinimal);
+  EXPECT_TRUE(StringToCaptureProfile("default", &profile));
+  EXPECT_EQ(profile, CaptureProfile::kDefault);
+  EXPECT_TRUE(StringToCaptureProfile("full", &profile));
+  EXPECT_EQ(profile, CaptureProfile::kFull);
+
+  profile = CaptureProfile::kUnset;
+  EXPECT_FALSE(StringToCaptureProfile("", &profile));
+  EXPECT_FALSE(StringToCaptureProfile("unset", &profile));
+  EXPECT_FALSE(StringToCaptureProfile("Full", &profile));
+  EXPECT_EQ(profile, CaptureProfile::kUnset);
+}
+
+TEST(CaptureProfile, CaptureLimitsForProfile) {
+  const CaptureLimits minimal =
+      CaptureLimitsForProfile(CaptureProfile::kMinimal);
+  const CaptureLimits default_limits =
+      CaptureLimitsForProfile(CaptureProfile::kDefault);
+  const CaptureLimits full = CaptureLimitsForProfile(CaptureProfile::kFull);
+
+  EXPECT_EQ(minimal.max_threads, 1u);
+  EXPECT_EQ(minimal.max_thread_stacks, 0u);
+  EXPECT_GT(minimal.max_stack_size, 0u);
+  EXPECT_EQ(minimal.max_indirectly_referenced_memory, 0u);
+  EXPECT_FALSE(minimal.include_memory_map);
+  EXPECT_FALSE(minimal.include_writable_memory);
+
+  EXPECT_EQ(default_limits.max_threads, 0u);
+  EXPECT_EQ(default_limits.max_thread_stacks, 0u);
+  EXPECT_EQ(default_limits.max_stack_size, 0u);
+  EXPECT_GT(default_limits.max_indirectly_referenced_memory, 0u);
+  EXPECT_FALSE(default_limits.include_memory_map);
+  EXPECT_FALSE(default_limits.include_writable_memory);
+
+  EXPECT_EQ(full.max_threads, 0u);
+  EXPECT_EQ(full.max_thread_stacks, 0u);
+  EXPECT_EQ(full.max_stack_size, 0u);
+  EXPECT_TRUE(full.include_memory_map);
+  EXPECT_TRUE(full.include_writable_memory);
+
+  // An unset profile behaves like the default one.
+  const CaptureLimits unset = CaptureLimitsForProfile(CaptureProfile::kUnset);
+  EXPECT_EQ(unset.max_threads, default_limits.max_threads);
+  EXPECT_EQ(unset.max_thread_stacks, default_limits.max_thread_stacks);
+  EXPECT_EQ(unset.max_stack_size, default_limits.max_stack_size);
+  EXPECT_EQ(unset.max_indirectly_referenced_memory,
+            default_limits.max_indirectly_referenced_memory);
+  EXPECT_EQ(unset.include_memory_map, default_limits.include_memory_map);
+  EXPECT_EQ(unset.include_writable_memory,
+            default_limits.include_writable_memory);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
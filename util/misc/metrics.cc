@@ -104,6 +104,12 @@ void Metrics::HandlerLifetimeMilestone(LifetimeMilestone milestone) {
                             LifetimeMilestone::kMaxValue);
 }
 
+// static
+void Metrics::LinkMapCacheLookup(LinkMapCacheResult result) {
+  UMA_HISTOGRAM_ENUMERATION(
+      "Crashpad.LinkMapCache.Lookup", result, LinkMapCacheResult::kMaxValue);
+}
+
 // static
 void Metrics::HandlerCrashed(uint32_t exception_code) {
   base::UmaHistogramSparse(
@@ -190,6 +190,35 @@ class Metrics {
   //! \brief Records a handler start/exit/crash event.
   static void HandlerLifetimeMilestone(LifetimeMilestone milestone);
 
+  //! \brief The result of looking up a process’ modules in a link map cache.
+  //!
+  //! \note These are used as metrics enumeration values, so new values should
+  //!     always be added at the end, before LinkMapCacheResult::kMaxValue.
+  enum class LinkMapCacheResult : int32_t {
+    //! \brief The cached modules were used.
+    kHit = 0,
+
+    //! \brief There were no cached modules for the process.
+    kMiss = 1,
+
+    //! \brief The process’ modules were cached, but modules were loaded or
+    //!     unloaded since.
+    kStale = 2,
+
+    //! \brief The process’ modules were cached and appeared current, but one
+    //!     of them could no longer be read.
+    kReadFailed = 3,
+
+    //! \brief The number of values in this enumeration; not a valid value.
+    kMaxValue
+  };
+
+  //! \brief Reports on the use of cached module information when capturing a
+  //!     snapshot.
+  //!
+  //! This is only used on Linux/Android.
+  static void LinkMapCacheLookup(LinkMapCacheResult result);
+
   //! \brief The handler process crashed with the given exception code.
   //!
   //! This is currently only reported on Windows.
@@ -16,13 +16,16 @@
 
 #include <algorithm>
 
+#include "base/logging.h"
+
 namespace crashpad {
 
-RangeSet::RangeSet() = default;
+RangeSet::RangeSet() : ranges_(), bases_(), lasts_(), frozen_(false) {}
 
 RangeSet::~RangeSet() = default;
 
 void RangeSet::Insert(VMAddress base, VMSize size) {
+  DCHECK(!frozen_);
   if (!size) {
     return;
   }
@@ -46,10 +49,57 @@ void RangeSet::Insert(VMAddress base, VMSize size) {
   ranges_[last] = base;
 }
 
+void RangeSet::Freeze() {
+  DCHECK(!frozen_);
+  frozen_ = true;
+
+  bases_.reserve(ranges_.size());
+  lasts_.reserve(ranges_.size());
+  for (const auto& range : ranges_) {
+    bases_.push_back(range.second);
+    lasts_.push_back(range.first);
+  }
+  ranges_.clear();
+}
+
 bool RangeSet::Contains(VMAddress address) const {
-  auto range_above_address = ranges_.lower_bound(address);
-  return range_above_address != ranges_.end() &&
-         range_above_address->second <= address;
+  if (!frozen_) {
+    auto range_above_address = ranges_.lower_bound(address);
+    return range_above_address != ranges_.end() &&
+           range_above_address->second <= address;
+  }
+
+  if (bases_.empty()) {
+    return false;
+  }
+
+  // Find the last range with a base no greater than |address|. The loop always
+  // runs log2(size) times and the comparison usually compiles to a conditional
+  // move, so there are no branches to mispredict on the data being searched.
+  const VMAddress* base = bases_.data();
+  size_t count = bases_.size();
+  while (count > 1) {
+    const size_t half = count / 2;
+    base = base[half] <= address ? base + half : base;
+    count -= half;
+  }
+
+  const size_t index = base - bases_.data();
+  return *base <= address && address <= lasts_[index];
+}
+
+bool RangeSet::IsEmpty() const {
+  return frozen_ ? bases_.empty() : ranges_.empty();
+}
+
+VMAddress RangeSet::Lowest() const {
+  DCHECK(!IsEmpty());
+  return frozen_ ? bases_.front() : ranges_.begin()->second;
+}
+
+VMAddress RangeSet::Highest() const {
+  DCHECK(!IsEmpty());
+  return frozen_ ? lasts_.back() : ranges_.rbegin()->first;
 }
 
 }  // namespace crashpad
@@ -16,6 +16,7 @@
 #define CRASHPAD_UTIL_MISC_RANGE_SET_H_
 
 #include <map>
+#include <vector>
 
 #include "base/macros.h"
 #include "util/misc/address_types.h"
@@ -23,6 +24,11 @@
 namespace crashpad {
 
 //! \brief A set of VMAddress ranges.
+//!
+//! Ranges are inserted into a tree. Once all ranges have been inserted, the set
+//! can be frozen into sorted arrays, which are faster to search. This is useful
+//! for sets that are searched many times, such as when every word of a stack is
+//! looked up.
 class RangeSet {
  public:
   RangeSet();
@@ -30,19 +36,47 @@ class RangeSet {
 
   //! \brief Inserts a range into the set.
   //!
+  //! This method must not be called after Freeze().
+  //!
   //! \param[in] base The low address of the range.
   //! \param[in] size The size of the range.
   void Insert(VMAddress base, VMSize size);
 
+  //! \brief Converts the set into a form that is faster to search.
+  //!
+  //! No ranges may be inserted after this method is called.
+  void Freeze();
+
   //! \brief Returns `true` if \a address falls within a range in this set.
   bool Contains(VMAddress address) const;
 
+  //! \brief Returns `true` if the set contains no ranges.
+  bool IsEmpty() const;
+
+  //! \brief Returns the lowest address in any range in the set.
+  //!
+  //! This method must only be called if IsEmpty() would return `false`. No
+  //! address below this value is contained in the set, which makes this useful
+  //! to quickly rule out addresses before calling Contains().
+  VMAddress Lowest() const;
+
+  //! \brief Returns the highest address in any range in the set.
+  //!
+  //! This method must only be called if IsEmpty() would return `false`.
+  VMAddress Highest() const;
+
  private:
   // Keys are the highest address in the range. Values are the base address of
   // the range. Overlapping ranges are merged on insertion. Adjacent ranges may
-  // be merged.
+  // be merged. Emptied by Freeze().
   std::map<VMAddress, VMAddress> ranges_;
 
+  // Set by Freeze(). The base and highest address of each range, sorted by
+  // address. Ranges don’t overlap.
+  std::vector<VMAddress> bases_;
+  std::vector<VMAddress> lasts_;
+  bool frozen_;
+
   DISALLOW_COPY_AND_ASSIGN(RangeSet);
 };
 
@@ -16,9 +16,11 @@
 
 #include <sys/types.h>
 
+#include <limits>
 #include <memory>
 
 #include "base/format_macros.h"
+#include "base/stl_util.h"
 #include "base/strings/stringprintf.h"
 #include "gtest/gtest.h"
 #include "util/misc/address_types.h"
@@ -111,6 +113,52 @@ TEST(RangeSet, LargeOverlappingRanges) {
   EXPECT_TRUE(ranges.Contains(addr + kBufferSize - 1));
 }
 
+TEST(RangeSet, Frozen) {
+  RangeSet ranges;
+  EXPECT_TRUE(ranges.IsEmpty());
+  ranges.Insert(37, 16);
+  ranges.Insert(9, 9);
+  ranges.Insert(17, 42);
+  ranges.Insert(100, 1);
+  ranges.Insert(200, 0);
+  ranges.Insert(300, 50);
+  EXPECT_FALSE(ranges.IsEmpty());
+  EXPECT_EQ(ranges.Lowest(), 9u);
+  EXPECT_EQ(ranges.Highest(), 349u);
+
+  bool unfrozen[400];
+  for (VMAddress address = 0; address < base::size(unfrozen); ++address) {
+    unfrozen[address] = ranges.Contains(address);
+  }
+
+  ranges.Freeze();
+  EXPECT_FALSE(ranges.IsEmpty());
+  EXPECT_EQ(ranges.Lowest(), 9u);
+  EXPECT_EQ(ranges.Highest(), 349u);
+  for (VMAddress address = 0; address < base::size(unfrozen); ++address) {
+    SCOPED_TRACE(base::StringPrintf("0x%" PRIx64, address));
+    EXPECT_EQ(ranges.Contains(address), unfrozen[address]);
+  }
+  EXPECT_FALSE(ranges.Contains(std::numeric_limits<VMAddress>::max()));
+}
+
+TEST(RangeSet, FrozenEmpty) {
+  RangeSet ranges;
+  ranges.Freeze();
+  EXPECT_TRUE(ranges.IsEmpty());
+  EXPECT_FALSE(ranges.Contains(0));
+  EXPECT_FALSE(ranges.Contains(std::numeric_limits<VMAddress>::max()));
+}
+
+TEST(RangeSet, FrozenHighestAddress) {
+  RangeSet ranges;
+  ranges.Insert(std::numeric_limits<VMAddress>::max() - 15, 16);
+  ranges.Freeze();
+  EXPECT_EQ(ranges.Highest(), std::numeric_limits<VMAddress>::max());
+  EXPECT_TRUE(ranges.Contains(std::numeric_limits<VMAddress>::max()));
+  EXPECT_FALSE(ranges.Contains(std::numeric_limits<VMAddress>::max() - 16));
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace crashpad
@@ -28,6 +28,7 @@
 namespace crashpad {
 
 constexpr uint64_t kNanosecondsPerSecond = static_cast<uint64_t>(1E9);
+constexpr uint64_t kNanosecondsPerMillisecond = static_cast<uint64_t>(1E6);
 
 //! \brief Add `timespec` \a ts1 and \a ts2 and return the result in \a result.
 void AddTimespec(const timespec& ts1, const timespec& ts2, timespec* result);
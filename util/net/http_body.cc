@@ -24,6 +24,10 @@
 
 namespace crashpad {
 
+bool HTTPBodyStream::GetFileBackedBytes(FileHandle* file, FileOffset* length) {
+  return false;
+}
+
 StringHTTPBodyStream::StringHTTPBodyStream(const std::string& string)
     : HTTPBodyStream(), string_(string), bytes_read_() {
 }
@@ -66,6 +70,32 @@ FileOperationResult FileReaderHTTPBodyStream::GetBytesBuffer(uint8_t* buffer,
   return rv;
 }
 
+bool FileReaderHTTPBodyStream::GetFileBackedBytes(FileHandle* file,
+                                                  FileOffset* length) {
+  if (reached_eof_) {
+    return false;
+  }
+
+  FileHandle file_handle = reader_->UnderlyingFileHandle();
+  if (file_handle == kInvalidFileHandle) {
+    return false;
+  }
+
+  FileOffset position = reader_->SeekGet();
+  if (position < 0) {
+    return false;
+  }
+
+  FileOffset size = LoggingFileSizeByHandle(file_handle);
+  if (size <= position) {
+    return false;
+  }
+
+  *file = file_handle;
+  *length = size - position;
+  return true;
+}
+
 CompositeHTTPBodyStream::CompositeHTTPBodyStream(
     const CompositeHTTPBodyStream::PartsList& parts)
     : HTTPBodyStream(), parts_(parts), current_part_(parts_.begin()) {
@@ -91,6 +121,16 @@ FileOperationResult CompositeHTTPBodyStream::GetBytesBuffer(uint8_t* buffer,
       // If the current part has returned 0 indicating EOF, advance the current
       // part and try again.
       ++current_part_;
+
+      // Don’t copy from a part whose bytes can be obtained directly from a
+      // file once some bytes have already been returned. The caller will be
+      // able to use GetFileBackedBytes() for that part on its next call.
+      FileHandle file;
+      FileOffset length;
+      if (bytes_copied > 0 && current_part_ != parts_.end() &&
+          (*current_part_)->GetFileBackedBytes(&file, &length)) {
+        break;
+      }
     } else if (this_read < 0) {
       return this_read;
     }
@@ -100,4 +140,10 @@ FileOperationResult CompositeHTTPBodyStream::GetBytesBuffer(uint8_t* buffer,
   return bytes_copied;
 }
 
+bool CompositeHTTPBodyStream::GetFileBackedBytes(FileHandle* file,
+                                                 FileOffset* length) {
+  return current_part_ != parts_.end() &&
+         (*current_part_)->GetFileBackedBytes(file, length);
+}
+
 }  // namespace crashpad
@@ -46,6 +46,26 @@ class HTTPBodyStream {
   virtual FileOperationResult GetBytesBuffer(uint8_t* buffer,
                                              size_t max_len) = 0;
 
+  //! \brief Determines whether the stream’s next bytes can be obtained
+  //!     directly from a file.
+  //!
+  //! When this method returns `true`, the caller may consume up to \a length
+  //! bytes from \a file, starting at its current file position, instead of
+  //! obtaining them from GetBytesBuffer(). This allows callers to transmit file
+  //! contents without copying them, for example, with `sendfile()`. The caller
+  //! must leave the file position advanced by the number of bytes consumed, as
+  //! reading from \a file would. Subsequent calls to GetBytesBuffer() will
+  //! continue with the bytes following those consumed.
+  //!
+  //! \param[out] file The file handle that the stream’s next bytes come from.
+  //! \param[out] length The number of bytes remaining in \a file that belong to
+  //!     the stream. This is always greater than `0`.
+  //!
+  //! \return `true` if the stream’s next bytes are available from \a file.
+  //!     `false` if they must be obtained from GetBytesBuffer(). The default
+  //!     implementation always returns `false`.
+  virtual bool GetFileBackedBytes(FileHandle* file, FileOffset* length);
+
  protected:
   HTTPBodyStream() {}
 };
@@ -86,6 +106,13 @@ class FileReaderHTTPBodyStream : public HTTPBodyStream {
   // HTTPBodyStream:
   FileOperationResult GetBytesBuffer(uint8_t* buffer, size_t max_len) override;
 
+  //! \copydoc HTTPBodyStream::GetFileBackedBytes()
+  //!
+  //! This returns `true` when the FileReaderInterface supplied to the
+  //! constructor is backed by a file handle, as indicated by
+  //! FileReaderInterface::UnderlyingFileHandle().
+  bool GetFileBackedBytes(FileHandle* file, FileOffset* length) override;
+
  private:
   FileReaderInterface* reader_;  // weak
   bool reached_eof_;
@@ -110,7 +137,15 @@ class CompositeHTTPBodyStream : public HTTPBodyStream {
   ~CompositeHTTPBodyStream() override;
 
   // HTTPBodyStream:
+
+  //! \copydoc HTTPBodyStream::GetBytesBuffer()
+  //!
+  //! Bytes from several parts may be combined into \a buffer, but this method
+  //! will not proceed into a part for which GetFileBackedBytes() returns
+  //! `true` after bytes from a preceding part have been copied. This gives
+  //! callers an opportunity to obtain that part’s bytes directly from its file.
   FileOperationResult GetBytesBuffer(uint8_t* buffer, size_t max_len) override;
+  bool GetFileBackedBytes(FileHandle* file, FileOffset* length) override;
 
  private:
   PartsList parts_;
@@ -148,6 +148,84 @@ TEST(FileReaderHTTPBodyStream, ReadBinaryFile) {
   ExpectBufferSet(buf, '!', sizeof(buf));
 }
 
+TEST(FileReaderHTTPBodyStream, FileBackedBytes) {
+  // HEX contents of file: |FEEDFACE A11A15|.
+  base::FilePath path = TestPaths::TestDataRoot().Append(
+      FILE_PATH_LITERAL("util/net/testdata/binary_http_body.dat"));
+
+  FileReader reader;
+  ASSERT_TRUE(reader.Open(path));
+  FileReaderHTTPBodyStream stream(&reader);
+
+  FileHandle file;
+  FileOffset length;
+  ASSERT_TRUE(stream.GetFileBackedBytes(&file, &length));
+  EXPECT_EQ(file, reader.UnderlyingFileHandle());
+  EXPECT_EQ(length, 7);
+
+  // Reading advances the file position, leaving fewer bytes for the caller to
+  // obtain directly from the file.
+  uint8_t buf[4];
+  EXPECT_EQ(stream.GetBytesBuffer(buf, sizeof(buf)), 4);
+  ASSERT_TRUE(stream.GetFileBackedBytes(&file, &length));
+  EXPECT_EQ(length, 3);
+
+  // Consuming the rest of the file directly leaves nothing for
+  // GetBytesBuffer().
+  ASSERT_TRUE(LoggingReadFileExactly(file, buf, static_cast<size_t>(length)));
+  EXPECT_FALSE(stream.GetFileBackedBytes(&file, &length));
+  EXPECT_EQ(stream.GetBytesBuffer(buf, sizeof(buf)), 0);
+  EXPECT_FALSE(stream.GetFileBackedBytes(&file, &length));
+}
+
+TEST(StringHTTPBodyStream, NotFileBacked) {
+  StringHTTPBodyStream stream("Hello, world");
+
+  FileHandle file;
+  FileOffset length;
+  EXPECT_FALSE(stream.GetFileBackedBytes(&file, &length));
+}
+
+TEST(CompositeHTTPBodyStream, StopsAtFileBackedPart) {
+  std::string string1("Hello! ");
+  std::string string2(" Goodbye :)");
+
+  std::vector<HTTPBodyStream*> parts;
+  parts.push_back(new StringHTTPBodyStream(string1));
+  base::FilePath path = TestPaths::TestDataRoot().Append(
+      FILE_PATH_LITERAL("util/net/testdata/ascii_http_body.txt"));
+
+  FileReader reader;
+  ASSERT_TRUE(reader.Open(path));
+  parts.push_back(new FileReaderHTTPBodyStream(&reader));
+  parts.push_back(new StringHTTPBodyStream(string2));
+
+  CompositeHTTPBodyStream stream(parts);
+
+  FileHandle file;
+  FileOffset length;
+  EXPECT_FALSE(stream.GetFileBackedBytes(&file, &length));
+
+  // Even though the buffer is large enough for the entire stream, only the
+  // first part is returned, because the second part is file-backed.
+  uint8_t buf[64];
+  ASSERT_EQ(stream.GetBytesBuffer(buf, sizeof(buf)),
+            implicit_cast<FileOperationResult>(string1.length()));
+  EXPECT_EQ(std::string(reinterpret_cast<char*>(buf), string1.length()),
+            string1);
+
+  ASSERT_TRUE(stream.GetFileBackedBytes(&file, &length));
+  EXPECT_EQ(file, reader.UnderlyingFileHandle());
+  const std::string file_contents("This is a test.\n");
+  ASSERT_EQ(length, implicit_cast<FileOffset>(file_contents.length()));
+  ASSERT_TRUE(LoggingReadFileExactly(file, buf, file_contents.length()));
+  EXPECT_EQ(std::string(reinterpret_cast<char*>(buf), file_contents.length()),
+            file_contents);
+
+  EXPECT_FALSE(stream.GetFileBackedBytes(&file, &length));
+  EXPECT_EQ(ReadStreamToString(&stream), string2);
+}
+
 TEST(CompositeHTTPBodyStream, TwoEmptyStrings) {
   std::vector<HTTPBodyStream*> parts;
   parts.push_back(new StringHTTPBodyStream(std::string()));
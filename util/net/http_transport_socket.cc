@@ -15,9 +15,14 @@
 #include "util/net/http_transport.h"
 
 #include <fcntl.h>
+#include <inttypes.h>
 #include <netdb.h>
 #include <poll.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <memory>
 
 #include "base/logging.h"
 #include "base/macros.h"
@@ -27,12 +32,17 @@
 #include "base/stl_util.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/stringprintf.h"
+#include "build/build_config.h"
 #include "util/file/file_io.h"
 #include "util/net/http_body.h"
 #include "util/net/url.h"
 #include "util/stdlib/string_number_conversion.h"
 #include "util/string/split_string.h"
 
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+#include <sys/sendfile.h>
+#endif
+
 #if defined(CRASHPAD_USE_BORINGSSL)
 #include <openssl/ssl.h>
 #endif
@@ -67,6 +77,35 @@ class Stream {
   virtual bool LoggingWrite(const void* data, size_t size) = 0;
   virtual bool LoggingRead(void* data, size_t size) = 0;
   virtual bool LoggingReadToEOF(std::string* contents) = 0;
+
+  // Writes the concatenation of the |iovcnt| buffers in |iov|. The default
+  // implementation writes each buffer separately.
+  virtual bool LoggingWritev(const iovec* iov, int iovcnt) {
+    for (int index = 0; index < iovcnt; ++index) {
+      if (iov[index].iov_len != 0 &&
+          !LoggingWrite(iov[index].iov_base, iov[index].iov_len)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Writes |size| bytes read from |file|, starting at its current file
+  // position, and leaves the file position advanced past those bytes. The
+  // default implementation copies the data through a buffer.
+  virtual bool LoggingSendFile(FileHandle file, FileOffset size) {
+    char buffer[32 * 1024];
+    while (size > 0) {
+      size_t chunk_size = static_cast<size_t>(
+          std::min(size, static_cast<FileOffset>(sizeof(buffer))));
+      if (!LoggingReadFileExactly(file, buffer, chunk_size) ||
+          !LoggingWrite(buffer, chunk_size)) {
+        return false;
+      }
+      size -= chunk_size;
+    }
+    return true;
+  }
 };
 
 class FdStream : public Stream {
@@ -85,8 +124,71 @@ class FdStream : public Stream {
     return crashpad::LoggingReadToEOF(fd_, result);
   }
 
+  bool LoggingWritev(const iovec* iov, int iovcnt) override {
+    constexpr int kMaxIovecs = 8;
+    DCHECK_LE(iovcnt, kMaxIovecs);
+    iovec remaining[kMaxIovecs];
+    std::copy(iov, iov + iovcnt, remaining);
+
+    iovec* next = remaining;
+    while (iovcnt > 0) {
+      ssize_t rv = HANDLE_EINTR(writev(fd_, next, iovcnt));
+      if (rv < 0) {
+        PLOG(ERROR) << "writev";
+        return false;
+      }
+
+      // Skip past the buffers that were written completely, and adjust the
+      // first buffer that was written partially, if any.
+      size_t written = rv;
+      while (iovcnt > 0 && written >= next->iov_len) {
+        written -= next->iov_len;
+        ++next;
+        --iovcnt;
+      }
+      if (iovcnt > 0) {
+        next->iov_base = static_cast<char*>(next->iov_base) + written;
+        next->iov_len -= written;
+      }
+    }
+    return true;
+  }
+
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  bool LoggingSendFile(FileHandle file, FileOffset size) override {
+    // sendfile() transfers at most this many bytes in a single call.
+    constexpr size_t kMaxSendFileSize = 0x7ffff000;
+
+    while (size > 0 && sendfile_supported_) {
+      size_t chunk_size = static_cast<size_t>(
+          std::min(size, static_cast<FileOffset>(kMaxSendFileSize)));
+      ssize_t rv = HANDLE_EINTR(sendfile(fd_, file, nullptr, chunk_size));
+      if (rv < 0) {
+        if (errno == EINVAL || errno == ENOSYS) {
+          // The file or the kernel doesn’t support sendfile(). The file
+          // position hasn’t moved, so fall back to copying what remains.
+          sendfile_supported_ = false;
+          break;
+        }
+        PLOG(ERROR) << "sendfile";
+        return false;
+      }
+      if (rv == 0) {
+        LOG(ERROR) << "sendfile: unexpected EOF";
+        return false;
+      }
+      size -= rv;
+    }
+
+    return Stream::LoggingSendFile(file, size);
+  }
+#endif  // OS_LINUX || OS_ANDROID
+
  private:
   int fd_;
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  bool sendfile_supported_ = true;
+#endif  // OS_LINUX || OS_ANDROID
 
   DISALLOW_COPY_AND_ASSIGN(FdStream);
 };
@@ -175,6 +277,29 @@ class SSLStream : public Stream {
     return SSL_read(ssl_.get(), data, size) != 0;
   }
 
+  // TLS can’t send from a file without copying, but SSL_write() is called with
+  // pieces as large as the file, up to a limit, rather than with the base
+  // class’ small stack buffer, so that each piece fills many TLS records.
+  bool LoggingSendFile(FileHandle file, FileOffset size) override {
+    constexpr FileOffset kMaxPieceSize = 1024 * 1024;
+    const size_t buffer_size =
+        static_cast<size_t>(std::min(size, kMaxPieceSize));
+    if (buffer_size == 0) {
+      return true;
+    }
+    std::unique_ptr<char[]> buffer(new char[buffer_size]);
+    while (size > 0) {
+      size_t piece_size = static_cast<size_t>(
+          std::min(size, static_cast<FileOffset>(buffer_size)));
+      if (!LoggingReadFileExactly(file, buffer.get(), piece_size) ||
+          !LoggingWrite(buffer.get(), piece_size)) {
+        return false;
+      }
+      size -= piece_size;
+    }
+    return true;
+  }
+
   bool LoggingReadToEOF(std::string* contents) override {
     contents->clear();
     char buffer[4096];
@@ -364,8 +489,35 @@ bool WriteRequest(Stream* stream,
     return false;
   }
 
-  FileOperationResult data_bytes;
-  do {
+  // In chunked mode, the CRLF that terminates a chunk sent directly from a file
+  // is deferred so that it can be written together with whatever follows it.
+  bool chunk_terminator_pending = false;
+
+  for (;;) {
+    FileHandle file;
+    FileOffset file_bytes;
+    if (body_stream->GetFileBackedBytes(&file, &file_bytes)) {
+      // Send this part of the body straight from the file, without copying it
+      // through a buffer.
+      DCHECK_GT(file_bytes, 0);
+      if (chunked) {
+        std::string chunk_header = base::StringPrintf(
+            "%s%" PRIx64 "%s",
+            chunk_terminator_pending ? kCRLFTerminator : "",
+            static_cast<uint64_t>(file_bytes),
+            kCRLFTerminator);
+        if (!stream->LoggingWrite(chunk_header.data(), chunk_header.size())) {
+          return false;
+        }
+        chunk_terminator_pending = true;
+      }
+
+      if (!stream->LoggingSendFile(file, file_bytes)) {
+        return false;
+      }
+      continue;
+    }
+
     constexpr size_t kCRLFSize = base::size(kCRLFTerminator) - 1;
     struct __attribute__((packed)) {
       char size[8];
@@ -377,7 +529,7 @@ bool WriteRequest(Stream* stream,
         "buf should not have padding");
 
     // Read a block of data.
-    data_bytes =
+    FileOperationResult data_bytes =
         body_stream->GetBytesBuffer(buf.data, sizeof(buf.data) - kCRLFSize);
     if (data_bytes == -1) {
       return false;
@@ -427,10 +579,25 @@ bool WriteRequest(Stream* stream,
     // sent to signal EOF. This will happen when processing the EOF indicated by
     // a 0 return from body_stream()->GetBytesBuffer() above.
     if (write_size != 0) {
-      if (!stream->LoggingWrite(write_start, write_size))
+      iovec iov[2];
+      int iovcnt = 0;
+      if (chunk_terminator_pending) {
+        iov[iovcnt].iov_base = const_cast<char*>(kCRLFTerminator);
+        iov[iovcnt].iov_len = kCRLFSize;
+        ++iovcnt;
+        chunk_terminator_pending = false;
+      }
+      iov[iovcnt].iov_base = write_start;
+      iov[iovcnt].iov_len = write_size;
+      ++iovcnt;
+      if (!stream->LoggingWritev(iov, iovcnt))
         return false;
     }
-  } while (data_bytes > 0);
+
+    if (data_bytes == 0) {
+      break;
+    }
+  }
 
   return true;
 }
@@ -31,8 +31,10 @@
 #include "build/build_config.h"
 #include "gtest/gtest.h"
 #include "test/multiprocess_exec.h"
+#include "test/scoped_temp_dir.h"
 #include "test/test_paths.h"
 #include "util/file/file_io.h"
+#include "util/file/file_reader.h"
 #include "util/misc/random_string.h"
 #include "util/net/http_body.h"
 #include "util/net/http_headers.h"
@@ -360,6 +362,71 @@ TEST_P(HTTPTransport, Upload33k_LengthUnknown) {
   RunUpload33k(GetParam(), false);
 }
 
+// Large enough to require sending the file in several pieces when it isn’t
+// sent directly from the file.
+constexpr size_t kAttachmentSize = 200 * 1024 + 3;
+
+std::string AttachmentContents() {
+  std::string contents(kAttachmentSize, '\0');
+  for (size_t index = 0; index < contents.size(); ++index) {
+    contents[index] = static_cast<char>(index % 251);
+  }
+  return contents;
+}
+
+void ValidFileAttachment(HTTPTransportTestFixture* fixture,
+                         const std::string& request) {
+  std::string boundary;
+  GetMultipartBoundary(request, &boundary);
+
+  size_t body_start = request.find("\r\n\r\n");
+  ASSERT_NE(body_start, std::string::npos);
+  body_start += 4;
+
+  std::string expected = "--" + boundary + "\r\n";
+  expected += "Content-Disposition: form-data; name=\"key1\"\r\n\r\n";
+  expected += "test\r\n";
+  expected += "--" + boundary + "\r\n";
+  expected +=
+      "Content-Disposition: form-data; name=\"file\"; "
+      "filename=\"file.dat\"\r\n";
+  expected += "Content-Type: application/octet-stream\r\n\r\n";
+  expected += AttachmentContents();
+  expected += "\r\n";
+  expected += "--" + boundary + "--\r\n";
+  ASSERT_EQ(request.length(), body_start + expected.length());
+  EXPECT_TRUE(request.compare(body_start, expected.length(), expected) == 0);
+}
+
+TEST_P(HTTPTransport, UploadFileAttachment) {
+  // A file-backed part of the body is sent directly from the file when
+  // possible. Make sure that the surrounding parts arrive intact.
+  ScopedTempDir temp_dir;
+  base::FilePath path = temp_dir.path().Append(FILE_PATH_LITERAL("file.dat"));
+  const std::string contents = AttachmentContents();
+  {
+    ScopedFileHandle file(LoggingOpenFileForWrite(
+        path, FileWriteMode::kCreateOrFail, FilePermissions::kOwnerOnly));
+    ASSERT_TRUE(file.is_valid());
+    ASSERT_TRUE(LoggingWriteFile(file.get(), contents.data(), contents.size()));
+  }
+
+  FileReader reader;
+  ASSERT_TRUE(reader.Open(path));
+
+  HTTPMultipartBuilder builder;
+  builder.SetFormData("key1", "test");
+  builder.SetFileAttachment(
+      "file", "file.dat", &reader, "application/octet-stream");
+
+  HTTPHeaders headers;
+  builder.PopulateContentHeaders(&headers);
+
+  HTTPTransportTestFixture test(
+      GetParam(), headers, builder.GetBodyStream(), 200, &ValidFileAttachment);
+  test.Run();
+}
+
 // This should be on for Fuchsia, but DX-382. Debug and re-enabled.
 #if defined(CRASHPAD_USE_BORINGSSL) && !defined(OS_FUCHSIA)
 // The test server requires BoringSSL or OpenSSL, so https in tests can only be
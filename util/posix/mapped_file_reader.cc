@@ -0,0 +1,144 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/posix/mapped_file_reader.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <limits>
+
+#include "base/logging.h"
+#include "base/numerics/safe_math.h"
+#include "util/file/file_io.h"
+#include "util/numeric/safe_assignment.h"
+
+namespace crashpad {
+
+MappedFileReader::MappedFileReader()
+    : mapping_(), size_(0), offset_(0), open_(false) {}
+
+MappedFileReader::~MappedFileReader() {}
+
+bool MappedFileReader::Open(const base::FilePath& path) {
+  CHECK(!open_);
+
+  ScopedFileHandle handle(LoggingOpenFileForRead(path));
+  if (!handle.is_valid()) {
+    return false;
+  }
+
+  const FileOffset file_size = LoggingFileSizeByHandle(handle.get());
+  if (file_size < 0) {
+    return false;
+  }
+
+  size_t size;
+  if (!AssignIfInRange(&size, file_size)) {
+    LOG(ERROR) << "file too large to map " << path.value();
+    return false;
+  }
+
+  // mmap() rejects zero-length mappings, but an empty file is still readable.
+  if (size > 0 &&
+      !mapping_.ResetMmap(
+          nullptr, size, PROT_READ, MAP_PRIVATE, handle.get(), 0)) {
+    return false;
+  }
+
+  // The mapping holds its own reference to the file, so the handle can be
+  // closed now.
+  size_ = size;
+  offset_ = 0;
+  open_ = true;
+  return true;
+}
+
+void MappedFileReader::Close() {
+  CHECK(open_);
+  mapping_.Reset();
+  size_ = 0;
+  offset_ = 0;
+  open_ = false;
+}
+
+FileOperationResult MappedFileReader::Read(void* data, size_t size) {
+  DCHECK(open_);
+
+  if (offset_ >= size_) {
+    return 0;
+  }
+
+  const size_t nread = std::min(
+      {size,
+       size_ - offset_,
+       static_cast<size_t>(std::numeric_limits<FileOperationResult>::max())});
+  memcpy(data, mapping_.addr_as<const char*>() + offset_, nread);
+  offset_ += nread;
+  return nread;
+}
+
+const void* MappedFileReader::MappedData(FileOffset offset, size_t size) {
+  DCHECK(open_);
+
+  size_t offset_sizet;
+  if (!AssignIfInRange(&offset_sizet, offset) || offset_sizet > size_ ||
+      size > size_ - offset_sizet) {
+    return nullptr;
+  }
+
+  if (size_ == 0) {
+    // There’s no mapping for an empty file, but an empty view of it is still
+    // valid, so return a non-null pointer that will never be dereferenced.
+    static constexpr char kEmpty = '\0';
+    return &kEmpty;
+  }
+
+  return mapping_.addr_as<const char*>() + offset_sizet;
+}
+
+FileOffset MappedFileReader::Seek(FileOffset offset, int whence) {
+  DCHECK(open_);
+
+  FileOffset base_offset;
+  switch (whence) {
+    case SEEK_SET:
+      base_offset = 0;
+      break;
+    case SEEK_CUR:
+      base_offset = static_cast<FileOffset>(offset_);
+      break;
+    case SEEK_END:
+      base_offset = static_cast<FileOffset>(size_);
+      break;
+    default:
+      LOG(ERROR) << "Seek(): invalid whence " << whence;
+      return -1;
+  }
+
+  base::CheckedNumeric<FileOffset> new_offset(base_offset);
+  new_offset += offset;
+  size_t new_offset_sizet;
+  if (!new_offset.AssignIfValid(&new_offset_sizet)) {
+    LOG(ERROR) << "Seek(): new_offset invalid";
+    return -1;
+  }
+
+  offset_ = new_offset_sizet;
+  return static_cast<FileOffset>(offset_);
+}
+
+}  // namespace crashpad
@@ -0,0 +1,77 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_POSIX_MAPPED_FILE_READER_H_
+#define CRASHPAD_UTIL_POSIX_MAPPED_FILE_READER_H_
+
+#include <sys/types.h>
+
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "util/file/file_reader.h"
+#include "util/posix/scoped_mmap.h"
+
+namespace crashpad {
+
+//! \brief A file reader that maps an entire file into memory.
+//!
+//! Read() copies out of the mapping, and MappedData() provides views into it
+//! without copying, so that large files can be consumed without reading all
+//! of their contents up front. Pages are only brought in from disk as they are
+//! touched.
+//!
+//! The file must not be truncated while it is mapped, because accessing a page
+//! beyond the end of the file will raise `SIGBUS`.
+class MappedFileReader : public FileReaderInterface {
+ public:
+  MappedFileReader();
+  ~MappedFileReader() override;
+
+  //! \brief Opens and maps the file at \a path.
+  //!
+  //! \return `true` if the operation succeeded, `false` if it failed, with an
+  //!     error message logged.
+  //!
+  //! \note After a successful call, this method cannot be called again until
+  //!     after Close().
+  bool Open(const base::FilePath& path);
+
+  //! \brief Unmaps the file.
+  //!
+  //! Pointers previously returned by MappedData() become invalid.
+  //!
+  //! \note It is only valid to call this method on an object that has had a
+  //!     successful Open() that has not yet been matched by a subsequent call
+  //!     to this method.
+  void Close();
+
+  // FileReaderInterface:
+  FileOperationResult Read(void* data, size_t size) override;
+  const void* MappedData(FileOffset offset, size_t size) override;
+
+  // FileSeekerInterface:
+  FileOffset Seek(FileOffset offset, int whence) override;
+
+ private:
+  ScopedMmap mapping_;
+  size_t size_;
+  size_t offset_;
+  bool open_;
+
+  DISALLOW_COPY_AND_ASSIGN(MappedFileReader);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_POSIX_MAPPED_FILE_READER_H_
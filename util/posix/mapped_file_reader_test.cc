@@ -0,0 +1,98 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/posix/mapped_file_reader.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "test/scoped_temp_dir.h"
+#include "util/file/file_io.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+void WriteTestFile(const base::FilePath& path, const std::string& contents) {
+  ScopedFileHandle handle(LoggingOpenFileForWrite(
+      path, FileWriteMode::kCreateOrFail, FilePermissions::kOwnerOnly));
+  ASSERT_TRUE(handle.is_valid());
+  ASSERT_TRUE(
+      LoggingWriteFile(handle.get(), contents.data(), contents.size()));
+}
+
+TEST(MappedFileReader, ReadAndMappedData) {
+  ScopedTempDir temp_dir;
+  const base::FilePath path = temp_dir.path().Append("file");
+  ASSERT_NO_FATAL_FAILURE(WriteTestFile(path, "abcdefgh"));
+
+  MappedFileReader reader;
+  ASSERT_TRUE(reader.Open(path));
+
+  char buffer[4];
+  ASSERT_TRUE(reader.ReadExactly(buffer, 3));
+  EXPECT_EQ(std::string(buffer, 3), "abc");
+  EXPECT_EQ(reader.Seek(0, SEEK_CUR), 3);
+
+  const char* view = static_cast<const char*>(reader.MappedData(2, 6));
+  ASSERT_TRUE(view);
+  EXPECT_EQ(std::string(view, 6), "cdefgh");
+  EXPECT_EQ(reader.MappedData(8, 0), view + 6);
+  EXPECT_FALSE(reader.MappedData(2, 7));
+  EXPECT_FALSE(reader.MappedData(9, 0));
+  EXPECT_FALSE(reader.MappedData(-1, 1));
+
+  // MappedData() doesn’t move the file position.
+  EXPECT_EQ(reader.Seek(0, SEEK_CUR), 3);
+
+  EXPECT_EQ(reader.Seek(-2, SEEK_END), 6);
+  EXPECT_EQ(reader.Read(buffer, sizeof(buffer)), 2);
+  EXPECT_EQ(std::string(buffer, 2), "gh");
+  EXPECT_EQ(reader.Read(buffer, sizeof(buffer)), 0);
+
+  EXPECT_EQ(reader.Seek(10, SEEK_SET), 10);
+  EXPECT_EQ(reader.Read(buffer, sizeof(buffer)), 0);
+  EXPECT_LT(reader.Seek(-11, SEEK_CUR), 0);
+
+  reader.Close();
+}
+
+TEST(MappedFileReader, EmptyFile) {
+  ScopedTempDir temp_dir;
+  const base::FilePath path = temp_dir.path().Append("empty");
+  ASSERT_NO_FATAL_FAILURE(WriteTestFile(path, std::string()));
+
+  MappedFileReader reader;
+  ASSERT_TRUE(reader.Open(path));
+
+  char c;
+  EXPECT_EQ(reader.Read(&c, 1), 0);
+  EXPECT_TRUE(reader.MappedData(0, 0));
+  EXPECT_FALSE(reader.MappedData(0, 1));
+
+  reader.Close();
+}
+
+TEST(MappedFileReader, NonexistentFile) {
+  ScopedTempDir temp_dir;
+  MappedFileReader reader;
+  EXPECT_FALSE(reader.Open(temp_dir.path().Append("nonexistent")));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
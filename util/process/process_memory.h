@@ -127,7 +127,8 @@ class ProcessMemory {
                                    VMSize size,
                                    std::string* string) const;
 
-  // Allow ProcessMemorySanitized to call ReadUpTo.
+  // Allow ProcessMemoryOverlay and ProcessMemorySanitized to call ReadUpTo.
+  friend class ProcessMemoryOverlay;
   friend class ProcessMemorySanitized;
 };
 
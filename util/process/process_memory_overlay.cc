@@ -0,0 +1,125 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/process/process_memory_overlay.h"
+
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/posix/eintr_wrapper.h"
+
+namespace crashpad {
+
+ProcessMemoryOverlay::ProcessMemoryOverlay()
+    : ProcessMemory(), memory_(nullptr), regions_(), initialized_() {}
+
+ProcessMemoryOverlay::~ProcessMemoryOverlay() {}
+
+bool ProcessMemoryOverlay::Initialize(const ProcessMemory* memory,
+                                      const Region& region) {
+  return Initialize(memory, std::vector<Region>(1, region));
+}
+
+bool ProcessMemoryOverlay::Initialize(const ProcessMemory* memory,
+                                      const std::vector<Region>& regions) {
+  INITIALIZATION_STATE_SET_INITIALIZING(initialized_);
+
+  regions_ = regions;
+  std::sort(regions_.begin(),
+            regions_.end(),
+            [](const Region& lhs, const Region& rhs) {
+              return lhs.address < rhs.address;
+            });
+
+  for (size_t index = 0; index < regions_.size(); ++index) {
+    const Region& region = regions_[index];
+    if (region.address + region.size < region.address) {
+      LOG(ERROR) << "region out of range";
+      return false;
+    }
+    if (index > 0 && regions_[index - 1].address + regions_[index - 1].size >
+                         region.address) {
+      LOG(ERROR) << "overlapping regions";
+      return false;
+    }
+  }
+
+  memory_ = memory;
+  INITIALIZATION_STATE_SET_VALID(initialized_);
+  return true;
+}
+
+ssize_t ProcessMemoryOverlay::ReadUpTo(VMAddress address,
+                                       size_t size,
+                                       void* buffer) const {
+  INITIALIZATION_STATE_DCHECK_VALID(initialized_);
+
+  // Find the first region that starts after |address|. Only the region before
+  // it can contain |address|.
+  auto next_region = std::upper_bound(
+      regions_.begin(),
+      regions_.end(),
+      address,
+      [](VMAddress value, const Region& region) {
+        return value < region.address;
+      });
+
+  if (next_region != regions_.begin()) {
+    const Region& region = *(next_region - 1);
+    const VMAddress region_end = region.address + region.size;
+    if (address < region_end) {
+      const size_t local_size =
+          static_cast<size_t>(std::min(VMSize{size}, region_end - address));
+      if (region.data) {
+        memcpy(buffer,
+               static_cast<const char*>(region.data) +
+                   (address - region.address),
+               local_size);
+        return local_size;
+      }
+
+      const uint64_t file_offset =
+          region.file_offset + (address - region.address);
+      const ssize_t bytes_read = HANDLE_EINTR(
+          pread64(region.file, buffer, local_size, file_offset));
+      if (bytes_read < 0) {
+        PLOG(ERROR) << "pread64";
+        return -1;
+      }
+      if (bytes_read == 0) {
+        LOG(ERROR) << "unexpected end of file";
+        return -1;
+      }
+      return bytes_read;
+    }
+  }
+
+  if (!memory_) {
+    LOG(ERROR) << "address 0x" << std::hex << address
+               << " is outside of the local regions";
+    return -1;
+  }
+
+  // Stop reading from |memory_| at the start of the next region, so that the
+  // rest is read locally.
+  if (next_region != regions_.end() && next_region->address - address < size) {
+    size = static_cast<size_t>(next_region->address - address);
+  }
+  return memory_->ReadUpTo(address, size, buffer);
+}
+
+}  // namespace crashpad
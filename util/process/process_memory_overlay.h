@@ -0,0 +1,106 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CRASHPAD_UTIL_PROCESS_PROCESS_MEMORY_OVERLAY_H_
+#define CRASHPAD_UTIL_PROCESS_PROCESS_MEMORY_OVERLAY_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <vector>
+
+#include "base/macros.h"
+#include "util/misc/address_types.h"
+#include "util/misc/initialization_state_dcheck.h"
+#include "util/process/process_memory.h"
+
+namespace crashpad {
+
+//! \brief Accesses the memory of another process, reading some regions of it
+//!     from mappings in the current process.
+//!
+//! This is used for memory that the target process shares with the current
+//! process, or whose contents are otherwise known to be identical to memory in
+//! the current process, so that it can be read without accessing the target
+//! process at all.
+class ProcessMemoryOverlay final : public ProcessMemory {
+ public:
+  //! \brief A region of the target process’s memory that is also mapped into
+  //!     the current process, or whose contents are in a file.
+  struct Region {
+    //! \brief The address of the region in the target process.
+    VMAddress address;
+
+    //! \brief The size of the region.
+    VMSize size;
+
+    //! \brief The address of the region’s contents in the current process, or
+    //!     `nullptr` to read them from #file.
+    const void* data;
+
+    //! \brief A file to read the region’s contents from, starting at
+    //!     #file_offset, if #data is `nullptr`.
+    //!
+    //! Unlike reading from a mapping of the file, reading from a file that has
+    //! been truncated fails instead of raising `SIGBUS`.
+    int file;
+
+    //! \brief The offset in #file of the region’s contents.
+    uint64_t file_offset;
+  };
+
+  ProcessMemoryOverlay();
+  ~ProcessMemoryOverlay();
+
+  //! \brief Initializes this object to read \a region locally, and all other
+  //!     memory from \a memory.
+  //!
+  //! This method must be called successfully prior to calling any other method
+  //! in this class.
+  //!
+  //! \param[in] memory The memory object to read memory outside of \a region
+  //!     from. May be `nullptr`, in which case only \a region can be read.
+  //! \param[in] region The region to read from the current process.
+  //!
+  //! \return `true` on success, `false` on failure with a message logged.
+  bool Initialize(const ProcessMemory* memory, const Region& region);
+
+  //! \brief Initializes this object to read \a regions locally, and all other
+  //!     memory from \a memory.
+  //!
+  //! This method must be called successfully prior to calling any other method
+  //! in this class.
+  //!
+  //! \param[in] memory The memory object to read memory outside of \a regions
+  //!     from. May be `nullptr`, in which case only \a regions can be read.
+  //! \param[in] regions The regions to read from the current process. These
+  //!     may be given in any order, but must not overlap.
+  //!
+  //! \return `true` on success, `false` on failure with a message logged.
+  bool Initialize(const ProcessMemory* memory,
+                  const std::vector<Region>& regions);
+
+ private:
+  ssize_t ReadUpTo(VMAddress address, size_t size, void* buffer) const override;
+
+  const ProcessMemory* memory_;
+  std::vector<Region> regions_;  // Sorted by address.
+  InitializationStateDcheck initialized_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProcessMemoryOverlay);
+};
+
+}  // namespace crashpad
+
+#endif  // CRASHPAD_UTIL_PROCESS_PROCESS_MEMORY_OVERLAY_H_
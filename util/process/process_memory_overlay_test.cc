@@ -0,0 +1,158 @@
+// Copyright 2020 The Crashpad Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "util/process/process_memory_overlay.h"
+
+#include <string.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "gtest/gtest.h"
+#include "test/errors.h"
+#include "test/process_type.h"
+#include "test/scoped_temp_dir.h"
+#include "util/file/file_io.h"
+#include "util/misc/from_pointer_cast.h"
+#include "util/process/process_memory_native.h"
+
+namespace crashpad {
+namespace test {
+namespace {
+
+TEST(ProcessMemoryOverlay, ReadsRegionLocally) {
+  ProcessMemoryNative memory;
+  ASSERT_TRUE(memory.Initialize(GetSelfProcess()));
+
+  char remote[8] = "ABCDEFG";
+  const char local[] = "cde";
+
+  ProcessMemoryOverlay::Region region;
+  region.address = FromPointerCast<VMAddress>(remote + 2);
+  region.size = 3;
+  region.data = local;
+
+  ProcessMemoryOverlay overlay;
+  ASSERT_TRUE(overlay.Initialize(&memory, region));
+
+  // Reads spanning the region combine the local and remote memory.
+  char out[8];
+  ASSERT_TRUE(overlay.Read(FromPointerCast<VMAddress>(remote), 8, out));
+  EXPECT_EQ(memcmp(out, "ABcdeFG", 8), 0);
+
+  ASSERT_TRUE(overlay.Read(FromPointerCast<VMAddress>(remote + 3), 1, out));
+  EXPECT_EQ(out[0], 'd');
+
+  ASSERT_TRUE(overlay.Read(FromPointerCast<VMAddress>(remote + 5), 2, out));
+  EXPECT_EQ(memcmp(out, "FG", 2), 0);
+}
+
+TEST(ProcessMemoryOverlay, RegionOnly) {
+  char remote[4] = "ABC";
+  const char local[] = "abc";
+
+  ProcessMemoryOverlay::Region region;
+  region.address = FromPointerCast<VMAddress>(remote);
+  region.size = 2;
+  region.data = local;
+
+  ProcessMemoryOverlay overlay;
+  ASSERT_TRUE(overlay.Initialize(nullptr, region));
+
+  char out[4];
+  ASSERT_TRUE(overlay.Read(FromPointerCast<VMAddress>(remote), 2, out));
+  EXPECT_EQ(memcmp(out, "ab", 2), 0);
+  EXPECT_FALSE(overlay.Read(FromPointerCast<VMAddress>(remote), 3, out));
+}
+
+TEST(ProcessMemoryOverlay, MultipleRegions) {
+  ProcessMemoryNative memory;
+  ASSERT_TRUE(memory.Initialize(GetSelfProcess()));
+
+  char remote[9] = "ABCDEFGH";
+  const char local_1[] = "b";
+  const char local_2[] = "efg";
+
+  std::vector<ProcessMemoryOverlay::Region> regions(2);
+  regions[0].address = FromPointerCast<VMAddress>(remote + 4);
+  regions[0].size = 3;
+  regions[0].data = local_2;
+  regions[1].address = FromPointerCast<VMAddress>(remote + 1);
+  regions[1].size = 1;
+  regions[1].data = local_1;
+
+  ProcessMemoryOverlay overlay;
+  ASSERT_TRUE(overlay.Initialize(&memory, regions));
+
+  char out[9];
+  ASSERT_TRUE(overlay.Read(FromPointerCast<VMAddress>(remote), 8, out));
+  EXPECT_EQ(memcmp(out, "AbCDefgH", 8), 0);
+
+  ASSERT_TRUE(overlay.Read(FromPointerCast<VMAddress>(remote + 5), 3, out));
+  EXPECT_EQ(memcmp(out, "fgH", 3), 0);
+}
+
+TEST(ProcessMemoryOverlay, FileRegion) {
+  ProcessMemoryNative memory;
+  ASSERT_TRUE(memory.Initialize(GetSelfProcess()));
+
+  ScopedTempDir temp_dir;
+  const base::FilePath path = temp_dir.path().Append("file");
+  ScopedFileHandle file(LoggingOpenFileForReadAndWrite(
+      path, FileWriteMode::kCreateOrFail, FilePermissions::kOwnerOnly));
+  ASSERT_TRUE(file.is_valid());
+  ASSERT_TRUE(LoggingWriteFile(file.get(), "abcdef", 6));
+
+  char remote[9] = "ABCDEFGH";
+  ProcessMemoryOverlay::Region region;
+  region.address = FromPointerCast<VMAddress>(remote + 2);
+  region.size = 4;
+  region.data = nullptr;
+  region.file = file.get();
+  region.file_offset = 2;
+
+  ProcessMemoryOverlay overlay;
+  ASSERT_TRUE(overlay.Initialize(&memory, region));
+
+  char out[9];
+  ASSERT_TRUE(overlay.Read(FromPointerCast<VMAddress>(remote), 8, out));
+  EXPECT_EQ(memcmp(out, "ABcdefGH", 8), 0);
+
+  // Reading past the end of a truncated file fails.
+  ASSERT_EQ(ftruncate(file.get(), 4), 0) << ErrnoMessage("ftruncate");
+  ASSERT_TRUE(overlay.Read(FromPointerCast<VMAddress>(remote + 2), 2, out));
+  EXPECT_EQ(memcmp(out, "cd", 2), 0);
+  EXPECT_FALSE(overlay.Read(FromPointerCast<VMAddress>(remote + 2), 4, out));
+}
+
+TEST(ProcessMemoryOverlay, OverlappingRegions) {
+  char remote[4] = "ABC";
+  const char local[] = "abc";
+
+  std::vector<ProcessMemoryOverlay::Region> regions(2);
+  regions[0].address = FromPointerCast<VMAddress>(remote);
+  regions[0].size = 2;
+  regions[0].data = local;
+  regions[1].address = FromPointerCast<VMAddress>(remote + 1);
+  regions[1].size = 2;
+  regions[1].data = local + 1;
+
+  ProcessMemoryOverlay overlay;
+  EXPECT_FALSE(overlay.Initialize(nullptr, regions));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace crashpad
@@ -82,6 +82,17 @@ class WorkerThread {
   //!     \a work_interval.
   void DoWorkNow();
 
+  //! \brief Overrides the \a work_interval for the wait that follows the
+  //!     current invocation of the work function.
+  //!
+  //! This may only be called from Delegate::DoWork(). It permits a delegate
+  //! that knows when it will next have work to do to sleep until then, or
+  //! indefinitely if it will only have work after DoWorkNow() is called.
+  //!
+  //! \param[in] delay The time in seconds to wait before invoking the work
+  //!     function again. This can be #kIndefiniteWait.
+  void SetNextWorkDelay(double delay);
+
   //! \return `true` if the thread is running, `false` if it is not.
   bool is_running() const { return running_; }
 
@@ -89,6 +100,7 @@ class WorkerThread {
   friend class internal::WorkerThreadImpl;
 
   double work_interval_;
+  double next_work_delay_;
   Delegate* delegate_;  // weak
   std::unique_ptr<internal::WorkerThreadImpl> impl_;
   bool running_;
@@ -156,6 +156,51 @@ TEST(WorkerThread, DoWorkNowAtStart) {
   EXPECT_FALSE(thread.is_running());
 }
 
+class DelayingDelegate : public WorkerThread::Delegate {
+ public:
+  DelayingDelegate() {}
+  ~DelayingDelegate() {}
+
+  void DoWork(const WorkerThread* thread) override {
+    ++work_count_;
+    thread_->SetNextWorkDelay(WorkerThread::kIndefiniteWait);
+    semaphore_.Signal();
+  }
+
+  void set_thread(WorkerThread* thread) { thread_ = thread; }
+
+  void WaitForWork() { semaphore_.Wait(); }
+
+  int work_count() const { return work_count_; }
+
+ private:
+  Semaphore semaphore_{0};
+  WorkerThread* thread_ = nullptr;
+  int work_count_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(DelayingDelegate);
+};
+
+TEST(WorkerThread, SetNextWorkDelay) {
+  DelayingDelegate delegate;
+  WorkerThread thread(0.01, &delegate);
+  delegate.set_thread(&thread);
+
+  thread.Start(0);
+  delegate.WaitForWork();
+
+  // The delegate asked to wait indefinitely, so the short work interval
+  // doesn’t cause more work until DoWorkNow() is called.
+  SleepNanoseconds(kNanosecondsPerSecond / 10);
+  EXPECT_EQ(delegate.work_count(), 1);
+
+  thread.DoWorkNow();
+  delegate.WaitForWork();
+  EXPECT_EQ(delegate.work_count(), 2);
+
+  thread.Stop();
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace crashpad
@@ -62,6 +62,8 @@
         'linux/checked_address_range.h',
         'linux/direct_ptrace_connection.cc',
         'linux/direct_ptrace_connection.h',
+        'linux/directory_watcher.cc',
+        'linux/directory_watcher.h',
         'linux/exception_handler_client.cc',
         'linux/exception_handler_client.h',
         'linux/exception_handler_protocol.cc',
@@ -69,6 +71,8 @@
         'linux/exception_information.h',
         'linux/memory_map.cc',
         'linux/memory_map.h',
+        'linux/page_map.cc',
+        'linux/page_map.h',
         'linux/proc_stat_reader.cc',
         'linux/proc_stat_reader.h',
         'linux/proc_task_reader.cc',
@@ -137,6 +141,10 @@
         'misc/arraysize.h',
         'misc/as_underlying_type.h',
         'misc/capture_context.h',
+        'misc/capture_deadline.cc',
+        'misc/capture_deadline.h',
+        'misc/capture_profile.cc',
+        'misc/capture_profile.h',
         'misc/capture_context_linux.S',
         'misc/capture_context_mac.S',
         'misc/capture_context_win.asm',
@@ -206,6 +214,8 @@
         'posix/drop_privileges.h',
         'posix/double_fork_and_exec.cc',
         'posix/double_fork_and_exec.h',
+        'posix/mapped_file_reader.cc',
+        'posix/mapped_file_reader.h',
         'posix/process_info.h',
         'posix/process_info_linux.cc',
         'posix/process_info_mac.cc',
@@ -417,6 +427,8 @@
         ['OS=="linux" or OS=="android"', {
           'sources': [
             'net/http_transport_socket.cc',
+            'process/process_memory_overlay.cc',
+            'process/process_memory_overlay.h',
             'process/process_memory_sanitized.cc',
             'process/process_memory_sanitized.h',
           ],
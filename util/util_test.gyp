@@ -43,7 +43,9 @@
         'file/filesystem_test.cc',
         'file/string_file_test.cc',
         'linux/auxiliary_vector_test.cc',
+        'linux/directory_watcher_test.cc',
         'linux/memory_map_test.cc',
+        'linux/page_map_test.cc',
         'linux/proc_stat_reader_test.cc',
         'linux/proc_task_reader_test.cc',
         'linux/ptrace_broker_test.cc',
@@ -71,6 +73,8 @@
         'misc/arraysize_test.cc',
         'misc/capture_context_test.cc',
         'misc/capture_context_test_util.h',
+        'misc/capture_deadline_test.cc',
+        'misc/capture_profile_test.cc',
         'misc/capture_context_test_util_linux.cc',
         'misc/capture_context_test_util_mac.cc',
         'misc/capture_context_test_util_win.cc',
@@ -96,6 +100,7 @@
         'numeric/checked_range_test.cc',
         'numeric/in_range_cast_test.cc',
         'numeric/int128_test.cc',
+        'posix/mapped_file_reader_test.cc',
         'posix/process_info_test.cc',
         'posix/scoped_mmap_test.cc',
         'posix/signals_test.cc',
@@ -156,6 +161,7 @@
         }],
         ['OS=="linux" or OS=="android"', {
           'sources': [
+            'process/process_memory_overlay_test.cc',
             'process/process_memory_sanitized_test.cc',
           ],
         }],